@@ -43,6 +43,7 @@ struct _EAddressbookModelPrivate {
 
 	/* Query Results */
 	GPtrArray *contacts;
+	GHashTable *contact_indexes; /* gchar *uid ~> index in contacts + 1 */
 
 	/* Signal Handler IDs */
 	gulong create_contact_id;
@@ -73,7 +74,7 @@ enum {
 	FOLDER_BAR_MESSAGE,
 	CONTACT_ADDED,
 	CONTACTS_REMOVED,
-	CONTACT_CHANGED,
+	CONTACTS_CHANGED,
 	MODEL_CHANGED,
 	STOP_STATE_CHANGED,
 	LAST_SIGNAL
@@ -91,6 +92,34 @@ free_data (EAddressbookModel *model)
 	array = model->priv->contacts;
 	g_ptr_array_foreach (array, (GFunc) g_object_unref, NULL);
 	g_ptr_array_set_size (array, 0);
+
+	g_hash_table_remove_all (model->priv->contact_indexes);
+}
+
+static void
+set_contact_index (EAddressbookModel *model,
+                   EContact *contact,
+                   guint index)
+{
+	const gchar *uid;
+
+	uid = e_contact_get_const (contact, E_CONTACT_UID);
+	if (uid != NULL)
+		g_hash_table_insert (
+			model->priv->contact_indexes,
+			g_strdup (uid), GUINT_TO_POINTER (index + 1));
+}
+
+/* Returns -1 when the contact is not in the model. */
+static gint
+find_contact_index (EAddressbookModel *model,
+                    const gchar *uid)
+{
+	gpointer value;
+
+	value = g_hash_table_lookup (model->priv->contact_indexes, uid);
+
+	return value ? GPOINTER_TO_INT (value) - 1 : -1;
 }
 
 static void
@@ -186,6 +215,7 @@ view_create_contact_cb (EBookClientView *client_view,
 	while (contact_list != NULL) {
 		EContact *contact = contact_list->data;
 
+		set_contact_index (model, contact, array->len);
 		g_ptr_array_add (array, g_object_ref (contact));
 		contact_list = contact_list->next;
 	}
@@ -209,103 +239,129 @@ view_remove_contact_cb (EBookClientView *client_view,
                         const GSList *ids,
                         EAddressbookModel *model)
 {
-	/* XXX we should keep a hash around instead of this O(n*m) loop */
 	const GSList *iter;
 	GArray *indices;
 	GPtrArray *array;
-	gint ii;
+	guint ii, jj;
 
 	array = model->priv->contacts;
 	indices = g_array_new (FALSE, FALSE, sizeof (gint));
 
 	for (iter = ids; iter != NULL; iter = iter->next) {
 		const gchar *target_uid = iter->data;
+		gint index;
 
-		for (ii = 0; ii < array->len; ii++) {
-			EContact *contact;
-			const gchar *uid;
+		index = find_contact_index (model, target_uid);
+		if (index < 0 || !array->pdata[index])
+			continue;
 
-			contact = array->pdata[ii];
-			/* check if already removed */
-			if (!contact)
-				continue;
+		g_object_unref (array->pdata[index]);
+		array->pdata[index] = NULL;
 
-			uid = e_contact_get_const (contact, E_CONTACT_UID);
-			g_return_if_fail (uid != NULL);
+		g_hash_table_remove (model->priv->contact_indexes, target_uid);
+		g_array_append_val (indices, index);
+	}
 
-			if (strcmp (uid, target_uid) == 0) {
-				g_object_unref (contact);
-				g_array_append_val (indices, ii);
-				array->pdata[ii] = NULL;
-				break;
-			}
-		}
+	if (indices->len == 0) {
+		g_array_free (indices, TRUE);
+		return;
 	}
 
-	/* Sort the 'indices' array in descending order, since
-	 * g_ptr_array_remove_index() shifts subsequent elements
-	 * down one position to fill the gap. */
-	g_array_sort (indices, sort_descending);
+	/* Compact the array in one pass, moving the remaining
+	 * contacts down over the gaps and fixing their indexes. */
+	for (ii = 0, jj = 0; ii < array->len; ii++) {
+		EContact *contact = array->pdata[ii];
 
-	for (ii = 0; ii < indices->len; ii++) {
-		gint index;
+		if (!contact)
+			continue;
 
-		index = g_array_index (indices, gint, ii);
-		g_ptr_array_remove_index (array, index);
+		if (ii != jj) {
+			array->pdata[jj] = contact;
+			set_contact_index (model, contact, jj);
+		}
+
+		jj++;
 	}
 
+	g_ptr_array_set_size (array, jj);
+
+	/* The listeners expect the indices in descending order,
+	 * as if the rows were removed one after another. */
+	g_array_sort (indices, sort_descending);
+
 	g_signal_emit (model, signals[CONTACTS_REMOVED], 0, indices);
-	g_array_free (indices, FALSE);
+	g_array_free (indices, TRUE);
 
 	update_folder_bar_message (model);
 }
 
+static gint
+sort_ascending (gconstpointer ca,
+                gconstpointer cb)
+{
+	gint a = *((gint *) ca);
+	gint b = *((gint *) cb);
+
+	return (a == b) ? 0 : (a < b) ? -1 : 1;
+}
+
 static void
 view_modify_contact_cb (EBookClientView *client_view,
                         const GSList *contact_list,
                         EAddressbookModel *model)
 {
 	GPtrArray *array;
+	GArray *indices;
+	guint ii, start;
 
 	array = model->priv->contacts;
+	indices = g_array_new (FALSE, FALSE, sizeof (gint));
 
 	while (contact_list != NULL) {
 		EContact *new_contact = contact_list->data;
 		const gchar *target_uid;
-		gint ii;
+		gint index;
 
 		target_uid = e_contact_get_const (new_contact, E_CONTACT_UID);
 		g_warn_if_fail (target_uid != NULL);
 
+		contact_list = contact_list->next;
+
 		/* skip contacts without UID */
-		if (!target_uid) {
-			contact_list = contact_list->next;
+		if (!target_uid)
+			continue;
+
+		index = find_contact_index (model, target_uid);
+		if (index < 0)
 			continue;
-		}
 
-		for (ii = 0; ii < array->len; ii++) {
-			EContact *old_contact;
-			const gchar *uid;
+		/* The view does not change the contacts it passes around,
+		 * thus a reference is enough, no need for a deep copy. */
+		g_object_unref (array->pdata[index]);
+		array->pdata[index] = g_object_ref (new_contact);
 
-			old_contact = array->pdata[ii];
-			g_return_if_fail (old_contact != NULL);
+		g_array_append_val (indices, index);
+	}
 
-			uid = e_contact_get_const (old_contact, E_CONTACT_UID);
-			g_return_if_fail (uid != NULL);
+	/* Notify about each run of adjacent changed rows at once. */
+	g_array_sort (indices, sort_ascending);
 
-			if (strcmp (uid, target_uid) != 0)
-				continue;
+	for (ii = 0, start = 0; ii < indices->len; ii++) {
+		gint index = g_array_index (indices, gint, ii);
 
-			g_object_unref (old_contact);
-			array->pdata[ii] = e_contact_duplicate (new_contact);
+		if (ii + 1 < indices->len &&
+		    g_array_index (indices, gint, ii + 1) <= index + 1)
+			continue;
 
-			g_signal_emit (
-				model, signals[CONTACT_CHANGED], 0, ii);
-			break;
-		}
+		g_signal_emit (
+			model, signals[CONTACTS_CHANGED], 0,
+			g_array_index (indices, gint, start),
+			index - g_array_index (indices, gint, start) + 1);
 
-		contact_list = contact_list->next;
+		start = ii + 1;
 	}
+
+	g_array_free (indices, TRUE);
 }
 
 static void
@@ -577,6 +633,7 @@ addressbook_model_finalize (GObject *object)
 	priv = E_ADDRESSBOOK_MODEL_GET_PRIVATE (object);
 
 	g_ptr_array_free (priv->contacts, TRUE);
+	g_hash_table_destroy (priv->contact_indexes);
 
 	/* Chain up to parent's finalize() method. */
 	G_OBJECT_CLASS (e_addressbook_model_parent_class)->finalize (object);
@@ -734,14 +791,15 @@ e_addressbook_model_class_init (EAddressbookModelClass *class)
 		G_TYPE_NONE, 1,
 		G_TYPE_POINTER);
 
-	signals[CONTACT_CHANGED] = g_signal_new (
-		"contact_changed",
+	signals[CONTACTS_CHANGED] = g_signal_new (
+		"contacts_changed",
 		G_OBJECT_CLASS_TYPE (object_class),
 		G_SIGNAL_RUN_LAST,
-		G_STRUCT_OFFSET (EAddressbookModelClass, contact_changed),
+		G_STRUCT_OFFSET (EAddressbookModelClass, contacts_changed),
 		NULL, NULL,
-		g_cclosure_marshal_VOID__INT,
-		G_TYPE_NONE, 1,
+		e_marshal_NONE__INT_INT,
+		G_TYPE_NONE, 2,
+		G_TYPE_INT,
 		G_TYPE_INT);
 
 	signals[MODEL_CHANGED] = g_signal_new (
@@ -768,6 +826,8 @@ e_addressbook_model_init (EAddressbookModel *model)
 {
 	model->priv = E_ADDRESSBOOK_MODEL_GET_PRIVATE (model);
 	model->priv->contacts = g_ptr_array_new ();
+	model->priv->contact_indexes = g_hash_table_new_full (
+		g_str_hash, g_str_equal, g_free, NULL);
 	model->priv->first_get_view = TRUE;
 }
 
@@ -863,7 +923,8 @@ e_addressbook_model_find (EAddressbookModel *model,
                           EContact *contact)
 {
 	GPtrArray *array;
-	gint ii;
+	const gchar *uid;
+	gint index;
 
 	/* XXX This searches for a particular EContact instance,
 	 *     as opposed to an equivalent but possibly different
@@ -873,13 +934,15 @@ e_addressbook_model_find (EAddressbookModel *model,
 	g_return_val_if_fail (E_IS_ADDRESSBOOK_MODEL (model), -1);
 	g_return_val_if_fail (E_IS_CONTACT (contact), -1);
 
+	uid = e_contact_get_const (contact, E_CONTACT_UID);
+	if (uid == NULL)
+		return -1;
+
 	array = model->priv->contacts;
-	for (ii = 0; ii < array->len; ii++) {
-		EContact *candidate = array->pdata[ii];
+	index = find_contact_index (model, uid);
 
-		if (contact == candidate)
-			return ii;
-	}
+	if (index >= 0 && array->pdata[index] == contact)
+		return index;
 
 	return -1;
 }
@@ -73,8 +73,9 @@ struct _EAddressbookModelClass {
 						 gint count);
 	void		(*contacts_removed)	(EAddressbookModel *model,
 						 gpointer id_list);
-	void		(*contact_changed)	(EAddressbookModel *model,
-						 gint index);
+	void		(*contacts_changed)	(EAddressbookModel *model,
+						 gint index,
+						 gint count);
 	void		(*model_changed)	(EAddressbookModel *model);
 	void		(*stop_state_changed)	(EAddressbookModel *model);
 };
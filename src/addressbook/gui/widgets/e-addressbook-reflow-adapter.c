@@ -384,11 +384,15 @@ remove_contacts (EAddressbookModel *model,
 }
 
 static void
-modify_contact (EAddressbookModel *model,
-                gint index,
-                EAddressbookReflowAdapter *adapter)
+modify_contacts (EAddressbookModel *model,
+                 gint index,
+                 gint count,
+                 EAddressbookReflowAdapter *adapter)
 {
-	e_reflow_model_item_changed (E_REFLOW_MODEL (adapter), index);
+	gint ii;
+
+	for (ii = 0; ii < count; ii++)
+		e_reflow_model_item_changed (E_REFLOW_MODEL (adapter), index + ii);
 }
 
 static void
@@ -607,8 +611,8 @@ e_addressbook_reflow_adapter_construct (EAddressbookReflowAdapter *adapter,
 		G_CALLBACK (remove_contacts), adapter);
 
 	priv->modify_contact_id = g_signal_connect (
-		priv->model, "contact_changed",
-		G_CALLBACK (modify_contact), adapter);
+		priv->model, "contacts_changed",
+		G_CALLBACK (modify_contacts), adapter);
 
 	priv->model_changed_id = g_signal_connect (
 		priv->model, "model_changed",
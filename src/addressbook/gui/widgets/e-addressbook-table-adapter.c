@@ -405,30 +405,53 @@ remove_contacts (EAddressbookModel *model,
                 EAddressbookTableAdapter *adapter)
 {
 	GArray *indices = (GArray *) data;
-	gint count = indices->len;
+	gint ii, first, count;
 
 	/* clear whole cache */
 	g_hash_table_remove_all (adapter->priv->emails);
 
+	/* The model has already removed all the contacts, thus only
+	 * a single run of adjacent rows (in descending order) can be
+	 * reported as deleted without listeners seeing a row count
+	 * which does not match the rows being deleted. */
+	for (ii = 1; ii < indices->len; ii++) {
+		if (g_array_index (indices, gint, ii) != g_array_index (indices, gint, ii - 1) - 1)
+			break;
+	}
+
 	e_table_model_pre_change (E_TABLE_MODEL (adapter));
-	if (count == 1)
-		e_table_model_rows_deleted (
-			E_TABLE_MODEL (adapter),
-			g_array_index (indices, gint, 0), 1);
-	else
+
+	if (indices->len == 0 || ii < indices->len) {
 		e_table_model_changed (E_TABLE_MODEL (adapter));
+		return;
+	}
+
+	count = indices->len;
+	first = g_array_index (indices, gint, count - 1);
+
+	e_table_model_rows_deleted (E_TABLE_MODEL (adapter), first, count);
 }
 
 static void
-modify_contact (EAddressbookModel *model,
-                gint index,
-                EAddressbookTableAdapter *adapter)
+modify_contacts (EAddressbookModel *model,
+                 gint index,
+                 gint count,
+                 EAddressbookTableAdapter *adapter)
 {
+	gint *rows;
+	gint ii;
+
 	/* clear whole cache */
 	g_hash_table_remove_all (adapter->priv->emails);
 
+	rows = g_new (gint, MAX (count, 1));
+	for (ii = 0; ii < count; ii++)
+		rows[ii] = index + ii;
+
 	e_table_model_pre_change (E_TABLE_MODEL (adapter));
-	e_table_model_row_changed (E_TABLE_MODEL (adapter), index);
+	e_table_model_rows_changed (E_TABLE_MODEL (adapter), rows, count);
+
+	g_free (rows);
 }
 
 static void
@@ -460,8 +483,8 @@ e_addressbook_table_adapter_construct (EAddressbookTableAdapter *adapter,
 		G_CALLBACK (remove_contacts), adapter);
 
 	priv->modify_contact_id = g_signal_connect (
-		priv->model, "contact_changed",
-		G_CALLBACK (modify_contact), adapter);
+		priv->model, "contacts_changed",
+		G_CALLBACK (modify_contacts), adapter);
 
 	priv->model_changed_id = g_signal_connect (
 		priv->model, "model_changed",
@@ -450,13 +450,10 @@ e_minicard_view_selection_event (EReflow *reflow,
 	switch (event->type) {
 	case GDK_FOCUS_CHANGE:
 		if (event->focus_change.in) {
-			gint i;
-			for (i = 0; i < reflow->count; i++) {
-				if (reflow->items[i] == item) {
-					e_selection_model_maybe_do_something (reflow->selection, i, 0, 0);
-					break;
-				}
-			}
+			gint row = e_reflow_get_item_row (reflow, item);
+
+			if (row != -1)
+				e_selection_model_maybe_do_something (reflow->selection, row, 0, 0);
 		}
 		break;
 	case GDK_BUTTON_PRESS:
@@ -670,14 +670,7 @@ e_minicard_event (GnomeCanvasItem *item,
 						view_index--;
 
 					model_index = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), view_index);
-					if (reflow->items[model_index] == NULL) {
-						reflow->items[model_index] = e_reflow_model_incarnate (reflow->model, model_index, GNOME_CANVAS_GROUP (reflow));
-						g_object_set (
-							reflow->items[model_index],
-							"width", (gdouble) reflow->column_width,
-							NULL);
-
-					}
+					e_reflow_incarnate_row (reflow, model_index);
 					e_canvas_item_grab_focus (reflow->items[model_index], FALSE);
 					return TRUE;
 				}
@@ -697,14 +690,7 @@ e_minicard_event (GnomeCanvasItem *item,
 						view_index++;
 
 					model_index = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), view_index);
-					if (reflow->items[model_index] == NULL) {
-						reflow->items[model_index] = e_reflow_model_incarnate (reflow->model, model_index, GNOME_CANVAS_GROUP (reflow));
-						g_object_set (
-							reflow->items[model_index],
-							"width", (gdouble) reflow->column_width,
-							NULL);
-
-					}
+					e_reflow_incarnate_row (reflow, model_index);
 					e_canvas_item_grab_focus (reflow->items[model_index], FALSE);
 					return TRUE;
 				}
@@ -737,13 +723,7 @@ e_minicard_event (GnomeCanvasItem *item,
 				gdouble xx, yy;
 
 				model_index = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), ii);
-				if (reflow->items[model_index] == NULL) {
-					reflow->items[model_index] = e_reflow_model_incarnate (reflow->model, model_index, GNOME_CANVAS_GROUP (reflow));
-					g_object_set (
-						reflow->items[model_index],
-						"width", (gdouble) reflow->column_width,
-						NULL);
-				}
+				e_reflow_incarnate_row (reflow, model_index);
 
 				g_object_get (G_OBJECT (reflow->items[model_index]),
 					"x", &xx,
@@ -786,13 +766,7 @@ e_minicard_event (GnomeCanvasItem *item,
 			}
 
 			if (adept_index != -1) {
-				if (reflow->items[adept_index] == NULL) {
-					reflow->items[adept_index] = e_reflow_model_incarnate (reflow->model, adept_index, GNOME_CANVAS_GROUP (reflow));
-					g_object_set (
-						reflow->items[adept_index],
-						"width", (gdouble) reflow->column_width,
-						NULL);
-				}
+				e_reflow_incarnate_row (reflow, adept_index);
 
 				e_canvas_item_grab_focus (reflow->items[adept_index], FALSE);
 			}
@@ -834,3 +834,535 @@ eab_contact_locate_match_full (ESourceRegistry *registry,
 	g_object_unref (source);
 }
 
+
+/*** Bulk matching ***/
+
+/* Instead of one book query per contact, the whole book is read once
+ * and its contacts are split into blocks by keys, which any two contacts
+ * eab_contact_compare() can rate better than EAB_CONTACT_MATCH_VAGUE
+ * have in common: the file-as, the family name, the given and additional
+ * names (with the synonyms folded together) and the e-mail user names.
+ * The phone numbers are not used, eab_contact_compare_telephone() does
+ * not compare them. Only the contacts sharing a block are compared. */
+
+#define MATCH_SERIAL_LIMIT 64
+
+static gint
+name_synonym_index (GPtrArray *names,
+                    const gchar *name)
+{
+	gchar *folded;
+	guint ii;
+
+	folded = g_utf8_casefold (name, -1);
+
+	for (ii = 0; ii < names->len; ii++) {
+		if (g_str_equal (g_ptr_array_index (names, ii), folded)) {
+			g_free (folded);
+			return ii;
+		}
+	}
+
+	g_ptr_array_add (names, folded);
+
+	return names->len - 1;
+}
+
+static gpointer
+name_synonym_roots_init (gpointer unused)
+{
+	GHashTable *roots;
+	GPtrArray *names;
+	GArray *pairs, *root;
+	gboolean changed;
+	guint ii;
+
+	names = g_ptr_array_new ();
+	pairs = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	for (ii = 0; name_synonyms[ii][0]; ii++) {
+		gint a = name_synonym_index (names, name_synonyms[ii][0]);
+		gint b = name_synonym_index (names, name_synonyms[ii][1]);
+
+		g_array_append_val (pairs, a);
+		g_array_append_val (pairs, b);
+	}
+
+	root = g_array_sized_new (FALSE, FALSE, sizeof (gint), names->len);
+	for (ii = 0; ii < names->len; ii++)
+		g_array_append_val (root, ii);
+
+	/* The synonyms are pairs, but "will", "william" and "bill" should
+	 * end in the same block, thus use the smallest name of each chain */
+	do {
+		changed = FALSE;
+
+		for (ii = 0; ii < pairs->len; ii += 2) {
+			gint a = g_array_index (pairs, gint, ii);
+			gint b = g_array_index (pairs, gint, ii + 1);
+			gint ra = g_array_index (root, gint, a);
+			gint rb = g_array_index (root, gint, b);
+			gint rr;
+
+			if (ra == rb)
+				continue;
+
+			rr = strcmp (g_ptr_array_index (names, ra), g_ptr_array_index (names, rb)) < 0 ? ra : rb;
+
+			g_array_index (root, gint, a) = rr;
+			g_array_index (root, gint, b) = rr;
+			changed = TRUE;
+		}
+	} while (changed);
+
+	/* The names are owned by the table, which is never freed */
+	roots = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (ii = 0; ii < names->len; ii++) {
+		g_hash_table_insert (
+			roots, g_ptr_array_index (names, ii),
+			g_ptr_array_index (names, g_array_index (root, gint, ii)));
+	}
+
+	g_ptr_array_free (names, TRUE);
+	g_array_free (pairs, TRUE);
+	g_array_free (root, TRUE);
+
+	return roots;
+}
+
+/* Returns a key, which is the same for the strings e_utf8_casefold_collate()
+ * considers equal; the synonyms are folded together for the given names */
+static gchar *
+match_collate_key (const gchar *prefix,
+                   const gchar *value,
+                   gboolean synonyms)
+{
+	gchar *folded, *collate_key, *key;
+
+	folded = g_utf8_casefold (value, -1);
+
+	if (synonyms) {
+		static GOnce roots_once = G_ONCE_INIT;
+		const gchar *root;
+
+		g_once (&roots_once, name_synonym_roots_init, NULL);
+
+		root = g_hash_table_lookup (roots_once.retval, folded);
+		if (root) {
+			g_free (folded);
+			folded = g_strdup (root);
+		}
+	}
+
+	collate_key = g_utf8_collate_key (folded, -1);
+	key = g_strconcat (prefix, collate_key, NULL);
+
+	g_free (collate_key);
+	g_free (folded);
+
+	return key;
+}
+
+static void
+match_add_email_keys (GPtrArray *keys,
+                      EContact *contact)
+{
+	GList *emails, *link;
+
+	emails = e_contact_get (contact, E_CONTACT_EMAIL);
+
+	for (link = emails; link; link = g_list_next (link)) {
+		const gchar *addr = link->data, *at;
+		gchar *user;
+
+		if (!addr || !*addr)
+			continue;
+
+		/* match_email_username() compares only the part before '@',
+		 * case insensitively */
+		at = strchr (addr, '@');
+		user = g_ascii_strdown (addr, at ? at - addr : -1);
+		g_ptr_array_add (keys, g_strconcat ("e:", user, NULL));
+		g_free (user);
+	}
+
+	g_list_free_full (emails, g_free);
+}
+
+/* Returns the blocking keys of the contact, as a NULL-terminated array.
+ * It also makes sure the contact's vCard is parsed, thus it can be read
+ * from more threads at once later. */
+static gchar **
+match_contact_keys (EContact *contact)
+{
+	GPtrArray *keys;
+	gchar *file_as;
+
+	keys = g_ptr_array_new ();
+
+	file_as = e_contact_get (contact, E_CONTACT_FILE_AS);
+	if (file_as && *file_as)
+		g_ptr_array_add (keys, match_collate_key ("f:", file_as, FALSE));
+	g_free (file_as);
+
+	if (!e_contact_get (contact, E_CONTACT_IS_LIST)) {
+		EContactName *name;
+
+		name = e_contact_get (contact, E_CONTACT_NAME);
+		if (name) {
+			if (name->family && *name->family)
+				g_ptr_array_add (keys, match_collate_key ("n:", name->family, FALSE));
+
+			/* Two matching names without the family name are enough
+			 * for eab_contact_compare_name() to rate it partial */
+			if (name->given && *name->given && name->additional && *name->additional) {
+				gchar *given, *additional;
+
+				given = match_collate_key ("g:", name->given, TRUE);
+				additional = match_collate_key ("|", name->additional, TRUE);
+				g_ptr_array_add (keys, g_strconcat (given, additional, NULL));
+				g_free (given);
+				g_free (additional);
+			}
+
+			e_contact_name_free (name);
+		}
+
+		match_add_email_keys (keys, contact);
+	}
+
+	g_ptr_array_add (keys, NULL);
+
+	return (gchar **) g_ptr_array_free (keys, FALSE);
+}
+
+typedef struct _MatchJob {
+	GPtrArray *book_contacts;	/* EContact * */
+	gchar ***book_keys;
+	GHashTable *blocks;		/* gchar *key ~> GArray { guint index to book_contacts } */
+
+	/* The contacts to find matches for; the book_contacts when NULL */
+	GPtrArray *contacts;
+	gchar ***contacts_keys;
+
+	EContact **matches;
+	EABContactMatchType *types;
+
+	GCancellable *cancellable;
+	volatile gint next_contact;
+} MatchJob;
+
+static void
+match_job_locate (MatchJob *job,
+                  guint contact_index,
+                  guint *seen)
+{
+	EContact *contact, *best_contact = NULL;
+	EABContactMatchType best_match = EAB_CONTACT_MATCH_NONE;
+	gchar **keys;
+	guint ii, jj;
+
+	if (job->contacts) {
+		contact = g_ptr_array_index (job->contacts, contact_index);
+		keys = job->contacts_keys[contact_index];
+	} else {
+		contact = g_ptr_array_index (job->book_contacts, contact_index);
+		keys = job->book_keys[contact_index];
+	}
+
+	for (ii = 0; keys[ii] && best_match != EAB_CONTACT_MATCH_EXACT; ii++) {
+		GArray *block;
+
+		block = g_hash_table_lookup (job->blocks, keys[ii]);
+		if (!block)
+			continue;
+
+		for (jj = 0; jj < block->len && best_match != EAB_CONTACT_MATCH_EXACT; jj++) {
+			guint other = g_array_index (block, guint, jj);
+			EContact *other_contact;
+			EABContactMatchType match;
+
+			/* Within the book itself each pair is compared only once */
+			if (!job->contacts && other <= contact_index)
+				continue;
+
+			if (seen[other] == contact_index + 1)
+				continue;
+
+			seen[other] = contact_index + 1;
+
+			other_contact = g_ptr_array_index (job->book_contacts, other);
+			match = eab_contact_compare (contact, other_contact);
+
+			if ((gint) match > (gint) best_match) {
+				best_match = match;
+				best_contact = other_contact;
+			}
+		}
+	}
+
+	job->matches[contact_index] = best_contact;
+	job->types[contact_index] = best_match;
+}
+
+static gpointer
+match_job_thread (gpointer user_data)
+{
+	MatchJob *job = user_data;
+	guint n_contacts, contact_index, *seen;
+
+	n_contacts = job->contacts ? job->contacts->len : job->book_contacts->len;
+	seen = g_new0 (guint, job->book_contacts->len);
+
+	while (contact_index = g_atomic_int_add (&job->next_contact, 1), contact_index < n_contacts) {
+		if (g_cancellable_is_cancelled (job->cancellable))
+			break;
+
+		match_job_locate (job, contact_index, seen);
+	}
+
+	g_free (seen);
+
+	return NULL;
+}
+
+/**
+ * eab_contact_match_result_free:
+ * @result: an #EABContactMatchResult
+ *
+ * Frees the @result, as returned in the array
+ * by eab_contact_locate_matches_sync().
+ **/
+void
+eab_contact_match_result_free (EABContactMatchResult *result)
+{
+	if (result) {
+		g_clear_object (&result->contact);
+		g_clear_object (&result->match);
+		g_free (result);
+	}
+}
+
+/**
+ * eab_contact_locate_matches_sync:
+ * @book_client: The book to look in.
+ * @contacts: (nullable): The contacts to compare to.
+ * @cancellable: (nullable): a #GCancellable
+ * @error: return location for a #GError, or %NULL
+ *
+ * Looks for the best match of each of the @contacts in the @book_client,
+ * the same as eab_contact_locate_match_full() would, but the whole book
+ * is read only once and the contacts are compared in more threads.
+ * The result is in the same order as the @contacts.
+ *
+ * When the @contacts is %NULL, looks for the duplicates within the book
+ * itself; each pair is reported only once and only the contacts with
+ * a match are part of the result.
+ *
+ * It's meant for bulk operations, like an import, not for big remote
+ * books, which should rather be queried.
+ *
+ * Returns: (transfer container) (element-type EABContactMatchResult):
+ *    a #GPtrArray of the #EABContactMatchResult, or %NULL on error
+ **/
+GPtrArray *
+eab_contact_locate_matches_sync (EBookClient *book_client,
+                                 const GSList *contacts,
+                                 GCancellable *cancellable,
+                                 GError **error)
+{
+	MatchJob job = { 0 };
+	GPtrArray *results = NULL;
+	EBookQuery *query;
+	GSList *book_contacts = NULL, *link;
+	gchar *query_str;
+	guint ii, n_contacts, n_threads;
+
+	g_return_val_if_fail (E_IS_BOOK_CLIENT (book_client), NULL);
+
+	query = e_book_query_any_field_contains ("");
+	query_str = e_book_query_to_string (query);
+	e_book_query_unref (query);
+
+	if (!e_book_client_get_contacts_sync (book_client, query_str, &book_contacts, cancellable, error)) {
+		g_free (query_str);
+		return NULL;
+	}
+
+	g_free (query_str);
+
+	job.cancellable = cancellable;
+	job.book_contacts = g_ptr_array_new_with_free_func (g_object_unref);
+	job.blocks = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_array_unref);
+
+	for (link = book_contacts; link; link = g_slist_next (link))
+		g_ptr_array_add (job.book_contacts, link->data);
+
+	g_slist_free (book_contacts);
+
+	job.book_keys = g_new0 (gchar **, job.book_contacts->len + 1);
+
+	for (ii = 0; ii < job.book_contacts->len; ii++) {
+		gint kk;
+
+		job.book_keys[ii] = match_contact_keys (g_ptr_array_index (job.book_contacts, ii));
+
+		for (kk = 0; job.book_keys[ii][kk]; kk++) {
+			GArray *block;
+
+			block = g_hash_table_lookup (job.blocks, job.book_keys[ii][kk]);
+			if (!block) {
+				block = g_array_new (FALSE, FALSE, sizeof (guint));
+				g_hash_table_insert (job.blocks, job.book_keys[ii][kk], block);
+			} else if (g_array_index (block, guint, block->len - 1) == ii) {
+				/* Two e-mails with the same user name */
+				continue;
+			}
+
+			g_array_append_val (block, ii);
+		}
+	}
+
+	if (contacts) {
+		job.contacts = g_ptr_array_new_with_free_func (g_object_unref);
+		job.contacts_keys = g_new0 (gchar **, g_slist_length ((GSList *) contacts) + 1);
+
+		for (link = (GSList *) contacts; link; link = g_slist_next (link)) {
+			job.contacts_keys[job.contacts->len] = match_contact_keys (link->data);
+			g_ptr_array_add (job.contacts, g_object_ref (link->data));
+		}
+	}
+
+	n_contacts = job.contacts ? job.contacts->len : job.book_contacts->len;
+	job.matches = g_new0 (EContact *, n_contacts);
+	job.types = g_new0 (EABContactMatchType, n_contacts);
+
+	n_threads = n_contacts <= MATCH_SERIAL_LIMIT ? 1 : CLAMP (g_get_num_processors (), 1, 8);
+
+	if (n_threads == 1) {
+		match_job_thread (&job);
+	} else {
+		GThread **threads;
+
+		threads = g_new0 (GThread *, n_threads);
+
+		for (ii = 0; ii < n_threads; ii++)
+			threads[ii] = g_thread_new ("eab-contact-match", match_job_thread, &job);
+
+		for (ii = 0; ii < n_threads; ii++)
+			g_thread_join (threads[ii]);
+
+		g_free (threads);
+	}
+
+	if (!g_cancellable_set_error_if_cancelled (cancellable, error)) {
+		results = g_ptr_array_new_with_free_func ((GDestroyNotify) eab_contact_match_result_free);
+
+		for (ii = 0; ii < n_contacts; ii++) {
+			EABContactMatchResult *result;
+
+			if (!job.contacts && !job.matches[ii])
+				continue;
+
+			result = g_new0 (EABContactMatchResult, 1);
+			result->contact = g_object_ref (g_ptr_array_index (job.contacts ? job.contacts : job.book_contacts, ii));
+			result->match = job.matches[ii] ? g_object_ref (job.matches[ii]) : NULL;
+			result->type = job.types[ii];
+
+			g_ptr_array_add (results, result);
+		}
+	}
+
+	g_hash_table_destroy (job.blocks);
+
+	for (ii = 0; ii < job.book_contacts->len; ii++)
+		g_strfreev (job.book_keys[ii]);
+	g_free (job.book_keys);
+
+	if (job.contacts) {
+		for (ii = 0; ii < job.contacts->len; ii++)
+			g_strfreev (job.contacts_keys[ii]);
+		g_free (job.contacts_keys);
+		g_ptr_array_unref (job.contacts);
+	}
+
+	g_ptr_array_unref (job.book_contacts);
+	g_free (job.matches);
+	g_free (job.types);
+
+	return results;
+}
+
+static void
+locate_matches_thread (GTask *task,
+                       gpointer source_object,
+                       gpointer task_data,
+                       GCancellable *cancellable)
+{
+	GPtrArray *results;
+	GError *local_error = NULL;
+
+	results = eab_contact_locate_matches_sync (E_BOOK_CLIENT (source_object), task_data, cancellable, &local_error);
+
+	if (results)
+		g_task_return_pointer (task, results, (GDestroyNotify) g_ptr_array_unref);
+	else
+		g_task_return_error (task, local_error);
+}
+
+/**
+ * eab_contact_locate_matches:
+ * @book_client: The book to look in.
+ * @contacts: (nullable): The contacts to compare to.
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: a callback to call when the lookup is finished
+ * @user_data: data to pass to the @callback
+ *
+ * Asynchronous version of eab_contact_locate_matches_sync(). Finish
+ * the call with eab_contact_locate_matches_finish() in the @callback.
+ **/
+void
+eab_contact_locate_matches (EBookClient *book_client,
+                            const GSList *contacts,
+                            GCancellable *cancellable,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
+{
+	GTask *task;
+	GSList *copy;
+
+	g_return_if_fail (E_IS_BOOK_CLIENT (book_client));
+
+	copy = g_slist_copy_deep ((GSList *) contacts, (GCopyFunc) g_object_ref, NULL);
+
+	task = g_task_new (book_client, cancellable, callback, user_data);
+	g_task_set_source_tag (task, eab_contact_locate_matches);
+	g_task_set_task_data (task, copy, (GDestroyNotify) e_client_util_free_object_slist);
+
+	g_task_run_in_thread (task, locate_matches_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * eab_contact_locate_matches_finish:
+ * @book_client: an #EBookClient
+ * @result: a #GAsyncResult
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes the call of eab_contact_locate_matches().
+ *
+ * Returns: (transfer container) (element-type EABContactMatchResult):
+ *    a #GPtrArray of the #EABContactMatchResult, or %NULL on error
+ **/
+GPtrArray *
+eab_contact_locate_matches_finish (EBookClient *book_client,
+                                   GAsyncResult *result,
+                                   GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, book_client), NULL);
+	g_return_val_if_fail (g_async_result_is_tagged (result, eab_contact_locate_matches), NULL);
+
+	return g_task_propagate_pointer (G_TASK (result), error);
+}
@@ -43,6 +43,12 @@ typedef enum {
 	EAB_CONTACT_MATCH_PART_FAMILY_NAME = 1 << 3
 } EABContactMatchPart;
 
+typedef struct _EABContactMatchResult {
+	EContact *contact;
+	EContact *match;	/* the best match, or NULL */
+	EABContactMatchType type;
+} EABContactMatchResult;
+
 typedef void	(*EABContactMatchQueryCallback)	(EContact *contact,
 						 EContact *match,
 						 EABContactMatchType type,
@@ -96,5 +102,20 @@ void		eab_contact_locate_match_full	(ESourceRegistry *registry,
 						 EABContactMatchQueryCallback cb,
 						 gpointer closure);
 
+void		eab_contact_match_result_free	(EABContactMatchResult *result);
+GPtrArray *	eab_contact_locate_matches_sync	(EBookClient *book_client,
+						 const GSList *contacts,
+						 GCancellable *cancellable,
+						 GError **error);
+void		eab_contact_locate_matches	(EBookClient *book_client,
+						 const GSList *contacts,
+						 GCancellable *cancellable,
+						 GAsyncReadyCallback callback,
+						 gpointer user_data);
+GPtrArray *	eab_contact_locate_matches_finish
+						(EBookClient *book_client,
+						 GAsyncResult *result,
+						 GError **error);
+
 #endif /* __E_CONTACT_COMPARE_H__ */
 
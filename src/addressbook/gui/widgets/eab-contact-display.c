@@ -41,11 +41,28 @@
 #define TEXT_IS_RIGHT_TO_LEFT \
 	(gtk_widget_get_default_direction () == GTK_TEXT_DIR_RTL)
 
+/* How many rendered contacts to remember */
+#define HTML_CACHE_SIZE 32
+
 struct _EABContactDisplayPrivate {
 	EContact *contact;
 
 	EABContactDisplayMode mode;
 	gboolean show_maps;
+
+	EABContactFormatter *formatter;
+
+	/* Rendered HTML by "UID\nREV", the least recently used first
+	 * in the html_cache_keys; the keys are owned by the hash table */
+	GHashTable *html_cache;
+	GQueue html_cache_keys;
+
+	GQueue prerender_queue; /* EContact * */
+	guint prerender_idle_id;
+
+	/* Whether a contact page is loaded, thus only its body
+	 * can be replaced with the next contact */
+	gboolean page_loaded;
 };
 
 enum {
@@ -159,20 +176,39 @@ static GtkActionEntry internal_mailto_entries[] = {
 	  G_CALLBACK (action_contact_send_message_cb) }
 };
 
+static gchar *
+contact_display_dup_cache_key (EContact *contact)
+{
+	const gchar *uid, *rev;
+
+	uid = e_contact_get_const (contact, E_CONTACT_UID);
+	rev = e_contact_get_const (contact, E_CONTACT_REV);
+
+	/* Without the revision the changes cannot be recognized */
+	if (!uid || !*uid || !rev || !*rev)
+		return NULL;
+
+	return g_strconcat (uid, "\n", rev, NULL);
+}
+
 static void
-load_contact (EABContactDisplay *display)
+contact_display_clear_html_cache (EABContactDisplay *display)
+{
+	g_hash_table_remove_all (display->priv->html_cache);
+	g_queue_clear (&display->priv->html_cache_keys);
+}
+
+static gchar *
+contact_display_format_contact (EABContactDisplay *display,
+                                EContact *contact)
 {
-	EABContactFormatter *formatter;
 	GString *buffer;
 
-	if (!display->priv->contact) {
-		e_web_view_clear (E_WEB_VIEW (display));
-		return;
-	}
+	if (!display->priv->formatter)
+		display->priv->formatter = eab_contact_formatter_new ();
 
-	formatter = eab_contact_formatter_new ();
 	g_object_set (
-		G_OBJECT (formatter),
+		G_OBJECT (display->priv->formatter),
 		"display-mode", display->priv->mode,
 		"render-maps", display->priv->show_maps,
 		NULL);
@@ -180,12 +216,146 @@ load_contact (EABContactDisplay *display)
 	buffer = g_string_sized_new (1024);
 
 	eab_contact_formatter_format_contact (
-		formatter, display->priv->contact, buffer);
-	e_web_view_load_string (E_WEB_VIEW (display), buffer->str);
+		display->priv->formatter, contact, buffer);
+
+	return g_string_free (buffer, FALSE);
+}
+
+/* Returns the HTML of the contact, from the cache when possible */
+static const gchar *
+contact_display_get_html (EABContactDisplay *display,
+                          EContact *contact,
+                          gchar **out_uncached)
+{
+	gchar *key, *html;
+	gpointer stored_key = NULL;
+
+	*out_uncached = NULL;
+
+	key = contact_display_dup_cache_key (contact);
+	if (!key) {
+		*out_uncached = contact_display_format_contact (display, contact);
+		return *out_uncached;
+	}
+
+	if (g_hash_table_lookup_extended (display->priv->html_cache, key, &stored_key, (gpointer *) &html)) {
+		g_queue_remove (&display->priv->html_cache_keys, stored_key);
+		g_queue_push_tail (&display->priv->html_cache_keys, stored_key);
+		g_free (key);
+
+		return html;
+	}
+
+	while (g_queue_get_length (&display->priv->html_cache_keys) >= HTML_CACHE_SIZE) {
+		g_hash_table_remove (
+			display->priv->html_cache,
+			g_queue_pop_head (&display->priv->html_cache_keys));
+	}
+
+	html = contact_display_format_contact (display, contact);
+
+	g_hash_table_insert (display->priv->html_cache, key, html);
+	g_queue_push_tail (&display->priv->html_cache_keys, key);
+
+	return html;
+}
+
+/* Replaces the body of the loaded contact page with the body of
+ * the html, which saves the whole page load and its style sheets */
+static gboolean
+contact_display_replace_body (EABContactDisplay *display,
+                              const gchar *html)
+{
+	GDBusProxy *web_extension;
+	const gchar *body_start, *body_end;
+	gchar *body;
+
+	if (!display->priv->page_loaded)
+		return FALSE;
+
+	web_extension = e_web_view_get_web_extension_proxy (E_WEB_VIEW (display));
+	if (!web_extension)
+		return FALSE;
+
+	body_start = strstr (html, "<body");
+	if (body_start)
+		body_start = strchr (body_start, '>');
+	body_end = g_strrstr (html, "</body>");
+
+	if (!body_start || !body_end || body_end <= body_start)
+		return FALSE;
+
+	body_start++;
+	body = g_strndup (body_start, body_end - body_start);
+
+	e_util_invoke_g_dbus_proxy_call_with_error_check (
+		web_extension,
+		"EABContactFormatterReplaceBody",
+		g_variant_new (
+			"(ts)",
+			webkit_web_view_get_page_id (WEBKIT_WEB_VIEW (display)),
+			body),
+		NULL);
 
-	g_string_free (buffer, TRUE);
+	g_free (body);
 
-	g_object_unref (formatter);
+	return TRUE;
+}
+
+static void
+load_contact (EABContactDisplay *display)
+{
+	const gchar *html;
+	gchar *uncached = NULL;
+
+	if (!display->priv->contact) {
+		display->priv->page_loaded = FALSE;
+		e_web_view_clear (E_WEB_VIEW (display));
+		return;
+	}
+
+	html = contact_display_get_html (display, display->priv->contact, &uncached);
+
+	if (!contact_display_replace_body (display, html)) {
+		display->priv->page_loaded = FALSE;
+		e_web_view_load_string (E_WEB_VIEW (display), html);
+	}
+
+	g_free (uncached);
+}
+
+static void
+contact_display_style_updated_cb (EABContactDisplay *display)
+{
+	/* The rendering can depend on the theme, like the icons */
+	contact_display_clear_html_cache (display);
+	display->priv->page_loaded = FALSE;
+
+	load_contact (display);
+}
+
+static gboolean
+contact_display_prerender_idle_cb (gpointer user_data)
+{
+	EABContactDisplay *display = user_data;
+	EContact *contact;
+
+	contact = g_queue_pop_head (&display->priv->prerender_queue);
+	if (contact) {
+		gchar *uncached = NULL;
+
+		contact_display_get_html (display, contact, &uncached);
+
+		g_free (uncached);
+		g_object_unref (contact);
+	}
+
+	if (g_queue_is_empty (&display->priv->prerender_queue)) {
+		display->priv->prerender_idle_id = 0;
+		return FALSE;
+	}
+
+	return TRUE;
 }
 
 static void
@@ -258,10 +428,34 @@ contact_display_dispose (GObject *object)
 		priv->contact = NULL;
 	}
 
+	if (priv->prerender_idle_id) {
+		g_source_remove (priv->prerender_idle_id);
+		priv->prerender_idle_id = 0;
+	}
+
+	g_queue_foreach (&priv->prerender_queue, (GFunc) g_object_unref, NULL);
+	g_queue_clear (&priv->prerender_queue);
+
+	g_clear_object (&priv->formatter);
+
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (eab_contact_display_parent_class)->dispose (object);
 }
 
+static void
+contact_display_finalize (GObject *object)
+{
+	EABContactDisplayPrivate *priv;
+
+	priv = EAB_CONTACT_DISPLAY_GET_PRIVATE (object);
+
+	g_queue_clear (&priv->html_cache_keys);
+	g_hash_table_destroy (priv->html_cache);
+
+	/* Chain up to parent's finalize() method. */
+	G_OBJECT_CLASS (eab_contact_display_parent_class)->finalize (object);
+}
+
 static void
 contact_display_hovering_over_link (EWebView *web_view,
                                     const gchar *title,
@@ -348,6 +542,16 @@ contact_display_load_changed (WebKitWebView *web_view,
 	}
 }
 
+static void
+contact_display_page_load_changed_cb (EABContactDisplay *display,
+                                      WebKitLoadEvent load_event)
+{
+	/* Any other load, like a clear, replaces the contact page */
+	display->priv->page_loaded =
+		load_event == WEBKIT_LOAD_FINISHED &&
+		display->priv->contact != NULL;
+}
+
 static void
 contact_display_update_actions (EWebView *web_view)
 {
@@ -386,6 +590,8 @@ contact_display_web_process_crashed_cb (EABContactDisplay *display)
 
 	g_return_if_fail (EAB_IS_CONTACT_DISPLAY (display));
 
+	display->priv->page_loaded = FALSE;
+
 	/* Cannot use the EWebView, because it places the alerts inside itself */
 	alert_sink = e_shell_utils_find_alternate_alert_sink (GTK_WIDGET (display));
 	if (alert_sink)
@@ -404,6 +610,7 @@ eab_contact_display_class_init (EABContactDisplayClass *class)
 	object_class->set_property = contact_display_set_property;
 	object_class->get_property = contact_display_get_property;
 	object_class->dispose = contact_display_dispose;
+	object_class->finalize = contact_display_finalize;
 
 	web_view_class = E_WEB_VIEW_CLASS (class);
 	web_view_class->hovering_over_link = contact_display_hovering_over_link;
@@ -464,6 +671,9 @@ eab_contact_display_init (EABContactDisplay *display)
 	GError *error = NULL;
 
 	display->priv = EAB_CONTACT_DISPLAY_GET_PRIVATE (display);
+	display->priv->html_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	g_queue_init (&display->priv->html_cache_keys);
+	g_queue_init (&display->priv->prerender_queue);
 
 	web_view = E_WEB_VIEW (display);
 	ui_manager = e_web_view_get_ui_manager (web_view);
@@ -475,9 +685,12 @@ eab_contact_display_init (EABContactDisplay *display)
 	e_signal_connect_notify (
 		web_view, "notify::load-changed",
 		G_CALLBACK (contact_display_load_changed), NULL);
+	g_signal_connect (
+		web_view, "load-changed",
+		G_CALLBACK (contact_display_page_load_changed_cb), NULL);
 	g_signal_connect (
 		web_view, "style-updated",
-		G_CALLBACK (load_contact), NULL);
+		G_CALLBACK (contact_display_style_updated_cb), NULL);
 
 	action_group = gtk_action_group_new ("internal-mailto");
 	gtk_action_group_set_translation_domain (action_group, domain);
@@ -551,6 +764,8 @@ eab_contact_display_set_mode (EABContactDisplay *display,
 
 	display->priv->mode = mode;
 
+	contact_display_clear_html_cache (display);
+	display->priv->page_loaded = FALSE;
 	load_contact (display);
 
 	g_object_notify (G_OBJECT (display), "mode");
@@ -575,7 +790,56 @@ eab_contact_display_set_show_maps (EABContactDisplay *display,
 
 	display->priv->show_maps = show_maps;
 
+	contact_display_clear_html_cache (display);
+	display->priv->page_loaded = FALSE;
 	load_contact (display);
 
 	g_object_notify (G_OBJECT (display), "show-maps");
 }
+
+/**
+ * eab_contact_display_prerender_contacts:
+ * @display: an #EABContactDisplay
+ * @contacts: (element-type EContact): contacts likely to be shown next
+ *
+ * Renders the @contacts in the background, when the main loop is idle,
+ * thus they can be shown without waiting for the formatter. Any contacts
+ * queued by a previous call, and not rendered yet, are forgotten.
+ **/
+void
+eab_contact_display_prerender_contacts (EABContactDisplay *display,
+                                        const GSList *contacts)
+{
+	const GSList *link;
+
+	g_return_if_fail (EAB_IS_CONTACT_DISPLAY (display));
+
+	g_queue_foreach (&display->priv->prerender_queue, (GFunc) g_object_unref, NULL);
+	g_queue_clear (&display->priv->prerender_queue);
+
+	for (link = contacts; link; link = g_slist_next (link)) {
+		EContact *contact = link->data;
+		gchar *key;
+
+		if (!E_IS_CONTACT (contact))
+			continue;
+
+		key = contact_display_dup_cache_key (contact);
+
+		/* Only what can be cached and is not already */
+		if (key && !g_hash_table_contains (display->priv->html_cache, key))
+			g_queue_push_tail (&display->priv->prerender_queue, g_object_ref (contact));
+
+		g_free (key);
+	}
+
+	if (g_queue_is_empty (&display->priv->prerender_queue)) {
+		if (display->priv->prerender_idle_id) {
+			g_source_remove (display->priv->prerender_idle_id);
+			display->priv->prerender_idle_id = 0;
+		}
+	} else if (!display->priv->prerender_idle_id) {
+		display->priv->prerender_idle_id = g_idle_add_full (
+			G_PRIORITY_LOW, contact_display_prerender_idle_cb, display, NULL);
+	}
+}
@@ -96,6 +96,9 @@ gboolean	eab_contact_display_get_show_maps
 void		eab_contact_display_set_show_maps
 						(EABContactDisplay *display,
 						 gboolean display_maps);
+void		eab_contact_display_prerender_contacts
+						(EABContactDisplay *display,
+						 const GSList *contacts);
 
 G_END_DECLS
 
@@ -68,6 +68,10 @@ typedef struct {
 	/*match is the duplicate contact already existing in the addressbook*/
 	EContact *match;
 	GList *avoid;
+	/* when the match was located together with other contacts */
+	gboolean located;
+	EContact *located_match;
+	EABContactMatchType located_type;
 	EABMergingAsyncCallback cb;
 	EABMergingIdAsyncCallback id_cb;
 	EABMergingContactAsyncCallback c_cb;
@@ -85,26 +89,154 @@ struct dropdown_data {
 static void match_query_callback (EContact *contact, EContact *match, EABContactMatchType type, gpointer closure);
 
 #define SIMULTANEOUS_MERGING_REQUESTS 20
+#define BATCH_MERGING_REQUESTS 10
 #define EVOLUTION_UI_SLOT_PARAM "X-EVOLUTION-UI-SLOT"
 
 static GList *merging_queue = NULL;
 static gint running_merge_requests = 0;
 
+/* Lookups of contacts being added, collected within one main loop iteration */
+static GSList *batch_queue = NULL;
+static guint batch_queue_id = 0;
+
 static void
-add_lookup (EContactMergingLookup *lookup)
+start_lookup (EContactMergingLookup *lookup)
 {
-	if (running_merge_requests < SIMULTANEOUS_MERGING_REQUESTS) {
-		running_merge_requests++;
+	running_merge_requests++;
+
+	if (lookup->located) {
+		EContact *match = lookup->located_match;
+
+		lookup->located_match = NULL;
+		match_query_callback (lookup->contact, match, lookup->located_type, lookup);
+		g_clear_object (&match);
+	} else {
 		eab_contact_locate_match_full (
 			lookup->registry, lookup->book_client,
 			lookup->contact, lookup->avoid,
 			match_query_callback, lookup);
 	}
+}
+
+static void
+queue_lookup (EContactMergingLookup *lookup)
+{
+	if (running_merge_requests < SIMULTANEOUS_MERGING_REQUESTS) {
+		start_lookup (lookup);
+	}
 	else {
 		merging_queue = g_list_append (merging_queue, lookup);
 	}
 }
 
+static void
+batch_lookups_located_cb (GObject *source_object,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+	GSList *lookups = user_data, *link;
+	GPtrArray *results;
+	GError *error = NULL;
+	guint ii;
+
+	results = eab_contact_locate_matches_finish (E_BOOK_CLIENT (source_object), result, &error);
+
+	if (error) {
+		g_warning ("%s: Failed to locate matches: %s", G_STRFUNC, error->message);
+		g_clear_error (&error);
+	}
+
+	/* The lookups without the result are done one by one */
+	for (link = lookups, ii = 0; link; link = g_slist_next (link), ii++) {
+		EContactMergingLookup *lookup = link->data;
+
+		if (results && ii < results->len) {
+			EABContactMatchResult *match_result = g_ptr_array_index (results, ii);
+
+			lookup->located = TRUE;
+			lookup->located_type = match_result->type;
+			lookup->located_match = match_result->match ? g_object_ref (match_result->match) : NULL;
+		}
+
+		queue_lookup (lookup);
+	}
+
+	if (results)
+		g_ptr_array_unref (results);
+	g_slist_free (lookups);
+}
+
+static gboolean
+batch_lookups_idle_cb (gpointer user_data)
+{
+	GHashTable *by_book;
+	GHashTableIter iter;
+	GSList *lookups, *link;
+	gpointer value;
+
+	lookups = g_slist_reverse (batch_queue);
+	batch_queue = NULL;
+	batch_queue_id = 0;
+
+	by_book = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	for (link = lookups; link; link = g_slist_next (link)) {
+		EContactMergingLookup *lookup = link->data;
+		GSList *book_lookups;
+
+		book_lookups = g_hash_table_lookup (by_book, lookup->book_client);
+		g_hash_table_insert (by_book, lookup->book_client, g_slist_prepend (book_lookups, lookup));
+	}
+
+	g_slist_free (lookups);
+
+	g_hash_table_iter_init (&iter, by_book);
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		GSList *book_lookups = g_slist_reverse (value);
+		EContactMergingLookup *lookup = book_lookups->data;
+
+		if (g_slist_length (book_lookups) >= BATCH_MERGING_REQUESTS) {
+			GSList *contacts = NULL;
+
+			for (link = book_lookups; link; link = g_slist_next (link)) {
+				lookup = link->data;
+				contacts = g_slist_prepend (contacts, lookup->contact);
+			}
+
+			contacts = g_slist_reverse (contacts);
+
+			eab_contact_locate_matches (
+				lookup->book_client, contacts, NULL,
+				batch_lookups_located_cb, book_lookups);
+
+			g_slist_free (contacts);
+		} else {
+			g_slist_free_full (book_lookups, (GDestroyNotify) queue_lookup);
+		}
+	}
+
+	g_hash_table_destroy (by_book);
+
+	return FALSE;
+}
+
+static void
+add_lookup (EContactMergingLookup *lookup)
+{
+	/* Contacts are added in bulk when copying or moving them between
+	 * the books; reading the book once is cheaper than a query for each
+	 * contact, unless it's a remote book, which cannot be read whole */
+	if (lookup->op == E_CONTACT_MERGING_ADD &&
+	    e_client_check_capability (E_CLIENT (lookup->book_client), "do-initial-query")) {
+		batch_queue = g_slist_prepend (batch_queue, lookup);
+
+		if (!batch_queue_id)
+			batch_queue_id = g_idle_add (batch_lookups_idle_cb, NULL);
+	} else {
+		queue_lookup (lookup);
+	}
+}
+
 static void
 finished_lookup (void)
 {
@@ -120,11 +252,7 @@ finished_lookup (void)
 
 		merging_queue = g_list_remove_link (merging_queue, merging_queue);
 
-		running_merge_requests++;
-		eab_contact_locate_match_full (
-			lookup->registry, lookup->book_client,
-			lookup->contact, lookup->avoid,
-			match_query_callback, lookup);
+		start_lookup (lookup);
 	}
 }
 
@@ -137,6 +265,7 @@ free_lookup (EContactMergingLookup *lookup)
 	g_list_free (lookup->avoid);
 	if (lookup->match)
 		g_object_unref (lookup->match);
+	g_clear_object (&lookup->located_match);
 	g_free (lookup);
 }
 
@@ -971,6 +1100,8 @@ eab_merging_book_add_contact (ESourceRegistry *registry,
 	lookup->closure = closure;
 	lookup->avoid = NULL;
 	lookup->match = NULL;
+	lookup->located = FALSE;
+	lookup->located_match = NULL;
 
 	add_lookup (lookup);
 
@@ -998,6 +1129,8 @@ eab_merging_book_modify_contact (ESourceRegistry *registry,
 	lookup->closure = closure;
 	lookup->avoid = g_list_append (NULL, contact);
 	lookup->match = NULL;
+	lookup->located = FALSE;
+	lookup->located_match = NULL;
 
 	add_lookup (lookup);
 
@@ -1023,6 +1156,8 @@ eab_merging_book_find_contact (ESourceRegistry *registry,
 	lookup->closure = closure;
 	lookup->avoid = g_list_append (NULL, contact);
 	lookup->match = NULL;
+	lookup->located = FALSE;
+	lookup->located_match = NULL;
 
 	add_lookup (lookup);
 
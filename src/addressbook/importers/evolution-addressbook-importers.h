@@ -18,6 +18,7 @@
  */
 
 #include <gtk/gtk.h>
+#include <libebook/libebook.h>
 
 struct _EImportImporter *evolution_ldif_importer_peek (void);
 struct _EImportImporter *evolution_vcard_importer_peek (void);
@@ -27,3 +28,30 @@ struct _EImportImporter *evolution_csv_evolution_importer_peek (void);
 
 /* private utility function for importers only */
 GtkWidget *evolution_contact_importer_get_preview_widget (const GSList *contacts);
+
+/* Reads the next contact to be stored, in a dedicated thread; returns NULL
+ * at the end of the current phase. Contacts read so far are stored before
+ * the next phase begins, two NULL-s in a row finish the import. The 'percent'
+ * can be set to the current progress, it's left at -1 otherwise. */
+typedef EContact *	(* EvolutionContactImporterReadFunc)
+						(gpointer user_data,
+						 gint *percent,
+						 GCancellable *cancellable);
+/* Called in the dedicated thread after a batch of contacts had been stored,
+ * with their UID-s already set */
+typedef void		(* EvolutionContactImporterStoredFunc)
+						(gpointer user_data,
+						 const GSList *contacts);
+/* Called in the main thread when the import finished */
+typedef void		(* EvolutionContactImporterDoneFunc)
+						(gpointer user_data,
+						 const GError *error);
+
+void		evolution_contact_importer_run	(struct _EImport *import,
+						 struct _EImportTarget *target,
+						 EBookClient *book_client,
+						 GCancellable *cancellable,
+						 EvolutionContactImporterReadFunc read_func,
+						 EvolutionContactImporterStoredFunc stored_func,
+						 EvolutionContactImporterDoneFunc done_func,
+						 gpointer user_data);
@@ -49,22 +49,22 @@ typedef struct {
 	EImport *import;
 	EImportTarget *target;
 
-	guint idle_id;
+	GCancellable *cancellable;
 
+	/* DN -> EContact with only the parts needed to resolve list members */
 	GHashTable *dn_contact_hash;
 
-	gint state;		/* 0 - initial scan, 1 - list cards, 2 - cancelled/complete */
+	gint state;		/* 0 - initial scan, 1 - list cards */
 	FILE *file;
 	gulong size;
 
 	EBookClient *book_client;
 
-	GSList *contacts;
 	GSList *list_contacts;
-	GSList *list_iterator;
 } LDIFImporter;
 
-static void ldif_import_done (LDIFImporter *gci);
+static void ldif_import_done (gpointer user_data,
+			      const GError *error);
 
 static struct {
 	const gchar *ldif_attribute;
@@ -218,8 +218,7 @@ populate_contact_address (EContactAddress *address,
 }
 
 static gboolean
-parseLine (GHashTable *dn_contact_hash,
-           EContact *contact,
+parseLine (EContact *contact,
            EContactAddress *work_address,
            EContactAddress *home_address,
            gchar **buf)
@@ -314,9 +313,9 @@ parseLine (GHashTable *dn_contact_hash,
 		/* handle objectclass/dn/member out here */
 		if (!field_handled) {
 			if (!g_ascii_strcasecmp (ptr, "dn"))
-				g_hash_table_insert (
-					dn_contact_hash,
-					g_strdup (ldif_value->str), contact);
+				g_object_set_data_full (
+					G_OBJECT (contact), "ldif-dn",
+					g_strdup (ldif_value->str), g_free);
 			else if (!g_ascii_strcasecmp (ptr, "objectclass") &&
 				!g_ascii_strcasecmp (ldif_value->str, "groupofnames")) {
 				e_contact_set (
@@ -350,8 +349,7 @@ parseLine (GHashTable *dn_contact_hash,
 }
 
 static EContact *
-getNextLDIFEntry (GHashTable *dn_contact_hash,
-                  FILE *f)
+getNextLDIFEntry (FILE *f)
 {
 	EContact *contact;
 	EContactAddress *work_address, *home_address;
@@ -381,7 +379,7 @@ getNextLDIFEntry (GHashTable *dn_contact_hash,
 
 	buf = str->str;
 	while (buf) {
-		if (!parseLine (dn_contact_hash, contact, work_address, home_address, &buf)) {
+		if (!parseLine (contact, work_address, home_address, &buf)) {
 			/* parsing error */
 			g_string_free (str, TRUE);
 			e_contact_address_free (work_address);
@@ -481,72 +479,89 @@ add_to_notes (EContact *contact,
 	g_free (new_text);
 }
 
-static gboolean
-ldif_import_contacts (gpointer d)
+static EContact *
+ldif_import_read_contact (gpointer user_data,
+                          gint *percent,
+                          GCancellable *cancellable)
 {
-	LDIFImporter *gci = d;
-	EContact *contact;
-	GSList *iter;
-	gint count = 0;
+	LDIFImporter *gci = user_data;
+	EContact *contact = NULL;
 
 	/* We process all normal cards immediately and keep the list
-	 * ones till the end */
+	 * ones till the end, when all the members are stored */
 
 	if (gci->state == 0) {
-		while (count < 50 && (contact = getNextLDIFEntry (
-			gci->dn_contact_hash, gci->file))) {
-			if (e_contact_get (contact, E_CONTACT_IS_LIST)) {
-				gci->list_contacts = g_slist_prepend (
-					gci->list_contacts, contact);
-			} else {
-				gchar *uid = NULL;
-
-				add_to_notes (contact, E_CONTACT_OFFICE);
-				add_to_notes (contact, E_CONTACT_SPOUSE);
-				add_to_notes (contact, E_CONTACT_BLOG_URL);
-
-				e_book_client_add_contact_sync (
-					gci->book_client,
-					contact, &uid, NULL, NULL);
-				if (uid != NULL) {
-					e_contact_set (contact, E_CONTACT_UID, uid);
-					g_free (uid);
-				}
-				gci->contacts = g_slist_prepend (gci->contacts, contact);
-			}
-			count++;
+		while (contact = getNextLDIFEntry (gci->file), contact != NULL) {
+			if (!e_contact_get (contact, E_CONTACT_IS_LIST))
+				break;
+
+			gci->list_contacts = g_slist_prepend (gci->list_contacts, contact);
 		}
-		if (contact == NULL) {
+
+		if (contact) {
+			add_to_notes (contact, E_CONTACT_OFFICE);
+			add_to_notes (contact, E_CONTACT_SPOUSE);
+			add_to_notes (contact, E_CONTACT_BLOG_URL);
+		} else {
 			gci->state = 1;
-			gci->list_iterator = gci->list_contacts;
+			gci->list_contacts = g_slist_reverse (gci->list_contacts);
 		}
+
+		if (gci->size > 0)
+			*percent = ftell (gci->file) * 100 / gci->size;
+	} else if (gci->list_contacts) {
+		contact = gci->list_contacts->data;
+		gci->list_contacts = g_slist_delete_link (gci->list_contacts, gci->list_contacts);
+
+		resolve_list_card (gci, contact);
 	}
-	if (gci->state == 1) {
-		for (iter = gci->list_iterator; count < 50 && iter; iter = iter->next) {
-			gchar *uid = NULL;
-
-			contact = iter->data;
-			resolve_list_card (gci, contact);
-			e_book_client_add_contact_sync (
-				gci->book_client, contact, &uid, NULL, NULL);
-			if (uid != NULL) {
-				e_contact_set (contact, E_CONTACT_UID, uid);
-				g_free (uid);
-			}
-			count++;
+
+	return contact;
+}
+
+static void
+ldif_import_stored (gpointer user_data,
+                    const GSList *contacts)
+{
+	LDIFImporter *gci = user_data;
+	const GSList *link;
+
+	/* Remember only what the list members need, not the whole
+	 * contacts, to not have the whole file in memory at the end */
+	for (link = contacts; link; link = g_slist_next (link)) {
+		EContact *contact = link->data, *dn_contact;
+		const gchar *dn;
+		GList *email;
+		gint ii;
+		const EContactField fields[] = {
+			E_CONTACT_UID,
+			E_CONTACT_FULL_NAME,
+			E_CONTACT_FILE_AS,
+			E_CONTACT_GIVEN_NAME,
+			E_CONTACT_FAMILY_NAME,
+			E_CONTACT_NICKNAME
+		};
+
+		dn = g_object_get_data (G_OBJECT (contact), "ldif-dn");
+		if (!dn || e_contact_get (contact, E_CONTACT_IS_LIST))
+			continue;
+
+		dn_contact = e_contact_new ();
+
+		for (ii = 0; ii < G_N_ELEMENTS (fields); ii++) {
+			const gchar *value = e_contact_get_const (contact, fields[ii]);
+
+			if (value && *value)
+				e_contact_set (dn_contact, fields[ii], value);
 		}
-		gci->list_iterator = iter;
-		if (iter == NULL)
-			gci->state = 2;
-	}
-	if (gci->state == 2) {
-		ldif_import_done (gci);
-		return FALSE;
-	} else {
-		e_import_status (
-			gci->import, gci->target, _("Importing..."),
-			ftell (gci->file) * 100 / gci->size);
-		return TRUE;
+
+		email = e_contact_get (contact, E_CONTACT_EMAIL);
+		if (email) {
+			e_contact_set (dn_contact, E_CONTACT_EMAIL, email);
+			g_list_free_full (email, g_free);
+		}
+
+		g_hash_table_insert (gci->dn_contact_hash, g_strdup (dn), dn_contact);
 	}
 }
 
@@ -655,20 +670,20 @@ ldif_supported (EImport *ei,
 }
 
 static void
-ldif_import_done (LDIFImporter *gci)
+ldif_import_done (gpointer user_data,
+                  const GError *error)
 {
-	if (gci->idle_id)
-		g_source_remove (gci->idle_id);
+	LDIFImporter *gci = user_data;
 
 	fclose (gci->file);
-	g_object_unref (gci->book_client);
-	g_slist_foreach (gci->contacts, (GFunc) g_object_unref, NULL);
-	g_slist_foreach (gci->list_contacts, (GFunc) g_object_unref, NULL);
-	g_slist_free (gci->contacts);
-	g_slist_free (gci->list_contacts);
+	g_clear_object (&gci->book_client);
+	g_clear_object (&gci->cancellable);
+	g_slist_free_full (gci->list_contacts, g_object_unref);
 	g_hash_table_destroy (gci->dn_contact_hash);
 
-	e_import_complete (gci->import, gci->target, NULL);
+	g_datalist_set_data (&gci->target->data, "ldif-data", NULL);
+
+	e_import_complete (gci->import, gci->target, error);
 	g_object_unref (gci->import);
 
 	g_free (gci);
@@ -685,12 +700,15 @@ book_client_connect_cb (GObject *source_object,
 	client = e_book_client_connect_finish (result, NULL);
 
 	if (client == NULL) {
-		ldif_import_done (gci);
+		ldif_import_done (gci, NULL);
 		return;
 	}
 
 	gci->book_client = E_BOOK_CLIENT (client);
-	gci->idle_id = g_idle_add (ldif_import_contacts, gci);
+
+	evolution_contact_importer_run (
+		gci->import, gci->target, gci->book_client, gci->cancellable,
+		ldif_import_read_contact, ldif_import_stored, ldif_import_done, gci);
 }
 
 static void
@@ -725,6 +743,7 @@ ldif_import (EImport *ei,
 	g_datalist_set_data (&target->data, "ldif-data", gci);
 	gci->import = g_object_ref (ei);
 	gci->target = target;
+	gci->cancellable = g_cancellable_new ();
 	gci->file = file;
 	fseek (file, 0, SEEK_END);
 	gci->size = ftell (file);
@@ -732,11 +751,11 @@ ldif_import (EImport *ei,
 	gci->dn_contact_hash = g_hash_table_new_full (
 		g_str_hash, g_str_equal,
 		(GDestroyNotify) g_free,
-		(GDestroyNotify) NULL);
+		(GDestroyNotify) g_object_unref);
 
 	source = g_datalist_get_data (&target->data, "ldif-source");
 
-	e_book_client_connect (source, 30, NULL, book_client_connect_cb, gci);
+	e_book_client_connect (source, 30, gci->cancellable, book_client_connect_cb, gci);
 }
 
 static void
@@ -747,7 +766,7 @@ ldif_cancel (EImport *ei,
 	LDIFImporter *gci = g_datalist_get_data (&target->data, "ldif-data");
 
 	if (gci)
-		gci->state = 2;
+		g_cancellable_cancel (gci->cancellable);
 }
 
 static GtkWidget *
@@ -760,7 +779,6 @@ ldif_get_preview (EImport *ei,
 	EContact *contact;
 	EImportTargetURI *s = (EImportTargetURI *) target;
 	gchar *filename;
-	GHashTable *dn_contact_hash;
 	FILE *file;
 
 	filename = g_filename_from_uri (s->uri_src, NULL, NULL);
@@ -777,12 +795,7 @@ ldif_get_preview (EImport *ei,
 		return NULL;
 	}
 
-	dn_contact_hash = g_hash_table_new_full (
-		g_str_hash, g_str_equal,
-		(GDestroyNotify) g_free,
-		(GDestroyNotify) NULL);
-
-	while (contact = getNextLDIFEntry (dn_contact_hash, file), contact != NULL) {
+	while (contact = getNextLDIFEntry (file), contact != NULL) {
 		if (!e_contact_get (contact, E_CONTACT_IS_LIST)) {
 			add_to_notes (contact, E_CONTACT_OFFICE);
 			add_to_notes (contact, E_CONTACT_SPOUSE);
@@ -792,8 +805,6 @@ ldif_get_preview (EImport *ei,
 		contacts = g_slist_prepend (contacts, contact);
 	}
 
-	g_hash_table_destroy (dn_contact_hash);
-
 	contacts = g_slist_reverse (contacts);
 	preview = evolution_contact_importer_get_preview_widget (contacts);
 
@@ -53,32 +53,26 @@ typedef struct {
 	EImport *import;
 	EImportTarget *target;
 
-	guint idle_id;
-
-	gint state;		/* 0 - importing, 1 - cancelled/complete */
-	gint total;
-	gint count;
+	GCancellable *cancellable;
 
 	ESource *primary;
 
-	GSList *contactlist;
-	GSList *iterator;
 	EBookClient *book_client;
 
-	/* when opening book */
-	gchar *contents;
-	VCardEncoding encoding;
+	/* read in the import thread */
+	GInputStream *file_stream;
+	GDataInputStream *data_stream;
+	goffset size;
 } VCardImporter;
 
-static void vcard_import_done (VCardImporter *gci);
+static void vcard_import_done (gpointer user_data,
+			       const GError *error);
 
 static void
-vcard_import_contact (VCardImporter *gci,
-                      EContact *contact)
+vcard_fixup_contact (EContact *contact)
 {
 	EContactPhoto *photo;
 	GList *attrs, *attr;
-	gchar *uid = NULL;
 
 	/* Apple's addressbook.app exports PHOTO's without a TYPE
 	 * param, so let's figure out the format here if there's a
@@ -211,43 +205,60 @@ vcard_import_contact (VCardImporter *gci,
 								"OTHER");
 		}
 	}
-
-	/* FIXME Error checking */
-	e_book_client_add_contact_sync (
-		gci->book_client, contact, &uid, NULL, NULL);
-	if (uid != NULL) {
-		e_contact_set (contact, E_CONTACT_UID, uid);
-		g_free (uid);
-	}
 }
 
-static gboolean
-vcard_import_contacts (gpointer data)
+static EContact *
+vcard_import_read_contact (gpointer user_data,
+                           gint *percent,
+                           GCancellable *cancellable)
 {
-	VCardImporter *gci = data;
-	gint count = 0;
-	GSList *iterator = gci->iterator;
-
-	if (gci->state == 0) {
-		while (count < 50 && iterator) {
-			vcard_import_contact (gci, iterator->data);
-			count++;
-			iterator = iterator->next;
+	VCardImporter *gci = user_data;
+	EContact *contact = NULL;
+	GString *vcard = NULL;
+	gint depth = 0;
+	gchar *line;
+
+	/* Split the same way as eab_contact_list_from_string() does,
+	 * only line by line, without reading the whole file in memory;
+	 * the nested vCards (like in the AGENT attribute) are part
+	 * of the contact they are in. */
+	while (!contact && (line = g_data_input_stream_read_line (gci->data_stream, NULL, cancellable, NULL)) != NULL) {
+		if (!g_ascii_strncasecmp (line, "BEGIN:VCARD", 11)) {
+			if (!vcard)
+				vcard = g_string_sized_new (1024);
+			depth++;
+		} else if (vcard && !g_ascii_strncasecmp (line, "END:VCARD", 9)) {
+			depth--;
 		}
-		gci->count += count;
-		gci->iterator = iterator;
-		if (iterator == NULL)
-			gci->state = 1;
-	}
-	if (gci->state == 1) {
-		vcard_import_done (gci);
-		return FALSE;
-	} else {
-		e_import_status (
-			gci->import, gci->target, _("Importing..."),
-			gci->count * 100 / gci->total);
-		return TRUE;
+
+		if (vcard) {
+			g_string_append (vcard, line);
+			g_string_append_c (vcard, '\n');
+
+			if (depth <= 0) {
+				contact = e_contact_new_from_vcard (vcard->str);
+				g_string_truncate (vcard, 0);
+				depth = 0;
+			}
+		}
+
+		g_free (line);
 	}
+
+	/* Unterminated vCard at the end of the file */
+	if (!contact && vcard && vcard->len)
+		contact = e_contact_new_from_vcard (vcard->str);
+
+	if (vcard)
+		g_string_free (vcard, TRUE);
+
+	if (contact)
+		vcard_fixup_contact (contact);
+
+	if (gci->size > 0)
+		*percent = g_seekable_tell (G_SEEKABLE (gci->file_stream)) * 100 / gci->size;
+
+	return contact;
 }
 
 #define BOM (gunichar2)0xFEFF
@@ -452,16 +463,19 @@ vcard_supported (EImport *ei,
 }
 
 static void
-vcard_import_done (VCardImporter *gci)
+vcard_import_done (gpointer user_data,
+                   const GError *error)
 {
-	if (gci->idle_id)
-		g_source_remove (gci->idle_id);
+	VCardImporter *gci = user_data;
 
-	g_free (gci->contents);
-	g_object_unref (gci->book_client);
-	g_slist_free_full (gci->contactlist, (GDestroyNotify) g_object_unref);
+	g_clear_object (&gci->data_stream);
+	g_clear_object (&gci->file_stream);
+	g_clear_object (&gci->book_client);
+	g_clear_object (&gci->cancellable);
 
-	e_import_complete (gci->import, gci->target, NULL);
+	g_datalist_set_data (&gci->target->data, "vcard-data", NULL);
+
+	e_import_complete (gci->import, gci->target, error);
 	g_object_unref (gci->import);
 	g_free (gci);
 }
@@ -477,37 +491,15 @@ book_client_connect_cb (GObject *source_object,
 	client = e_book_client_connect_finish (result, NULL);
 
 	if (client == NULL) {
-		vcard_import_done (gci);
+		vcard_import_done (gci, NULL);
 		return;
 	}
 
 	gci->book_client = E_BOOK_CLIENT (client);
 
-	if (gci->encoding == VCARD_ENCODING_UTF16) {
-		gchar *tmp;
-
-		gunichar2 *contents_utf16 = (gunichar2 *) gci->contents;
-		tmp = utf16_to_utf8 (contents_utf16);
-		g_free (gci->contents);
-		gci->contents = tmp;
-
-	} else if (gci->encoding == VCARD_ENCODING_LOCALE) {
-		gchar *tmp;
-		tmp = g_locale_to_utf8 (gci->contents, -1, NULL, NULL, NULL);
-		g_free (gci->contents);
-		gci->contents = tmp;
-	}
-
-	gci->contactlist = eab_contact_list_from_string (gci->contents);
-	g_free (gci->contents);
-	gci->contents = NULL;
-	gci->iterator = gci->contactlist;
-	gci->total = g_slist_length (gci->contactlist);
-
-	if (gci->iterator)
-		gci->idle_id = g_idle_add (vcard_import_contacts, gci);
-	else
-		vcard_import_done (gci);
+	evolution_contact_importer_run (
+		gci->import, gci->target, gci->book_client, gci->cancellable,
+		vcard_import_read_contact, NULL, vcard_import_done, gci);
 }
 
 static void
@@ -518,8 +510,11 @@ vcard_import (EImport *ei,
 	VCardImporter *gci;
 	ESource *source;
 	EImportTargetURI *s = (EImportTargetURI *) target;
+	GFile *file;
+	GFileInputStream *file_stream;
+	GInputStream *stream;
+	GFileInfo *info;
 	gchar *filename;
-	gchar *contents;
 	VCardEncoding encoding;
 	GError *error = NULL;
 
@@ -540,25 +535,58 @@ vcard_import (EImport *ei,
 		return;
 	}
 
-	if (!g_file_get_contents (filename, &contents, NULL, &error)) {
-		g_free (filename);
+	file = g_file_new_for_path (filename);
+	g_free (filename);
+
+	file_stream = g_file_read (file, NULL, &error);
+	g_object_unref (file);
+
+	if (!file_stream) {
 		e_import_complete (ei, target, error);
 		g_clear_error (&error);
 
 		return;
 	}
 
-	g_free (filename);
 	gci = g_malloc0 (sizeof (*gci));
 	g_datalist_set_data (&target->data, "vcard-data", gci);
 	gci->import = g_object_ref (ei);
 	gci->target = target;
-	gci->encoding = encoding;
-	gci->contents = contents;
+	gci->cancellable = g_cancellable_new ();
+	gci->file_stream = G_INPUT_STREAM (file_stream);
+
+	info = g_file_input_stream_query_info (file_stream, G_FILE_ATTRIBUTE_STANDARD_SIZE, NULL, NULL);
+	if (info) {
+		gci->size = g_file_info_get_size (info);
+		g_object_unref (info);
+	}
+
+	/* The file is converted to UTF-8 while being read */
+	if (encoding == VCARD_ENCODING_UTF16 || encoding == VCARD_ENCODING_LOCALE) {
+		GCharsetConverter *converter;
+		const gchar *charset = "UTF-16";
+
+		if (encoding == VCARD_ENCODING_LOCALE)
+			g_get_charset (&charset);
+
+		converter = g_charset_converter_new ("UTF-8", charset, NULL);
+		if (converter) {
+			stream = g_converter_input_stream_new (gci->file_stream, G_CONVERTER (converter));
+			g_object_unref (converter);
+		} else {
+			stream = g_object_ref (gci->file_stream);
+		}
+	} else {
+		stream = g_object_ref (gci->file_stream);
+	}
+
+	gci->data_stream = g_data_input_stream_new (stream);
+	g_data_input_stream_set_newline_type (gci->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+	g_object_unref (stream);
 
 	source = g_datalist_get_data (&target->data, "vcard-source");
 
-	e_book_client_connect (source, 30, NULL, book_client_connect_cb, gci);
+	e_book_client_connect (source, 30, gci->cancellable, book_client_connect_cb, gci);
 }
 
 static void
@@ -569,7 +597,7 @@ vcard_cancel (EImport *ei,
 	VCardImporter *gci = g_datalist_get_data (&target->data, "vcard-data");
 
 	if (gci)
-		gci->state = 1;
+		g_cancellable_cancel (gci->cancellable);
 }
 
 static GtkWidget *
@@ -994,3 +1022,235 @@ evolution_contact_importer_get_preview_widget (const GSList *contacts)
 
 	return preview;
 }
+
+/* The contacts are read and stored in a dedicated thread, in batches
+ * sized by how fast the book stores them. The next batch is not read
+ * before the previous one is stored, thus only one batch is held in
+ * memory at a time, regardless of the file size. */
+
+#define CONTACT_IMPORT_BATCH_MIN	10
+#define CONTACT_IMPORT_BATCH_START	50
+#define CONTACT_IMPORT_BATCH_MAX	1000
+
+typedef struct _ContactImportData {
+	EImport *import;
+	EImportTarget *target;
+	EBookClient *book_client;
+	GCancellable *cancellable;
+	EvolutionContactImporterReadFunc read_func;
+	EvolutionContactImporterStoredFunc stored_func;
+	EvolutionContactImporterDoneFunc done_func;
+	gpointer user_data;
+
+	gint percent;
+	guint batch_size;
+	GError *error;
+} ContactImportData;
+
+typedef struct _ContactImportStatus {
+	EImport *import;
+	EImportTarget *target;
+	gint percent;
+} ContactImportStatus;
+
+static gboolean
+contact_import_status_idle_cb (gpointer user_data)
+{
+	ContactImportStatus *status = user_data;
+
+	e_import_status (status->import, status->target, _("Importing..."), status->percent);
+
+	g_object_unref (status->import);
+	g_slice_free (ContactImportStatus, status);
+
+	return FALSE;
+}
+
+static gboolean
+contact_import_done_idle_cb (gpointer user_data)
+{
+	ContactImportData *cid = user_data;
+
+	cid->done_func (cid->user_data, cid->error);
+
+	g_clear_error (&cid->error);
+	g_clear_object (&cid->cancellable);
+	g_object_unref (cid->book_client);
+	g_object_unref (cid->import);
+	g_slice_free (ContactImportData, cid);
+
+	return FALSE;
+}
+
+static void
+contact_import_store_batch (ContactImportData *cid,
+                            GSList *batch,
+                            guint n_contacts)
+{
+	GSList *uids = NULL, *link, *uid_link;
+	GError *local_error = NULL;
+	gint64 started;
+
+	started = g_get_monotonic_time ();
+
+	if (!e_book_client_add_contacts_sync (cid->book_client, batch, &uids, cid->cancellable, &local_error)) {
+		if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_propagate_error (&cid->error, local_error);
+			return;
+		}
+
+		g_clear_error (&local_error);
+
+		/* Do not lose the whole batch due to one broken contact;
+		 * store them one by one, skipping those the book refuses,
+		 * the same as before the contacts were stored in batches. */
+		for (link = batch; link; link = g_slist_next (link)) {
+			gchar *uid = NULL;
+
+			if (g_cancellable_set_error_if_cancelled (cid->cancellable, &cid->error))
+				break;
+
+			if (e_book_client_add_contact_sync (cid->book_client, link->data, &uid, cid->cancellable, NULL) && uid)
+				uids = g_slist_prepend (uids, uid);
+			else
+				uids = g_slist_prepend (uids, NULL);
+		}
+
+		uids = g_slist_reverse (uids);
+
+		/* Stored one by one, thus go back to the small batches */
+		cid->batch_size = CONTACT_IMPORT_BATCH_MIN;
+	} else {
+		gint64 elapsed = g_get_monotonic_time () - started;
+
+		/* Aim for roughly a quarter up to one second per batch, to keep
+		 * the backend round-trips low, while still being responsive
+		 * to the cancellation and the progress updates. */
+		if (elapsed < G_USEC_PER_SEC / 4 && n_contacts >= cid->batch_size)
+			cid->batch_size = MIN (cid->batch_size * 2, CONTACT_IMPORT_BATCH_MAX);
+		else if (elapsed > G_USEC_PER_SEC)
+			cid->batch_size = MAX (cid->batch_size / 2, CONTACT_IMPORT_BATCH_MIN);
+	}
+
+	for (link = batch, uid_link = uids; link && uid_link; link = g_slist_next (link), uid_link = g_slist_next (uid_link)) {
+		if (uid_link->data)
+			e_contact_set (link->data, E_CONTACT_UID, uid_link->data);
+	}
+
+	if (cid->stored_func && !cid->error)
+		cid->stored_func (cid->user_data, batch);
+
+	g_slist_free_full (uids, g_free);
+}
+
+static gpointer
+contact_import_thread (gpointer user_data)
+{
+	ContactImportData *cid = user_data;
+	GSList *batch = NULL;
+	guint n_contacts = 0;
+	gboolean phase_ended = FALSE;
+
+	while (!cid->error && !g_cancellable_set_error_if_cancelled (cid->cancellable, &cid->error)) {
+		EContact *contact;
+		gint percent = -1;
+
+		contact = cid->read_func (cid->user_data, &percent, cid->cancellable);
+
+		if (percent >= 0 && percent != cid->percent) {
+			ContactImportStatus *status;
+
+			cid->percent = percent;
+
+			status = g_slice_new (ContactImportStatus);
+			status->import = g_object_ref (cid->import);
+			status->target = cid->target;
+			status->percent = percent;
+
+			g_idle_add (contact_import_status_idle_cb, status);
+		}
+
+		if (contact) {
+			batch = g_slist_prepend (batch, contact);
+			n_contacts++;
+			phase_ended = FALSE;
+
+			if (n_contacts < cid->batch_size)
+				continue;
+		} else if (phase_ended) {
+			break;
+		} else {
+			phase_ended = TRUE;
+		}
+
+		if (batch) {
+			batch = g_slist_reverse (batch);
+			contact_import_store_batch (cid, batch, n_contacts);
+			g_slist_free_full (batch, g_object_unref);
+			batch = NULL;
+			n_contacts = 0;
+		}
+	}
+
+	g_slist_free_full (batch, g_object_unref);
+
+	/* Cancelled import is not an error */
+	if (g_error_matches (cid->error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		g_clear_error (&cid->error);
+
+	g_idle_add (contact_import_done_idle_cb, cid);
+
+	return NULL;
+}
+
+/**
+ * evolution_contact_importer_run:
+ * @import: an #EImport
+ * @target: an #EImportTarget
+ * @book_client: an #EBookClient to store the contacts to
+ * @cancellable: (nullable): a #GCancellable, to cancel the import with
+ * @read_func: an #EvolutionContactImporterReadFunc
+ * @stored_func: (nullable): an #EvolutionContactImporterStoredFunc
+ * @done_func: an #EvolutionContactImporterDoneFunc
+ * @user_data: user data passed to the functions
+ *
+ * Runs the import in a dedicated thread: the contacts are read one by one
+ * with the @read_func and stored into the @book_client in batches, the progress
+ * is reported with e_import_status(). The @done_func is called in the main
+ * thread once all the contacts are stored, on error or after cancel; it is
+ * responsible to call e_import_complete().
+ **/
+void
+evolution_contact_importer_run (EImport *import,
+                                EImportTarget *target,
+                                EBookClient *book_client,
+                                GCancellable *cancellable,
+                                EvolutionContactImporterReadFunc read_func,
+                                EvolutionContactImporterStoredFunc stored_func,
+                                EvolutionContactImporterDoneFunc done_func,
+                                gpointer user_data)
+{
+	ContactImportData *cid;
+	GThread *thread;
+
+	g_return_if_fail (E_IS_IMPORT (import));
+	g_return_if_fail (target != NULL);
+	g_return_if_fail (E_IS_BOOK_CLIENT (book_client));
+	g_return_if_fail (read_func != NULL);
+	g_return_if_fail (done_func != NULL);
+
+	cid = g_slice_new0 (ContactImportData);
+	cid->import = g_object_ref (import);
+	cid->target = target;
+	cid->book_client = g_object_ref (book_client);
+	cid->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	cid->read_func = read_func;
+	cid->stored_func = stored_func;
+	cid->done_func = done_func;
+	cid->user_data = user_data;
+	cid->percent = -1;
+	cid->batch_size = CONTACT_IMPORT_BATCH_START;
+
+	thread = g_thread_new (NULL, contact_import_thread, cid);
+	g_thread_unref (thread);
+}
@@ -37,8 +37,35 @@
 
 #include "e-contact-print.h"
 
+/* How long one step of the pagination can take, in microseconds,
+ * before it returns to the main loop */
+#define PAGINATE_TIME_SLICE (G_USEC_PER_SEC / 20)
+
 typedef struct _EContactPrintContext EContactPrintContext;
 typedef struct _ContactPrintItem ContactPrintItem;
+typedef struct _ContactPrintPage ContactPrintPage;
+
+struct _ContactPrintItem
+{
+	EContact *contact;
+	gchar *collate_key;	/* of the file-as, or NULL */
+	gchar *section;		/* upper-cased first letter of the file-as, or NULL */
+	gdouble height;		/* estimated height, or negative when not measured yet */
+};
+
+/* State of the layout before the first contact printed on a page,
+ * thus the page can be drawn without laying out all the previous ones */
+struct _ContactPrintPage
+{
+	guint first_item;
+	gint pages;
+	gdouble x;
+	gdouble y;
+	gint column;
+	const gchar *section;
+	gboolean first_section;
+	gboolean first_contact;
+};
 
 struct _EContactPrintContext
 {
@@ -55,10 +82,14 @@ struct _EContactPrintContext
 	gint page_nr, pages;
 
 	PangoFontDescription *letter_heading_font;
-	gchar *section;
+	const gchar *section;
 	gboolean first_contact;
 
 	GSList *contact_list;
+
+	GPtrArray *items;	/* ContactPrintItem *, sorted */
+	GArray *page_starts;	/* ContactPrintPage */
+	guint n_paginated;
 };
 
 static gdouble
@@ -150,7 +181,7 @@ e_contact_text_height (GtkPrintContext *context,
 
 static void
 e_contact_print_letter_heading (EContactPrintContext *ctxt,
-                                gchar *letter)
+                                const gchar *letter)
 {
 	PangoLayout *layout;
 	PangoFontDescription *desc;
@@ -351,6 +382,7 @@ print_line (EContactPrintContext *ctxt,
 {
 	GtkPageSetup *setup;
 	gdouble page_height;
+	gdouble text_width;
 	gint wrapped_lines = 0;
 	gchar *text;
 
@@ -370,12 +402,9 @@ print_line (EContactPrintContext *ctxt,
 			ctxt->context, ctxt->style->body_font,
 			ctxt->x, ctxt->y, ctxt->column_width + 4, text);
 
-	if (get_font_width (ctxt->context,
-		ctxt->style->body_font, text) > ctxt->column_width)
-		wrapped_lines =
-			(get_font_width (ctxt->context,
-			ctxt->style->body_font, text) /
-			(ctxt->column_width + 4)) + 1;
+	text_width = get_font_width (ctxt->context, ctxt->style->body_font, text);
+	if (text_width > ctxt->column_width)
+		wrapped_lines = (text_width / (ctxt->column_width + 4)) + 1;
 	ctxt->y =
 		ctxt->y + ((wrapped_lines + 1) *
 		e_contact_text_height (
@@ -508,32 +537,62 @@ e_contact_print_contact (EContact *contact,
 	cairo_restore (cr);
 }
 
-static gint
-contact_compare (EContact *contact1,
-                 EContact *contact2)
+static ContactPrintItem *
+contact_print_item_new (EContact *contact)
 {
-	const gchar *field1, *field2;
+	ContactPrintItem *item;
+	const gchar *file_as;
 
-	if (contact1 == NULL || contact2 == NULL)
-		return 0;
+	item = g_slice_new0 (ContactPrintItem);
+	item->contact = g_object_ref (contact);
+	item->height = -1.0;
 
-	field1 = e_contact_get_const (contact1, E_CONTACT_FILE_AS);
-	field2 = e_contact_get_const (contact2, E_CONTACT_FILE_AS);
+	file_as = e_contact_get_const (contact, E_CONTACT_FILE_AS);
+	if (file_as != NULL) {
+		item->collate_key = g_utf8_collate_key (file_as, -1);
+		item->section = g_utf8_strup (file_as, g_utf8_next_char (file_as) - file_as);
+	}
 
-	if (field1 != NULL && field2 != NULL)
-		return g_utf8_collate (field1, field2);
+	return item;
+}
 
-	if (field1 != NULL || field2 != NULL)
-		return (field1 != NULL) ? -1 : 1;
+static void
+contact_print_item_free (gpointer ptr)
+{
+	ContactPrintItem *item = ptr;
 
-	field1 = e_contact_get_const (contact1, E_CONTACT_UID);
-	field2 = e_contact_get_const (contact2, E_CONTACT_UID);
+	if (item) {
+		g_object_unref (item->contact);
+		g_free (item->collate_key);
+		g_free (item->section);
+		g_slice_free (ContactPrintItem, item);
+	}
+}
+
+static gint
+contact_print_item_compare (gconstpointer ptr1,
+                            gconstpointer ptr2)
+{
+	const ContactPrintItem *item1 = *((ContactPrintItem **) ptr1);
+	const ContactPrintItem *item2 = *((ContactPrintItem **) ptr2);
+	const gchar *uid1, *uid2;
+
+	/* The collation keys are computed once, instead of collating
+	 * the file-as strings on each comparison */
+	if (item1->collate_key != NULL && item2->collate_key != NULL)
+		return strcmp (item1->collate_key, item2->collate_key);
+
+	if (item1->collate_key != NULL || item2->collate_key != NULL)
+		return (item1->collate_key != NULL) ? -1 : 1;
+
+	uid1 = e_contact_get_const (item1->contact, E_CONTACT_UID);
+	uid2 = e_contact_get_const (item2->contact, E_CONTACT_UID);
 
 	g_return_val_if_fail (
-		field1 != NULL && field2 != NULL,
-		(field1 != NULL) ? -1 : 1);
+		uid1 != NULL && uid2 != NULL,
+		(uid1 != NULL) ? -1 : 1);
 
-	return strcmp (field1, field2);
+	return strcmp (uid1, uid2);
 }
 
 static void
@@ -750,43 +809,41 @@ e_contact_build_style (EContactPrintStyle *style)
 
 }
 
+static gdouble
+contact_print_item_get_height (ContactPrintItem *item,
+                               EContactPrintContext *ctxt)
+{
+	if (item->height < 0)
+		item->height = e_contact_get_contact_height (item->contact, ctxt);
+
+	return item->height;
+}
+
 static void
-contact_draw (EContact *contact,
+contact_draw (ContactPrintItem *item,
               EContactPrintContext *ctxt)
 {
 	GtkPageSetup *setup;
 	gdouble page_height;
-	gchar *file_as;
 	gboolean new_section = FALSE;
 
 	setup = gtk_print_context_get_page_setup (ctxt->context);
 	page_height = gtk_page_setup_get_page_height (setup, GTK_UNIT_POINTS);
 
-	file_as = e_contact_get (contact, E_CONTACT_FILE_AS);
-
-	if (file_as != NULL) {
-		gchar *section;
-		gsize width;
-
-		width = g_utf8_next_char (file_as) - file_as;
-		section = g_utf8_strup (file_as, width);
-
+	if (item->section != NULL) {
 		new_section = (ctxt->section == NULL ||
-			g_utf8_collate (ctxt->section, section) != 0);
+			g_utf8_collate (ctxt->section, item->section) != 0);
 
-		if (new_section) {
-			g_free (ctxt->section);
-			ctxt->section = section;
-		} else
-			g_free (section);
+		if (new_section)
+			ctxt->section = item->section;
 	}
 
 	if (new_section) {
 		if (!ctxt->first_contact) {
 			if (ctxt->style->sections_start_new_page)
 				e_contact_start_new_page (ctxt);
-			else if ((ctxt->y + e_contact_get_contact_height (
-					contact, ctxt)) > page_height)
+			else if ((ctxt->y + contact_print_item_get_height (
+					item, ctxt)) > page_height)
 				e_contact_start_new_column (ctxt);
 		}
 		if (ctxt->style->letter_headings)
@@ -795,23 +852,46 @@ contact_draw (EContact *contact,
 	}
 
 	else if (!ctxt->first_contact && ((ctxt->y +
-		e_contact_get_contact_height (contact, ctxt)) > page_height)) {
+		contact_print_item_get_height (item, ctxt)) > page_height)) {
 		e_contact_start_new_column (ctxt);
 		if (ctxt->style->letter_headings)
 			e_contact_print_letter_heading (ctxt, ctxt->section);
 	}
 
-	e_contact_print_contact (contact, ctxt);
+	e_contact_print_contact (item->contact, ctxt);
 
 	ctxt->first_contact = FALSE;
 }
 
+static void
+contact_print_item_add (EContact *contact,
+                        GPtrArray *items)
+{
+	g_ptr_array_add (items, contact_print_item_new (contact));
+}
+
+static void
+contact_print_save_state (EContactPrintContext *ctxt,
+                          ContactPrintPage *state,
+                          guint first_item)
+{
+	state->first_item = first_item;
+	state->pages = ctxt->pages;
+	state->x = ctxt->x;
+	state->y = ctxt->y;
+	state->column = ctxt->column;
+	state->section = ctxt->section;
+	state->first_section = ctxt->first_section;
+	state->first_contact = ctxt->first_contact;
+}
+
 static void
 contact_begin_print (GtkPrintOperation *operation,
                      GtkPrintContext *context,
                      EContactPrintContext *ctxt)
 {
 	GtkPageSetup *setup;
+	ContactPrintPage first_page;
 	gdouble page_width;
 
 	e_contact_build_style (ctxt->style);
@@ -825,6 +905,8 @@ contact_begin_print (GtkPrintOperation *operation,
 	ctxt->first_contact = TRUE;
 	ctxt->first_section = TRUE;
 	ctxt->section = NULL;
+	ctxt->page_nr = -1;
+	ctxt->pages = 0;
 
 	ctxt->column_spacing = gtk_print_context_get_dpi_x (context) / 4;
 	ctxt->column_width = (page_width + ctxt->column_spacing) /
@@ -840,15 +922,51 @@ contact_begin_print (GtkPrintOperation *operation,
 		pango_font_description_get_size (
 			ctxt->style->headings_font) * 1.5);
 
-	if (ctxt->contact_list != NULL) {
-		ctxt->page_nr = -1;
-		ctxt->pages = 1;
-		ctxt->contact_list = g_slist_sort (
-			ctxt->contact_list,
-			(GCompareFunc) contact_compare);
-		g_slist_foreach (ctxt->contact_list, (GFunc) contact_draw, ctxt);
-		gtk_print_operation_set_n_pages (operation, ctxt->pages);
+	ctxt->items = g_ptr_array_new_full (
+		g_slist_length (ctxt->contact_list), contact_print_item_free);
+	g_slist_foreach (ctxt->contact_list, (GFunc) contact_print_item_add, ctxt->items);
+	g_ptr_array_sort (ctxt->items, contact_print_item_compare);
+
+	ctxt->page_starts = g_array_new (FALSE, FALSE, sizeof (ContactPrintPage));
+	ctxt->n_paginated = 0;
+
+	contact_print_save_state (ctxt, &first_page, 0);
+	g_array_append_val (ctxt->page_starts, first_page);
+}
+
+/* Lays out the contacts in steps, thus the UI does not freeze for
+ * large books; remembers where each page starts, thus the pages can
+ * be drawn without laying out all the contacts again for each page */
+static gboolean
+contact_paginate (GtkPrintOperation *operation,
+                  GtkPrintContext *context,
+                  EContactPrintContext *ctxt)
+{
+	gint64 end_time;
+
+	end_time = g_get_monotonic_time () + PAGINATE_TIME_SLICE;
+
+	while (ctxt->n_paginated < ctxt->items->len) {
+		ContactPrintPage start;
+		gint pages = ctxt->pages;
+
+		contact_print_save_state (ctxt, &start, ctxt->n_paginated);
+		contact_draw (g_ptr_array_index (ctxt->items, ctxt->n_paginated), ctxt);
+		ctxt->n_paginated++;
+
+		/* A contact can continue on the next page(s) */
+		while (pages < ctxt->pages) {
+			g_array_append_val (ctxt->page_starts, start);
+			pages++;
+		}
+
+		if (g_get_monotonic_time () >= end_time)
+			break;
 	}
+
+	gtk_print_operation_set_n_pages (operation, ctxt->page_starts->len);
+
+	return ctxt->n_paginated >= ctxt->items->len;
 }
 
 /* contact_page_draw_footer inserts the
@@ -906,17 +1024,29 @@ contact_draw_page (GtkPrintOperation *operation,
                    gint page_nr,
                    EContactPrintContext *ctxt)
 {
-	/* only text on page_nr == pages will be drawn, the pages is recalculated */
-	ctxt->page_nr = page_nr;
-	ctxt->pages = 0;
-
-	ctxt->x = ctxt->y = .0;
-	ctxt->column = 0;
-	ctxt->first_contact = TRUE;
-	ctxt->first_section = TRUE;
-	ctxt->section = NULL;
+	const ContactPrintPage *start;
+	guint ii;
+
+	/* only text on page_nr == pages will be drawn; the layout continues
+	 * from the contact the page starts with, until the page is full */
+	if (page_nr >= 0 && page_nr < (gint) ctxt->page_starts->len) {
+		start = &g_array_index (ctxt->page_starts, ContactPrintPage, page_nr);
+
+		ctxt->page_nr = page_nr;
+		ctxt->pages = start->pages;
+
+		ctxt->x = start->x;
+		ctxt->y = start->y;
+		ctxt->column = start->column;
+		ctxt->section = start->section;
+		ctxt->first_section = start->first_section;
+		ctxt->first_contact = start->first_contact;
+
+		/* The contact can start on a previous page */
+		for (ii = start->first_item; ii < ctxt->items->len && ctxt->pages <= page_nr; ii++)
+			contact_draw (g_ptr_array_index (ctxt->items, ii), ctxt);
+	}
 
-	g_slist_foreach (ctxt->contact_list, (GFunc) contact_draw, ctxt);
 	contact_page_draw_footer (operation, context, page_nr);
 }
 
@@ -934,9 +1064,16 @@ contact_end_print (GtkPrintOperation *operation,
 	g_slist_free_full (
 		ctxt->contact_list,
 		(GDestroyNotify) g_object_unref);
+	ctxt->contact_list = NULL;
+
+	g_clear_pointer (&ctxt->items, g_ptr_array_unref);
+	if (ctxt->page_starts) {
+		g_array_free (ctxt->page_starts, TRUE);
+		ctxt->page_starts = NULL;
+	}
 
 	g_free (ctxt->style);
-	g_free (ctxt->section);
+	ctxt->section = NULL;
 }
 
 static void
@@ -1012,6 +1149,9 @@ e_contact_print (EBookClient *book_client,
 	g_signal_connect (
 		operation, "begin-print",
 		G_CALLBACK (contact_begin_print), ctxt);
+	g_signal_connect (
+		operation, "paginate",
+		G_CALLBACK (contact_paginate), ctxt);
 	g_signal_connect (
 		operation, "draw_page",
 		G_CALLBACK (contact_draw_page), ctxt);
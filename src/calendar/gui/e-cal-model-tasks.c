@@ -1418,19 +1418,25 @@ e_cal_model_tasks_update_due_tasks (ECalModelTasks *model)
 	gint row, row_count;
 	ECalModelComponent *comp_data;
 	ECalModelTasksDueStatus status;
+	GArray *rows;
 
 	g_return_if_fail (E_IS_CAL_MODEL_TASKS (model));
 
 	row_count = e_table_model_row_count (E_TABLE_MODEL (model));
+	rows = g_array_new (FALSE, FALSE, sizeof (gint));
 
 	for (row = 0; row < row_count; row++)
 	{
 		comp_data = e_cal_model_get_component_at (E_CAL_MODEL (model), row);
 		status = get_due_status (E_CAL_MODEL_TASKS (model), comp_data);
 		if ((status == E_CAL_MODEL_TASKS_DUE_TODAY) || (status == E_CAL_MODEL_TASKS_DUE_OVERDUE))
-		{
-			e_table_model_pre_change (E_TABLE_MODEL (model));
-			e_table_model_row_changed (E_TABLE_MODEL (model), row);
-		}
+			g_array_append_val (rows, row);
+	}
+
+	if (rows->len > 0) {
+		e_table_model_pre_change (E_TABLE_MODEL (model));
+		e_table_model_rows_changed (E_TABLE_MODEL (model), (const gint *) rows->data, rows->len);
 	}
+
+	g_array_free (rows, TRUE);
 }
@@ -61,12 +61,9 @@ struct _EMeetingStorePrivate {
 	GMutex mutex;
 	guint refresh_idle_id;
 
-	guint num_threads;
 	guint num_queries;
 };
 
-#define BUF_SIZE 1024
-
 typedef struct _EMeetingStoreQueueData EMeetingStoreQueueData;
 struct _EMeetingStoreQueueData {
 	EMeetingStore *store;
@@ -77,9 +74,6 @@ struct _EMeetingStoreQueueData {
 	EMeetingTime start;
 	EMeetingTime end;
 
-	gchar buffer[BUF_SIZE];
-	GString *string;
-
 	GPtrArray *call_backs;
 	GPtrArray *data;
 };
@@ -95,6 +89,7 @@ enum {
 
 /* Forward Declarations */
 static void ems_tree_model_init (GtkTreeModelIface *iface);
+static void free_busy_service_init (void);
 
 G_DEFINE_TYPE_WITH_CODE (
 	EMeetingStore, e_meeting_store, GTK_TYPE_LIST_STORE,
@@ -752,6 +747,8 @@ e_meeting_store_class_init (EMeetingStoreClass *class)
 
 	g_type_class_add_private (class, sizeof (EMeetingStorePrivate));
 
+	free_busy_service_init ();
+
 	object_class = G_OBJECT_CLASS (class);
 	object_class->set_property = meeting_store_set_property;
 	object_class->get_property = meeting_store_get_property;
@@ -1298,14 +1295,112 @@ process_callbacks (EMeetingStoreQueueData *qdata)
 		g_idle_add ((GSourceFunc) call_back, data);
 	}
 
-	g_mutex_lock (&store->priv->mutex);
-	store->priv->num_threads--;
-	g_mutex_unlock (&store->priv->mutex);
-
 	refresh_queue_remove (qdata->store, qdata->attendee);
 	g_object_unref (store);
 }
 
+/* Free/busy information is fetched by a process-wide service shared by
+ * all EMeetingStore instances.  Lookups run in a bounded thread pool,
+ * concurrent requests for the same attendee and time range are merged
+ * into a single job, and the parsed result is kept for a while, thus
+ * reopening a meeting editor does not query the same attendees again. */
+
+#define FREE_BUSY_MAX_THREADS 4
+#define FREE_BUSY_CACHE_TIMEOUT_SECONDS (5 * 60)
+
+typedef struct _FreeBusyPeriodData {
+	struct icaltimetype start;	/* in UTC */
+	struct icaltimetype end;	/* in UTC */
+	EMeetingFreeBusyType busy_type;
+	gchar *summary;
+	gchar *location;
+} FreeBusyPeriodData;
+
+typedef struct _FreeBusyData {
+	/* Either in UTC or floating, when the zone was not known */
+	struct icaltimetype start_range;
+	struct icaltimetype end_range;
+	GArray *periods;	/* FreeBusyPeriodData */
+	gint64 expires;		/* g_get_monotonic_time() based */
+} FreeBusyData;
+
+typedef struct _FreeBusyJob {
+	gchar *key;
+	ECalClient *client;
+	gchar *email;
+	gchar *fb_uri;
+	time_t startt;
+	time_t endt;
+
+	/* Set by the worker thread */
+	gboolean needs_authentication;
+	FreeBusyData *fb_data;
+
+	/* EMeetingStoreQueueData waiting for the result */
+	GSList *waiting;
+} FreeBusyJob;
+
+/* All of these are accessed only from the main thread */
+static GThreadPool *free_busy_pool = NULL;
+static GHashTable *free_busy_cache = NULL;	/* gchar *key ~> FreeBusyData * */
+static GHashTable *free_busy_jobs = NULL;	/* gchar *key ~> FreeBusyJob * */
+
+static void
+free_busy_period_data_clear (gpointer ptr)
+{
+	FreeBusyPeriodData *period = ptr;
+
+	g_free (period->summary);
+	g_free (period->location);
+}
+
+static FreeBusyData *
+free_busy_data_new (void)
+{
+	FreeBusyData *fb_data;
+
+	fb_data = g_slice_new0 (FreeBusyData);
+	fb_data->start_range = icaltime_null_time ();
+	fb_data->end_range = icaltime_null_time ();
+	fb_data->periods = g_array_new (FALSE, TRUE, sizeof (FreeBusyPeriodData));
+	g_array_set_clear_func (fb_data->periods, free_busy_period_data_clear);
+
+	return fb_data;
+}
+
+static void
+free_busy_data_free (gpointer ptr)
+{
+	FreeBusyData *fb_data = ptr;
+
+	if (fb_data) {
+		g_array_free (fb_data->periods, TRUE);
+		g_slice_free (FreeBusyData, fb_data);
+	}
+}
+
+static struct icaltimetype
+free_busy_time_to_utc (icalproperty *ip,
+                       struct icaltimetype itt,
+                       icalcomponent *tz_top_level)
+{
+	icaltimezone *zone;
+
+	if (itt.is_utc)
+		return itt;
+
+	zone = find_zone (ip, tz_top_level);
+	if (zone) {
+		icaltimezone *utc_zone = icaltimezone_get_utc_timezone ();
+
+		icaltimezone_convert_time (&itt, zone, utc_zone);
+		icaltime_set_timezone (&itt, utc_zone);
+		icaltimezone_free (zone, TRUE);
+	}
+
+	return itt;
+}
+
 static void
 process_free_busy_comp_get_xfb (icalproperty *ip,
                                 gchar **summary,
@@ -1334,51 +1429,22 @@ process_free_busy_comp_get_xfb (icalproperty *ip,
 }
 
 static void
-process_free_busy_comp (EMeetingAttendee *attendee,
+process_free_busy_comp (FreeBusyData *fb_data,
                         icalcomponent *fb_comp,
-                        icaltimezone *zone,
                         icalcomponent *tz_top_level)
 {
 	icalproperty *ip;
 
 	ip = icalcomponent_get_first_property (fb_comp, ICAL_DTSTART_PROPERTY);
 	if (ip != NULL) {
-		struct icaltimetype dtstart;
-		icaltimezone *ds_zone;
-
-		dtstart = icalproperty_get_dtstart (ip);
-		if (!dtstart.is_utc)
-			ds_zone = find_zone (ip, tz_top_level);
-		else
-			ds_zone = icaltimezone_get_utc_timezone ();
-		icaltimezone_convert_time (&dtstart, ds_zone, zone);
-		e_meeting_attendee_set_start_busy_range (
-			attendee,
-			dtstart.year,
-			dtstart.month,
-			dtstart.day,
-			dtstart.hour,
-			dtstart.minute);
+		fb_data->start_range = free_busy_time_to_utc (
+			ip, icalproperty_get_dtstart (ip), tz_top_level);
 	}
 
 	ip = icalcomponent_get_first_property (fb_comp, ICAL_DTEND_PROPERTY);
 	if (ip != NULL) {
-		struct icaltimetype dtend;
-		icaltimezone *de_zone;
-
-		dtend = icalproperty_get_dtend (ip);
-		if (!dtend.is_utc)
-			de_zone = find_zone (ip, tz_top_level);
-		else
-			de_zone = icaltimezone_get_utc_timezone ();
-		icaltimezone_convert_time (&dtend, de_zone, zone);
-		e_meeting_attendee_set_end_busy_range (
-			attendee,
-			dtend.year,
-			dtend.month,
-			dtend.day,
-			dtend.hour,
-			dtend.minute);
+		fb_data->end_range = free_busy_time_to_utc (
+			ip, icalproperty_get_dtend (ip), tz_top_level);
 	}
 
 	ip = icalcomponent_get_first_property (fb_comp, ICAL_FREEBUSY_PROPERTY);
@@ -1415,63 +1481,42 @@ process_free_busy_comp (EMeetingAttendee *attendee,
 		}
 
 		if (busy_type != E_MEETING_FREE_BUSY_LAST) {
-			icaltimezone *utc_zone = icaltimezone_get_utc_timezone ();
-			gchar *summary = NULL;
-			gchar *location = NULL;
+			FreeBusyPeriodData period;
 
-			icaltimezone_convert_time (&fb.start, utc_zone, zone);
-			icaltimezone_convert_time (&fb.end, utc_zone, zone);
+			period.start = fb.start;
+			period.end = fb.end;
+			period.busy_type = busy_type;
+			period.summary = NULL;
+			period.location = NULL;
 
 			/* Extract extended free/busy (XFB) information from
 			 * the icalproperty, if it carries such.
 			 * See the comment for the EMeetingXfbData structure
 			 * for a reference.
 			 */
-			process_free_busy_comp_get_xfb (ip, &summary, &location);
-
-			e_meeting_attendee_add_busy_period (
-				attendee,
-				fb.start.year,
-				fb.start.month,
-				fb.start.day,
-				fb.start.hour,
-				fb.start.minute,
-				fb.end.year,
-				fb.end.month,
-				fb.end.day,
-				fb.end.hour,
-				fb.end.minute,
-				busy_type,
-				summary,
-				location);
-
-			if (summary != NULL)
-				g_free (summary);
-			if (location != NULL)
-				g_free (location);
+			process_free_busy_comp_get_xfb (ip, &period.summary, &period.location);
+
+			g_array_append_val (fb_data->periods, period);
 		}
 
 		ip = icalcomponent_get_next_property (fb_comp, ICAL_FREEBUSY_PROPERTY);
 	}
 }
 
-static void
-process_free_busy (EMeetingStoreQueueData *qdata,
-                   gchar *text)
+/* This is called from a free/busy worker thread, thus it
+ * cannot touch any EMeetingStore nor EMeetingAttendee. */
+static FreeBusyData *
+process_free_busy (const gchar *text)
 {
-	EMeetingStore *store = qdata->store;
-	EMeetingStorePrivate *priv;
-	EMeetingAttendee *attendee = qdata->attendee;
+	FreeBusyData *fb_data;
 	icalcomponent *main_comp;
 	icalcomponent_kind kind = ICAL_NO_COMPONENT;
 
-	priv = store->priv;
-
 	main_comp = icalparser_parse_string (text);
-	if (main_comp == NULL) {
-		process_callbacks (qdata);
-		return;
-	}
+	if (main_comp == NULL)
+		return NULL;
+
+	fb_data = free_busy_data_new ();
 
 	kind = icalcomponent_isa (main_comp);
 	if (kind == ICAL_VCALENDAR_COMPONENT) {
@@ -1492,353 +1537,172 @@ process_free_busy (EMeetingStoreQueueData *qdata,
 
 		iter = icalcomponent_begin_component (main_comp, ICAL_VFREEBUSY_COMPONENT);
 		while ((sub_comp = icalcompiter_deref (&iter)) != NULL) {
-			process_free_busy_comp (attendee, sub_comp, priv->zone, tz_top_level);
+			process_free_busy_comp (fb_data, sub_comp, tz_top_level);
 
 			icalcompiter_next (&iter);
 		}
 		icalcomponent_free (tz_top_level);
 	} else if (kind == ICAL_VFREEBUSY_COMPONENT) {
-		process_free_busy_comp (attendee, main_comp, priv->zone, NULL);
+		process_free_busy_comp (fb_data, main_comp, NULL);
 	}
 
 	icalcomponent_free (main_comp);
 
-	process_callbacks (qdata);
+	return fb_data;
 }
 
-/*
- * Replace all instances of from_value in string with to_value
- * In the returned newly allocated string.
-*/
-static gchar *
-replace_string (gchar *string,
-                const gchar *from_value,
-                gchar *to_value)
+static void
+free_busy_data_apply (FreeBusyData *fb_data,
+                      EMeetingAttendee *attendee,
+                      icaltimezone *zone)
 {
-	gchar *replaced;
-	gchar **split_uri;
-
-	split_uri = g_strsplit (string, from_value, 0);
-	replaced = g_strjoinv (to_value, split_uri);
-	g_strfreev (split_uri);
+	icaltimezone *utc_zone = icaltimezone_get_utc_timezone ();
+	guint ii;
 
-	return replaced;
-}
+	if (!icaltime_is_null_time (fb_data->start_range)) {
+		struct icaltimetype dtstart = fb_data->start_range;
 
-static void start_async_read (const gchar *uri, gpointer data);
-
-typedef struct {
-	ECalClient *client;
-	time_t startt;
-	time_t endt;
-	GSList *users;
-	GSList *fb_data;
-	gchar *fb_uri;
-	gchar *email;
-	EMeetingAttendee *attendee;
-	EMeetingStoreQueueData *qdata;
-	EMeetingStore *store;
-} FreeBusyAsyncData;
-
-#define USER_SUB   "%u"
-#define DOMAIN_SUB "%d"
-
-static gboolean
-freebusy_async (gpointer data)
-{
-	FreeBusyAsyncData *fbd = data;
-	EMeetingAttendee *attendee = fbd->attendee;
-	gchar *default_fb_uri = NULL;
-	gchar *fburi = NULL;
-	static GMutex mutex;
-	EMeetingStorePrivate *priv = fbd->store->priv;
-
-	if (fbd->client) {
-		/* FIXME This a workaround for getting all the free busy
-		 *       information for the users.  We should be able to
-		 *       get free busy asynchronously. */
-		g_mutex_lock (&mutex);
-		priv->num_queries++;
-		e_cal_client_get_free_busy_sync (
-			fbd->client, fbd->startt,
-			fbd->endt, fbd->users, &fbd->fb_data, NULL, NULL);
-		priv->num_queries--;
-		g_mutex_unlock (&mutex);
-
-		g_slist_foreach (fbd->users, (GFunc) g_free, NULL);
-		g_slist_free (fbd->users);
-
-		if (fbd->fb_data != NULL) {
-			ECalComponent *comp = fbd->fb_data->data;
-			gchar *comp_str;
-
-			comp_str = e_cal_component_get_as_string (comp);
-			process_free_busy (fbd->qdata, comp_str);
-			g_free (comp_str);
-
-			return TRUE;
-		}
-	}
-
-	/* Look for fburl's of attendee with no free busy info on server */
-	if (!e_meeting_attendee_is_set_address (attendee)) {
-		process_callbacks (fbd->qdata);
-		return TRUE;
+		if (dtstart.is_utc)
+			icaltimezone_convert_time (&dtstart, utc_zone, zone);
+		e_meeting_attendee_set_start_busy_range (
+			attendee,
+			dtstart.year,
+			dtstart.month,
+			dtstart.day,
+			dtstart.hour,
+			dtstart.minute);
 	}
 
-	/* Check for free busy info on the default server */
-	default_fb_uri = g_strdup (fbd->fb_uri);
-	fburi = g_strdup (e_meeting_attendee_get_fburi (attendee));
+	if (!icaltime_is_null_time (fb_data->end_range)) {
+		struct icaltimetype dtend = fb_data->end_range;
 
-	if (fburi && !*fburi) {
-		g_free (fburi);
-		fburi = NULL;
+		if (dtend.is_utc)
+			icaltimezone_convert_time (&dtend, utc_zone, zone);
+		e_meeting_attendee_set_end_busy_range (
+			attendee,
+			dtend.year,
+			dtend.month,
+			dtend.day,
+			dtend.hour,
+			dtend.minute);
 	}
 
-	if (fburi) {
-		priv->num_queries++;
-		start_async_read (fburi, fbd->qdata);
-		g_free (fburi);
-	} else if (default_fb_uri != NULL && !g_str_equal (default_fb_uri, "")) {
-		gchar *tmp_fb_uri;
-		gchar **split_email;
+	for (ii = 0; ii < fb_data->periods->len; ii++) {
+		FreeBusyPeriodData *period;
+		struct icaltimetype start, end;
 
-		split_email = g_strsplit (fbd->email, "@", 2);
+		period = &g_array_index (fb_data->periods, FreeBusyPeriodData, ii);
 
-		tmp_fb_uri = replace_string (default_fb_uri, USER_SUB, split_email[0]);
-		g_free (default_fb_uri);
-		default_fb_uri = replace_string (tmp_fb_uri, DOMAIN_SUB, split_email[1]);
+		start = period->start;
+		end = period->end;
 
-		priv->num_queries++;
-		start_async_read (default_fb_uri, fbd->qdata);
-		g_free (tmp_fb_uri);
-		g_strfreev (split_email);
-		g_free (default_fb_uri);
-	} else {
-		process_callbacks (fbd->qdata);
-	}
+		icaltimezone_convert_time (&start, utc_zone, zone);
+		icaltimezone_convert_time (&end, utc_zone, zone);
 
-	return TRUE;
+		e_meeting_attendee_add_busy_period (
+			attendee,
+			start.year,
+			start.month,
+			start.day,
+			start.hour,
+			start.minute,
+			end.year,
+			end.month,
+			end.day,
+			end.hour,
+			end.minute,
+			period->busy_type,
+			period->summary,
+			period->location);
+	}
 }
 
-#undef USER_SUB
-#undef DOMAIN_SUB
-
-static gboolean
-refresh_busy_periods (gpointer data)
+static FreeBusyData *
+free_busy_cache_lookup (const gchar *key)
 {
-	EMeetingStore *store = E_MEETING_STORE (data);
-	EMeetingStorePrivate *priv;
-	EMeetingAttendee *attendee = NULL;
-	EMeetingStoreQueueData *qdata = NULL;
-	gint i;
-	GThread *thread;
-	GError *error = NULL;
-	FreeBusyAsyncData *fbd;
-
-	priv = store->priv;
-
-	/* Check to see if there are any remaining attendees in the queue */
-	for (i = 0; i < priv->refresh_queue->len; i++) {
-		attendee = g_ptr_array_index (priv->refresh_queue, i);
-		g_return_val_if_fail (attendee != NULL, FALSE);
-
-		qdata = g_hash_table_lookup (
-			priv->refresh_data, itip_strip_mailto (
-			e_meeting_attendee_get_address (attendee)));
-		if (!qdata)
-			continue;
-
-		if (!qdata->refreshing)
-			break;
-	}
-
-	/* The everything in the queue is being refreshed */
-	if (i >= priv->refresh_queue->len) {
-		priv->refresh_idle_id = 0;
-		return FALSE;
-	}
-
-	/* Indicate we are trying to refresh it */
-	qdata->refreshing = TRUE;
-
-	/* We take a ref in case we get destroyed in the gui during a callback */
-	g_object_ref (qdata->store);
-
-	fbd = g_new0 (FreeBusyAsyncData, 1);
-	fbd->client = priv->client;
-	fbd->attendee = attendee;
-	fbd->users = NULL;
-	fbd->fb_data = NULL;
-	fbd->qdata = qdata;
-	fbd->fb_uri = priv->fb_uri;
-	fbd->store = store;
-	fbd->email = g_strdup (itip_strip_mailto (
-		e_meeting_attendee_get_address (attendee)));
-
-	/* Check the server for free busy data */
-	if (priv->client) {
-		struct icaltimetype itt;
-
-		itt = icaltime_null_time ();
-		itt.year = g_date_get_year (&qdata->start.date);
-		itt.month = g_date_get_month (&qdata->start.date);
-		itt.day = g_date_get_day (&qdata->start.date);
-		itt.hour = qdata->start.hour;
-		itt.minute = qdata->start.minute;
-		fbd->startt = icaltime_as_timet_with_zone (itt, priv->zone);
-
-		itt = icaltime_null_time ();
-		itt.year = g_date_get_year (&qdata->end.date);
-		itt.month = g_date_get_month (&qdata->end.date);
-		itt.day = g_date_get_day (&qdata->end.date);
-		itt.hour = qdata->end.hour;
-		itt.minute = qdata->end.minute;
-		fbd->endt = icaltime_as_timet_with_zone (itt, priv->zone);
-		fbd->qdata = qdata;
-
-		fbd->users = g_slist_append (fbd->users, g_strdup (fbd->email));
+	FreeBusyData *fb_data;
 
+	fb_data = g_hash_table_lookup (free_busy_cache, key);
+	if (fb_data && fb_data->expires <= g_get_monotonic_time ()) {
+		g_hash_table_remove (free_busy_cache, key);
+		fb_data = NULL;
 	}
 
-	g_mutex_lock (&store->priv->mutex);
-	store->priv->num_threads++;
-	g_mutex_unlock (&store->priv->mutex);
-
-	thread = g_thread_try_new (NULL, (GThreadFunc) freebusy_async, fbd, &error);
-	if (!thread) {
-		/* do clean up stuff here */
-		g_slist_foreach (fbd->users, (GFunc) g_free, NULL);
-		g_slist_free (fbd->users);
-		g_free (fbd->email);
-		priv->refresh_idle_id = 0;
-
-		g_mutex_lock (&store->priv->mutex);
-		store->priv->num_threads--;
-		g_mutex_unlock (&store->priv->mutex);
-
-		return FALSE;
-	}
+	return fb_data;
+}
 
-	g_thread_unref (thread);
+static gboolean
+free_busy_cache_remove_expired_cb (gpointer key,
+                                   gpointer value,
+                                   gpointer user_data)
+{
+	FreeBusyData *fb_data = value;
+	gint64 *now = user_data;
 
-	return TRUE;
+	return fb_data->expires <= *now;
 }
 
 static void
-refresh_queue_add (EMeetingStore *store,
-                   gint row,
-                   EMeetingTime *start,
-                   EMeetingTime *end,
-                   EMeetingStoreRefreshCallback call_back,
-                   gpointer data)
+free_busy_cache_add (const gchar *key,
+                     FreeBusyData *fb_data)
 {
-	EMeetingStorePrivate *priv;
-	EMeetingAttendee *attendee;
-	EMeetingStoreQueueData *qdata;
-	gint i;
+	gint64 now;
 
-	priv = store->priv;
+	now = g_get_monotonic_time ();
 
-	attendee = g_ptr_array_index (priv->attendees, row);
-	if ((attendee == NULL) || !strcmp (itip_strip_mailto (
-		e_meeting_attendee_get_address (attendee)), ""))
-		return;
+	g_hash_table_foreach_remove (
+		free_busy_cache,
+		free_busy_cache_remove_expired_cb, &now);
 
-	/* check the queue if the attendee is already in there*/
-	for (i = 0; i < priv->refresh_queue->len; i++) {
-		if (attendee == g_ptr_array_index (priv->refresh_queue, i))
-			return;
-
-		if (!strcmp (e_meeting_attendee_get_address (attendee),
-			e_meeting_attendee_get_address (
-			g_ptr_array_index (priv->refresh_queue, i))))
-			return;
-	}
-
-	g_mutex_lock (&priv->mutex);
-	qdata = g_hash_table_lookup (
-		priv->refresh_data, itip_strip_mailto (
-		e_meeting_attendee_get_address (attendee)));
-
-	if (qdata == NULL) {
-		qdata = g_new0 (EMeetingStoreQueueData, 1);
+	fb_data->expires = now + FREE_BUSY_CACHE_TIMEOUT_SECONDS * G_USEC_PER_SEC;
 
-		qdata->store = store;
-		qdata->attendee = attendee;
-		e_meeting_attendee_clear_busy_periods (attendee);
-		e_meeting_attendee_set_has_calendar_info (attendee, FALSE);
-
-		qdata->start = *start;
-		qdata->end = *end;
-		qdata->string = g_string_new (NULL);
-		qdata->call_backs = g_ptr_array_new ();
-		qdata->data = g_ptr_array_new ();
-		g_ptr_array_add (qdata->call_backs, call_back);
-		g_ptr_array_add (qdata->data, data);
+	g_hash_table_insert (free_busy_cache, g_strdup (key), fb_data);
+}
 
-		g_hash_table_insert (
-			priv->refresh_data, g_strdup (itip_strip_mailto (
-			e_meeting_attendee_get_address (attendee))), qdata);
-	} else {
-		if (e_meeting_time_compare_times (start, &qdata->start) == -1)
-			qdata->start = *start;
-		if (e_meeting_time_compare_times (end, &qdata->end) == -1)
-			qdata->end = *end;
-		g_ptr_array_add (qdata->call_backs, call_back);
-		g_ptr_array_add (qdata->data, data);
+static void
+free_busy_job_free (FreeBusyJob *job)
+{
+	if (job) {
+		g_clear_object (&job->client);
+		free_busy_data_free (job->fb_data);
+		g_slist_free (job->waiting);
+		g_free (job->key);
+		g_free (job->email);
+		g_free (job->fb_uri);
+		g_slice_free (FreeBusyJob, job);
 	}
-	g_mutex_unlock (&priv->mutex);
-
-	g_object_ref (attendee);
-	g_ptr_array_add (priv->refresh_queue, attendee);
-
-	if (priv->refresh_idle_id == 0)
-		priv->refresh_idle_id = g_idle_add (refresh_busy_periods, store);
 }
 
+/* Delivers the result to every queued attendee of every store
+ * which asked for it.  The FreeBusyJob is freed afterwards. */
 static void
-async_read (GObject *source_object,
-            GAsyncResult *result,
-            gpointer data)
+free_busy_job_finish (FreeBusyJob *job)
 {
-	EMeetingStoreQueueData *qdata = data;
-	GError *error = NULL;
-	GInputStream *istream;
-	gssize read;
+	GSList *link;
 
-	g_return_if_fail (source_object != NULL);
-	g_return_if_fail (G_IS_INPUT_STREAM (source_object));
+	g_hash_table_remove (free_busy_jobs, job->key);
 
-	istream = G_INPUT_STREAM (source_object);
+	if (job->fb_data) {
+		free_busy_cache_add (job->key, job->fb_data);
+	}
 
-	read = g_input_stream_read_finish (istream, result, &error);
+	for (link = job->waiting; link; link = g_slist_next (link)) {
+		EMeetingStoreQueueData *qdata = link->data;
+		EMeetingStorePrivate *priv = qdata->store->priv;
 
-	if (error != NULL) {
-		g_warning (
-			"Read finish failed: %s", error->message);
-		g_error_free (error);
+		if (job->fb_data)
+			free_busy_data_apply (job->fb_data, qdata->attendee, priv->zone);
 
-		g_input_stream_close (istream, NULL, NULL);
-		g_object_unref (istream);
-		process_free_busy (qdata, qdata->string->str);
-		return;
-	}
+		if (priv->num_queries > 0)
+			priv->num_queries--;
 
-	g_return_if_fail (read >= 0);
+		process_callbacks (qdata);
+	}
 
-	if (read == 0) {
-		g_input_stream_close (istream, NULL, NULL);
-		g_object_unref (istream);
-		process_free_busy (qdata, qdata->string->str);
-	} else {
-		qdata->buffer[read] = '\0';
-		qdata->string = g_string_append (qdata->string, qdata->buffer);
+	/* Owned by the cache now */
+	job->fb_data = NULL;
 
-		g_input_stream_read_async (
-			istream, qdata->buffer, BUF_SIZE - 1,
-			G_PRIORITY_DEFAULT, NULL, async_read, qdata);
-	}
+	free_busy_job_free (job);
 }
 
 static void
@@ -1965,17 +1829,20 @@ soup_msg_ready_cb (SoupSession *session,
                    SoupMessage *msg,
                    gpointer user_data)
 {
-	EMeetingStoreQueueData *qdata = user_data;
+	FreeBusyJob *job = user_data;
 
 	g_return_if_fail (session != NULL);
 	g_return_if_fail (msg != NULL);
-	g_return_if_fail (qdata != NULL);
+	g_return_if_fail (job != NULL);
 
 	if (SOUP_STATUS_IS_SUCCESSFUL (msg->status_code)) {
-		qdata->string = g_string_new_len (
+		gchar *text;
+
+		text = g_strndup (
 			msg->response_body->data,
 			msg->response_body->length);
-		process_free_busy (qdata, qdata->string->str);
+		job->fb_data = process_free_busy (text);
+		g_free (text);
 	} else {
 		g_warning (
 			"Unable to access free/busy url: %s",
@@ -1983,28 +1850,28 @@ soup_msg_ready_cb (SoupSession *session,
 			msg->reason_phrase : (soup_status_get_phrase (
 			msg->status_code) ? soup_status_get_phrase (
 			msg->status_code) : "Unknown error"));
-		process_callbacks (qdata);
 	}
+
+	free_busy_job_finish (job);
 }
 
 static void
-download_with_libsoup (const gchar *uri,
-                       EMeetingStoreQueueData *qdata)
+download_with_libsoup (FreeBusyJob *job)
 {
 	SoupSession *session;
 	SoupMessage *msg;
 
-	g_return_if_fail (uri != NULL);
-	g_return_if_fail (qdata != NULL);
+	g_return_if_fail (job != NULL);
+	g_return_if_fail (job->fb_uri != NULL);
 
-	msg = soup_message_new (SOUP_METHOD_GET, uri);
+	msg = soup_message_new (SOUP_METHOD_GET, job->fb_uri);
 	if (!msg) {
-		g_warning ("Unable to access free/busy url '%s'; malformed?", uri);
-		process_callbacks (qdata);
+		g_warning ("Unable to access free/busy url '%s'; malformed?", job->fb_uri);
+		free_busy_job_finish (job);
 		return;
 	}
 
-	g_object_set_data_full (G_OBJECT (msg), "orig-uri", g_strdup (uri), g_free);
+	g_object_set_data_full (G_OBJECT (msg), "orig-uri", g_strdup (job->fb_uri), g_free);
 
 	session = soup_session_new ();
 	g_object_set (session, SOUP_SESSION_TIMEOUT, 90, NULL);
@@ -2017,53 +1884,346 @@ download_with_libsoup (const gchar *uri,
 		msg, "got_body", "Location",
 		G_CALLBACK (redirect_handler), session);
 	soup_message_headers_append (msg->request_headers, "Connection", "close");
-	soup_session_queue_message (session, msg, soup_msg_ready_cb, qdata);
+	soup_session_queue_message (session, msg, soup_msg_ready_cb, job);
+}
+
+static gboolean
+free_busy_job_done_idle_cb (gpointer user_data)
+{
+	FreeBusyJob *job = user_data;
+
+	/* The password prompt needs the main thread,
+	 * thus the authenticated download is done here. */
+	if (job->needs_authentication)
+		download_with_libsoup (job);
+	else
+		free_busy_job_finish (job);
+
+	return FALSE;
 }
 
 static void
-start_async_read (const gchar *uri,
-                  gpointer data)
+free_busy_job_run (gpointer data,
+                   gpointer user_data)
 {
-	EMeetingStoreQueueData *qdata = data;
-	GError *error = NULL;
-	GFile *file;
-	GInputStream *istream;
+	FreeBusyJob *job = data;
+	gboolean asked_client = FALSE;
+
+	if (job->client) {
+		GSList *users, *fb_comps = NULL;
+		GError *error = NULL;
+
+		users = g_slist_prepend (NULL, job->email);
+
+		asked_client = e_cal_client_get_free_busy_sync (
+			job->client, job->startt, job->endt,
+			users, &fb_comps, NULL, &error);
 
-	g_return_if_fail (uri != NULL);
-	g_return_if_fail (data != NULL);
+		g_slist_free (users);
 
-	qdata->store->priv->num_queries--;
-	file = g_file_new_for_uri (uri);
+		if (fb_comps != NULL) {
+			gchar *comp_str;
+
+			comp_str = e_cal_component_get_as_string (fb_comps->data);
+			job->fb_data = process_free_busy (comp_str);
+			g_free (comp_str);
 
-	g_return_if_fail (file != NULL);
+			e_cal_client_free_ecalcomp_slist (fb_comps);
+		}
 
-	istream = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+		g_clear_error (&error);
+	}
+
+	/* Look for fburl's of attendee with no free busy info on server */
+	if (job->fb_data == NULL && job->fb_uri != NULL) {
+		GFile *file;
+		gchar *contents = NULL;
+		GError *error = NULL;
+
+		file = g_file_new_for_uri (job->fb_uri);
+
+		if (g_file_load_contents (file, NULL, &contents, NULL, NULL, &error)) {
+			job->fb_data = process_free_busy (contents);
+			g_free (contents);
+		} else if (g_error_matches (error, SOUP_HTTP_ERROR, SOUP_STATUS_UNAUTHORIZED)) {
+			job->needs_authentication = TRUE;
+		} else {
+			g_warning (
+				"Unable to access free/busy url: %s",
+				error ? error->message : "Unknown error");
+		}
 
-	if (g_error_matches (error, SOUP_HTTP_ERROR, SOUP_STATUS_UNAUTHORIZED)) {
-		download_with_libsoup (uri, qdata);
+		g_clear_error (&error);
 		g_object_unref (file);
-		g_error_free (error);
+	} else if (job->fb_data == NULL && asked_client) {
+		/* The server answered there is nothing, remember it
+		 * the same way as a real result to not ask again. */
+		job->fb_data = free_busy_data_new ();
+	}
+
+	g_idle_add (free_busy_job_done_idle_cb, job);
+}
+
+static void
+free_busy_job_queue (const gchar *key,
+                     ECalClient *client,
+                     const gchar *email,
+                     const gchar *fb_uri,
+                     time_t startt,
+                     time_t endt,
+                     EMeetingStoreQueueData *qdata)
+{
+	FreeBusyJob *job;
+
+	/* The same lookup is already running, only wait for it */
+	job = g_hash_table_lookup (free_busy_jobs, key);
+	if (job) {
+		job->waiting = g_slist_prepend (job->waiting, qdata);
 		return;
 	}
 
-	if (error != NULL) {
-		g_warning (
-			"Unable to access free/busy url: %s",
-			error->message);
-		g_error_free (error);
-		process_callbacks (qdata);
-		g_object_unref (file);
+	job = g_slice_new0 (FreeBusyJob);
+	job->key = g_strdup (key);
+	job->client = client ? g_object_ref (client) : NULL;
+	job->email = g_strdup (email);
+	job->fb_uri = g_strdup (fb_uri);
+	job->startt = startt;
+	job->endt = endt;
+	job->waiting = g_slist_prepend (NULL, qdata);
+
+	g_hash_table_insert (free_busy_jobs, job->key, job);
+
+	g_thread_pool_push (free_busy_pool, job, NULL);
+}
+
+static void
+free_busy_service_init (void)
+{
+	if (free_busy_pool)
 		return;
+
+	free_busy_cache = g_hash_table_new_full (
+		g_str_hash, g_str_equal,
+		g_free, free_busy_data_free);
+	free_busy_jobs = g_hash_table_new (g_str_hash, g_str_equal);
+	free_busy_pool = g_thread_pool_new (
+		free_busy_job_run, NULL,
+		FREE_BUSY_MAX_THREADS, FALSE, NULL);
+}
+
+/*
+ * Replace all instances of from_value in string with to_value
+ * In the returned newly allocated string.
+*/
+static gchar *
+replace_string (gchar *string,
+                const gchar *from_value,
+                gchar *to_value)
+{
+	gchar *replaced;
+	gchar **split_uri;
+
+	split_uri = g_strsplit (string, from_value, 0);
+	replaced = g_strjoinv (to_value, split_uri);
+	g_strfreev (split_uri);
+
+	return replaced;
+}
+
+#define USER_SUB   "%u"
+#define DOMAIN_SUB "%d"
+
+/* Returns the URL to download free/busy information of the attendee
+ * from, when the calendar server does not provide any, or NULL. */
+static gchar *
+free_busy_get_uri (EMeetingStore *store,
+                   EMeetingAttendee *attendee,
+                   const gchar *email)
+{
+	const gchar *fburi;
+	gchar *default_fb_uri;
+	gchar *tmp_fb_uri;
+	gchar **split_email;
+
+	if (!e_meeting_attendee_is_set_address (attendee))
+		return NULL;
+
+	fburi = e_meeting_attendee_get_fburi (attendee);
+	if (fburi && *fburi)
+		return g_strdup (fburi);
+
+	if (!store->priv->fb_uri || !*store->priv->fb_uri)
+		return NULL;
+
+	split_email = g_strsplit (email, "@", 2);
+
+	tmp_fb_uri = replace_string (store->priv->fb_uri, USER_SUB, split_email[0]);
+	default_fb_uri = replace_string (tmp_fb_uri, DOMAIN_SUB, split_email[1] ? split_email[1] : (gchar *) "");
+
+	g_free (tmp_fb_uri);
+	g_strfreev (split_email);
+
+	return default_fb_uri;
+}
+
+#undef USER_SUB
+#undef DOMAIN_SUB
+
+static time_t
+meeting_time_to_timet (const EMeetingTime *mtime,
+                       icaltimezone *zone)
+{
+	struct icaltimetype itt;
+
+	itt = icaltime_null_time ();
+	itt.year = g_date_get_year (&mtime->date);
+	itt.month = g_date_get_month (&mtime->date);
+	itt.day = g_date_get_day (&mtime->date);
+	itt.hour = mtime->hour;
+	itt.minute = mtime->minute;
+
+	return icaltime_as_timet_with_zone (itt, zone);
+}
+
+static gboolean
+refresh_busy_periods (gpointer data)
+{
+	EMeetingStore *store = E_MEETING_STORE (data);
+	EMeetingStorePrivate *priv;
+	EMeetingAttendee *attendee = NULL;
+	EMeetingStoreQueueData *qdata = NULL;
+	FreeBusyData *fb_data;
+	const gchar *email;
+	gchar *fb_uri, *key;
+	time_t startt, endt;
+	gint i;
+
+	priv = store->priv;
+
+	/* Check to see if there are any remaining attendees in the queue */
+	for (i = 0; i < priv->refresh_queue->len; i++) {
+		attendee = g_ptr_array_index (priv->refresh_queue, i);
+		g_return_val_if_fail (attendee != NULL, FALSE);
+
+		qdata = g_hash_table_lookup (
+			priv->refresh_data, itip_strip_mailto (
+			e_meeting_attendee_get_address (attendee)));
+		if (!qdata)
+			continue;
+
+		if (!qdata->refreshing)
+			break;
+	}
+
+	/* The everything in the queue is being refreshed */
+	if (i >= priv->refresh_queue->len) {
+		priv->refresh_idle_id = 0;
+		return FALSE;
 	}
 
-	if (!istream) {
+	/* Indicate we are trying to refresh it */
+	qdata->refreshing = TRUE;
+
+	/* We take a ref in case we get destroyed in the gui during a callback */
+	g_object_ref (qdata->store);
+
+	email = itip_strip_mailto (e_meeting_attendee_get_address (attendee));
+	fb_uri = free_busy_get_uri (store, attendee, email);
+	startt = meeting_time_to_timet (&qdata->start, priv->zone);
+	endt = meeting_time_to_timet (&qdata->end, priv->zone);
+
+	key = g_strdup_printf (
+		"%s\n%s\n%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT,
+		priv->client ? e_source_get_uid (e_client_get_source (E_CLIENT (priv->client))) : "",
+		email, fb_uri ? fb_uri : "", (gint64) startt, (gint64) endt);
+
+	fb_data = free_busy_cache_lookup (key);
+	if (fb_data) {
+		free_busy_data_apply (fb_data, attendee, priv->zone);
 		process_callbacks (qdata);
-		g_object_unref (file);
 	} else {
-		g_input_stream_read_async (
-			istream, qdata->buffer, BUF_SIZE - 1,
-			G_PRIORITY_DEFAULT, NULL, async_read, qdata);
+		priv->num_queries++;
+
+		free_busy_job_queue (
+			key, priv->client, email, fb_uri,
+			startt, endt, qdata);
+	}
+
+	g_free (fb_uri);
+	g_free (key);
+
+	return TRUE;
+}
+
+static void
+refresh_queue_add (EMeetingStore *store,
+                   gint row,
+                   EMeetingTime *start,
+                   EMeetingTime *end,
+                   EMeetingStoreRefreshCallback call_back,
+                   gpointer data)
+{
+	EMeetingStorePrivate *priv;
+	EMeetingAttendee *attendee;
+	EMeetingStoreQueueData *qdata;
+	gint i;
+
+	priv = store->priv;
+
+	attendee = g_ptr_array_index (priv->attendees, row);
+	if ((attendee == NULL) || !strcmp (itip_strip_mailto (
+		e_meeting_attendee_get_address (attendee)), ""))
+		return;
+
+	/* check the queue if the attendee is already in there*/
+	for (i = 0; i < priv->refresh_queue->len; i++) {
+		if (attendee == g_ptr_array_index (priv->refresh_queue, i))
+			return;
+
+		if (!strcmp (e_meeting_attendee_get_address (attendee),
+			e_meeting_attendee_get_address (
+			g_ptr_array_index (priv->refresh_queue, i))))
+			return;
+	}
+
+	g_mutex_lock (&priv->mutex);
+	qdata = g_hash_table_lookup (
+		priv->refresh_data, itip_strip_mailto (
+		e_meeting_attendee_get_address (attendee)));
+
+	if (qdata == NULL) {
+		qdata = g_new0 (EMeetingStoreQueueData, 1);
+
+		qdata->store = store;
+		qdata->attendee = attendee;
+		e_meeting_attendee_clear_busy_periods (attendee);
+		e_meeting_attendee_set_has_calendar_info (attendee, FALSE);
+
+		qdata->start = *start;
+		qdata->end = *end;
+		qdata->call_backs = g_ptr_array_new ();
+		qdata->data = g_ptr_array_new ();
+		g_ptr_array_add (qdata->call_backs, call_back);
+		g_ptr_array_add (qdata->data, data);
+
+		g_hash_table_insert (
+			priv->refresh_data, g_strdup (itip_strip_mailto (
+			e_meeting_attendee_get_address (attendee))), qdata);
+	} else {
+		if (e_meeting_time_compare_times (start, &qdata->start) == -1)
+			qdata->start = *start;
+		if (e_meeting_time_compare_times (end, &qdata->end) == -1)
+			qdata->end = *end;
+		g_ptr_array_add (qdata->call_backs, call_back);
+		g_ptr_array_add (qdata->data, data);
 	}
+	g_mutex_unlock (&priv->mutex);
+
+	g_object_ref (attendee);
+	g_ptr_array_add (priv->refresh_queue, attendee);
+
+	if (priv->refresh_idle_id == 0)
+		priv->refresh_idle_id = g_idle_add (refresh_busy_periods, store);
 }
 
 void
@@ -55,8 +55,7 @@ e_week_view_layout_events (GArray *events,
                            gint *rows_per_day)
 {
 	EWeekViewEvent *event;
-	EWeekViewEventSpan *span;
-	gint num_days, day, event_num, span_num;
+	gint num_days, day, event_num;
 	guint8 *grid;
 	GArray *spans;
 
@@ -91,18 +90,8 @@ e_week_view_layout_events (GArray *events,
 	/* Free the grid. */
 	g_free (grid);
 
-	/* Destroy the old spans array, destroying any unused canvas items. */
-	if (old_spans) {
-		for (span_num = 0; span_num < old_spans->len; span_num++) {
-			span = &g_array_index (old_spans, EWeekViewEventSpan,
-					       span_num);
-			if (span->background_item)
-				g_object_run_dispose (G_OBJECT (span->background_item));
-			if (span->text_item)
-				g_object_run_dispose (G_OBJECT (span->text_item));
-		}
-		g_array_free (old_spans, TRUE);
-	}
+	/* The old spans array is left to the caller, with any canvas
+	 * items which were not reused, thus they can be recycled. */
 
 	return spans;
 }
@@ -193,6 +182,7 @@ e_week_view_layout_event (EWeekViewEvent *event,
 			span.start_day = span_start_day;
 			span.num_days = span_end_day - span_start_day + 1;
 			span.row = free_row;
+			span.needs_reshape = TRUE;
 			span.background_item = NULL;
 			span.text_item = NULL;
 			if (event->num_spans > span_num) {
@@ -201,6 +191,13 @@ e_week_view_layout_event (EWeekViewEvent *event,
 					event->spans_index + span_num);
 				span.background_item = old_span->background_item;
 				span.text_item = old_span->text_item;
+				span.needs_reshape =
+					old_span->needs_reshape ||
+					!span.background_item ||
+					!span.text_item ||
+					old_span->start_day != span.start_day ||
+					old_span->num_days != span.num_days ||
+					old_span->row != span.row;
 				old_span->background_item = NULL;
 				old_span->text_item = NULL;
 			}
@@ -30,6 +30,9 @@ G_BEGIN_DECLS
 /* I've split these functions away from EWeekView so we can use them for
  * printing. */
 
+/* Returns a new array of spans. The canvas items of the old_spans are moved
+ * to the new spans of the same events, the old_spans array itself is not
+ * freed, it is up to the caller to free it and any canvas items left in it. */
 GArray *	e_week_view_layout_events	(GArray *events,
 						 GArray *old_spans,
 						 gboolean multi_week_view,
@@ -99,8 +99,19 @@ struct _EWeekViewPrivate {
 	gulong notify_week_start_day_id;
 
 	gboolean show_icons_month_view;
+
+	/* Hidden canvas items of the spans which are not shown any more,
+	 * to be reused by new spans. */
+	GPtrArray *free_background_items;
+	GPtrArray *free_text_items;
+
+	/* Frame clock tick callback doing the queued layout. */
+	guint layout_tick_id;
 };
 
+/* The maximum number of unused canvas items of each kind kept around. */
+#define E_WEEK_VIEW_MAX_POOLED_ITEMS 256
+
 typedef struct {
 	EWeekView *week_view;
 	ECalModelComponent *comp_data;
@@ -143,7 +154,8 @@ static void e_week_view_add_event (ECalClient *client,
 				   gpointer data);
 static void e_week_view_check_layout (EWeekView *week_view);
 static void e_week_view_ensure_events_sorted (EWeekView *week_view);
-static void e_week_view_reshape_events (EWeekView *week_view);
+static void e_week_view_reshape_events (EWeekView *week_view,
+					gboolean reshape_all);
 static void e_week_view_reshape_event_span (EWeekView *week_view,
 					    gint event_num,
 					    gint span_num);
@@ -204,6 +216,79 @@ enum {
 static gint map_left[] = {0, 1, 2, 0, 1, 2, 2};
 static gint map_right[] = {3, 4, 5, 3, 4, 5, 6};
 
+/* Canvas items of spans which are not shown any more are hidden and kept
+ * in a pool, from which new spans take them, instead of destroying and
+ * creating the canvas items on each layout. */
+static void
+week_view_pool_item (GPtrArray *pool,
+                     GnomeCanvasItem *item)
+{
+	GnomeCanvas *canvas;
+
+	if (!item)
+		return;
+
+	canvas = item->canvas;
+
+	/* Items with a state, or the pool is full */
+	if (!pool || pool->len >= E_WEEK_VIEW_MAX_POOLED_ITEMS ||
+	    (E_IS_TEXT (item) && E_TEXT (item)->editing) ||
+	    (canvas && (canvas->focused_item == item ||
+	    canvas->grabbed_item == item || canvas->current_item == item))) {
+		g_object_run_dispose (G_OBJECT (item));
+		return;
+	}
+
+	gnome_canvas_item_hide (item);
+	g_ptr_array_add (pool, item);
+}
+
+static GnomeCanvasItem *
+week_view_take_pooled_item (GPtrArray *pool)
+{
+	GnomeCanvasItem *item;
+
+	if (!pool || !pool->len)
+		return NULL;
+
+	item = g_ptr_array_index (pool, pool->len - 1);
+	g_ptr_array_remove_index (pool, pool->len - 1);
+
+	/* The text item is taken after the background item,
+	 * thus this keeps it above the background. */
+	gnome_canvas_item_raise_to_top (item);
+	gnome_canvas_item_show (item);
+
+	return item;
+}
+
+static void
+week_view_recycle_span_items (EWeekView *week_view,
+                              EWeekViewEventSpan *span)
+{
+	week_view_pool_item (week_view->priv->free_background_items, span->background_item);
+	week_view_pool_item (week_view->priv->free_text_items, span->text_item);
+
+	span->background_item = NULL;
+	span->text_item = NULL;
+}
+
+static void
+week_view_free_pooled_items (GPtrArray **ppool)
+{
+	GPtrArray *pool = *ppool;
+	guint ii;
+
+	if (!pool)
+		return;
+
+	for (ii = 0; ii < pool->len; ii++)
+		g_object_run_dispose (g_ptr_array_index (pool, ii));
+
+	g_ptr_array_free (pool, TRUE);
+	*ppool = NULL;
+}
+
 static void
 week_view_process_component (EWeekView *week_view,
                              ECalModelComponent *comp_data)
@@ -855,6 +940,9 @@ week_view_dispose (GObject *object)
 		week_view->events = NULL;
 	}
 
+	week_view_free_pooled_items (&week_view->priv->free_background_items);
+	week_view_free_pooled_items (&week_view->priv->free_text_items);
+
 	if (week_view->small_font_desc) {
 		pango_font_description_free (week_view->small_font_desc);
 		week_view->small_font_desc = NULL;
@@ -1684,6 +1772,8 @@ e_week_view_init (EWeekView *week_view)
 	week_view->priv->show_event_end_times = TRUE;
 	week_view->priv->update_base_date = TRUE;
 	week_view->priv->display_start_day = G_DATE_MONDAY;
+	week_view->priv->free_background_items = g_ptr_array_new ();
+	week_view->priv->free_text_items = g_ptr_array_new ();
 
 	gtk_widget_set_can_focus (GTK_WIDGET (week_view), TRUE);
 
@@ -2681,14 +2771,7 @@ e_week_view_remove_event_cb (EWeekView *week_view,
 			span = &g_array_index (week_view->spans, EWeekViewEventSpan,
 					       event->spans_index + span_num);
 
-			if (span->text_item) {
-				g_object_run_dispose (G_OBJECT (span->text_item));
-				span->text_item = NULL;
-			}
-			if (span->background_item) {
-				g_object_run_dispose (G_OBJECT (span->background_item));
-				span->background_item = NULL;
-			}
+			week_view_recycle_span_items (week_view, span);
 		}
 
 		/* Update event_num numbers for already created spans with event_num higher than our event_num */
@@ -3176,16 +3259,13 @@ e_week_view_free_events (EWeekView *week_view)
 
 	g_array_set_size (week_view->events, 0);
 
-	/* Destroy all the old canvas items. */
+	/* Recycle all the old canvas items. */
 	if (week_view->spans) {
 		for (span_num = 0; span_num < week_view->spans->len;
 		     span_num++) {
 			span = &g_array_index (week_view->spans,
 					       EWeekViewEventSpan, span_num);
-			if (span->background_item)
-				g_object_run_dispose (G_OBJECT (span->background_item));
-			if (span->text_item)
-				g_object_run_dispose (G_OBJECT (span->text_item));
+			week_view_recycle_span_items (week_view, span);
 		}
 		g_array_free (week_view->spans, TRUE);
 		week_view->spans = NULL;
@@ -3298,10 +3378,12 @@ e_week_view_check_layout (EWeekView *week_view)
 	/* Make sure the events are sorted (by start and size). */
 	e_week_view_ensure_events_sorted (week_view);
 
-	if (week_view->events_need_layout)
+	if (week_view->events_need_layout) {
+		GArray *old_spans = week_view->spans;
+
 		week_view->spans = e_week_view_layout_events (
 			week_view->events,
-			week_view->spans,
+			old_spans,
 			e_week_view_get_multi_week_view (week_view),
 			e_week_view_get_weeks_shown (week_view),
 			e_week_view_get_compress_weekend (week_view),
@@ -3309,8 +3391,22 @@ e_week_view_check_layout (EWeekView *week_view)
 			week_view->day_starts,
 			week_view->rows_per_day);
 
+		/* Canvas items of the spans which are gone */
+		if (old_spans) {
+			guint span_num;
+
+			for (span_num = 0; span_num < old_spans->len; span_num++) {
+				week_view_recycle_span_items (
+					week_view, &g_array_index (old_spans,
+					EWeekViewEventSpan, span_num));
+			}
+
+			g_array_free (old_spans, TRUE);
+		}
+	}
+
 	if (week_view->events_need_layout || week_view->events_need_reshape)
-		e_week_view_reshape_events (week_view);
+		e_week_view_reshape_events (week_view, week_view->events_need_reshape);
 
 	week_view->events_need_layout = FALSE;
 	week_view->events_need_reshape = FALSE;
@@ -3351,8 +3447,38 @@ e_week_view_event_sort_func (gconstpointer arg1,
 	return 0;
 }
 
+/* Only the index of the event could change, the shape is the same */
 static void
-e_week_view_reshape_events (EWeekView *week_view)
+e_week_view_rebind_event_span (EWeekView *week_view,
+                               gint event_num,
+                               gint span_num)
+{
+	EWeekViewEvent *event;
+	EWeekViewEventSpan *span;
+
+	event = &g_array_index (week_view->events, EWeekViewEvent, event_num);
+	span = &g_array_index (week_view->spans, EWeekViewEventSpan, event->spans_index + span_num);
+
+	if (span->background_item) {
+		g_object_set_data (G_OBJECT (span->background_item), "event-num", GINT_TO_POINTER (event_num));
+
+		if (E_IS_WEEK_VIEW_EVENT_ITEM (span->background_item)) {
+			EWeekViewEventItem *wveitem = E_WEEK_VIEW_EVENT_ITEM (span->background_item);
+
+			e_week_view_event_item_set_event_num (wveitem, event_num);
+			e_week_view_event_item_set_span_num (wveitem, span_num);
+		}
+	}
+
+	if (span->text_item)
+		g_object_set_data (G_OBJECT (span->text_item), "event-num", GINT_TO_POINTER (event_num));
+}
+
+/* With reshape_all set reshapes all spans, like after a size change,
+ * otherwise only the spans the layout marked as new or moved. */
+static void
+e_week_view_reshape_events (EWeekView *week_view,
+                            gboolean reshape_all)
 {
 	EWeekViewEvent *event;
 	GDateWeekday display_start_day;
@@ -3367,22 +3493,27 @@ e_week_view_reshape_events (EWeekView *week_view)
 			continue;
 
 		for (span_num = 0; span_num < event->num_spans; span_num++) {
+			EWeekViewEventSpan *span;
 			gchar *current_comp_string;
 
-			e_week_view_reshape_event_span (
-				week_view, event_num, span_num);
+			if (!is_array_index_in_bounds (week_view->spans, event->spans_index + span_num))
+				break;
+
+			span = &g_array_index (week_view->spans, EWeekViewEventSpan, event->spans_index + span_num);
+
+			if (reshape_all || span->needs_reshape) {
+				e_week_view_reshape_event_span (
+					week_view, event_num, span_num);
+				span->needs_reshape = FALSE;
+			} else {
+				e_week_view_rebind_event_span (
+					week_view, event_num, span_num);
+			}
+
 			if (week_view->last_edited_comp_string == NULL)
 				continue;
 			current_comp_string = icalcomponent_as_ical_string_r (event->comp_data->icalcomp);
 			if (strncmp (current_comp_string, week_view->last_edited_comp_string,50) == 0) {
-				EWeekViewEventSpan *span;
-
-				if (!is_array_index_in_bounds (week_view->spans, event->spans_index + span_num)) {
-					g_free (current_comp_string);
-					continue;
-				}
-
-				span = &g_array_index (week_view->spans, EWeekViewEventSpan, event->spans_index + span_num);
 				e_canvas_item_grab_focus (span->text_item, TRUE);
 				g_free (week_view->last_edited_comp_string);
 				week_view->last_edited_comp_string = NULL;
@@ -3633,26 +3764,20 @@ e_week_view_reshape_event_span (EWeekView *week_view,
 
 	span = &g_array_index (week_view->spans, EWeekViewEventSpan,
 			       event->spans_index + span_num);
-	comp = e_cal_component_new ();
-	e_cal_component_set_icalcomponent (comp, icalcomponent_new_clone (event->comp_data->icalcomp));
-
-	one_day_event = e_week_view_is_one_day_event (week_view, event_num);
 
-	/* If the span will not be visible destroy the canvas items and
+	/* If the span will not be visible recycle the canvas items and
 	 * return. */
 	if (!e_week_view_get_span_position (week_view, event_num, span_num,
 					    &span_x, &span_y, &span_w)) {
-		if (span->background_item)
-			g_object_run_dispose (G_OBJECT (span->background_item));
-		if (span->text_item)
-			g_object_run_dispose (G_OBJECT (span->text_item));
-		span->background_item = NULL;
-		span->text_item = NULL;
-
-		g_object_unref (comp);
+		week_view_recycle_span_items (week_view, span);
 		return;
 	}
 
+	comp = e_cal_component_new ();
+	e_cal_component_set_icalcomponent (comp, icalcomponent_new_clone (event->comp_data->icalcomp));
+
+	one_day_event = e_week_view_is_one_day_event (week_view, event_num);
+
 	/* Set up Pango prerequisites */
 	pango_context = gtk_widget_get_pango_context (GTK_WIDGET (week_view));
 	font_metrics = pango_context_get_metrics (
@@ -3687,18 +3812,22 @@ e_week_view_reshape_event_span (EWeekView *week_view,
 	}
 
 	/* Create the background canvas item if necessary. */
+	if (!span->background_item)
+		span->background_item = week_view_take_pooled_item (week_view->priv->free_background_items);
+
 	if (!span->background_item) {
 		span->background_item =
 			gnome_canvas_item_new (
 				GNOME_CANVAS_GROUP (GNOME_CANVAS (week_view->main_canvas)->root),
 				e_week_view_event_item_get_type (),
 				NULL);
+
+		g_signal_connect (
+			span->background_item, "event",
+			G_CALLBACK (tooltip_event_cb), week_view);
 	}
 
 	g_object_set_data ((GObject *) span->background_item, "event-num", GINT_TO_POINTER (event_num));
-	g_signal_connect (
-		span->background_item, "event",
-		G_CALLBACK (tooltip_event_cb), week_view);
 
 	gnome_canvas_item_set (
 		span->background_item,
@@ -3715,18 +3844,35 @@ e_week_view_reshape_event_span (EWeekView *week_view,
 		color = e_week_view_get_text_color (week_view, event);
 		summary = get_comp_summary (event->comp_data->client, event->comp_data->icalcomp, &free_text);
 
-		span->text_item =
-			gnome_canvas_item_new (
-				GNOME_CANVAS_GROUP (GNOME_CANVAS (week_view->main_canvas)->root),
-				e_text_get_type (),
-				"clip", TRUE,
-				"max_lines", 1,
-				"editable", TRUE,
+		span->text_item = week_view_take_pooled_item (week_view->priv->free_text_items);
+
+		if (span->text_item) {
+			gnome_canvas_item_set (
+				span->text_item,
 				"text", summary ? summary : "",
-				"use_ellipsis", TRUE,
 				"fill_color_gdk", &color,
-				"im_context", E_CANVAS (week_view->main_canvas)->im_context,
+				"bold", FALSE,
+				"italic", FALSE,
+				"strikeout", FALSE,
 				NULL);
+		} else {
+			span->text_item =
+				gnome_canvas_item_new (
+					GNOME_CANVAS_GROUP (GNOME_CANVAS (week_view->main_canvas)->root),
+					e_text_get_type (),
+					"clip", TRUE,
+					"max_lines", 1,
+					"editable", TRUE,
+					"text", summary ? summary : "",
+					"use_ellipsis", TRUE,
+					"fill_color_gdk", &color,
+					"im_context", E_CANVAS (week_view->main_canvas)->im_context,
+					NULL);
+
+			g_signal_connect (
+				span->text_item, "event",
+				G_CALLBACK (e_week_view_on_text_item_event), week_view);
+		}
 
 		if (free_text)
 			g_free ((gchar *) summary);
@@ -3734,9 +3880,6 @@ e_week_view_reshape_event_span (EWeekView *week_view,
 		if (e_cal_util_component_has_attendee (event->comp_data->icalcomp))
 			set_style_from_attendee (event, span, registry);
 
-		g_signal_connect (
-			span->text_item, "event",
-			G_CALLBACK (e_week_view_on_text_item_event), week_view);
 		g_signal_emit_by_name (
 			G_OBJECT (week_view),
 			"event_added", event);
@@ -5150,17 +5293,51 @@ e_week_view_cancel_layout (EWeekView *week_view)
 		g_source_remove (week_view->layout_timeout_id);
 		week_view->layout_timeout_id = 0;
 	}
+
+	if (week_view->priv->layout_tick_id != 0) {
+		gtk_widget_remove_tick_callback (
+			week_view->main_canvas,
+			week_view->priv->layout_tick_id);
+		week_view->priv->layout_tick_id = 0;
+	}
 }
 
 static gboolean
-e_week_view_layout_timeout_cb (gpointer data)
+e_week_view_layout_tick_cb (GtkWidget *widget,
+                            GdkFrameClock *frame_clock,
+                            gpointer user_data)
 {
-	EWeekView *week_view = E_WEEK_VIEW (data);
+	EWeekView *week_view = E_WEEK_VIEW (user_data);
+
+	week_view->priv->layout_tick_id = 0;
 
 	gtk_widget_queue_draw (week_view->main_canvas);
 	e_week_view_check_layout (week_view);
 
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+e_week_view_layout_timeout_cb (gpointer data)
+{
+	EWeekView *week_view = E_WEEK_VIEW (data);
+
 	week_view->layout_timeout_id = 0;
+
+	/* Do the layout at the start of the next frame, thus all
+	 * the canvas item changes are painted together. */
+	if (gtk_widget_get_mapped (week_view->main_canvas)) {
+		if (!week_view->priv->layout_tick_id) {
+			week_view->priv->layout_tick_id = gtk_widget_add_tick_callback (
+				week_view->main_canvas,
+				e_week_view_layout_tick_cb,
+				week_view, NULL);
+		}
+	} else {
+		gtk_widget_queue_draw (week_view->main_canvas);
+		e_week_view_check_layout (week_view);
+	}
+
 	return FALSE;
 }
 
@@ -149,6 +149,9 @@ struct _EWeekViewEventSpan {
 	guint start_day : 6;
 	guint num_days : 3;
 	guint row : 7;
+	/* Set by the layout when the span is new or it moved,
+	 * unchanged spans keep their canvas items as they are. */
+	guint needs_reshape : 1;
 	GnomeCanvasItem *background_item;
 	GnomeCanvasItem *text_item;
 };
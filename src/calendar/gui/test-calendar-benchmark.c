@@ -0,0 +1,726 @@
+/*
+ * test-calendar-benchmark.c
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* A headless benchmark of the calendar view code paths. It generates
+ * synthetic data (dense recurring series, multi-day all-day spans and
+ * thousands of overlapping meetings) and measures the recurrence
+ * expansion and the Day/Week view layout functions, reporting the time
+ * per iteration; run it under heaptrack or valgrind --tool=massif to see
+ * the allocations of each code path. With --source it
+ * also measures how long an ECalDataModel subscription over the given
+ * calendar takes to complete; --populate fills that calendar with the
+ * synthetic components first, thus use a scratch calendar for it. */
+
+#include "evolution-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <libecal/libecal.h>
+
+#include "e-cal-data-model.h"
+#include "e-cal-data-model-subscriber.h"
+#include "e-day-view.h"
+#include "e-day-view-layout.h"
+#include "e-week-view.h"
+#include "e-week-view-layout.h"
+
+#define SECONDS_PER_DAY (24 * 60 * 60)
+
+static gint opt_events = 2000;
+static gint opt_series = 200;
+static gint opt_iterations = 10;
+static gint opt_seed = 1;
+static gchar *opt_source_uid = NULL;
+static gboolean opt_populate = FALSE;
+
+static GOptionEntry entries[] = {
+	{ "events", 'e', 0, G_OPTION_ARG_INT, &opt_events,
+	  "Number of synthetic meetings and all-day events", "N" },
+	{ "series", 'r', 0, G_OPTION_ARG_INT, &opt_series,
+	  "Number of synthetic recurring series", "N" },
+	{ "iterations", 'i', 0, G_OPTION_ARG_INT, &opt_iterations,
+	  "How many times to repeat each benchmark", "N" },
+	{ "seed", 0, 0, G_OPTION_ARG_INT, &opt_seed,
+	  "Seed of the random generator", "N" },
+	{ "source", 's', 0, G_OPTION_ARG_STRING, &opt_source_uid,
+	  "UID of a calendar to measure ECalDataModel with", "UID" },
+	{ "populate", 'p', 0, G_OPTION_ARG_NONE, &opt_populate,
+	  "Store the synthetic components into the --source calendar first", NULL },
+	{ NULL }
+};
+
+typedef struct _BenchTimer {
+	gint64 started;
+} BenchTimer;
+
+static void
+bench_timer_start (BenchTimer *timer)
+{
+	timer->started = g_get_monotonic_time ();
+}
+
+static void
+bench_timer_report (BenchTimer *timer,
+                    const gchar *name,
+                    gint iterations,
+                    const gchar *details)
+{
+	gint64 elapsed;
+
+	elapsed = g_get_monotonic_time () - timer->started;
+
+	if (iterations <= 0)
+		iterations = 1;
+
+	g_print ("%-26s %10.3f ms/iter   %s\n",
+		name,
+		elapsed / 1000.0 / iterations,
+		details ? details : "");
+}
+
+/* Midnight UTC of 2017-01-02, a Monday */
+static time_t
+bench_get_base_time (void)
+{
+	return 1483315200;
+}
+
+static gchar *
+bench_time_to_string (time_t tt)
+{
+	struct icaltimetype itt;
+
+	itt = icaltime_from_timet_with_zone (tt, FALSE, icaltimezone_get_utc_timezone ());
+
+	return g_strdup (icaltime_as_ical_string (itt));
+}
+
+static icalcomponent *
+bench_new_event (const gchar *uid,
+                 time_t dtstart,
+                 time_t dtend,
+                 const gchar *rrule,
+                 const gchar *summary)
+{
+	icalcomponent *icalcomp;
+	gchar *start, *end, *str;
+
+	start = bench_time_to_string (dtstart);
+	end = bench_time_to_string (dtend);
+
+	str = g_strdup_printf (
+		"BEGIN:VEVENT\r\n"
+		"UID:%s\r\n"
+		"DTSTAMP:20170101T000000Z\r\n"
+		"DTSTART:%s\r\n"
+		"DTEND:%s\r\n"
+		"%s%s%s"
+		"SUMMARY:%s\r\n"
+		"END:VEVENT\r\n",
+		uid, start, end,
+		rrule ? "RRULE:" : "", rrule ? rrule : "", rrule ? "\r\n" : "",
+		summary);
+
+	icalcomp = icalcomponent_new_from_string (str);
+
+	g_free (start);
+	g_free (end);
+	g_free (str);
+
+	return icalcomp;
+}
+
+/* Returns a list of icalcomponent-s; the recurring series first,
+ * then the meetings of the first day and then the all-day spans. */
+static GSList *
+bench_generate_components (GRand *rand,
+                           gint n_series,
+                           gint n_events)
+{
+	const gchar *rrules[] = {
+		"FREQ=DAILY",
+		"FREQ=WEEKLY;BYDAY=MO,TU,WE,TH,FR",
+		"FREQ=HOURLY;INTERVAL=4",
+		"FREQ=MONTHLY;BYMONTHDAY=1,15",
+		"FREQ=DAILY;INTERVAL=2;COUNT=100"
+	};
+	GSList *icalcomps = NULL;
+	time_t base = bench_get_base_time ();
+	gint ii;
+
+	for (ii = 0; ii < n_series; ii++) {
+		gchar *uid, *summary;
+		time_t start;
+
+		uid = g_strdup_printf ("bench-series-%d", ii);
+		summary = g_strdup_printf ("Recurring %d", ii);
+		start = base + g_rand_int_range (rand, 0, 7 * 24 * 4) * 15 * 60;
+
+		icalcomps = g_slist_prepend (icalcomps, bench_new_event (uid,
+			start, start + g_rand_int_range (rand, 1, 8) * 15 * 60,
+			rrules[ii % G_N_ELEMENTS (rrules)], summary));
+
+		g_free (summary);
+		g_free (uid);
+	}
+
+	for (ii = 0; ii < n_events; ii++) {
+		gchar *uid, *summary;
+		time_t start, end;
+
+		uid = g_strdup_printf ("bench-event-%d", ii);
+		summary = g_strdup_printf ("Event %d", ii);
+
+		/* Every fifth event is an all-day span over the six weeks,
+		 * the rest are short meetings overlapping on the first day. */
+		if ((ii % 5) == 4) {
+			start = base + g_rand_int_range (rand, -3, 42) * SECONDS_PER_DAY;
+			end = start + g_rand_int_range (rand, 1, 10) * SECONDS_PER_DAY;
+		} else {
+			start = base + g_rand_int_range (rand, 0, 24 * 12 - 3) * 5 * 60;
+			end = MIN (start + g_rand_int_range (rand, 3, 48) * 5 * 60, base + SECONDS_PER_DAY);
+		}
+
+		icalcomps = g_slist_prepend (icalcomps, bench_new_event (uid, start, end, NULL, summary));
+
+		g_free (summary);
+		g_free (uid);
+	}
+
+	return g_slist_reverse (icalcomps);
+}
+
+static icaltimezone *
+bench_resolve_tzid_cb (const gchar *tzid,
+                       gpointer user_data)
+{
+	icaltimezone *zone;
+
+	zone = tzid ? icaltimezone_get_builtin_timezone_from_tzid (tzid) : NULL;
+
+	return zone ? zone : icaltimezone_get_utc_timezone ();
+}
+
+static gboolean
+bench_count_instance_cb (ECalComponent *comp,
+                         time_t instance_start,
+                         time_t instance_end,
+                         gpointer user_data)
+{
+	gint *n_instances = user_data;
+
+	(*n_instances)++;
+
+	return TRUE;
+}
+
+static void
+bench_recurrences (GSList *icalcomps,
+                   gint iterations)
+{
+	GSList *comps = NULL, *link;
+	BenchTimer timer;
+	time_t range_start, range_end;
+	gint ii, n_instances = 0;
+	gchar *details;
+
+	for (link = icalcomps; link; link = g_slist_next (link)) {
+		icalcomponent *icalcomp = link->data;
+
+		if (!e_cal_util_component_has_recurrences (icalcomp))
+			continue;
+
+		comps = g_slist_prepend (comps,
+			e_cal_component_new_from_icalcomponent (icalcomponent_new_clone (icalcomp)));
+	}
+
+	range_start = bench_get_base_time ();
+	range_end = range_start + 365 * SECONDS_PER_DAY;
+
+	bench_timer_start (&timer);
+
+	for (ii = 0; ii < iterations; ii++) {
+		n_instances = 0;
+
+		for (link = comps; link; link = g_slist_next (link)) {
+			e_cal_recur_generate_instances (
+				link->data, range_start, range_end,
+				bench_count_instance_cb, &n_instances,
+				bench_resolve_tzid_cb, NULL,
+				icaltimezone_get_utc_timezone ());
+		}
+	}
+
+	details = g_strdup_printf ("%d series, %d instances in a year", g_slist_length (comps), n_instances);
+	bench_timer_report (&timer, "recurrence expansion", iterations, details);
+	g_free (details);
+
+	g_slist_free_full (comps, g_object_unref);
+}
+
+static void
+bench_get_times (icalcomponent *icalcomp,
+                 time_t *start,
+                 time_t *end)
+{
+	icaltimezone *utc = icaltimezone_get_utc_timezone ();
+
+	*start = icaltime_as_timet_with_zone (icalcomponent_get_dtstart (icalcomp), utc);
+	*end = icaltime_as_timet_with_zone (icalcomponent_get_dtend (icalcomp), utc);
+}
+
+static void
+bench_day_view_layout (GSList *icalcomps,
+                       gint iterations)
+{
+	GArray *events, *long_events;
+	GSList *link;
+	BenchTimer timer;
+	time_t day_starts[E_DAY_VIEW_MAX_DAYS + 1];
+	guint8 cols_per_row[24 * 60 / 5];
+	gint ii, day, rows, mins_per_row, cols = 0, rows_in_top_display = 0;
+	gchar *details;
+
+	events = g_array_new (FALSE, TRUE, sizeof (EDayViewEvent));
+	long_events = g_array_new (FALSE, TRUE, sizeof (EDayViewEvent));
+
+	for (day = 0; day <= E_DAY_VIEW_MAX_DAYS; day++)
+		day_starts[day] = bench_get_base_time () + day * SECONDS_PER_DAY;
+
+	for (link = icalcomps; link; link = g_slist_next (link)) {
+		EDayViewEvent event;
+
+		if (e_cal_util_component_has_recurrences (link->data))
+			continue;
+
+		memset (&event, 0, sizeof (EDayViewEvent));
+		bench_get_times (link->data, &event.start, &event.end);
+
+		if (event.end - event.start >= SECONDS_PER_DAY) {
+			g_array_append_val (long_events, event);
+		} else {
+			event.start_minute = (event.start - day_starts[0]) / 60;
+			event.end_minute = (event.end - day_starts[0]) / 60;
+			g_array_append_val (events, event);
+		}
+	}
+
+	qsort (events->data, events->len, sizeof (EDayViewEvent), e_day_view_event_sort_func);
+	qsort (long_events->data, long_events->len, sizeof (EDayViewEvent), e_day_view_event_sort_func);
+
+	for (mins_per_row = 30; mins_per_row >= 5; mins_per_row -= 25) {
+		rows = 24 * 60 / mins_per_row;
+
+		/* The single day view does not limit the number of columns */
+		bench_timer_start (&timer);
+
+		for (ii = 0; ii < iterations; ii++) {
+			cols = e_day_view_layout_day_events (events, rows, mins_per_row, cols_per_row, -1);
+		}
+
+		details = g_strdup_printf ("%d meetings, %d rows, %d columns", events->len, rows, cols);
+		bench_timer_report (&timer, "day view layout", iterations, details);
+		g_free (details);
+
+		bench_timer_start (&timer);
+
+		for (ii = 0; ii < iterations; ii++) {
+			cols = e_day_view_layout_day_events (events, rows, mins_per_row, cols_per_row,
+				E_DAY_VIEW_MULTI_DAY_MAX_COLUMNS);
+		}
+
+		details = g_strdup_printf ("%d meetings, %d rows, %d columns", events->len, rows, cols);
+		bench_timer_report (&timer, "work week view layout", iterations, details);
+		g_free (details);
+	}
+
+	bench_timer_start (&timer);
+
+	for (ii = 0; ii < iterations; ii++) {
+		e_day_view_layout_long_events (long_events, 7, day_starts, &rows_in_top_display);
+	}
+
+	details = g_strdup_printf ("%d all-day spans, %d top rows", long_events->len, rows_in_top_display);
+	bench_timer_report (&timer, "day view long events", iterations, details);
+	g_free (details);
+
+	g_array_free (long_events, TRUE);
+	g_array_free (events, TRUE);
+}
+
+static void
+bench_week_view_layout (GSList *icalcomps,
+                        gint iterations)
+{
+	GArray *events, *spans = NULL;
+	GSList *link;
+	BenchTimer timer;
+	time_t day_starts[E_WEEK_VIEW_MAX_WEEKS * 7 + 1];
+	gint rows_per_day[E_WEEK_VIEW_MAX_WEEKS * 7];
+	gint ii, day;
+	gchar *details;
+
+	events = g_array_new (FALSE, TRUE, sizeof (EWeekViewEvent));
+
+	for (day = 0; day <= E_WEEK_VIEW_MAX_WEEKS * 7; day++)
+		day_starts[day] = bench_get_base_time () + day * SECONDS_PER_DAY;
+
+	for (link = icalcomps; link; link = g_slist_next (link)) {
+		EWeekViewEvent event;
+
+		if (e_cal_util_component_has_recurrences (link->data))
+			continue;
+
+		memset (&event, 0, sizeof (EWeekViewEvent));
+		bench_get_times (link->data, &event.start, &event.end);
+
+		g_array_append_val (events, event);
+	}
+
+	qsort (events->data, events->len, sizeof (EWeekViewEvent), e_week_view_event_sort_func);
+
+	bench_timer_start (&timer);
+
+	for (ii = 0; ii < iterations; ii++) {
+		spans = e_week_view_layout_events (
+			events, NULL, TRUE, E_WEEK_VIEW_MAX_WEEKS, FALSE,
+			G_DATE_MONDAY, day_starts, rows_per_day);
+
+		if (ii + 1 < iterations)
+			g_array_free (spans, TRUE);
+	}
+
+	details = g_strdup_printf ("%d events, %d spans", events->len, spans ? spans->len : 0);
+	bench_timer_report (&timer, "month view layout", iterations, details);
+	g_free (details);
+
+	/* A relayout of unchanged events, as done after each change in the view */
+	bench_timer_start (&timer);
+
+	for (ii = 0; ii < iterations; ii++) {
+		GArray *new_spans;
+
+		new_spans = e_week_view_layout_events (
+			events, spans, TRUE, E_WEEK_VIEW_MAX_WEEKS, FALSE,
+			G_DATE_MONDAY, day_starts, rows_per_day);
+
+		g_array_free (spans, TRUE);
+		spans = new_spans;
+	}
+
+	details = g_strdup_printf ("%d events, %d spans", events->len, spans ? spans->len : 0);
+	bench_timer_report (&timer, "month view relayout", iterations, details);
+	g_free (details);
+
+	if (spans)
+		g_array_free (spans, TRUE);
+	g_array_free (events, TRUE);
+}
+
+/* ECalDataModel part, which requires a running evolution-data-server */
+
+typedef struct _BenchSubscriber {
+	GObject parent;
+
+	gint n_added;
+	gint n_modified;
+	gint n_removed;
+} BenchSubscriber;
+
+typedef struct _BenchSubscriberClass {
+	GObjectClass parent_class;
+} BenchSubscriberClass;
+
+static GType bench_subscriber_get_type (void);
+static void bench_subscriber_interface_init (ECalDataModelSubscriberInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (BenchSubscriber, bench_subscriber, G_TYPE_OBJECT,
+	G_IMPLEMENT_INTERFACE (E_TYPE_CAL_DATA_MODEL_SUBSCRIBER, bench_subscriber_interface_init))
+
+static void
+bench_subscriber_component_added (ECalDataModelSubscriber *subscriber,
+                                  ECalClient *client,
+                                  ECalComponent *comp)
+{
+	((BenchSubscriber *) subscriber)->n_added++;
+}
+
+static void
+bench_subscriber_component_modified (ECalDataModelSubscriber *subscriber,
+                                     ECalClient *client,
+                                     ECalComponent *comp)
+{
+	((BenchSubscriber *) subscriber)->n_modified++;
+}
+
+static void
+bench_subscriber_component_removed (ECalDataModelSubscriber *subscriber,
+                                    ECalClient *client,
+                                    const gchar *uid,
+                                    const gchar *rid)
+{
+	((BenchSubscriber *) subscriber)->n_removed++;
+}
+
+static void
+bench_subscriber_freeze (ECalDataModelSubscriber *subscriber)
+{
+}
+
+static void
+bench_subscriber_thaw (ECalDataModelSubscriber *subscriber)
+{
+}
+
+static void
+bench_subscriber_class_init (BenchSubscriberClass *class)
+{
+}
+
+static void
+bench_subscriber_interface_init (ECalDataModelSubscriberInterface *iface)
+{
+	iface->component_added = bench_subscriber_component_added;
+	iface->component_modified = bench_subscriber_component_modified;
+	iface->component_removed = bench_subscriber_component_removed;
+	iface->freeze = bench_subscriber_freeze;
+	iface->thaw = bench_subscriber_thaw;
+}
+
+static void
+bench_subscriber_init (BenchSubscriber *subscriber)
+{
+}
+
+typedef struct _BenchThreadJob {
+	EAlertSinkThreadJobFunc func;
+	gpointer user_data;
+	GDestroyNotify free_user_data;
+	GCancellable *cancellable;
+} BenchThreadJob;
+
+static gpointer
+bench_thread_job_thread (gpointer user_data)
+{
+	BenchThreadJob *job = user_data;
+	GError *local_error = NULL;
+
+	job->func (NULL, job->user_data, job->cancellable, &local_error);
+
+	if (local_error) {
+		g_printerr ("Thread job failed: %s\n", local_error->message);
+		g_clear_error (&local_error);
+	}
+
+	if (job->free_user_data)
+		job->free_user_data (job->user_data);
+
+	g_object_unref (job->cancellable);
+	g_free (job);
+
+	return NULL;
+}
+
+static GCancellable *
+bench_submit_thread_job (GObject *responder,
+                         const gchar *description,
+                         const gchar *alert_ident,
+                         const gchar *alert_arg_0,
+                         EAlertSinkThreadJobFunc func,
+                         gpointer user_data,
+                         GDestroyNotify free_user_data)
+{
+	BenchThreadJob *job;
+	GThread *thread;
+
+	job = g_new0 (BenchThreadJob, 1);
+	job->func = func;
+	job->user_data = user_data;
+	job->free_user_data = free_user_data;
+	job->cancellable = g_cancellable_new ();
+
+	thread = g_thread_new (NULL, bench_thread_job_thread, job);
+	g_thread_unref (thread);
+
+	return g_object_ref (job->cancellable);
+}
+
+static void
+bench_view_state_changed_cb (ECalDataModel *data_model,
+                             ECalClientView *view,
+                             ECalDataModelViewState state,
+                             guint percent,
+                             const gchar *message,
+                             const GError *error,
+                             GMainLoop *main_loop)
+{
+	if (error)
+		g_printerr ("View failed: %s\n", error->message);
+
+	if (state == E_CAL_DATA_MODEL_VIEW_STATE_COMPLETE ||
+	    state == E_CAL_DATA_MODEL_VIEW_STATE_STOP)
+		g_main_loop_quit (main_loop);
+}
+
+static gboolean
+bench_timeout_cb (gpointer user_data)
+{
+	GMainLoop *main_loop = user_data;
+
+	g_printerr ("Timed out waiting for the view to complete\n");
+	g_main_loop_quit (main_loop);
+
+	return FALSE;
+}
+
+static gboolean
+bench_data_model (GSList *icalcomps,
+                  const gchar *source_uid,
+                  gboolean populate)
+{
+	ESourceRegistry *registry;
+	ESource *source;
+	EClient *client;
+	ECalDataModel *data_model;
+	BenchSubscriber *subscriber;
+	GMainLoop *main_loop;
+	BenchTimer timer;
+	time_t range_start;
+	gulong handler_id;
+	guint timeout_id;
+	gchar *details;
+	GError *local_error = NULL;
+
+	registry = e_source_registry_new_sync (NULL, &local_error);
+	if (!registry) {
+		g_printerr ("Failed to create source registry: %s\n", local_error ? local_error->message : "Unknown error");
+		g_clear_error (&local_error);
+		return FALSE;
+	}
+
+	source = e_source_registry_ref_source (registry, source_uid);
+	if (!source) {
+		g_printerr ("Calendar '%s' not found\n", source_uid);
+		g_object_unref (registry);
+		return FALSE;
+	}
+
+	client = e_cal_client_connect_sync (source, E_CAL_CLIENT_SOURCE_TYPE_EVENTS, 30, NULL, &local_error);
+	if (!client) {
+		g_printerr ("Failed to open '%s': %s\n", source_uid, local_error ? local_error->message : "Unknown error");
+		g_clear_error (&local_error);
+		g_object_unref (source);
+		g_object_unref (registry);
+		return FALSE;
+	}
+
+	if (populate) {
+		bench_timer_start (&timer);
+
+		if (!e_cal_client_create_objects_sync (E_CAL_CLIENT (client), icalcomps, NULL, NULL, &local_error)) {
+			g_printerr ("Failed to populate '%s': %s\n", source_uid, local_error ? local_error->message : "Unknown error");
+			g_clear_error (&local_error);
+		} else {
+			details = g_strdup_printf ("%d components", g_slist_length (icalcomps));
+			bench_timer_report (&timer, "calendar populate", 1, details);
+			g_free (details);
+		}
+	}
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+	subscriber = g_object_new (bench_subscriber_get_type (), NULL);
+
+	data_model = e_cal_data_model_new (bench_submit_thread_job, NULL);
+	e_cal_data_model_set_expand_recurrences (data_model, TRUE);
+	e_cal_data_model_set_timezone (data_model, icaltimezone_get_utc_timezone ());
+
+	handler_id = g_signal_connect (data_model, "view-state-changed",
+		G_CALLBACK (bench_view_state_changed_cb), main_loop);
+
+	range_start = bench_get_base_time ();
+
+	bench_timer_start (&timer);
+
+	e_cal_data_model_subscribe (data_model, E_CAL_DATA_MODEL_SUBSCRIBER (subscriber),
+		range_start, range_start + E_WEEK_VIEW_MAX_WEEKS * 7 * SECONDS_PER_DAY);
+	e_cal_data_model_add_client (data_model, E_CAL_CLIENT (client));
+
+	timeout_id = e_named_timeout_add_seconds (300, bench_timeout_cb, main_loop);
+	g_main_loop_run (main_loop);
+	g_source_remove (timeout_id);
+
+	details = g_strdup_printf ("%d added, %d modified, %d removed",
+		subscriber->n_added, subscriber->n_modified, subscriber->n_removed);
+	bench_timer_report (&timer, "data model subscription", 1, details);
+	g_free (details);
+
+	g_signal_handler_disconnect (data_model, handler_id);
+	e_cal_data_model_unsubscribe (data_model, E_CAL_DATA_MODEL_SUBSCRIBER (subscriber));
+	e_cal_data_model_remove_client (data_model, source_uid);
+
+	g_object_unref (data_model);
+	g_object_unref (subscriber);
+	g_main_loop_unref (main_loop);
+	g_object_unref (client);
+	g_object_unref (source);
+	g_object_unref (registry);
+
+	return TRUE;
+}
+
+gint
+main (gint argc,
+      gchar **argv)
+{
+	GOptionContext *context;
+	GSList *icalcomps;
+	GRand *rand;
+	gboolean success = TRUE;
+	GError *local_error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Measures the calendar views with synthetic data.");
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &local_error)) {
+		g_printerr ("%s\n", local_error->message);
+		g_clear_error (&local_error);
+		g_option_context_free (context);
+		exit (EXIT_FAILURE);
+	}
+
+	g_option_context_free (context);
+
+	if (opt_iterations <= 0)
+		opt_iterations = 1;
+
+	rand = g_rand_new_with_seed (opt_seed);
+	icalcomps = bench_generate_components (rand, MAX (opt_series, 0), MAX (opt_events, 0));
+	g_rand_free (rand);
+
+	bench_recurrences (icalcomps, opt_iterations);
+	bench_day_view_layout (icalcomps, opt_iterations);
+	bench_week_view_layout (icalcomps, opt_iterations);
+
+	if (opt_source_uid)
+		success = bench_data_model (icalcomps, opt_source_uid, opt_populate);
+
+	g_slist_free_full (icalcomps, (GDestroyNotify) icalcomponent_free);
+	g_free (opt_source_uid);
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -54,6 +54,7 @@ typedef struct {
 	ECalClientSourceType source_type;
 
 	icalcomponent *icalcomp;
+	GFile *file;	/* set when the file is imported in a stream */
 
 	GCancellable *cancellable;
 } ICalImporter;
@@ -98,7 +99,10 @@ ivcal_import_done (ICalImporter *ici,
 {
 	if (ici->cal_client)
 		g_object_unref (ici->cal_client);
-	icalcomponent_free (ici->icalcomp);
+	if (ici->icalcomp)
+		icalcomponent_free (ici->icalcomp);
+	if (ici->file)
+		g_object_unref (ici->file);
 
 	e_import_complete (ici->import, ici->target, error);
 	g_object_unref (ici->import);
@@ -450,6 +454,444 @@ ivcal_import_items (gpointer d)
 	return FALSE;
 }
 
+/* ********************************************************************** */
+/*
+ * Streaming iCalendar import.
+ *
+ * The file is read line by line and split at the component boundary,
+ * without building the whole icalcomponent tree. Batches of components
+ * are parsed in a thread pool and submitted to the calendar in the order
+ * they were read. At most ICAL_STREAM_MAX_PENDING batches are held in
+ * memory at once, thus the memory use does not depend on the file size.
+ */
+
+#define ICAL_STREAM_BATCH_SIZE 100
+#define ICAL_STREAM_MAX_PENDING (2 * ical_stream_n_threads () + 2)
+
+typedef enum {
+	ICAL_STREAM_COMP_NONE,
+	ICAL_STREAM_COMP_WANTED,
+	ICAL_STREAM_COMP_TIMEZONE,
+	ICAL_STREAM_COMP_SKIP
+} ICalStreamCompType;
+
+typedef struct _ICalStreamBatch {
+	guint index;
+	goffset bytes_read;
+	guint n_components;
+	GString *text;		/* freed by the parser */
+	icalcomponent *vcal;	/* set by the parser */
+} ICalStreamBatch;
+
+typedef struct _ICalStreamImport {
+	ICalImporter *ici;
+	const gchar *wanted_kind;
+
+	GThreadPool *pool;
+	GAsyncQueue *parsed;	/* ICalStreamBatch * */
+	GHashTable *ready;	/* guint index ~> ICalStreamBatch * */
+	guint n_batches;
+	guint next_index;
+	guint n_pending;
+
+	goffset file_size;
+	gint last_percent;
+
+	GError *error;
+} ICalStreamImport;
+
+typedef struct _ICalStreamStatus {
+	ICalImporter *ici;
+	gint percent;
+	GError *error;
+} ICalStreamStatus;
+
+static guint
+ical_stream_n_threads (void)
+{
+	return CLAMP (g_get_num_processors (), 1, 8);
+}
+
+static gboolean
+ical_stream_line_is (const gchar *line,
+                     const gchar *prefix,
+                     const gchar **value)
+{
+	gsize len = strlen (prefix);
+
+	if (g_ascii_strncasecmp (line, prefix, len) != 0)
+		return FALSE;
+
+	if (value)
+		*value = line + len;
+
+	return TRUE;
+}
+
+static gboolean
+ical_stream_kind_is (const gchar *value,
+                     const gchar *kind)
+{
+	gsize len = strlen (kind);
+
+	/* The value can have trailing white spaces */
+	return g_ascii_strncasecmp (value, kind, len) == 0 &&
+		(!value[len] || g_ascii_isspace (value[len]));
+}
+
+static void
+ical_stream_batch_free (gpointer ptr)
+{
+	ICalStreamBatch *batch = ptr;
+
+	if (batch) {
+		if (batch->text)
+			g_string_free (batch->text, TRUE);
+		if (batch->vcal)
+			icalcomponent_free (batch->vcal);
+		g_slice_free (ICalStreamBatch, batch);
+	}
+}
+
+static void
+ical_stream_parse_batch_thread (gpointer data,
+                                gpointer user_data)
+{
+	ICalStreamBatch *batch = data;
+	GAsyncQueue *parsed = user_data;
+
+	batch->vcal = icalparser_parse_string (batch->text->str);
+
+	g_string_free (batch->text, TRUE);
+	batch->text = NULL;
+
+	if (batch->vcal && !icalcomponent_get_first_property (batch->vcal, ICAL_METHOD_PROPERTY))
+		icalcomponent_set_method (batch->vcal, ICAL_METHOD_PUBLISH);
+
+	g_async_queue_push (parsed, batch);
+}
+
+static gboolean
+ical_stream_status_idle_cb (gpointer user_data)
+{
+	ICalStreamStatus *status = user_data;
+
+	e_import_status (status->ici->import, status->ici->target, _("Importing..."), status->percent);
+
+	g_slice_free (ICalStreamStatus, status);
+
+	return FALSE;
+}
+
+static gboolean
+ical_stream_done_idle_cb (gpointer user_data)
+{
+	ICalStreamStatus *status = user_data;
+
+	ivcal_import_done (status->ici, status->error);
+
+	g_clear_error (&status->error);
+	g_slice_free (ICalStreamStatus, status);
+
+	return FALSE;
+}
+
+static void
+ical_stream_submit_batch (ICalStreamImport *sim,
+                          ICalStreamBatch *batch)
+{
+	ICalImporter *ici = sim->ici;
+	gint percent;
+
+	if (sim->error || !batch->vcal || !batch->n_components)
+		return;
+
+	if (!e_cal_client_receive_objects_sync (ici->cal_client, batch->vcal, ici->cancellable, &sim->error))
+		return;
+
+	if (sim->file_size <= 0)
+		return;
+
+	percent = (gint) (100 * batch->bytes_read / sim->file_size);
+	percent = CLAMP (percent, 0, 100);
+
+	if (percent != sim->last_percent) {
+		ICalStreamStatus *status;
+
+		sim->last_percent = percent;
+
+		status = g_slice_new0 (ICalStreamStatus);
+		status->ici = ici;
+		status->percent = percent;
+
+		g_idle_add (ical_stream_status_idle_cb, status);
+	}
+}
+
+/* Submits parsed batches in the order they were read. With 'wait' set
+ * blocks until the next batch in order is parsed and submitted. */
+static void
+ical_stream_submit_ready (ICalStreamImport *sim,
+                          gboolean wait)
+{
+	ICalStreamBatch *batch;
+
+	while (sim->n_pending > 0) {
+		while ((batch = g_async_queue_try_pop (sim->parsed)) != NULL)
+			g_hash_table_insert (sim->ready, GUINT_TO_POINTER (batch->index), batch);
+
+		batch = g_hash_table_lookup (sim->ready, GUINT_TO_POINTER (sim->next_index));
+		if (!batch) {
+			if (!wait)
+				break;
+
+			batch = g_async_queue_pop (sim->parsed);
+			g_hash_table_insert (sim->ready, GUINT_TO_POINTER (batch->index), batch);
+			continue;
+		}
+
+		g_hash_table_steal (sim->ready, GUINT_TO_POINTER (sim->next_index));
+		sim->next_index++;
+		sim->n_pending--;
+
+		ical_stream_submit_batch (sim, batch);
+		ical_stream_batch_free (batch);
+
+		/* Only one batch was requested */
+		wait = FALSE;
+	}
+}
+
+static void
+ical_stream_flush_batch (ICalStreamImport *sim,
+                         const GString *header,
+                         const GString *timezones,
+                         GString *components,
+                         guint *n_components,
+                         goffset bytes_read)
+{
+	ICalStreamBatch *batch;
+
+	if (!*n_components)
+		return;
+
+	batch = g_slice_new0 (ICalStreamBatch);
+	batch->index = sim->n_batches++;
+	batch->bytes_read = bytes_read;
+	batch->n_components = *n_components;
+	batch->text = g_string_sized_new (header->len + timezones->len + components->len + 32);
+
+	g_string_append (batch->text, "BEGIN:VCALENDAR\r\n");
+	g_string_append_len (batch->text, header->str, header->len);
+	g_string_append_len (batch->text, timezones->str, timezones->len);
+	g_string_append_len (batch->text, components->str, components->len);
+	g_string_append (batch->text, "END:VCALENDAR\r\n");
+
+	g_string_truncate (components, 0);
+	*n_components = 0;
+
+	sim->n_pending++;
+	g_thread_pool_push (sim->pool, batch, NULL);
+
+	/* Back-pressure, do not read further than the calendar can store */
+	if (sim->n_pending >= ICAL_STREAM_MAX_PENDING)
+		ical_stream_submit_ready (sim, TRUE);
+	else
+		ical_stream_submit_ready (sim, FALSE);
+}
+
+static void
+ical_stream_read (ICalStreamImport *sim,
+                  GDataInputStream *data_stream)
+{
+	ICalStreamCompType comp_type = ICAL_STREAM_COMP_NONE;
+	GString *header, *timezones, *components, *target = NULL;
+	guint n_components = 0, depth = 0, comp_depth = 0;
+	goffset bytes_read = 0;
+	gchar *line;
+	gsize len;
+
+	header = g_string_new ("");
+	timezones = g_string_new ("");
+	components = g_string_new ("");
+
+	while (!sim->error && (line = g_data_input_stream_read_line (data_stream, &len, sim->ici->cancellable, &sim->error)) != NULL) {
+		const gchar *value = NULL;
+
+		bytes_read += len + 1;
+
+		if (ical_stream_line_is (line, "BEGIN:", &value)) {
+			if (comp_type == ICAL_STREAM_COMP_NONE && ical_stream_kind_is (value, "VCALENDAR")) {
+				ical_stream_flush_batch (sim, header, timezones, components, &n_components, bytes_read);
+				g_string_truncate (header, 0);
+				depth++;
+			} else if (comp_type == ICAL_STREAM_COMP_NONE) {
+				comp_depth = depth;
+				depth++;
+
+				if (ical_stream_kind_is (value, "VTIMEZONE")) {
+					comp_type = ICAL_STREAM_COMP_TIMEZONE;
+					target = timezones;
+				} else if (ical_stream_kind_is (value, sim->wanted_kind)) {
+					comp_type = ICAL_STREAM_COMP_WANTED;
+					target = components;
+				} else {
+					comp_type = ICAL_STREAM_COMP_SKIP;
+					target = NULL;
+				}
+			} else {
+				depth++;
+			}
+		} else if (ical_stream_line_is (line, "END:", NULL)) {
+			if (comp_type != ICAL_STREAM_COMP_NONE && depth > 0 && depth - 1 == comp_depth) {
+				if (target) {
+					g_string_append (target, line);
+					g_string_append (target, "\r\n");
+				}
+
+				if (comp_type == ICAL_STREAM_COMP_WANTED)
+					n_components++;
+
+				comp_type = ICAL_STREAM_COMP_NONE;
+				target = NULL;
+				depth--;
+
+				if (n_components >= ICAL_STREAM_BATCH_SIZE)
+					ical_stream_flush_batch (sim, header, timezones, components, &n_components, bytes_read);
+
+				g_free (line);
+				continue;
+			}
+
+			if (depth > 0)
+				depth--;
+
+			if (comp_type == ICAL_STREAM_COMP_NONE) {
+				/* END:VCALENDAR */
+				ical_stream_flush_batch (sim, header, timezones, components, &n_components, bytes_read);
+				g_free (line);
+				continue;
+			}
+		}
+
+		if (comp_type != ICAL_STREAM_COMP_NONE) {
+			if (target) {
+				g_string_append (target, line);
+				g_string_append (target, "\r\n");
+			}
+		} else if (depth > 0 && !ical_stream_line_is (line, "BEGIN:", NULL)) {
+			/* VCALENDAR properties, like VERSION or METHOD */
+			g_string_append (header, line);
+			g_string_append (header, "\r\n");
+		}
+
+		g_free (line);
+	}
+
+	ical_stream_flush_batch (sim, header, timezones, components, &n_components, bytes_read);
+
+	g_string_free (header, TRUE);
+	g_string_free (timezones, TRUE);
+	g_string_free (components, TRUE);
+}
+
+static gpointer
+ical_stream_import_thread (gpointer user_data)
+{
+	ICalStreamImport sim = { 0 };
+	ICalStreamStatus *status;
+	GFileInputStream *file_stream;
+	GFileInfo *info;
+
+	sim.ici = user_data;
+	sim.last_percent = -1;
+	sim.wanted_kind = sim.ici->source_type == E_CAL_CLIENT_SOURCE_TYPE_TASKS ? "VTODO" : "VEVENT";
+
+	file_stream = g_file_read (sim.ici->file, sim.ici->cancellable, &sim.error);
+	if (file_stream) {
+		GDataInputStream *data_stream;
+
+		info = g_file_input_stream_query_info (file_stream, G_FILE_ATTRIBUTE_STANDARD_SIZE, sim.ici->cancellable, NULL);
+		if (info) {
+			sim.file_size = g_file_info_get_size (info);
+			g_object_unref (info);
+		}
+
+		sim.parsed = g_async_queue_new ();
+		sim.ready = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, ical_stream_batch_free);
+		sim.pool = g_thread_pool_new (ical_stream_parse_batch_thread, sim.parsed, ical_stream_n_threads (), FALSE, NULL);
+
+		data_stream = g_data_input_stream_new (G_INPUT_STREAM (file_stream));
+		g_data_input_stream_set_newline_type (data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+
+		ical_stream_read (&sim, data_stream);
+
+		/* Wait for the rest, even on failure, to free the batches */
+		while (sim.n_pending > 0)
+			ical_stream_submit_ready (&sim, TRUE);
+
+		g_thread_pool_free (sim.pool, FALSE, TRUE);
+		g_hash_table_destroy (sim.ready);
+		g_async_queue_unref (sim.parsed);
+
+		g_object_unref (data_stream);
+		g_object_unref (file_stream);
+	}
+
+	status = g_slice_new0 (ICalStreamStatus);
+	status->ici = sim.ici;
+	status->error = sim.error;
+
+	g_idle_add (ical_stream_done_idle_cb, status);
+
+	return NULL;
+}
+
+/* Checks whether the file looks like an iCalendar file with events
+ * or tasks, without reading more of it than necessary. */
+static gboolean
+ical_stream_is_usable (const gchar *filename)
+{
+	GFile *file;
+	GFileInputStream *file_stream;
+	gboolean usable = FALSE;
+
+	file = g_file_new_for_path (filename);
+	file_stream = g_file_read (file, NULL, NULL);
+
+	if (file_stream) {
+		GDataInputStream *data_stream;
+		gchar *line;
+		gboolean first_line = TRUE;
+
+		data_stream = g_data_input_stream_new (G_INPUT_STREAM (file_stream));
+		g_data_input_stream_set_newline_type (data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+
+		while (!usable && (line = g_data_input_stream_read_line (data_stream, NULL, NULL, NULL)) != NULL) {
+			const gchar *value = NULL;
+
+			if (first_line && !ical_stream_line_is (line, "BEGIN:", NULL)) {
+				g_free (line);
+				break;
+			}
+
+			first_line = FALSE;
+
+			if (ical_stream_line_is (line, "BEGIN:", &value))
+				usable = ical_stream_kind_is (value, "VEVENT") || ical_stream_kind_is (value, "VTODO");
+
+			g_free (line);
+		}
+
+		g_object_unref (data_stream);
+		g_object_unref (file_stream);
+	}
+
+	g_object_unref (file);
+
+	return usable;
+}
+
 static void
 ivcal_connect_cb (GObject *source_object,
                   GAsyncResult *result,
@@ -477,13 +919,22 @@ ivcal_connect_cb (GObject *source_object,
 	ici->cal_client = E_CAL_CLIENT (client);
 
 	e_import_status (ici->import, ici->target, _("Importing..."), 0);
-	ici->idle_id = g_idle_add (ivcal_import_items, ici);
+
+	if (ici->file) {
+		GThread *thread;
+
+		thread = g_thread_new (NULL, ical_stream_import_thread, ici);
+		g_thread_unref (thread);
+	} else {
+		ici->idle_id = g_idle_add (ivcal_import_items, ici);
+	}
 }
 
 static void
-ivcal_import (EImport *ei,
-              EImportTarget *target,
-              icalcomponent *icalcomp)
+ivcal_import_full (EImport *ei,
+                   EImportTarget *target,
+                   icalcomponent *icalcomp,
+                   GFile *file)
 {
 	ECalClientSourceType type;
 	ICalImporter *ici = g_malloc0 (sizeof (*ici));
@@ -495,6 +946,7 @@ ivcal_import (EImport *ei,
 	g_object_ref (ei);
 	ici->target = target;
 	ici->icalcomp = icalcomp;
+	ici->file = file ? g_object_ref (file) : NULL;
 	ici->cal_client = NULL;
 	ici->source_type = type;
 	ici->cancellable = g_cancellable_new ();
@@ -505,6 +957,14 @@ ivcal_import (EImport *ei,
 		type, 30, ici->cancellable, ivcal_connect_cb, ici);
 }
 
+static void
+ivcal_import (EImport *ei,
+              EImportTarget *target,
+              icalcomponent *icalcomp)
+{
+	ivcal_import_full (ei, target, icalcomp, NULL);
+}
+
 static void
 ivcal_cancel (EImport *ei,
               EImportTarget *target,
@@ -527,7 +987,6 @@ ical_supported (EImport *ei,
                 EImportImporter *im)
 {
 	gchar *filename;
-	gchar *contents;
 	gboolean ret = FALSE;
 	EImportTargetURI *s;
 
@@ -545,21 +1004,7 @@ ical_supported (EImport *ei,
 	if (!filename)
 		return FALSE;
 
-	if (g_file_get_contents (filename, &contents, NULL, NULL)) {
-		icalcomponent *icalcomp = NULL;
-
-		if (g_ascii_strncasecmp (contents, "BEGIN:", 6) == 0)
-			icalcomp = e_cal_util_parse_ics_string (contents);
-		g_free (contents);
-
-		if (icalcomp) {
-			if (is_icalcomp_usable (icalcomp))
-				ret = TRUE;
-			else
-				ret = FALSE;
-			icalcomponent_free (icalcomp);
-		}
-	}
+	ret = ical_stream_is_usable (filename);
 	g_free (filename);
 
 	return ret;
@@ -570,34 +1015,15 @@ ical_import (EImport *ei,
              EImportTarget *target,
              EImportImporter *im)
 {
-	gchar *filename;
-	gchar *contents;
-	icalcomponent *icalcomp;
-	GError *error = NULL;
+	GFile *file;
 	EImportTargetURI *s = (EImportTargetURI *) target;
 
-	filename = g_filename_from_uri (s->uri_src, NULL, &error);
-	if (!filename) {
-		e_import_complete (ei, target, error);
-		g_clear_error (&error);
-		return;
-	}
-
-	if (!g_file_get_contents (filename, &contents, NULL, &error)) {
-		g_free (filename);
-		e_import_complete (ei, target, error);
-		g_clear_error (&error);
-		return;
-	}
-	g_free (filename);
+	file = g_file_new_for_uri (s->uri_src);
 
-	icalcomp = e_cal_util_parse_ics_string (contents);
-	g_free (contents);
+	/* The file is read and parsed by the importer in a stream */
+	ivcal_import_full (ei, target, NULL, file);
 
-	if (icalcomp)
-		ivcal_import (ei, target, icalcomp);
-	else
-		e_import_complete (ei, target, error);
+	g_object_unref (file);
 }
 
 static GtkWidget *
@@ -684,38 +1110,31 @@ vcal_supported (EImport *ei,
 	if (!filename)
 		return FALSE;
 
-	/* Z: Wow, this is *efficient* */
+	/* If we can create proper iCalendar from the file, then
+	 * rather use ics importer, because it knows to read more
+	 * information than older version, the vCalendar. */
+	if (ical_stream_is_usable (filename)) {
+		g_free (filename);
+		return FALSE;
+	}
 
 	if (g_file_get_contents (filename, &contents, NULL, NULL)) {
 		VObject *vcal;
 		icalcomponent *icalcomp;
 
-		icalcomp = e_cal_util_parse_ics_string (contents);
-
-		if (icalcomp && is_icalcomp_usable (icalcomp)) {
-			/* If we can create proper iCalendar from the file, then
-			 * rather use ics importer, because it knows to read more
-			 * information than older version, the vCalendar. */
-			ret = FALSE;
-			g_free (contents);
-		} else {
-			if (icalcomp)
-				icalcomponent_free (icalcomp);
-
-			/* parse the file */
-			vcal = Parse_MIME (contents, strlen (contents));
-			g_free (contents);
-
-			if (vcal) {
-				icalcomp = icalvcal_convert (vcal);
+		/* parse the file */
+		vcal = Parse_MIME (contents, strlen (contents));
+		g_free (contents);
 
-				if (icalcomp) {
-					icalcomponent_free (icalcomp);
-					ret = TRUE;
-				}
+		if (vcal) {
+			icalcomp = icalvcal_convert (vcal);
 
-				cleanVObject (vcal);
+			if (icalcomp) {
+				icalcomponent_free (icalcomp);
+				ret = TRUE;
 			}
+
+			cleanVObject (vcal);
 		}
 	}
 	g_free (filename);
@@ -25,6 +25,7 @@
 #include <libedataserver/libedataserver.h>
 
 #include "e-canvas.h"
+#include "e-table-trace.h"
 
 #define d(x)
 
@@ -432,6 +433,22 @@ canvas_style_updated (GtkWidget *widget)
 		GNOME_CANVAS (widget))));
 }
 
+static gboolean
+canvas_draw (GtkWidget *widget,
+             cairo_t *cr)
+{
+	gint64 trace_begin;
+	gboolean handled;
+
+	trace_begin = E_TABLE_TRACE_FRAME_BEGIN ();
+
+	handled = GTK_WIDGET_CLASS (e_canvas_parent_class)->draw (widget, cr);
+
+	E_TABLE_TRACE_FRAME_END (trace_begin);
+
+	return handled;
+}
+
 static gint
 canvas_button_event (GtkWidget *widget,
                      GdkEventButton *event)
@@ -604,6 +621,7 @@ e_canvas_class_init (ECanvasClass *class)
 	widget_class->realize = canvas_realize;
 	widget_class->unrealize = canvas_unrealize;
 	widget_class->style_updated = canvas_style_updated;
+	widget_class->draw = canvas_draw;
 	widget_class->button_press_event = canvas_button_event;
 	widget_class->button_release_event = canvas_button_event;
 	widget_class->key_press_event = canvas_key_event;
@@ -38,6 +38,7 @@
 #include <ctype.h>
 #include <math.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include <gtk/gtk.h>
 #include <glib/gi18n.h>
@@ -50,6 +51,8 @@
 #include "e-canvas.h"
 #include "e-cell-text.h"
 #include "e-table-item.h"
+#include "e-table-subset.h"
+#include "e-table-trace.h"
 #include "e-table.h"
 #include "e-text-event-processor-emacs-like.h"
 #include "e-text-event-processor.h"
@@ -119,6 +122,33 @@ typedef struct {
 
 typedef struct _CellEdit CellEdit;
 
+/* How many layouts each view keeps; well above the cells of a viewport */
+#define LAYOUT_CACHE_SIZE 512
+
+/* The text attributes of a row, see get_text_style() */
+enum {
+	TEXT_STYLE_BOLD = 1 << 0,
+	TEXT_STYLE_STRIKEOUT = 1 << 1,
+	TEXT_STYLE_UNDERLINE = 1 << 2,
+	TEXT_STYLE_ITALIC = 1 << 3
+};
+
+/* A laid out cell; it is keyed by the model_col, row and width and
+ * it is valid while the text and the style of the cell match. The row
+ * is the one of the source model, thus the layouts survive sorting. */
+typedef struct {
+	gint model_col;
+	gint row;			/* in ECellTextView::source_model */
+	gint width;
+
+	guint style;
+	guint strikeout_color;
+	gchar *text;
+
+	PangoLayout *layout;
+	GList *link;			/* in ECellTextView::layout_lru */
+} CachedLayout;
+
 typedef struct {
 	ECellView    cell_view;
 	GdkCursor *i_cursor;
@@ -133,6 +163,11 @@ typedef struct {
 	gint xofs, yofs;                 /* This gets added to the x
                                            and y for the cell text. */
 	gdouble ellipsis_width[2];      /* The width of the ellipsis. */
+
+	ETableModel *source_model;	/* notifies about the cached rows */
+	GHashTable *layout_cache;	/* CachedLayout, keyed by itself */
+	GQueue layout_lru;		/* CachedLayout, the most recently used first */
+	guint layout_serial;		/* of the canvas' PangoContext the layouts use */
 } ECellTextView;
 
 struct _CellEdit {
@@ -329,6 +364,139 @@ ect_cancel_edit (ECellTextView *text_view)
 	e_table_item_leave_edit_ (text_view->cell_view.e_table_item_view);
 }
 
+static guint
+cached_layout_hash (gconstpointer key)
+{
+	const CachedLayout *cached = key;
+
+	return (cached->row * 31 + cached->model_col) * 31 + cached->width;
+}
+
+static gboolean
+cached_layout_equal (gconstpointer key1,
+                     gconstpointer key2)
+{
+	const CachedLayout *cached1 = key1, *cached2 = key2;
+
+	return cached1->row == cached2->row &&
+		cached1->model_col == cached2->model_col &&
+		cached1->width == cached2->width;
+}
+
+static void
+cached_layout_free (gpointer ptr)
+{
+	CachedLayout *cached = ptr;
+
+	g_object_unref (cached->layout);
+	g_free (cached->text);
+	g_free (cached);
+}
+
+static void
+layout_cache_remove (ECellTextView *text_view,
+                     CachedLayout *cached)
+{
+	g_queue_delete_link (&text_view->layout_lru, cached->link);
+	g_hash_table_remove (text_view->layout_cache, cached);
+}
+
+static void
+layout_cache_clear (ECellTextView *text_view)
+{
+	g_queue_clear (&text_view->layout_lru);
+	g_hash_table_remove_all (text_view->layout_cache);
+}
+
+/* Drops the layouts of the rows between first_row and last_row,
+ * inclusive, of the model_col, or of all columns when it is -1 */
+static void
+layout_cache_remove_rows (ECellTextView *text_view,
+                          gint model_col,
+                          gint first_row,
+                          gint last_row)
+{
+	GList *link, *next;
+
+	for (link = text_view->layout_lru.head; link; link = next) {
+		CachedLayout *cached = link->data;
+
+		next = g_list_next (link);
+
+		if (cached->row >= first_row && cached->row <= last_row &&
+		    (model_col == -1 || cached->model_col == model_col))
+			layout_cache_remove (text_view, cached);
+	}
+}
+
+/* Maps the view row to the row of the source model */
+static gint
+ect_get_source_row (ECellTextView *text_view,
+                    gint row)
+{
+	ETableModel *model = text_view->cell_view.e_table_model;
+
+	while (row >= 0 && E_IS_TABLE_SUBSET (model)) {
+		row = e_table_subset_view_to_model_row (E_TABLE_SUBSET (model), row);
+		model = e_table_subset_get_source_model (E_TABLE_SUBSET (model));
+	}
+
+	return row;
+}
+
+static void
+ect_model_changed_cb (ETableModel *table_model,
+                      ECellTextView *text_view)
+{
+	layout_cache_clear (text_view);
+}
+
+static gint
+ect_compare_rows (gconstpointer a,
+                  gconstpointer b)
+{
+	return *((const gint *) a) - *((const gint *) b);
+}
+
+/* The changed rows are sorted, thus each cached layout is looked up
+ * among them, instead of going through the cache for each row */
+static void
+ect_model_rows_changed_cb (ETableModel *table_model,
+                           const gint *rows,
+                           gint n_rows,
+                           ECellTextView *text_view)
+{
+	GList *link, *next;
+
+	for (link = text_view->layout_lru.head; link; link = next) {
+		CachedLayout *cached = link->data;
+
+		next = g_list_next (link);
+
+		if (bsearch (&cached->row, rows, n_rows, sizeof (gint), ect_compare_rows))
+			layout_cache_remove (text_view, cached);
+	}
+}
+
+static void
+ect_model_cell_changed_cb (ETableModel *table_model,
+                           gint col,
+                           gint row,
+                           ECellTextView *text_view)
+{
+	layout_cache_remove_rows (text_view, col, row, row);
+}
+
+/* The rows after the change move, thus their layouts cannot be used */
+static void
+ect_model_rows_shifted_cb (ETableModel *table_model,
+                           gint row,
+                           gint count,
+                           ECellTextView *text_view)
+{
+	layout_cache_remove_rows (text_view, -1, row, G_MAXINT);
+}
+
 /*
  * ECell::new_view method
  */
@@ -351,6 +519,39 @@ ect_new_view (ECell *ecell,
 	text_view->xofs = 0.0;
 	text_view->yofs = 0.0;
 
+	text_view->layout_cache = g_hash_table_new_full (
+		cached_layout_hash, cached_layout_equal,
+		NULL, cached_layout_free);
+	g_queue_init (&text_view->layout_lru);
+
+	/* The layouts are cached by the rows of the source model, thus
+	 * listen to it; it is referenced, because the ETableItem can drop
+	 * the model before it kills its cell views */
+	if (E_IS_TABLE_SUBSET (table_model))
+		text_view->source_model = e_table_subset_get_toplevel (
+			E_TABLE_SUBSET (table_model));
+	else
+		text_view->source_model = table_model;
+
+	g_object_ref (table_model);
+	g_object_ref (text_view->source_model);
+
+	g_signal_connect (
+		text_view->source_model, "model_changed",
+		G_CALLBACK (ect_model_changed_cb), text_view);
+	g_signal_connect (
+		text_view->source_model, "model_rows_changed",
+		G_CALLBACK (ect_model_rows_changed_cb), text_view);
+	g_signal_connect (
+		text_view->source_model, "model_cell_changed",
+		G_CALLBACK (ect_model_cell_changed_cb), text_view);
+	g_signal_connect (
+		text_view->source_model, "model_rows_inserted",
+		G_CALLBACK (ect_model_rows_shifted_cb), text_view);
+	g_signal_connect (
+		text_view->source_model, "model_rows_deleted",
+		G_CALLBACK (ect_model_rows_shifted_cb), text_view);
+
 	return (ECellView *) text_view;
 }
 
@@ -368,6 +569,14 @@ ect_kill_view (ECellView *ecv)
 	if (text_view->cell_view.kill_view_cb_data)
 	    g_list_free (text_view->cell_view.kill_view_cb_data);
 
+	g_signal_handlers_disconnect_by_data (
+		text_view->source_model, text_view);
+	g_object_unref (text_view->source_model);
+	g_object_unref (text_view->cell_view.e_table_model);
+
+	layout_cache_clear (text_view);
+	g_hash_table_destroy (text_view->layout_cache);
+
 	g_free (text_view);
 }
 
@@ -399,61 +608,75 @@ ect_unrealize (ECellView *ecv)
 
 	g_object_unref (text_view->i_cursor);
 
+	layout_cache_clear (text_view);
+
 	if (E_CELL_CLASS (e_cell_text_parent_class)->unrealize)
 		(* E_CELL_CLASS (e_cell_text_parent_class)->unrealize) (ecv);
 
 }
 
-static PangoAttrList *
-build_attr_list (ECellTextView *text_view,
-                 gint row,
-                 gint text_length)
+static guint
+get_text_style (ECellTextView *text_view,
+                gint row,
+                guint *strikeout_color)
 {
-
 	ECellView *ecell_view = (ECellView *) text_view;
 	ECellText *ect = E_CELL_TEXT (ecell_view->ecell);
-	PangoAttrList *attrs = pango_attr_list_new ();
-	gboolean bold, strikeout, underline, italic;
-	gint strikeout_color = 0;
-
-	bold = ect->bold_column >= 0 &&
-		row >= 0 &&
-		e_table_model_value_at (ecell_view->e_table_model, ect->bold_column, row);
-	strikeout = ect->strikeout_column >= 0 &&
-		row >= 0 &&
-		e_table_model_value_at (ecell_view->e_table_model, ect->strikeout_column, row);
-	underline = ect->underline_column >= 0 &&
-		row >= 0 &&
-		e_table_model_value_at (ecell_view->e_table_model, ect->underline_column, row);
-	italic = ect->italic_column >= 0 &&
-		row >= 0 &&
-		e_table_model_value_at (ecell_view->e_table_model, ect->italic_column, row);
+	guint style = 0;
+
+	*strikeout_color = 0;
+
+	if (row < 0)
+		return 0;
+
+	if (ect->bold_column >= 0 &&
+	    e_table_model_value_at (ecell_view->e_table_model, ect->bold_column, row))
+		style |= TEXT_STYLE_BOLD;
+	if (ect->strikeout_column >= 0 &&
+	    e_table_model_value_at (ecell_view->e_table_model, ect->strikeout_column, row))
+		style |= TEXT_STYLE_STRIKEOUT;
+	if (ect->underline_column >= 0 &&
+	    e_table_model_value_at (ecell_view->e_table_model, ect->underline_column, row))
+		style |= TEXT_STYLE_UNDERLINE;
+	if (ect->italic_column >= 0 &&
+	    e_table_model_value_at (ecell_view->e_table_model, ect->italic_column, row))
+		style |= TEXT_STYLE_ITALIC;
+
+	if (ect->strikeout_color_column >= 0)
+		*strikeout_color = GPOINTER_TO_UINT (e_table_model_value_at (ecell_view->e_table_model, ect->strikeout_color_column, row));
 
-	if (ect->strikeout_color_column >= 0 && row >= 0)
-		strikeout_color = GPOINTER_TO_UINT (e_table_model_value_at (ecell_view->e_table_model, ect->strikeout_color_column, row));
+	return style;
+}
+
+static PangoAttrList *
+build_style_attr_list (guint style,
+                       guint strikeout_color,
+                       gint text_length)
+{
+	PangoAttrList *attrs = pango_attr_list_new ();
 
-	if (bold) {
+	if ((style & TEXT_STYLE_BOLD) != 0) {
 		PangoAttribute *attr = pango_attr_weight_new (PANGO_WEIGHT_BOLD);
 		attr->start_index = 0;
 		attr->end_index = text_length;
 
 		pango_attr_list_insert_before (attrs, attr);
 	}
-	if (strikeout) {
+	if ((style & TEXT_STYLE_STRIKEOUT) != 0) {
 		PangoAttribute *attr = pango_attr_strikethrough_new (TRUE);
 		attr->start_index = 0;
 		attr->end_index = text_length;
 
 		pango_attr_list_insert_before (attrs, attr);
 	}
-	if (underline) {
+	if ((style & TEXT_STYLE_UNDERLINE) != 0) {
 		PangoAttribute *attr = pango_attr_underline_new (TRUE);
 		attr->start_index = 0;
 		attr->end_index = text_length;
 
 		pango_attr_list_insert_before (attrs, attr);
 	}
-	if (italic) {
+	if ((style & TEXT_STYLE_ITALIC) != 0) {
 		PangoAttribute *attr = pango_attr_style_new (PANGO_STYLE_ITALIC);
 		attr->start_index = 0;
 		attr->end_index = text_length;
@@ -475,6 +698,18 @@ build_attr_list (ECellTextView *text_view,
 	return attrs;
 }
 
+static PangoAttrList *
+build_attr_list (ECellTextView *text_view,
+                 gint row,
+                 gint text_length)
+{
+	guint style, strikeout_color;
+
+	style = get_text_style (text_view, row, &strikeout_color);
+
+	return build_style_attr_list (style, strikeout_color, text_length);
+}
+
 static PangoLayout *
 layout_with_preedit (ECellTextView *text_view,
                      gint row,
@@ -551,6 +786,8 @@ build_layout (ECellTextView *text_view,
 	PangoAttrList *attrs;
 	PangoLayout *layout;
 
+	E_TABLE_TRACE_COUNT (E_TABLE_TRACE_COUNTER_LAYOUT);
+
 	layout = gtk_widget_create_pango_layout (GTK_WIDGET (((GnomeCanvasItem *) ecell_view->e_table_item_view)->canvas), text);
 
 	attrs = (PangoAttrList *) build_attr_list (text_view, row, text ? strlen (text) : 0);
@@ -609,6 +846,83 @@ build_layout (ECellTextView *text_view,
 	return layout;
 }
 
+/* Returns the layout of the cell from the cache, building it only
+ * when the cell was not laid out yet, or its text or style changed
+ * since then, or the font changed. The returned layout is shared,
+ * thus it should not be modified. */
+static PangoLayout *
+lookup_layout (ECellTextView *text_view,
+               gint model_col,
+               gint row,
+               gint width)
+{
+	ECellView *ecell_view = (ECellView *) text_view;
+	ECellText *ect = E_CELL_TEXT (ecell_view->ecell);
+	PangoContext *pango_context;
+	CachedLayout key, *cached;
+	const gchar *str;
+	gchar *text = NULL;
+	guint style, strikeout_color;
+
+	/* build_layout() makes the same layout for all of these */
+	if (width < 0)
+		width = 0;
+
+	pango_context = gtk_widget_get_pango_context (GTK_WIDGET (text_view->canvas));
+	if (pango_context_get_serial (pango_context) != text_view->layout_serial) {
+		layout_cache_clear (text_view);
+		text_view->layout_serial = pango_context_get_serial (pango_context);
+	}
+
+	if (row >= 0) {
+		text = e_cell_text_get_text (ect, ecell_view->e_table_model, model_col, row);
+		str = text ? text : "?";
+	} else
+		str = "Mumbo Jumbo";
+
+	style = get_text_style (text_view, row, &strikeout_color);
+
+	key.model_col = model_col;
+	key.row = ect_get_source_row (text_view, row);
+	key.width = width;
+
+	cached = g_hash_table_lookup (text_view->layout_cache, &key);
+
+	/* Not every model notifies about all of its changes */
+	if (cached && (cached->style != style ||
+	    cached->strikeout_color != strikeout_color ||
+	    g_strcmp0 (cached->text, str) != 0)) {
+		layout_cache_remove (text_view, cached);
+		cached = NULL;
+	}
+
+	if (cached) {
+		g_queue_unlink (&text_view->layout_lru, cached->link);
+		g_queue_push_head_link (&text_view->layout_lru, cached->link);
+	} else {
+		cached = g_new0 (CachedLayout, 1);
+		cached->model_col = model_col;
+		cached->row = key.row;
+		cached->width = width;
+		cached->style = style;
+		cached->strikeout_color = strikeout_color;
+		cached->text = g_strdup (str);
+		cached->layout = build_layout (text_view, row, str, width);
+
+		g_queue_push_head (&text_view->layout_lru, cached);
+		cached->link = text_view->layout_lru.head;
+		g_hash_table_add (text_view->layout_cache, cached);
+
+		while (text_view->layout_lru.length > LAYOUT_CACHE_SIZE)
+			layout_cache_remove (text_view, g_queue_peek_tail (&text_view->layout_lru));
+	}
+
+	if (row >= 0)
+		e_cell_text_free_text (ect, ecell_view->e_table_model, model_col, text);
+
+	return g_object_ref (cached->layout);
+}
+
 static PangoLayout *
 generate_layout (ECellTextView *text_view,
                  gint model_col,
@@ -626,6 +940,10 @@ generate_layout (ECellTextView *text_view,
 		return edit->layout;
 	}
 
+	/* The layouts are set up differently while editing, see build_layout() */
+	if (!edit)
+		return lookup_layout (text_view, model_col, row, width);
+
 	if (row >= 0) {
 		gchar *temp = e_cell_text_get_text (ect, ecell_view->e_table_model, model_col, row);
 		layout = build_layout (text_view, row, temp ? temp : "?", width);
@@ -1511,22 +1829,65 @@ ect_max_width (ECellView *ecell_view,
 {
 	/* New ECellText */
 	ECellTextView *text_view = (ECellTextView *) ecell_view;
+	ECellText *ect = E_CELL_TEXT (ecell_view->ecell);
+	CellEdit *edit = text_view->edit;
+	GHashTable *measured;
+	PangoLayout *layout;
 	gint row;
 	gint number_of_rows;
 	gint max_width = 0;
 
 	number_of_rows = e_table_model_row_count (ecell_view->e_table_model);
 
+	/* Many rows share their text, like the dates or the senders, thus
+	 * each distinct text and style is measured only once, in a single
+	 * reused layout, the same as build_layout() makes without a width */
+	measured = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	layout = gtk_widget_create_pango_layout (GTK_WIDGET (text_view->canvas), NULL);
+
 	for (row = 0; row < number_of_rows; row++) {
-		PangoLayout *layout = generate_layout (text_view, model_col, view_col, row, 0);
+		PangoAttrList *attrs;
+		const gchar *str;
+		gchar *text, *key;
+		guint style, strikeout_color;
 		gint width;
 
-		pango_layout_get_pixel_size (layout, &width, NULL);
+		if (edit && edit->model_col == model_col && edit->row == row) {
+			PangoLayout *edit_layout = generate_layout (text_view, model_col, view_col, row, 0);
+
+			pango_layout_get_pixel_size (edit_layout, &width, NULL);
+			max_width = MAX (max_width, width);
+			g_object_unref (edit_layout);
+			continue;
+		}
+
+		text = e_cell_text_get_text (ect, ecell_view->e_table_model, model_col, row);
+		str = text ? text : "?";
+
+		/* The strikeout color does not change the width */
+		style = get_text_style (text_view, row, &strikeout_color);
+		key = g_strdup_printf ("%x:%s", style, str);
+
+		if (g_hash_table_contains (measured, key)) {
+			g_free (key);
+		} else {
+			pango_layout_set_text (layout, str, -1);
+			attrs = build_style_attr_list (style, 0, strlen (str));
+			pango_layout_set_attributes (layout, attrs);
+			pango_attr_list_unref (attrs);
+
+			pango_layout_get_pixel_size (layout, &width, NULL);
+			max_width = MAX (max_width, width);
 
-		max_width = MAX (max_width, width);
-		g_object_unref (layout);
+			g_hash_table_add (measured, key);
+		}
+
+		e_cell_text_free_text (ect, ecell_view->e_table_model, model_col, text);
 	}
 
+	g_object_unref (layout);
+	g_hash_table_destroy (measured);
+
 	return max_width + 8;
 }
 
@@ -26,6 +26,7 @@
 #include <gtk/gtk.h>
 
 #include "e-cell.h"
+#include "e-table-trace.h"
 
 G_DEFINE_TYPE (ECell, e_cell, G_TYPE_OBJECT)
 
@@ -342,6 +343,7 @@ e_cell_draw (ECellView *ecell_view,
              gint y2)
 {
 	ECellClass *class;
+	gint64 trace_begin;
 
 	g_return_if_fail (ecell_view != NULL);
 	g_return_if_fail (row >= 0);
@@ -350,6 +352,8 @@ e_cell_draw (ECellView *ecell_view,
 	class = E_CELL_GET_CLASS (ecell_view->ecell);
 	g_return_if_fail (class->draw != NULL);
 
+	trace_begin = E_TABLE_TRACE_BEGIN ();
+
 	cairo_save (cr);
 
 	class->draw (
@@ -358,6 +362,9 @@ e_cell_draw (ECellView *ecell_view,
 		row, flags, x1, y1, x2, y2);
 
 	cairo_restore (cr);
+
+	/* Spans are named by the cell type, like "ECellText" */
+	E_TABLE_TRACE_END (G_OBJECT_TYPE_NAME (ecell_view->ecell), trace_begin);
 }
 
 /**
@@ -44,6 +44,7 @@ struct _EContactStorePrivate {
 	gint stamp;
 	EBookQuery *query;
 	GArray *contact_sources;
+	GArray *source_offsets;  /* gint, row offset of each source, plus the total */
 };
 
 /* Signals */
@@ -100,13 +101,17 @@ typedef struct
 
 	EBookClientView *client_view;
 	GPtrArray *contacts;
+	GHashTable *contacts_index;  /* UID ~> index + 1 in contacts */
 
 	EBookClientView *client_view_pending;
 	GPtrArray *contacts_pending;
+	GHashTable *contacts_pending_index;  /* UID ~> index + 1 in contacts_pending */
 }
 ContactSource;
 
 static void free_contact_ptrarray (GPtrArray *contacts);
+static void contacts_index_invalidate (GHashTable **pindex);
+static void rebuild_source_offsets (EContactStore *contact_store);
 static void clear_contact_source  (EContactStore *contact_store, ContactSource *source);
 static void stop_view             (EContactStore *contact_store, EBookClientView *view);
 
@@ -128,9 +133,11 @@ contact_store_dispose (GObject *object)
 
 		clear_contact_source (E_CONTACT_STORE (object), source);
 		free_contact_ptrarray (source->contacts);
+		contacts_index_invalidate (&source->contacts_index);
 		g_object_unref (source->book_client);
 	}
 	g_array_set_size (priv->contact_sources, 0);
+	rebuild_source_offsets (E_CONTACT_STORE (object));
 
 	if (priv->query != NULL) {
 		e_book_query_unref (priv->query);
@@ -149,6 +156,7 @@ contact_store_finalize (GObject *object)
 	priv = E_CONTACT_STORE_GET_PRIVATE (object);
 
 	g_array_free (priv->contact_sources, TRUE);
+	g_array_free (priv->source_offsets, TRUE);
 
 	/* Chain up to parent's finalize() method. */
 	G_OBJECT_CLASS (e_contact_store_parent_class)->finalize (object);
@@ -227,12 +235,16 @@ static void
 e_contact_store_init (EContactStore *contact_store)
 {
 	GArray *contact_sources;
+	GArray *source_offsets;
 
 	contact_sources = g_array_new (FALSE, FALSE, sizeof (ContactSource));
+	source_offsets = g_array_sized_new (FALSE, TRUE, sizeof (gint), 1);
+	g_array_set_size (source_offsets, 1);
 
 	contact_store->priv = E_CONTACT_STORE_GET_PRIVATE (contact_store);
 	contact_store->priv->stamp = g_random_int ();
 	contact_store->priv->contact_sources = contact_sources;
+	contact_store->priv->source_offsets = source_offsets;
 }
 
 /**
@@ -345,22 +357,29 @@ static gint
 find_contact_source_by_offset (EContactStore *contact_store,
                                gint offset)
 {
-	GArray *array;
-	gint i;
+	GArray *offsets;
+	gint lo, hi;
 
-	array = contact_store->priv->contact_sources;
+	offsets = contact_store->priv->source_offsets;
 
-	for (i = 0; i < array->len; i++) {
-		ContactSource *source;
+	if (offset < 0 || offset >= g_array_index (offsets, gint, offsets->len - 1))
+		return -1;
 
-		source = &g_array_index (array, ContactSource, i);
-		if (source->contacts->len > offset)
-			return i;
+	/* Find the first source which ends after the offset,
+	 * that skips empty sources in front of it as well. */
+	lo = 0;
+	hi = offsets->len - 1;
 
-		offset -= source->contacts->len;
+	while (lo < hi) {
+		gint mid = (lo + hi) / 2;
+
+		if (g_array_index (offsets, gint, mid + 1) <= offset)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	return -1;
+	return lo;
 }
 
 static gint
@@ -384,113 +403,150 @@ static gint
 get_contact_source_offset (EContactStore *contact_store,
                            gint contact_source_index)
 {
-	GArray *array;
+	GArray *offsets;
+
+	offsets = contact_store->priv->source_offsets;
+
+	g_return_val_if_fail (contact_source_index < offsets->len - 1, 0);
+
+	return g_array_index (offsets, gint, contact_source_index);
+}
+
+/* Adjusts the offsets of the sources after the one at @contact_source_index,
+ * when the number of its contacts changed by @delta. Must be called before
+ * the corresponding row signal is emitted. */
+static void
+contact_source_length_changed (EContactStore *contact_store,
+                               gint contact_source_index,
+                               gint delta)
+{
+	GArray *offsets;
+	gint i;
+
+	offsets = contact_store->priv->source_offsets;
+
+	for (i = contact_source_index + 1; i < offsets->len; i++)
+		g_array_index (offsets, gint, i) += delta;
+}
+
+static void
+rebuild_source_offsets (EContactStore *contact_store)
+{
+	GArray *array, *offsets;
 	gint offset = 0;
 	gint i;
 
 	array = contact_store->priv->contact_sources;
+	offsets = contact_store->priv->source_offsets;
 
-	g_return_val_if_fail (contact_source_index < array->len, 0);
+	g_array_set_size (offsets, array->len + 1);
 
-	for (i = 0; i < contact_source_index; i++) {
+	for (i = 0; i < array->len; i++) {
 		ContactSource *source;
 
 		source = &g_array_index (array, ContactSource, i);
+
+		g_array_index (offsets, gint, i) = offset;
 		offset += source->contacts->len;
 	}
 
-	return offset;
+	g_array_index (offsets, gint, array->len) = offset;
 }
 
 static gint
 count_contacts (EContactStore *contact_store)
 {
-	GArray *array;
-	gint count = 0;
-	gint i;
+	GArray *offsets;
 
-	array = contact_store->priv->contact_sources;
+	offsets = contact_store->priv->source_offsets;
 
-	for (i = 0; i < array->len; i++) {
-		ContactSource *source;
+	return g_array_index (offsets, gint, offsets->len - 1);
+}
 
-		source = &g_array_index (array, ContactSource, i);
-		count += source->contacts->len;
-	}
+/* The UID indexes of the contact arrays are built on demand and dropped
+ * whenever contacts are removed, because the removal shifts the indexes
+ * of all the following contacts. A batch of removals then costs a single
+ * rebuild at the next lookup, instead of a scan of the array per UID. */
+
+static void
+contacts_index_add (GHashTable *index,
+                    EContact *contact,
+                    gint position)
+{
+	const gchar *uid;
 
-	return count;
+	/* The first of the contacts with the same UID wins, as with a scan */
+	uid = e_contact_get_const (contact, E_CONTACT_UID);
+	if (uid && !g_hash_table_contains (index, uid))
+		g_hash_table_insert (index, g_strdup (uid), GINT_TO_POINTER (position + 1));
 }
 
 static gint
-find_contact_by_view_and_uid (EContactStore *contact_store,
-                              EBookClientView *find_view,
-                              const gchar *find_uid)
+contacts_index_lookup (GPtrArray *contacts,
+                       GHashTable **pindex,
+                       const gchar *uid)
 {
-	GArray *array;
-	ContactSource *source;
-	GPtrArray *contacts;
-	gint source_index;
-	gint i;
-
-	g_return_val_if_fail (find_uid != NULL, -1);
+	gpointer value;
 
-	source_index = find_contact_source_by_view (contact_store, find_view);
-	if (source_index < 0)
+	if (!uid)
 		return -1;
 
-	array = contact_store->priv->contact_sources;
-	source = &g_array_index (array, ContactSource, source_index);
-
-	if (find_view == source->client_view)
-		contacts = source->contacts;          /* Current view */
-	else
-		contacts = source->contacts_pending;  /* Pending view */
+	if (!*pindex) {
+		gint i;
 
-	for (i = 0; i < contacts->len; i++) {
-		EContact    *contact = g_ptr_array_index (contacts, i);
-		const gchar *uid = e_contact_get_const (contact, E_CONTACT_UID);
+		*pindex = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-		if (uid && !strcmp (find_uid, uid))
-			return i;
+		for (i = 0; i < contacts->len; i++)
+			contacts_index_add (*pindex, g_ptr_array_index (contacts, i), i);
 	}
 
-	return -1;
+	value = g_hash_table_lookup (*pindex, uid);
+
+	return value ? GPOINTER_TO_INT (value) - 1 : -1;
+}
+
+static void
+contacts_index_append (GPtrArray *contacts,
+                       GHashTable *index,
+                       EContact *contact)
+{
+	g_ptr_array_add (contacts, contact);
+
+	if (index)
+		contacts_index_add (index, contact, contacts->len - 1);
 }
 
-static GHashTable *
-get_contact_hash (EContactStore *contact_store,
-                  EBookClientView *find_view)
+static void
+contacts_index_invalidate (GHashTable **pindex)
+{
+	if (*pindex) {
+		g_hash_table_destroy (*pindex);
+		*pindex = NULL;
+	}
+}
+
+static gint
+find_contact_by_view_and_uid (EContactStore *contact_store,
+                              EBookClientView *find_view,
+                              const gchar *find_uid)
 {
 	GArray *array;
 	ContactSource *source;
-	GPtrArray *contacts;
 	gint source_index;
-	gint ii;
-	GHashTable *hash;
+
+	g_return_val_if_fail (find_uid != NULL, -1);
 
 	source_index = find_contact_source_by_view (contact_store, find_view);
 	if (source_index < 0)
-		return NULL;
+		return -1;
 
 	array = contact_store->priv->contact_sources;
 	source = &g_array_index (array, ContactSource, source_index);
 
 	if (find_view == source->client_view)
-		contacts = source->contacts;          /* Current view */
-	else
-		contacts = source->contacts_pending;  /* Pending view */
-
-	hash = g_hash_table_new (g_str_hash, g_str_equal);
+		return contacts_index_lookup (source->contacts, &source->contacts_index, find_uid);
 
-	for (ii = 0; ii < contacts->len; ii++) {
-		EContact *contact = g_ptr_array_index (contacts, ii);
-		const gchar *uid = e_contact_get_const (contact, E_CONTACT_UID);
-
-		if (uid)
-			g_hash_table_insert (hash, (gpointer) uid, GINT_TO_POINTER (ii));
-	}
-
-	return hash;
+	return contacts_index_lookup (source->contacts_pending, &source->contacts_pending_index, find_uid);
 }
 
 static gint
@@ -506,13 +562,9 @@ find_contact_by_uid (EContactStore *contact_store,
 		ContactSource *source = &g_array_index (array, ContactSource, i);
 		gint           j;
 
-		for (j = 0; j < source->contacts->len; j++) {
-			EContact    *contact = g_ptr_array_index (source->contacts, j);
-			const gchar *uid = e_contact_get_const (contact, E_CONTACT_UID);
-
-			if (!strcmp (find_uid, uid))
-				return get_contact_source_offset (contact_store, i) + j;
-		}
+		j = contacts_index_lookup (source->contacts, &source->contacts_index, find_uid);
+		if (j >= 0)
+			return get_contact_source_offset (contact_store, i) + j;
 	}
 
 	return -1;
@@ -563,22 +615,34 @@ static gboolean
 find_contact_source_details_by_view (EContactStore *contact_store,
                                      EBookClientView *client_view,
                                      ContactSource **contact_source,
+                                     gint *source_index,
                                      gint *offset)
 {
 	GArray *array;
-	gint source_index;
+	gint index;
 
-	source_index = find_contact_source_by_view (contact_store, client_view);
-	if (source_index < 0)
+	index = find_contact_source_by_view (contact_store, client_view);
+	if (index < 0)
 		return FALSE;
 
 	array = contact_store->priv->contact_sources;
-	*contact_source = &g_array_index (array, ContactSource, source_index);
-	*offset = get_contact_source_offset (contact_store, source_index);
+	*contact_source = &g_array_index (array, ContactSource, index);
+	*source_index = index;
+	*offset = get_contact_source_offset (contact_store, index);
 
 	return TRUE;
 }
 
+static gint
+sort_descending (gconstpointer ca,
+                 gconstpointer cb)
+{
+	gint a = *((gint *) ca);
+	gint b = *((gint *) cb);
+
+	return (a == b) ? 0 : (a < b) ? 1 : -1;
+}
+
 /* ------------------------- *
  * EBookView signal handlers *
  * ------------------------- */
@@ -589,10 +653,11 @@ view_contacts_added (EContactStore *contact_store,
                      EBookClientView *client_view)
 {
 	ContactSource *source;
+	gint           source_index;
 	gint           offset;
 	const GSList  *l;
 
-	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &offset)) {
+	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &source_index, &offset)) {
 		g_warning ("EContactStore got 'contacts_added' signal from unknown EBookView!");
 		return;
 	}
@@ -604,11 +669,12 @@ view_contacts_added (EContactStore *contact_store,
 
 		if (client_view == source->client_view) {
 			/* Current view */
-			g_ptr_array_add (source->contacts, contact);
+			contacts_index_append (source->contacts, source->contacts_index, contact);
+			contact_source_length_changed (contact_store, source_index, 1);
 			row_inserted (contact_store, offset + source->contacts->len - 1);
 		} else {
 			/* Pending view */
-			g_ptr_array_add (source->contacts_pending, contact);
+			contacts_index_append (source->contacts_pending, source->contacts_pending_index, contact);
 		}
 	}
 }
@@ -619,37 +685,60 @@ view_contacts_removed (EContactStore *contact_store,
                        EBookClientView *client_view)
 {
 	ContactSource *source;
+	GPtrArray     *cached_contacts;
+	GArray        *indices;
+	gint           source_index;
 	gint           offset;
+	gboolean       is_current;
 	const GSList  *l;
+	gint           i;
 
-	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &offset)) {
+	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &source_index, &offset)) {
 		g_warning ("EContactStore got 'contacts_removed' signal from unknown EBookView!");
 		return;
 	}
 
+	is_current = client_view == source->client_view;
+	cached_contacts = is_current ? source->contacts : source->contacts_pending;
+	indices = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	/* Find all the rows first, while the index is valid */
 	for (l = uids; l; l = g_slist_next (l)) {
 		const gchar *uid = l->data;
 		gint         n = find_contact_by_view_and_uid (contact_store, client_view, uid);
-		EContact    *contact;
 
 		if (n < 0) {
 			g_warning ("EContactStore got 'contacts_removed' on unknown contact!");
 			continue;
 		}
 
-		if (client_view == source->client_view) {
-			/* Current view */
-			contact = g_ptr_array_index (source->contacts, n);
-			g_object_unref (contact);
-			g_ptr_array_remove_index (source->contacts, n);
-			row_deleted (contact_store, offset + n);
-		} else {
-			/* Pending view */
-			contact = g_ptr_array_index (source->contacts_pending, n);
-			g_object_unref (contact);
-			g_ptr_array_remove_index (source->contacts_pending, n);
+		g_array_append_val (indices, n);
+	}
+
+	if (indices->len > 0) {
+		contacts_index_invalidate (is_current ? &source->contacts_index : &source->contacts_pending_index);
+
+		/* Removing from the end keeps the lower rows in place */
+		g_array_sort (indices, sort_descending);
+
+		for (i = 0; i < indices->len; i++) {
+			gint n = g_array_index (indices, gint, i);
+
+			/* The same UID listed twice */
+			if (i > 0 && n == g_array_index (indices, gint, i - 1))
+				continue;
+
+			g_object_unref (g_ptr_array_index (cached_contacts, n));
+			g_ptr_array_remove_index (cached_contacts, n);
+
+			if (is_current) {
+				contact_source_length_changed (contact_store, source_index, -1);
+				row_deleted (contact_store, offset + n);
+			}
 		}
 	}
+
+	g_array_free (indices, TRUE);
 }
 
 static void
@@ -659,10 +748,11 @@ view_contacts_modified (EContactStore *contact_store,
 {
 	GPtrArray     *cached_contacts;
 	ContactSource *source;
+	gint           source_index;
 	gint           offset;
 	const GSList  *l;
 
-	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &offset)) {
+	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &source_index, &offset)) {
 		g_warning ("EContactStore got 'contacts_changed' signal from unknown EBookView!");
 		return;
 	}
@@ -676,7 +766,7 @@ view_contacts_modified (EContactStore *contact_store,
 		EContact    *cached_contact;
 		EContact    *contact = l->data;
 		const gchar *uid = e_contact_get_const (contact, E_CONTACT_UID);
-		gint         n = find_contact_by_view_and_uid (contact_store, client_view, uid);
+		gint         n = uid ? find_contact_by_view_and_uid (contact_store, client_view, uid) : -1;
 
 		if (n < 0) {
 			g_warning ("EContactStore got change notification on unknown contact!");
@@ -703,11 +793,11 @@ view_complete (EContactStore *contact_store,
                EBookClientView *client_view)
 {
 	ContactSource *source;
+	gint           source_index;
 	gint           offset;
 	gint           i;
-	GHashTable *hash;
 
-	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &offset)) {
+	if (!find_contact_source_details_by_view (contact_store, client_view, &source, &source_index, &offset)) {
 		g_warning ("EContactStore got 'complete' signal from unknown EBookClientView!");
 		return;
 	}
@@ -725,38 +815,37 @@ view_complete (EContactStore *contact_store,
 
 	g_signal_emit (contact_store, signals[START_UPDATE], 0, client_view);
 
-	/* Deletions */
-	hash = get_contact_hash (contact_store, source->client_view_pending);
-	for (i = 0; i < source->contacts->len; i++) {
+	/* Deletions, from the end, thus the lower rows and the index stay valid */
+	for (i = source->contacts->len - 1; i >= 0; i--) {
 		EContact    *old_contact = g_ptr_array_index (source->contacts, i);
 		const gchar *old_uid = e_contact_get_const (old_contact, E_CONTACT_UID);
 
-		if (!g_hash_table_contains (hash, old_uid)) {
+		if (contacts_index_lookup (source->contacts_pending, &source->contacts_pending_index, old_uid) < 0) {
 			/* Contact is not in new view; removed */
 			g_object_unref (old_contact);
 			g_ptr_array_remove_index (source->contacts, i);
+			contact_source_length_changed (contact_store, source_index, -1);
 			row_deleted (contact_store, offset + i);
-			i--;  /* Stay in place */
 		}
 	}
-	g_hash_table_unref (hash);
+
+	contacts_index_invalidate (&source->contacts_index);
 
 	/* Insertions */
-	hash = get_contact_hash (contact_store, source->client_view);
 	for (i = 0; i < source->contacts_pending->len; i++) {
 		EContact    *new_contact = g_ptr_array_index (source->contacts_pending, i);
 		const gchar *new_uid = e_contact_get_const (new_contact, E_CONTACT_UID);
 
-		if (!g_hash_table_contains (hash, new_uid)) {
+		if (contacts_index_lookup (source->contacts, &source->contacts_index, new_uid) < 0) {
 			/* Contact is not in old view; inserted */
-			g_ptr_array_add (source->contacts, new_contact);
+			contacts_index_append (source->contacts, source->contacts_index, new_contact);
+			contact_source_length_changed (contact_store, source_index, 1);
 			row_inserted (contact_store, offset + source->contacts->len - 1);
 		} else {
 			/* Contact already in old view; drop the new one */
 			g_object_unref (new_contact);
 		}
 	}
-	g_hash_table_unref (hash);
 
 	g_signal_emit (contact_store, signals[STOP_UPDATE], 0, client_view);
 
@@ -769,6 +858,7 @@ view_complete (EContactStore *contact_store,
 	/* Free array of pending contacts (members have been either moved or unreffed) */
 	g_ptr_array_free (source->contacts_pending, TRUE);
 	source->contacts_pending = NULL;
+	contacts_index_invalidate (&source->contacts_pending_index);
 }
 
 /* --------------------- *
@@ -874,6 +964,7 @@ clear_contact_source (EContactStore *contact_store,
 
 			g_object_unref (contact);
 			g_ptr_array_remove_index_fast (source->contacts, i);
+			contact_source_length_changed (contact_store, source_index, -1);
 
 			gtk_tree_path_prev (path);
 			gtk_tree_model_row_deleted (GTK_TREE_MODEL (contact_store), path);
@@ -883,6 +974,8 @@ clear_contact_source (EContactStore *contact_store,
 		g_signal_emit (contact_store, signals[STOP_UPDATE], 0, source->client_view);
 	}
 
+	contacts_index_invalidate (&source->contacts_index);
+
 	/* Free main and pending views, clear cached contacts */
 
 	if (source->client_view) {
@@ -896,6 +989,7 @@ clear_contact_source (EContactStore *contact_store,
 		stop_view (contact_store, source->client_view_pending);
 		g_object_unref (source->client_view_pending);
 		free_contact_ptrarray (source->contacts_pending);
+		contacts_index_invalidate (&source->contacts_pending_index);
 
 		source->client_view_pending = NULL;
 		source->contacts_pending = NULL;
@@ -932,6 +1026,7 @@ client_view_ready_cb (GObject *source_object,
 				stop_view (contact_store, source->client_view_pending);
 				g_object_unref (source->client_view_pending);
 				free_contact_ptrarray (source->contacts_pending);
+				contacts_index_invalidate (&source->contacts_pending_index);
 			}
 
 			source->client_view_pending = client_view;
@@ -972,6 +1067,7 @@ query_contact_source (EContactStore *contact_store,
 			stop_view (contact_store, source->client_view_pending);
 			g_object_unref (source->client_view_pending);
 			free_contact_ptrarray (source->contacts_pending);
+			contacts_index_invalidate (&source->contacts_pending_index);
 			source->client_view_pending = NULL;
 			source->contacts_pending = NULL;
 		}
@@ -1126,6 +1222,7 @@ e_contact_store_add_client (EContactStore *contact_store,
 	source.book_client = g_object_ref (book_client);
 	source.contacts = g_ptr_array_new ();
 	g_array_append_val (array, source);
+	rebuild_source_offsets (contact_store);
 
 	indexed_source = &g_array_index (array, ContactSource, array->len - 1);
 
@@ -1164,9 +1261,11 @@ e_contact_store_remove_client (EContactStore *contact_store,
 	source = &g_array_index (array, ContactSource, source_index);
 	clear_contact_source (contact_store, source);
 	free_contact_ptrarray (source->contacts);
+	contacts_index_invalidate (&source->contacts_index);
 	g_object_unref (book_client);
 
 	g_array_remove_index (array, source_index);  /* Preserve order */
+	rebuild_source_offsets (contact_store);
 
 	return TRUE;
 }
@@ -33,6 +33,22 @@
 	(G_TYPE_INSTANCE_GET_PRIVATE \
 	((obj), E_TYPE_NAME_SELECTOR_ENTRY, ENameSelectorEntryPrivate))
 
+/* Stages of the autocompletion, from a keystroke to the popup */
+enum {
+	COMPLETION_STAGE_UPDATE_MODEL,	/* the query or the local narrowing */
+	COMPLETION_STAGE_FIRST_RESULT,	/* from the query to the first contact */
+	COMPLETION_STAGE_GENERATE_ROWS,	/* generate_contact_rows(), in total */
+	COMPLETION_STAGE_FIND,		/* find_existing_completion(), in total */
+	N_COMPLETION_STAGES
+};
+
+static const gchar *completion_stage_names[N_COMPLETION_STAGES] = {
+	"update-model",
+	"first-result",
+	"generate-rows",
+	"find-completion"
+};
+
 struct _ENameSelectorEntryPrivate {
 	EClientCache *client_cache;
 	gint minimum_query_length;
@@ -66,13 +82,33 @@ struct _ENameSelectorEntryPrivate {
 	GQueue cancellables;
 
 	GHashTable *known_contacts; /* gchar * ~> 1 */
+
+	/* Local narrowing of the completion results, see completion_index_match() */
+	gchar *completion_query_cue; /* casefolded cue of the query in contact_store */
+	gchar *completion_filter_cue; /* casefolded cue the rows are filtered by, or NULL */
+	gchar *completion_filter_name_cue; /* the same, as compared with the name fields */
+	gchar *completion_filter_comma_cue; /* the same, as "Family, Given", or NULL */
+	GHashTable *completion_index; /* EContact * ~> CompletionIndexEntry * */
+
+	/* Autocompletion latency, see completion_timing_start() */
+	gint64 completion_keystroke_time; /* 0 when not measuring */
+	gint64 completion_query_time;
+	gint64 completion_stage_times[N_COMPLETION_STAGES];
+	gint completion_n_rows;
+	GVariant *completion_timings; /* of the last finished completion */
 };
 
+typedef struct _CompletionIndexEntry {
+	gchar *names; /* casefolded full name and file-as, each on its own line */
+	gchar *others; /* casefolded nickname and e-mail addresses */
+} CompletionIndexEntry;
+
 enum {
 	PROP_0,
 	PROP_CLIENT_CACHE,
 	PROP_MINIMUM_QUERY_LENGTH,
-	PROP_SHOW_ADDRESS
+	PROP_SHOW_ADDRESS,
+	PROP_COMPLETION_TIMINGS
 };
 
 enum {
@@ -112,6 +148,91 @@ static void user_delete_text (ENameSelectorEntry *name_selector_entry, gint star
 static void setup_default_contact_store (ENameSelectorEntry *name_selector_entry);
 static void deep_free_list (GList *list);
 
+/* Set E_NAME_SELECTOR_ENTRY_DEBUG to print how long the completions take */
+static gboolean
+completion_timing_debug_enabled (void)
+{
+	static gint enabled = -1;
+
+	if (enabled == -1)
+		enabled = g_getenv ("E_NAME_SELECTOR_ENTRY_DEBUG") ? 1 : 0;
+
+	return enabled == 1;
+}
+
+/* Starts measuring the completion kicked off by a keystroke; a next
+ * keystroke restarts it, because the popup waits for the last one */
+static void
+completion_timing_start (ENameSelectorEntry *name_selector_entry)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+	gint ii;
+
+	priv->completion_keystroke_time = g_get_monotonic_time ();
+	priv->completion_query_time = 0;
+	priv->completion_n_rows = 0;
+
+	for (ii = 0; ii < N_COMPLETION_STAGES; ii++)
+		priv->completion_stage_times[ii] = 0;
+}
+
+static void
+completion_timing_add (ENameSelectorEntry *name_selector_entry,
+                       gint stage,
+                       gint64 since)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+
+	if (priv->completion_keystroke_time)
+		priv->completion_stage_times[stage] += g_get_monotonic_time () - since;
+}
+
+/* Finishes the measurement when the completion is offered to the user */
+static void
+completion_timing_finish (ENameSelectorEntry *name_selector_entry,
+                          const gchar *cue_str)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+	GVariantBuilder builder;
+	gint64 total;
+	gint ii;
+
+	if (!priv->completion_keystroke_time)
+		return;
+
+	total = g_get_monotonic_time () - priv->completion_keystroke_time;
+	priv->completion_keystroke_time = 0;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sx}"));
+	for (ii = 0; ii < N_COMPLETION_STAGES; ii++) {
+		g_variant_builder_add (
+			&builder, "{sx}",
+			completion_stage_names[ii],
+			priv->completion_stage_times[ii]);
+	}
+	g_variant_builder_add (&builder, "{sx}", "total", total);
+	g_variant_builder_add (&builder, "{sx}", "contacts", (gint64) priv->completion_n_rows);
+
+	if (priv->completion_timings)
+		g_variant_unref (priv->completion_timings);
+	priv->completion_timings = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+	if (completion_timing_debug_enabled ()) {
+		g_print (
+			"ENameSelectorEntry: '%s' completed in %.1f ms "
+			"(update-model %.1f ms, first-result %.1f ms, "
+			"generate-rows %.1f ms, find-completion %.1f ms), %d contacts\n",
+			cue_str, total / 1000.0,
+			priv->completion_stage_times[COMPLETION_STAGE_UPDATE_MODEL] / 1000.0,
+			priv->completion_stage_times[COMPLETION_STAGE_FIRST_RESULT] / 1000.0,
+			priv->completion_stage_times[COMPLETION_STAGE_GENERATE_ROWS] / 1000.0,
+			priv->completion_stage_times[COMPLETION_STAGE_FIND] / 1000.0,
+			priv->completion_n_rows);
+	}
+
+	g_object_notify (G_OBJECT (name_selector_entry), "completion-timings");
+}
+
 static void
 name_selector_entry_set_property (GObject *object,
                                   guint property_id,
@@ -168,6 +289,13 @@ name_selector_entry_get_property (GObject *object,
 				e_name_selector_entry_get_show_address (
 				E_NAME_SELECTOR_ENTRY (object)));
 			return;
+
+		case PROP_COMPLETION_TIMINGS:
+			g_value_take_variant (
+				value,
+				e_name_selector_entry_ref_completion_timings (
+				E_NAME_SELECTOR_ENTRY (object)));
+			return;
 	}
 
 	G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -217,6 +345,17 @@ name_selector_entry_dispose (GObject *object)
 		priv->known_contacts = NULL;
 	}
 
+	if (priv->completion_index) {
+		g_hash_table_destroy (priv->completion_index);
+		priv->completion_index = NULL;
+	}
+
+	g_clear_pointer (&priv->completion_query_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_name_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_comma_cue, g_free);
+	g_clear_pointer (&priv->completion_timings, g_variant_unref);
+
 	g_slist_foreach (priv->user_query_fields, (GFunc) g_free, NULL);
 	g_slist_free (priv->user_query_fields);
 	priv->user_query_fields = NULL;
@@ -373,6 +512,29 @@ e_name_selector_entry_class_init (ENameSelectorEntryClass *class)
 			G_PARAM_READWRITE |
 			G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * ENameSelectorEntry:completion-timings:
+	 *
+	 * How long the last finished autocompletion took, from the keystroke
+	 * to offering the completion, as an "a{sx}" dictionary of microseconds
+	 * per stage ("update-model", "first-result", "generate-rows",
+	 * "find-completion") and in "total", with the number of received
+	 * "contacts". It is %NULL until the first completion.
+	 *
+	 * Since: 3.26
+	 **/
+	g_object_class_install_property (
+		object_class,
+		PROP_COMPLETION_TIMINGS,
+		g_param_spec_variant (
+			"completion-timings",
+			"Completion Timings",
+			NULL,
+			G_VARIANT_TYPE ("a{sx}"),
+			NULL,
+			G_PARAM_READABLE |
+			G_PARAM_STATIC_STRINGS));
+
 	signals[UPDATED] = g_signal_new (
 		"updated",
 		E_TYPE_NAME_SELECTOR_ENTRY,
@@ -482,6 +644,189 @@ sanitize_string (const gchar *string)
 	return g_string_free (gstring, FALSE);
 }
 
+/* The contact store holds the result of the backend query for the last
+ * cue which could not be answered locally. When the user types further,
+ * the new cue only narrows that result, because every part of the query
+ * is a "beginswith" or a "contains" test. Instead of restarting the views
+ * of all the completion books, the rows are filtered in completion_match_cb()
+ * through a per-contact index of casefolded completion fields. The index
+ * entries are created when the row is first matched and dropped with
+ * the result of the backend query. */
+
+static void
+completion_index_entry_free (gpointer ptr)
+{
+	CompletionIndexEntry *entry = ptr;
+
+	if (entry) {
+		g_free (entry->names);
+		g_free (entry->others);
+		g_free (entry);
+	}
+}
+
+static void
+completion_index_add_name (GString *names,
+                           const gchar *value)
+{
+	gchar *folded, *eol;
+
+	if (!value || !*value)
+		return;
+
+	folded = g_utf8_casefold (value, -1);
+
+	/* The name_style_query() is a "beginswith" test on the whole value,
+	 * thus with the value on its own line it is a simple search for "\n"
+	 * followed by the cue. The cue has no new line characters, thus it
+	 * cannot match past the first line of the value. */
+	eol = strchr (folded, '\n');
+	if (eol)
+		*eol = '\0';
+
+	g_string_append (names, folded);
+	g_string_append_c (names, '\n');
+
+	g_free (folded);
+}
+
+static void
+completion_index_add_other (GString *others,
+                            const gchar *value)
+{
+	gchar *folded;
+
+	if (!value || !*value)
+		return;
+
+	folded = g_utf8_casefold (value, -1);
+	g_string_append (others, folded);
+	g_string_append_c (others, '\n');
+	g_free (folded);
+}
+
+static CompletionIndexEntry *
+completion_index_ref_entry (ENameSelectorEntry *name_selector_entry,
+                            EContact *contact)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+	CompletionIndexEntry *entry;
+	GString *names, *others;
+	GList *emails, *link;
+
+	entry = g_hash_table_lookup (priv->completion_index, contact);
+	if (entry)
+		return entry;
+
+	names = g_string_new ("\n");
+	others = g_string_new ("");
+
+	completion_index_add_name (names, e_contact_get_const (contact, E_CONTACT_FULL_NAME));
+	completion_index_add_name (names, e_contact_get_const (contact, E_CONTACT_FILE_AS));
+	completion_index_add_other (others, e_contact_get_const (contact, E_CONTACT_NICKNAME));
+
+	emails = e_contact_get (contact, E_CONTACT_EMAIL);
+	for (link = emails; link; link = g_list_next (link)) {
+		completion_index_add_other (others, link->data);
+	}
+	deep_free_list (emails);
+
+	entry = g_new0 (CompletionIndexEntry, 1);
+	entry->names = g_string_free (names, FALSE);
+	entry->others = g_string_free (others, FALSE);
+
+	g_hash_table_insert (priv->completion_index, g_object_ref (contact), entry);
+
+	return entry;
+}
+
+static gboolean
+completion_index_match (ENameSelectorEntry *name_selector_entry,
+                        EContact *contact)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+	CompletionIndexEntry *entry;
+
+	if (!priv->completion_filter_cue)
+		return TRUE;
+
+	entry = completion_index_ref_entry (name_selector_entry, contact);
+
+	if (strstr (entry->others, priv->completion_filter_cue))
+		return TRUE;
+
+	if (strstr (entry->names, priv->completion_filter_name_cue))
+		return TRUE;
+
+	return priv->completion_filter_comma_cue &&
+		strstr (entry->names, priv->completion_filter_comma_cue);
+}
+
+static void
+completion_index_clear (ENameSelectorEntry *name_selector_entry)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+
+	if (priv->completion_index)
+		g_hash_table_remove_all (priv->completion_index);
+
+	g_clear_pointer (&priv->completion_query_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_name_cue, g_free);
+	g_clear_pointer (&priv->completion_filter_comma_cue, g_free);
+}
+
+/* Returns whether the rows in the contact store could be narrowed to
+ * the @cue_str, without asking the books. */
+static gboolean
+completion_index_narrow (ENameSelectorEntry *name_selector_entry,
+                         const gchar *cue_str)
+{
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+	gchar *folded, *spaced_str;
+	gchar **strv;
+
+	/* User fields can contain exact matches, which do not narrow */
+	if (!priv->completion_query_cue || priv->user_query_fields)
+		return FALSE;
+
+	folded = g_utf8_casefold (cue_str, -1);
+
+	if (!g_str_has_prefix (folded, priv->completion_query_cue)) {
+		g_free (folded);
+		return FALSE;
+	}
+
+	g_free (priv->completion_filter_cue);
+	g_free (priv->completion_filter_name_cue);
+	g_free (priv->completion_filter_comma_cue);
+
+	priv->completion_filter_cue = folded;
+
+	/* The same forms as name_style_query() uses */
+	spaced_str = sanitize_string (folded);
+	g_strstrip (spaced_str);
+
+	strv = g_strsplit (spaced_str, " ", 0);
+
+	priv->completion_filter_name_cue = g_strconcat ("\n", spaced_str, NULL);
+
+	if (strv[0] && strv[1]) {
+		gchar *comma_str = g_strjoinv (", ", strv);
+
+		g_strstrip (comma_str);
+		priv->completion_filter_comma_cue = g_strconcat ("\n", comma_str, NULL);
+		g_free (comma_str);
+	} else {
+		priv->completion_filter_comma_cue = NULL;
+	}
+
+	g_strfreev (strv);
+	g_free (spaced_str);
+
+	return TRUE;
+}
+
 /* Called for each list store entry whenever the user types (but not on cut/paste) */
 static gboolean
 completion_match_cb (GtkEntryCompletion *completion,
@@ -489,9 +834,27 @@ completion_match_cb (GtkEntryCompletion *completion,
                      GtkTreeIter *iter,
                      gpointer user_data)
 {
+	ENameSelectorEntry *name_selector_entry = user_data;
+	GtkTreeIter contact_store_iter;
+	EContact *contact;
+
 	ENS_DEBUG (g_print ("completion_match_cb, key=%s\n", key));
 
-	return TRUE;
+	if (!name_selector_entry->priv->completion_filter_cue ||
+	    !name_selector_entry->priv->contact_store ||
+	    !name_selector_entry->priv->email_generator)
+		return TRUE;
+
+	if (!e_tree_model_generator_convert_iter_to_child_iter (
+		name_selector_entry->priv->email_generator,
+		&contact_store_iter, NULL, iter))
+		return TRUE;
+
+	contact = e_contact_store_get_contact (name_selector_entry->priv->contact_store, &contact_store_iter);
+	if (!contact)
+		return TRUE;
+
+	return completion_index_match (name_selector_entry, contact);
 }
 
 /* Gets context of n_unichars total (n_unicars / 2, before and after position)
@@ -842,6 +1205,7 @@ set_completion_query (ENameSelectorEntry *name_selector_entry,
 	if (!cue_str) {
 		/* Clear the store */
 		e_contact_store_set_query (name_selector_entry->priv->contact_store, NULL);
+		completion_index_clear (name_selector_entry);
 		return;
 	}
 
@@ -873,10 +1237,15 @@ set_completion_query (ENameSelectorEntry *name_selector_entry,
 	ENS_DEBUG (g_print ("%s\n", query_str));
 
 	book_query = e_book_query_from_string (query_str);
+	priv->completion_query_time = g_get_monotonic_time ();
 	e_contact_store_set_query (name_selector_entry->priv->contact_store, book_query);
 	e_book_query_unref (book_query);
 
 	g_free (query_str);
+
+	/* New result from the books; later keystrokes can narrow it */
+	completion_index_clear (name_selector_entry);
+	priv->completion_query_cue = g_utf8_casefold (cue_str, -1);
 }
 
 static gchar *
@@ -1171,6 +1540,8 @@ type_ahead_complete (ENameSelectorEntry *name_selector_entry)
 	const gchar   *text;
 	gchar         *cue_str;
 	gchar         *temp_str;
+	gint64         started;
+	gboolean       found;
 	ENameSelectorEntryPrivate *priv;
 
 	priv = E_NAME_SELECTOR_ENTRY_GET_PRIVATE (name_selector_entry);
@@ -1188,12 +1559,19 @@ type_ahead_complete (ENameSelectorEntry *name_selector_entry)
 	destination = find_destination_at_position (name_selector_entry, cursor_pos);
 
 	cue_str = get_entry_substring (name_selector_entry, range_start, range_end);
-	if (!find_existing_completion (name_selector_entry, cue_str, &contact,
-				       &textrep, &matched_field, &matched_email_num, &book_client)) {
+	started = g_get_monotonic_time ();
+	found = find_existing_completion (
+		name_selector_entry, cue_str, &contact,
+		&textrep, &matched_field, &matched_email_num, &book_client);
+	completion_timing_add (name_selector_entry, COMPLETION_STAGE_FIND, started);
+
+	if (!found) {
 		g_free (cue_str);
 		return;
 	}
 
+	completion_timing_finish (name_selector_entry, cue_str);
+
 	temp_str = sanitize_string (textrep);
 	g_free (textrep);
 	textrep = temp_str;
@@ -1263,6 +1641,7 @@ clear_completion_model (ENameSelectorEntry *name_selector_entry)
 
 	e_contact_store_set_query (name_selector_entry->priv->contact_store, NULL);
 	g_hash_table_remove_all (name_selector_entry->priv->known_contacts);
+	completion_index_clear (name_selector_entry);
 	priv->is_completing = FALSE;
 }
 
@@ -1281,13 +1660,22 @@ update_completion_model (ENameSelectorEntry *name_selector_entry)
 		get_range_at_position (text, cursor_pos, &range_start, &range_end);
 
 	if (range_end - range_start >= name_selector_entry->priv->minimum_query_length && cursor_pos == range_end) {
+		gint64 started = g_get_monotonic_time ();
 		gchar *cue_str;
 
 		cue_str = get_entry_substring (name_selector_entry, range_start, range_end);
-		set_completion_query (name_selector_entry, cue_str);
-		g_free (cue_str);
 
-		g_hash_table_remove_all (name_selector_entry->priv->known_contacts);
+		if (completion_index_narrow (name_selector_entry, cue_str)) {
+			/* The rows stay, only refilter them */
+			gtk_entry_completion_complete (name_selector_entry->priv->entry_completion);
+		} else {
+			set_completion_query (name_selector_entry, cue_str);
+			g_hash_table_remove_all (name_selector_entry->priv->known_contacts);
+		}
+
+		completion_timing_add (name_selector_entry, COMPLETION_STAGE_UPDATE_MODEL, started);
+
+		g_free (cue_str);
 	} else {
 		/* N/A; Clear completion model */
 		clear_completion_model (name_selector_entry);
@@ -1630,11 +2018,15 @@ user_insert_text (ENameSelectorEntry *name_selector_entry,
 	}
 
 	if (chars_inserted >= 1) {
-		/* If the user inserted one character, kick off completion */
+		completion_timing_start (name_selector_entry);
+
+		/* If the user inserted one character, kick off completion;
+		 * the narrowing of already fetched contacts is cheap, thus
+		 * does not need to wait that long */
 		re_set_timeout (
 			name_selector_entry->priv->update_completions_cb_id,
 			update_completions_on_timeout_cb,  name_selector_entry,
-			AUTOCOMPLETE_TIMEOUT);
+			name_selector_entry->priv->completion_query_cue ? SHOW_RESULT_TIMEOUT : AUTOCOMPLETE_TIMEOUT);
 		re_set_timeout (
 			name_selector_entry->priv->type_ahead_complete_cb_id,
 			type_ahead_complete_on_timeout_cb, name_selector_entry,
@@ -1681,6 +2073,7 @@ user_delete_text (ENameSelectorEntry *name_selector_entry,
 
 	if (end_pos - start_pos == 1) {
 		/* Might be backspace; update completion model so dropdown is accurate */
+		completion_timing_start (name_selector_entry);
 		re_set_timeout (
 			name_selector_entry->priv->update_completions_cb_id,
 			update_completions_on_timeout_cb, name_selector_entry,
@@ -2329,6 +2722,7 @@ generate_contact_rows (EContactStore *contact_store,
 	const gchar *contact_uid;
 	GList       *email_list;
 	gint         n_rows;
+	gint64       started;
 
 	contact = e_contact_store_get_contact (contact_store, iter);
 	g_return_val_if_fail (contact != NULL, 0);
@@ -2337,15 +2731,19 @@ generate_contact_rows (EContactStore *contact_store,
 	if (!contact_uid)
 		return 0;  /* Can happen with broken databases */
 
-	if (is_duplicate_contact_and_remember (name_selector_entry, contact))
-		return 0;
+	started = g_get_monotonic_time ();
 
-	if (e_contact_get (contact, E_CONTACT_IS_LIST))
-		return 1;
+	if (is_duplicate_contact_and_remember (name_selector_entry, contact))
+		n_rows = 0;
+	else if (e_contact_get (contact, E_CONTACT_IS_LIST))
+		n_rows = 1;
+	else {
+		email_list = e_contact_get (contact, E_CONTACT_EMAIL);
+		n_rows = g_list_length (email_list);
+		deep_free_list (email_list);
+	}
 
-	email_list = e_contact_get (contact, E_CONTACT_EMAIL);
-	n_rows = g_list_length (email_list);
-	deep_free_list (email_list);
+	completion_timing_add (name_selector_entry, COMPLETION_STAGE_GENERATE_ROWS, started);
 
 	return n_rows;
 }
@@ -2353,6 +2751,17 @@ generate_contact_rows (EContactStore *contact_store,
 static void
 ensure_type_ahead_complete_on_timeout (ENameSelectorEntry *name_selector_entry)
 {
+	ENameSelectorEntryPrivate *priv = name_selector_entry->priv;
+
+	if (priv->completion_keystroke_time) {
+		if (priv->completion_query_time && !priv->completion_n_rows) {
+			priv->completion_stage_times[COMPLETION_STAGE_FIRST_RESULT] =
+				g_get_monotonic_time () - priv->completion_query_time;
+		}
+
+		priv->completion_n_rows++;
+	}
+
 	/* this is called whenever a new item is added to the model,
 	 * thus, to not starve when there are many matches, do not
 	 * postpone on each add, but show results as soon as possible */
@@ -2367,6 +2776,8 @@ ensure_type_ahead_complete_on_timeout (ENameSelectorEntry *name_selector_entry)
 static void
 setup_contact_store (ENameSelectorEntry *name_selector_entry)
 {
+	completion_index_clear (name_selector_entry);
+
 	if (name_selector_entry->priv->email_generator) {
 		g_object_unref (name_selector_entry->priv->email_generator);
 		name_selector_entry->priv->email_generator = NULL;
@@ -3402,6 +3813,8 @@ e_name_selector_entry_init (ENameSelectorEntry *name_selector_entry)
 	name_selector_entry->priv->minimum_query_length = 3;
 	name_selector_entry->priv->show_address = FALSE;
 	name_selector_entry->priv->known_contacts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	name_selector_entry->priv->completion_index = g_hash_table_new_full (
+		g_direct_hash, g_direct_equal, g_object_unref, completion_index_entry_free);
 
 	/* Edit signals */
 
@@ -3457,7 +3870,7 @@ e_name_selector_entry_init (ENameSelectorEntry *name_selector_entry)
 	name_selector_entry->priv->entry_completion = gtk_entry_completion_new ();
 	gtk_entry_completion_set_match_func (
 		name_selector_entry->priv->entry_completion,
-		(GtkEntryCompletionMatchFunc) completion_match_cb, NULL, NULL);
+		(GtkEntryCompletionMatchFunc) completion_match_cb, name_selector_entry, NULL);
 	g_signal_connect_swapped (
 		name_selector_entry->priv->entry_completion, "match-selected",
 		G_CALLBACK (completion_match_selected), name_selector_entry);
@@ -3653,6 +4066,29 @@ e_name_selector_entry_set_show_address (ENameSelectorEntry *name_selector_entry,
 	g_object_notify (G_OBJECT (name_selector_entry), "show-address");
 }
 
+/**
+ * e_name_selector_entry_ref_completion_timings:
+ * @name_selector_entry: an #ENameSelectorEntry
+ *
+ * Returns how long the last finished autocompletion took, see
+ * #ENameSelectorEntry:completion-timings. Free the returned #GVariant
+ * with g_variant_unref(), when done with it.
+ *
+ * Returns: (transfer full) (nullable): the timings, or %NULL
+ *
+ * Since: 3.26
+ **/
+GVariant *
+e_name_selector_entry_ref_completion_timings (ENameSelectorEntry *name_selector_entry)
+{
+	g_return_val_if_fail (E_IS_NAME_SELECTOR_ENTRY (name_selector_entry), NULL);
+
+	if (!name_selector_entry->priv->completion_timings)
+		return NULL;
+
+	return g_variant_ref (name_selector_entry->priv->completion_timings);
+}
+
 /**
  * e_name_selector_entry_peek_contact_store:
  * @name_selector_entry: an #ENameSelectorEntry
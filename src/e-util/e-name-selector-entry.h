@@ -90,6 +90,8 @@ gboolean	e_name_selector_entry_get_show_address
 void		e_name_selector_entry_set_show_address
 						(ENameSelectorEntry *name_selector_entry,
 						 gboolean show);
+GVariant *	e_name_selector_entry_ref_completion_timings
+						(ENameSelectorEntry *name_selector_entry);
 EContactStore *	e_name_selector_entry_peek_contact_store
 						(ENameSelectorEntry *name_selector_entry);
 void		e_name_selector_entry_set_contact_store
@@ -23,16 +23,20 @@
  * #EPhotoCache finds photos associated with an email address.
  *
  * A limited internal cache is employed to speed up frequently searched
- * email addresses.  The exact caching semantics are private and subject
- * to change.
+ * email addresses.  The cache is kept on disk between sessions and also
+ * remembers, for a limited time, email addresses with no photo.  The exact
+ * caching semantics are private and subject to change.
  **/
 
 #include "e-photo-cache.h"
 
+#include <errno.h>
 #include <string.h>
+#include <glib/gstdio.h>
 #include <libebackend/libebackend.h>
 
 #include <e-util/e-data-capture.h>
+#include <e-util/e-misc-utils.h>
 
 #define E_PHOTO_CACHE_GET_PRIVATE(obj) \
 	(G_TYPE_INSTANCE_GET_PRIVATE \
@@ -43,10 +47,18 @@
 #define ASYNC_TIMEOUT_SECONDS 3.0
 
 /* How many email addresses we track at once, regardless of whether
- * the email address has a photo.  As new cache entries are added, we
- * discard the least recently accessed entries to keep the cache size
- * within the limit. */
-#define MAX_CACHE_SIZE 20
+ * the email address has a photo, when not set in GSettings.  As new
+ * cache entries are added, we discard the least recently accessed
+ * entries to keep the cache size within the limit. */
+#define DEFAULT_CACHE_SIZE 500
+
+/* How long (in seconds) to remember that an email address has no photo,
+ * when not set in GSettings. */
+#define DEFAULT_NEGATIVE_TTL (24 * 60 * 60)
+
+/* How long (in seconds) to use a found photo before asking the photo
+ * sources again, in case it changed, when not set in GSettings. */
+#define DEFAULT_POSITIVE_TTL (7 * 24 * 60 * 60)
 
 #define ERROR_IS_CANCELLED(error) \
 	(g_error_matches ((error), G_IO_ERROR, G_IO_ERROR_CANCELLED))
@@ -54,6 +66,7 @@
 typedef struct _AsyncContext AsyncContext;
 typedef struct _AsyncSubtask AsyncSubtask;
 typedef struct _DataCaptureClosure DataCaptureClosure;
+typedef struct _DiskJob DiskJob;
 typedef struct _PhotoData PhotoData;
 
 struct _EPhotoCachePrivate {
@@ -64,18 +77,39 @@ struct _EPhotoCachePrivate {
 	GQueue photo_ht_keys;
 	GMutex photo_ht_lock;
 
+	/* The on-disk copy of photo_ht.  There is one file per email
+	 * address, named by a checksum of the address, which contains
+	 * the checksum of the photo data, or nothing when the address
+	 * has no photo.  The photo data itself is stored once in the
+	 * "blobs" subdirectory.  The files are read and written only
+	 * by the single thread of the disk_pool, in the order of the
+	 * changes; the blobs_ht is protected by photo_ht_lock. */
+	gchar *cache_dir;
+	GThreadPool *disk_pool;
+	GHashTable *blobs_ht; /* gchar *checksum ~> number of users */
+
+	guint max_cache_size;
+	gint64 negative_ttl;
+	gint64 positive_ttl;
+
 	GHashTable *sources_ht;
 	GMutex sources_ht_lock;
 };
 
 struct _AsyncContext {
 	GMutex lock;
+	gchar *email_address;
 	GTimer *timer;
 	GHashTable *subtasks;
 	GQueue results;
 	GInputStream *stream;
 	GConverter *data_capture;
 
+	/* An entry loaded from the disk cache, its photo data
+	 * is read from the blob_filename in a worker thread */
+	PhotoData *photo_data;
+	gchar *blob_filename;
+
 	GCancellable *cancellable;
 	gulong cancelled_handler_id;
 };
@@ -95,10 +129,43 @@ struct _DataCaptureClosure {
 	gchar *email_address;
 };
 
+typedef enum {
+	DISK_JOB_LOAD,
+	DISK_JOB_WRITE,
+	DISK_JOB_WRITE_BLOB,
+	DISK_JOB_UNLINK
+} DiskJobKind;
+
+typedef struct _DiskEntry {
+	gchar *key;
+	gchar *checksum; /* NULL when no photo */
+	gint64 expires;
+} DiskEntry;
+
+struct _DiskJob {
+	DiskJobKind kind;
+	gchar *filename; /* the cache directory for DISK_JOB_LOAD */
+	gchar *contents; /* for DISK_JOB_WRITE */
+	GBytes *bytes; /* for DISK_JOB_WRITE_BLOB */
+
+	/* For DISK_JOB_LOAD; the loaded entries, the most recent
+	 * first, are added to the photo_cache in its main_context */
+	GWeakRef photo_cache;
+	GMainContext *main_context;
+	gint64 negative_ttl;
+	gint64 positive_ttl;
+	GArray *entries;
+};
+
 struct _PhotoData {
 	volatile gint ref_count;
 	GMutex lock;
 	GBytes *bytes;
+
+	/* These are protected by the photo_ht_lock */
+	gchar *checksum; /* of the photo data, NULL when no photo */
+	gint64 expires; /* real time in seconds */
+	GList *link; /* in the photo_ht_keys */
 };
 
 enum {
@@ -108,6 +175,8 @@ enum {
 
 /* Forward Declarations */
 static void	async_context_cancel_subtasks	(AsyncContext *async_context);
+static void	photo_data_unref		(PhotoData *photo_data);
+static gboolean	photo_ht_loaded_idle_cb		(gpointer user_data);
 
 G_DEFINE_TYPE_WITH_CODE (
 	EPhotoCache,
@@ -276,6 +345,17 @@ async_subtask_complete (AsyncSubtask *async_subtask)
 		}
 
 		async_subtask_unref (async_subtask);
+	} else {
+		EPhotoCache *photo_cache;
+
+		/* None of the photo sources knows this email address,
+		 * remember that, to not ask all of them again soon. */
+		photo_cache = E_PHOTO_CACHE (
+			g_async_result_get_source_object (
+			G_ASYNC_RESULT (simple)));
+		e_photo_cache_add_photo (
+			photo_cache, async_context->email_address, NULL);
+		g_object_unref (photo_cache);
 	}
 
 	g_simple_async_result_complete_in_idle (simple);
@@ -297,13 +377,15 @@ async_context_cancelled_cb (GCancellable *cancellable,
 }
 
 static AsyncContext *
-async_context_new (EDataCapture *data_capture,
+async_context_new (const gchar *email_address,
+                   EDataCapture *data_capture,
                    GCancellable *cancellable)
 {
 	AsyncContext *async_context;
 
 	async_context = g_slice_new0 (AsyncContext);
 	g_mutex_init (&async_context->lock);
+	async_context->email_address = g_strdup (email_address);
 	async_context->timer = g_timer_new ();
 
 	async_context->subtasks = g_hash_table_new_full (
@@ -342,9 +424,14 @@ async_context_free (AsyncContext *async_context)
 
 	g_mutex_clear (&async_context->lock);
 	g_timer_destroy (async_context->timer);
+	g_free (async_context->email_address);
 
 	g_hash_table_destroy (async_context->subtasks);
 
+	if (async_context->photo_data != NULL)
+		photo_data_unref (async_context->photo_data);
+	g_free (async_context->blob_filename);
+
 	g_clear_object (&async_context->stream);
 	g_clear_object (&async_context->data_capture);
 	g_clear_object (&async_context->cancellable);
@@ -448,6 +535,7 @@ photo_data_unref (PhotoData *photo_data)
 		g_mutex_clear (&photo_data->lock);
 		if (photo_data->bytes != NULL)
 			g_bytes_unref (photo_data->bytes);
+		g_free (photo_data->checksum);
 		g_slice_free (PhotoData, photo_data);
 	}
 }
@@ -488,13 +576,439 @@ static gchar *
 photo_ht_normalize_key (const gchar *email_address)
 {
 	gchar *lowercase_email_address;
-	gchar *collation_key;
+	gchar *key;
 
+	/* The key names the file in the cache directory as well,
+	 * thus it should not depend on the current locale. */
 	lowercase_email_address = g_utf8_strdown (email_address, -1);
-	collation_key = g_utf8_collate_key (lowercase_email_address, -1);
+	key = g_compute_checksum_for_string (
+		G_CHECKSUM_SHA1, lowercase_email_address, -1);
 	g_free (lowercase_email_address);
 
-	return collation_key;
+	return key;
+}
+
+/* Checks for a hexadecimal checksum of the given length, like
+ * the file names of the disk cache are */
+static gboolean
+photo_ht_is_checksum (const gchar *name,
+                      gint length)
+{
+	gint ii;
+
+	for (ii = 0; name[ii]; ii++) {
+		if (!g_ascii_isxdigit (name[ii]))
+			return FALSE;
+	}
+
+	return ii == length;
+}
+
+static gchar *
+photo_ht_build_blob_filename (EPhotoCache *photo_cache,
+                              const gchar *checksum)
+{
+	return g_build_filename (
+		photo_cache->priv->cache_dir, "blobs", checksum, NULL);
+}
+
+static DiskJob *
+disk_job_new (DiskJobKind kind,
+              gchar *filename)
+{
+	DiskJob *disk_job;
+
+	disk_job = g_slice_new0 (DiskJob);
+	disk_job->kind = kind;
+	disk_job->filename = filename; /* takes ownership */
+
+	return disk_job;
+}
+
+static void
+disk_job_free (DiskJob *disk_job)
+{
+	g_free (disk_job->filename);
+	g_free (disk_job->contents);
+
+	if (disk_job->bytes != NULL)
+		g_bytes_unref (disk_job->bytes);
+
+	g_weak_ref_set (&disk_job->photo_cache, NULL);
+
+	if (disk_job->main_context != NULL)
+		g_main_context_unref (disk_job->main_context);
+
+	if (disk_job->entries != NULL) {
+		guint ii;
+
+		for (ii = 0; ii < disk_job->entries->len; ii++) {
+			DiskEntry *entry = &g_array_index (disk_job->entries, DiskEntry, ii);
+
+			g_free (entry->key);
+			g_free (entry->checksum);
+		}
+
+		g_array_free (disk_job->entries, TRUE);
+	}
+
+	g_slice_free (DiskJob, disk_job);
+}
+
+/* Takes ownership of the disk_job */
+static void
+photo_cache_push_disk_job (EPhotoCache *photo_cache,
+                           DiskJob *disk_job)
+{
+	if (photo_cache->priv->disk_pool != NULL)
+		g_thread_pool_push (photo_cache->priv->disk_pool, disk_job, NULL);
+	else
+		disk_job_free (disk_job);
+}
+
+static void
+photo_cache_unlink_file (EPhotoCache *photo_cache,
+                         gchar *filename)
+{
+	photo_cache_push_disk_job (
+		photo_cache, disk_job_new (DISK_JOB_UNLINK, filename));
+}
+
+static gint
+disk_entry_compare (gconstpointer a,
+                    gconstpointer b)
+{
+	const DiskEntry *entry_a = a;
+	const DiskEntry *entry_b = b;
+
+	return (entry_a->expires < entry_b->expires) - (entry_a->expires > entry_b->expires);
+}
+
+/* Reads the entries stored by the previous sessions.  Only the keys
+ * and checksums are read, the photo data is read when the email address
+ * is looked up.  Runs in the thread of the disk_pool. */
+static void
+disk_job_load (DiskJob *disk_job)
+{
+	GHashTable *referenced;
+	GDir *dir;
+	GSource *idle_source;
+	gchar *blobs_dir;
+	const gchar *name;
+	gint64 now;
+
+	now = g_get_real_time () / G_USEC_PER_SEC;
+	referenced = g_hash_table_new (g_str_hash, g_str_equal);
+	disk_job->entries = g_array_new (FALSE, FALSE, sizeof (DiskEntry));
+
+	dir = g_dir_open (disk_job->filename, 0, NULL);
+
+	while (dir != NULL && (name = g_dir_read_name (dir)) != NULL) {
+		DiskEntry entry;
+		GStatBuf st;
+		gchar *checksum = NULL;
+		gchar *filename;
+
+		if (!photo_ht_is_checksum (name, 40))
+			continue;
+
+		filename = g_build_filename (disk_job->filename, name, NULL);
+
+		if (g_stat (filename, &st) != 0 ||
+		    !g_file_get_contents (filename, &checksum, NULL, NULL)) {
+			g_free (filename);
+			continue;
+		}
+
+		g_strstrip (checksum);
+
+		if (*checksum)
+			entry.expires = st.st_mtime + disk_job->positive_ttl;
+		else
+			entry.expires = st.st_mtime + disk_job->negative_ttl;
+
+		/* Expired entries, or broken files */
+		if (entry.expires <= now ||
+		    (*checksum && !photo_ht_is_checksum (checksum, 64))) {
+			g_unlink (filename);
+			g_free (filename);
+			g_free (checksum);
+			continue;
+		}
+
+		g_free (filename);
+
+		if (!*checksum) {
+			g_free (checksum);
+			checksum = NULL;
+		}
+
+		entry.key = g_strdup (name);
+		entry.checksum = checksum;
+		g_array_append_val (disk_job->entries, entry);
+
+		if (checksum != NULL)
+			g_hash_table_add (referenced, checksum);
+	}
+
+	if (dir != NULL)
+		g_dir_close (dir);
+
+	/* Remove the photo data no entry refers to.  Those added since
+	 * are written again by the jobs queued after this one. */
+	blobs_dir = g_build_filename (disk_job->filename, "blobs", NULL);
+	dir = g_dir_open (blobs_dir, 0, NULL);
+
+	if (dir != NULL) {
+		while ((name = g_dir_read_name (dir)) != NULL) {
+			if (!g_hash_table_contains (referenced, name)) {
+				gchar *filename;
+
+				filename = g_build_filename (blobs_dir, name, NULL);
+				g_unlink (filename);
+				g_free (filename);
+			}
+		}
+
+		g_dir_close (dir);
+	}
+
+	g_free (blobs_dir);
+	g_hash_table_destroy (referenced);
+
+	/* The most recent first */
+	g_array_sort (disk_job->entries, disk_entry_compare);
+
+	idle_source = g_idle_source_new ();
+	g_source_set_callback (
+		idle_source, photo_ht_loaded_idle_cb,
+		disk_job, (GDestroyNotify) disk_job_free);
+	g_source_attach (idle_source, disk_job->main_context);
+	g_source_unref (idle_source);
+}
+
+static void
+disk_job_run (gpointer data,
+              gpointer user_data)
+{
+	DiskJob *disk_job = data;
+
+	switch (disk_job->kind) {
+		case DISK_JOB_LOAD:
+			/* Freed in the main context */
+			disk_job_load (disk_job);
+			return;
+		case DISK_JOB_WRITE:
+			g_file_set_contents (
+				disk_job->filename,
+				disk_job->contents, -1, NULL);
+			break;
+		case DISK_JOB_WRITE_BLOB:
+			/* The same photo data is stored only once */
+			if (!g_file_test (disk_job->filename, G_FILE_TEST_EXISTS)) {
+				gconstpointer blob_data;
+				gsize size = 0;
+
+				blob_data = g_bytes_get_data (disk_job->bytes, &size);
+				g_file_set_contents (disk_job->filename, blob_data, size, NULL);
+			}
+			break;
+		case DISK_JOB_UNLINK:
+			g_unlink (disk_job->filename);
+			break;
+	}
+
+	disk_job_free (disk_job);
+}
+
+static void
+photo_ht_blob_ref_locked (EPhotoCache *photo_cache,
+                          const gchar *checksum,
+                          GBytes *bytes)
+{
+	GHashTable *blobs_ht;
+	guint n_users;
+
+	blobs_ht = photo_cache->priv->blobs_ht;
+
+	n_users = GPOINTER_TO_UINT (g_hash_table_lookup (blobs_ht, checksum));
+
+	if (n_users == 0 && bytes != NULL && photo_cache->priv->cache_dir) {
+		DiskJob *disk_job;
+
+		disk_job = disk_job_new (
+			DISK_JOB_WRITE_BLOB,
+			photo_ht_build_blob_filename (photo_cache, checksum));
+		disk_job->bytes = g_bytes_ref (bytes);
+
+		photo_cache_push_disk_job (photo_cache, disk_job);
+	}
+
+	g_hash_table_insert (
+		blobs_ht, g_strdup (checksum),
+		GUINT_TO_POINTER (n_users + 1));
+}
+
+static void
+photo_ht_blob_unref_locked (EPhotoCache *photo_cache,
+                            const gchar *checksum)
+{
+	GHashTable *blobs_ht;
+	guint n_users;
+
+	blobs_ht = photo_cache->priv->blobs_ht;
+
+	n_users = GPOINTER_TO_UINT (g_hash_table_lookup (blobs_ht, checksum));
+
+	if (n_users > 1) {
+		g_hash_table_insert (
+			blobs_ht, g_strdup (checksum),
+			GUINT_TO_POINTER (n_users - 1));
+	} else if (n_users == 1) {
+		g_hash_table_remove (blobs_ht, checksum);
+
+		if (photo_cache->priv->cache_dir)
+			photo_cache_unlink_file (
+				photo_cache,
+				photo_ht_build_blob_filename (photo_cache, checksum));
+	}
+}
+
+static void
+photo_ht_write_key_locked (EPhotoCache *photo_cache,
+                           const gchar *key,
+                           PhotoData *photo_data)
+{
+	DiskJob *disk_job;
+
+	if (!photo_cache->priv->cache_dir)
+		return;
+
+	disk_job = disk_job_new (
+		DISK_JOB_WRITE,
+		g_build_filename (photo_cache->priv->cache_dir, key, NULL));
+	disk_job->contents = g_strdup (photo_data->checksum ? photo_data->checksum : "");
+
+	photo_cache_push_disk_job (photo_cache, disk_job);
+}
+
+static gboolean
+photo_ht_remove_locked (EPhotoCache *photo_cache,
+                        const gchar *key,
+                        gboolean remove_file)
+{
+	GHashTable *photo_ht;
+	GQueue *photo_ht_keys;
+	PhotoData *photo_data;
+
+	photo_ht = photo_cache->priv->photo_ht;
+	photo_ht_keys = &photo_cache->priv->photo_ht_keys;
+
+	photo_data = g_hash_table_lookup (photo_ht, key);
+	if (photo_data == NULL)
+		return FALSE;
+
+	if (photo_data->link != NULL) {
+		g_free (photo_data->link->data);
+		g_queue_delete_link (photo_ht_keys, photo_data->link);
+		photo_data->link = NULL;
+	}
+
+	if (photo_data->checksum != NULL)
+		photo_ht_blob_unref_locked (photo_cache, photo_data->checksum);
+
+	if (remove_file && photo_cache->priv->cache_dir)
+		photo_cache_unlink_file (
+			photo_cache,
+			g_build_filename (photo_cache->priv->cache_dir, key, NULL));
+
+	g_hash_table_remove (photo_ht, key);
+
+	return TRUE;
+}
+
+/* Takes ownership of the photo_data */
+static void
+photo_ht_add_locked (EPhotoCache *photo_cache,
+                     const gchar *key,
+                     PhotoData *photo_data)
+{
+	GHashTable *photo_ht;
+	GQueue *photo_ht_keys;
+
+	photo_ht = photo_cache->priv->photo_ht;
+	photo_ht_keys = &photo_cache->priv->photo_ht_keys;
+
+	g_hash_table_insert (photo_ht, g_strdup (key), photo_data);
+
+	/* Push the key to the head of the MRU queue. */
+	g_queue_push_head (photo_ht_keys, g_strdup (key));
+	photo_data->link = g_queue_peek_head_link (photo_ht_keys);
+
+	/* Trim the cache if necessary. */
+	while (g_queue_get_length (photo_ht_keys) > photo_cache->priv->max_cache_size) {
+		gchar *oldest_key;
+
+		oldest_key = g_strdup (g_queue_peek_tail (photo_ht_keys));
+		photo_ht_remove_locked (photo_cache, oldest_key, TRUE);
+		g_free (oldest_key);
+	}
+}
+
+/* Adds the entries read by disk_job_load() after those the current
+ * session already knows about, which are more recent and win. */
+static gboolean
+photo_ht_loaded_idle_cb (gpointer user_data)
+{
+	DiskJob *disk_job = user_data;
+	EPhotoCache *photo_cache;
+	GQueue *photo_ht_keys;
+	guint ii;
+
+	photo_cache = g_weak_ref_get (&disk_job->photo_cache);
+	if (photo_cache == NULL)
+		return FALSE;
+
+	photo_ht_keys = &photo_cache->priv->photo_ht_keys;
+
+	g_mutex_lock (&photo_cache->priv->photo_ht_lock);
+
+	for (ii = 0; ii < disk_job->entries->len; ii++) {
+		DiskEntry *entry = &g_array_index (disk_job->entries, DiskEntry, ii);
+		PhotoData *photo_data;
+
+		if (g_hash_table_contains (photo_cache->priv->photo_ht, entry->key))
+			continue;
+
+		if (g_queue_get_length (photo_ht_keys) >= photo_cache->priv->max_cache_size) {
+			photo_cache_unlink_file (
+				photo_cache,
+				g_build_filename (photo_cache->priv->cache_dir, entry->key, NULL));
+			continue;
+		}
+
+		photo_data = photo_data_new (NULL);
+		photo_data->expires = entry->expires;
+
+		if (entry->checksum != NULL) {
+			photo_data->checksum = entry->checksum;
+			entry->checksum = NULL;
+			photo_ht_blob_ref_locked (photo_cache, photo_data->checksum, NULL);
+		}
+
+		g_hash_table_insert (
+			photo_cache->priv->photo_ht,
+			g_strdup (entry->key), photo_data);
+
+		g_queue_push_tail (photo_ht_keys, g_strdup (entry->key));
+		photo_data->link = g_queue_peek_tail_link (photo_ht_keys);
+	}
+
+	g_mutex_unlock (&photo_cache->priv->photo_ht_lock);
+
+	g_object_unref (photo_cache);
+
+	return FALSE;
 }
 
 static void
@@ -505,6 +1019,7 @@ photo_ht_insert (EPhotoCache *photo_cache,
 	GHashTable *photo_ht;
 	GQueue *photo_ht_keys;
 	PhotoData *photo_data;
+	gint64 now;
 	gchar *key;
 
 	g_return_if_fail (email_address != NULL);
@@ -513,47 +1028,56 @@ photo_ht_insert (EPhotoCache *photo_cache,
 	photo_ht_keys = &photo_cache->priv->photo_ht_keys;
 
 	key = photo_ht_normalize_key (email_address);
+	now = g_get_real_time () / G_USEC_PER_SEC;
 
 	g_mutex_lock (&photo_cache->priv->photo_ht_lock);
 
 	photo_data = g_hash_table_lookup (photo_ht, key);
 
 	if (photo_data != NULL) {
-		GList *link;
-
 		/* Replace the old photo data if we have new photo
 		 * data, otherwise leave the old photo data alone. */
-		if (bytes != NULL)
+		if (bytes != NULL) {
+			gchar *checksum;
+
+			checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+
+			if (g_strcmp0 (checksum, photo_data->checksum) != 0) {
+				photo_ht_blob_ref_locked (photo_cache, checksum, bytes);
+
+				if (photo_data->checksum != NULL)
+					photo_ht_blob_unref_locked (photo_cache, photo_data->checksum);
+
+				g_free (photo_data->checksum);
+				photo_data->checksum = checksum;
+			} else {
+				g_free (checksum);
+			}
+
+			/* Rewritten even when the same, the time of the file
+			 * is when the entry expires in the next sessions */
+			photo_data->expires = now + photo_cache->priv->positive_ttl;
+			photo_ht_write_key_locked (photo_cache, key, photo_data);
+
 			photo_data_set_bytes (photo_data, bytes);
+		}
 
 		/* Move the key to the head of the MRU queue. */
-		link = g_queue_find_custom (
-			photo_ht_keys, key,
-			(GCompareFunc) strcmp);
-		if (link != NULL) {
-			g_queue_unlink (photo_ht_keys, link);
-			g_queue_push_head_link (photo_ht_keys, link);
-		}
+		g_queue_unlink (photo_ht_keys, photo_data->link);
+		g_queue_push_head_link (photo_ht_keys, photo_data->link);
 	} else {
 		photo_data = photo_data_new (bytes);
 
-		g_hash_table_insert (
-			photo_ht, g_strdup (key),
-			photo_data_ref (photo_data));
-
-		/* Push the key to the head of the MRU queue. */
-		g_queue_push_head (photo_ht_keys, g_strdup (key));
-
-		/* Trim the cache if necessary. */
-		while (g_queue_get_length (photo_ht_keys) > MAX_CACHE_SIZE) {
-			gchar *oldest_key;
-
-			oldest_key = g_queue_pop_tail (photo_ht_keys);
-			g_hash_table_remove (photo_ht, oldest_key);
-			g_free (oldest_key);
+		if (bytes != NULL) {
+			photo_data->checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+			photo_data->expires = now + photo_cache->priv->positive_ttl;
+			photo_ht_blob_ref_locked (photo_cache, photo_data->checksum, bytes);
+		} else {
+			photo_data->expires = now + photo_cache->priv->negative_ttl;
 		}
 
-		photo_data_unref (photo_data);
+		photo_ht_write_key_locked (photo_cache, key, photo_data);
+		photo_ht_add_locked (photo_cache, key, photo_data);
 	}
 
 	/* Hash table and queue sizes should be equal at all times. */
@@ -566,20 +1090,29 @@ photo_ht_insert (EPhotoCache *photo_cache,
 	g_free (key);
 }
 
+/* When the entry was loaded from the disk cache, its photo data is not
+ * read here; the out_photo_data and out_blob_filename are set instead,
+ * for photo_cache_read_blob_thread(). */
 static gboolean
 photo_ht_lookup (EPhotoCache *photo_cache,
                  const gchar *email_address,
-                 GInputStream **out_stream)
+                 GInputStream **out_stream,
+                 PhotoData **out_photo_data,
+                 gchar **out_blob_filename)
 {
 	GHashTable *photo_ht;
+	GQueue *photo_ht_keys;
 	PhotoData *photo_data;
 	gboolean found = FALSE;
 	gchar *key;
 
 	g_return_val_if_fail (email_address != NULL, FALSE);
 	g_return_val_if_fail (out_stream != NULL, FALSE);
+	g_return_val_if_fail (out_photo_data != NULL, FALSE);
+	g_return_val_if_fail (out_blob_filename != NULL, FALSE);
 
 	photo_ht = photo_cache->priv->photo_ht;
+	photo_ht_keys = &photo_cache->priv->photo_ht_keys;
 
 	key = photo_ht_normalize_key (email_address);
 
@@ -587,18 +1120,44 @@ photo_ht_lookup (EPhotoCache *photo_cache,
 
 	photo_data = g_hash_table_lookup (photo_ht, key);
 
-	if (photo_data != NULL) {
+	/* Ask the photo sources again after a while, the photo
+	 * could be added or changed since */
+	if (photo_data != NULL &&
+	    photo_data->expires <= g_get_real_time () / G_USEC_PER_SEC) {
+		photo_ht_remove_locked (photo_cache, key, TRUE);
+		photo_data = NULL;
+	}
+
+	if (photo_data != NULL && photo_data->checksum == NULL) {
+		/* The email address has no photo. */
+		*out_stream = NULL;
+		found = TRUE;
+	} else if (photo_data != NULL) {
 		GBytes *bytes;
 
 		bytes = photo_data_ref_bytes (photo_data);
+
 		if (bytes != NULL) {
 			*out_stream =
 				g_memory_input_stream_new_from_bytes (bytes);
 			g_bytes_unref (bytes);
-		} else {
+			found = TRUE;
+		} else if (photo_cache->priv->cache_dir) {
 			*out_stream = NULL;
+			*out_photo_data = photo_data_ref (photo_data);
+			*out_blob_filename = photo_ht_build_blob_filename (
+				photo_cache, photo_data->checksum);
+			found = TRUE;
+		}
+
+		if (found) {
+			/* Move the key to the head of the MRU queue. */
+			g_queue_unlink (photo_ht_keys, photo_data->link);
+			g_queue_push_head_link (photo_ht_keys, photo_data->link);
+		} else {
+			/* The photo data is gone, ask the photo sources. */
+			photo_ht_remove_locked (photo_cache, key, TRUE);
 		}
-		found = TRUE;
 	}
 
 	g_mutex_unlock (&photo_cache->priv->photo_ht_lock);
@@ -615,7 +1174,7 @@ photo_ht_remove (EPhotoCache *photo_cache,
 	GHashTable *photo_ht;
 	GQueue *photo_ht_keys;
 	gchar *key;
-	gboolean removed = FALSE;
+	gboolean removed;
 
 	g_return_val_if_fail (email_address != NULL, FALSE);
 
@@ -626,18 +1185,7 @@ photo_ht_remove (EPhotoCache *photo_cache,
 
 	g_mutex_lock (&photo_cache->priv->photo_ht_lock);
 
-	if (g_hash_table_remove (photo_ht, key)) {
-		GList *link;
-
-		link = g_queue_find_custom (
-			photo_ht_keys, key,
-			(GCompareFunc) strcmp);
-		if (link != NULL) {
-			g_free (link->data);
-			g_queue_delete_link (photo_ht_keys, link);
-			removed = TRUE;
-		}
-	}
+	removed = photo_ht_remove_locked (photo_cache, key, TRUE);
 
 	/* Hash table and queue sizes should be equal at all times. */
 	g_warn_if_fail (
@@ -651,6 +1199,7 @@ photo_ht_remove (EPhotoCache *photo_cache,
 	return removed;
 }
 
+/* Drops the in-memory entries only, the disk cache is kept. */
 static void
 photo_ht_remove_all (EPhotoCache *photo_cache)
 {
@@ -663,6 +1212,7 @@ photo_ht_remove_all (EPhotoCache *photo_cache)
 	g_mutex_lock (&photo_cache->priv->photo_ht_lock);
 
 	g_hash_table_remove_all (photo_ht);
+	g_hash_table_remove_all (photo_cache->priv->blobs_ht);
 
 	while (!g_queue_is_empty (photo_ht_keys))
 		g_free (g_queue_pop_head (photo_ht_keys));
@@ -670,6 +1220,64 @@ photo_ht_remove_all (EPhotoCache *photo_cache)
 	g_mutex_unlock (&photo_cache->priv->photo_ht_lock);
 }
 
+/* Drops the "no photo" entries, both in memory and on the disk,
+ * because a newly added photo source can have a photo for them. */
+static void
+photo_ht_remove_negative (EPhotoCache *photo_cache)
+{
+	GHashTableIter iter;
+	GPtrArray *keys;
+	gpointer key, value;
+	guint ii;
+
+	keys = g_ptr_array_new_with_free_func (g_free);
+
+	g_mutex_lock (&photo_cache->priv->photo_ht_lock);
+
+	g_hash_table_iter_init (&iter, photo_cache->priv->photo_ht);
+
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		PhotoData *photo_data = value;
+
+		if (photo_data->checksum == NULL)
+			g_ptr_array_add (keys, g_strdup (key));
+	}
+
+	for (ii = 0; ii < keys->len; ii++)
+		photo_ht_remove_locked (
+			photo_cache, g_ptr_array_index (keys, ii), TRUE);
+
+	g_mutex_unlock (&photo_cache->priv->photo_ht_lock);
+
+	g_ptr_array_unref (keys);
+}
+
+/* Reads the photo data of an entry loaded from the disk cache */
+static void
+photo_cache_read_blob_thread (GSimpleAsyncResult *simple,
+                              GObject *source_object,
+                              GCancellable *cancellable)
+{
+	AsyncContext *async_context;
+	gchar *contents = NULL;
+	gsize length = 0;
+
+	async_context = g_simple_async_result_get_op_res_gpointer (simple);
+
+	if (g_file_get_contents (async_context->blob_filename, &contents, &length, NULL)) {
+		GBytes *bytes;
+
+		bytes = g_bytes_new_take (contents, length);
+		photo_data_set_bytes (async_context->photo_data, bytes);
+		async_context->stream = g_memory_input_stream_new_from_bytes (bytes);
+		g_bytes_unref (bytes);
+	} else {
+		/* The photo data is gone, the photo sources are asked
+		 * the next time; this time there is no photo. */
+		photo_ht_remove (E_PHOTO_CACHE (source_object), async_context->email_address);
+	}
+}
+
 static void
 photo_cache_data_captured_cb (EDataCapture *data_capture,
                               GBytes *bytes,
@@ -771,10 +1379,17 @@ photo_cache_finalize (GObject *object)
 
 	priv = E_PHOTO_CACHE_GET_PRIVATE (object);
 
+	/* Waits for the pending writes */
+	if (priv->disk_pool != NULL)
+		g_thread_pool_free (priv->disk_pool, FALSE, TRUE);
+
 	g_main_context_unref (priv->main_context);
 
 	g_hash_table_destroy (priv->photo_ht);
 	g_hash_table_destroy (priv->sources_ht);
+	g_hash_table_destroy (priv->blobs_ht);
+
+	g_free (priv->cache_dir);
 
 	g_mutex_clear (&priv->photo_ht_lock);
 	g_mutex_clear (&priv->sources_ht_lock);
@@ -786,6 +1401,64 @@ photo_cache_finalize (GObject *object)
 static void
 photo_cache_constructed (GObject *object)
 {
+	EPhotoCache *photo_cache;
+	GSettings *settings;
+	gchar *cache_dir;
+	gint value;
+
+	photo_cache = E_PHOTO_CACHE (object);
+
+	settings = e_util_ref_settings ("org.gnome.evolution.mail");
+
+	value = g_settings_get_int (settings, "photo-cache-size");
+	photo_cache->priv->max_cache_size = value > 0 ? value : DEFAULT_CACHE_SIZE;
+
+	value = g_settings_get_int (settings, "photo-cache-negative-ttl");
+	photo_cache->priv->negative_ttl = value >= 0 ? value : DEFAULT_NEGATIVE_TTL;
+
+	value = g_settings_get_int (settings, "photo-cache-ttl");
+	photo_cache->priv->positive_ttl = value >= 0 ? value : DEFAULT_POSITIVE_TTL;
+
+	g_object_unref (settings);
+
+	cache_dir = g_build_filename (e_get_user_cache_dir (), "photos", NULL);
+
+	/* Without the disk cache, only the in-memory cache is used */
+	if (g_mkdir_with_parents (cache_dir, 0700) == 0) {
+		gchar *blobs_dir;
+
+		blobs_dir = g_build_filename (cache_dir, "blobs", NULL);
+
+		if (g_mkdir_with_parents (blobs_dir, 0700) == 0)
+			photo_cache->priv->cache_dir = g_strdup (cache_dir);
+		else
+			g_warning ("%s: Failed to create '%s': %s", G_STRFUNC, blobs_dir, g_strerror (errno));
+
+		g_free (blobs_dir);
+	} else {
+		g_warning ("%s: Failed to create '%s': %s", G_STRFUNC, cache_dir, g_strerror (errno));
+	}
+
+	g_free (cache_dir);
+
+	/* One thread, thus the files are changed in the order of the changes */
+	if (photo_cache->priv->cache_dir) {
+		DiskJob *disk_job;
+
+		photo_cache->priv->disk_pool = g_thread_pool_new (
+			disk_job_run, NULL, 1, FALSE, NULL);
+
+		disk_job = disk_job_new (
+			DISK_JOB_LOAD,
+			g_strdup (photo_cache->priv->cache_dir));
+		g_weak_ref_set (&disk_job->photo_cache, photo_cache);
+		disk_job->main_context = g_main_context_ref (photo_cache->priv->main_context);
+		disk_job->negative_ttl = photo_cache->priv->negative_ttl;
+		disk_job->positive_ttl = photo_cache->priv->positive_ttl;
+
+		photo_cache_push_disk_job (photo_cache, disk_job);
+	}
+
 	/* Chain up to parent's constructed() method. */
 	G_OBJECT_CLASS (e_photo_cache_parent_class)->constructed (object);
 
@@ -829,6 +1502,7 @@ e_photo_cache_init (EPhotoCache *photo_cache)
 {
 	GHashTable *photo_ht;
 	GHashTable *sources_ht;
+	GHashTable *blobs_ht;
 
 	photo_ht = g_hash_table_new_full (
 		(GHashFunc) g_str_hash,
@@ -842,10 +1516,20 @@ e_photo_cache_init (EPhotoCache *photo_cache)
 		(GDestroyNotify) g_object_unref,
 		(GDestroyNotify) NULL);
 
+	blobs_ht = g_hash_table_new_full (
+		(GHashFunc) g_str_hash,
+		(GEqualFunc) g_str_equal,
+		(GDestroyNotify) g_free,
+		(GDestroyNotify) NULL);
+
 	photo_cache->priv = E_PHOTO_CACHE_GET_PRIVATE (photo_cache);
 	photo_cache->priv->main_context = g_main_context_ref_thread_default ();
 	photo_cache->priv->photo_ht = photo_ht;
 	photo_cache->priv->sources_ht = sources_ht;
+	photo_cache->priv->blobs_ht = blobs_ht;
+	photo_cache->priv->max_cache_size = DEFAULT_CACHE_SIZE;
+	photo_cache->priv->negative_ttl = DEFAULT_NEGATIVE_TTL;
+	photo_cache->priv->positive_ttl = DEFAULT_POSITIVE_TTL;
 
 	g_mutex_init (&photo_cache->priv->photo_ht_lock);
 	g_mutex_init (&photo_cache->priv->sources_ht_lock);
@@ -894,6 +1578,9 @@ e_photo_cache_ref_client_cache (EPhotoCache *photo_cache)
  * @photo_source: an #EPhotoSource
  *
  * Adds @photo_source as a potential source of photos.
+ *
+ * Cached "no photo" results are discarded, since @photo_source
+ * may be able to provide a photo for those email addresses.
  **/
 void
 e_photo_cache_add_photo_source (EPhotoCache *photo_cache,
@@ -911,6 +1598,8 @@ e_photo_cache_add_photo_source (EPhotoCache *photo_cache,
 	g_hash_table_add (sources_ht, g_object_ref (photo_source));
 
 	g_mutex_unlock (&photo_cache->priv->sources_ht_lock);
+
+	photo_ht_remove_negative (photo_cache);
 }
 
 /**
@@ -993,7 +1682,7 @@ e_photo_cache_remove_photo_source (EPhotoCache *photo_cache,
  *
  * The @bytes argument can also be %NULL to indicate no photo is available for
  * @email_address.  Subsequent photo requests for @email_address will yield no
- * input stream.
+ * input stream, until the entry expires.
  *
  * The entry may be removed without notice however, subject to @photo_cache's
  * internal caching policy.
@@ -1116,7 +1805,7 @@ e_photo_cache_get_photo (EPhotoCache *photo_cache,
 		data_capture_closure_new (photo_cache, email_address),
 		(GClosureNotify) data_capture_closure_free, 0);
 
-	async_context = async_context_new (data_capture, cancellable);
+	async_context = async_context_new (email_address, data_capture, cancellable);
 
 	simple = g_simple_async_result_new (
 		G_OBJECT (photo_cache), callback,
@@ -1128,9 +1817,17 @@ e_photo_cache_get_photo (EPhotoCache *photo_cache,
 		simple, async_context, (GDestroyNotify) async_context_free);
 
 	/* Check if we have this email address already cached. */
-	if (photo_ht_lookup (photo_cache, email_address, &stream)) {
+	if (photo_ht_lookup (photo_cache, email_address, &stream,
+	    &async_context->photo_data, &async_context->blob_filename)) {
 		async_context->stream = stream;  /* takes ownership */
-		g_simple_async_result_complete_in_idle (simple);
+
+		/* Do not block the caller on the disk */
+		if (async_context->blob_filename != NULL)
+			g_simple_async_result_run_in_thread (
+				simple, photo_cache_read_blob_thread,
+				G_PRIORITY_DEFAULT, cancellable);
+		else
+			g_simple_async_result_complete_in_idle (simple);
 		goto exit;
 	}
 
@@ -22,11 +22,26 @@
 #include <string.h>
 #include <camel/camel.h>
 
+/* The vectors of an arena are carved from blocks of this many bytes */
+#define ARENA_BLOCK_SIZE 65536
+
 struct _EPoolv {
+	EPoolvArena *arena;
 	guchar length;
 	const gchar *s[1];
 };
 
+struct _EPoolvArena {
+	GStringChunk *strings;
+
+	/* The first block is the one being carved */
+	GSList *blocks;
+	gsize block_used;
+
+	/* Destroyed vectors, linked through their first string */
+	EPoolv *free_poolvs;
+};
+
 /**
  * e_poolv_new:
  * @size: The number of elements in the poolv, maximum of 254 elements.
@@ -78,6 +93,19 @@ e_poolv_set (EPoolv *poolv,
 	g_return_val_if_fail (poolv != NULL, NULL);
 	g_return_val_if_fail (index >= 0 && index < poolv->length, NULL);
 
+	/* The strings of an arena stay until the arena is freed */
+	if (poolv->arena) {
+		if (str) {
+			poolv->s[index] = g_string_chunk_insert_const (poolv->arena->strings, str);
+			if (freeit)
+				g_free (str);
+		} else {
+			poolv->s[index] = NULL;
+		}
+
+		return poolv;
+	}
+
 	if (!str) {
 		camel_pstring_free (poolv->s[index]);
 		poolv->s[index] = NULL;
@@ -120,6 +148,9 @@ e_poolv_get (EPoolv *poolv,
  *
  * Free a pooled string vector.  This doesn't free the strings from
  * the vector, however.
+ *
+ * A vector from an #EPoolvArena is only returned to the arena, to be
+ * reused by e_poolv_arena_alloc(); its strings stay in the arena.
  **/
 void
 e_poolv_destroy (EPoolv *poolv)
@@ -128,9 +159,113 @@ e_poolv_destroy (EPoolv *poolv)
 
 	g_return_if_fail (poolv != NULL);
 
+	if (poolv->arena) {
+		poolv->s[0] = (const gchar *) poolv->arena->free_poolvs;
+		poolv->arena->free_poolvs = poolv;
+		return;
+	}
+
 	for (ii = 0; ii < poolv->length; ii++) {
 		camel_pstring_free (poolv->s[ii]);
 	}
 
 	g_free (poolv);
 }
+
+/**
+ * e_poolv_arena_new:
+ *
+ * Create a new #EPoolvArena, from which e_poolv_arena_alloc() allocates
+ * pooled string vectors.  Unlike the vectors from e_poolv_new(), which
+ * share a global reference counted pool, the vectors of an arena and
+ * their strings are carved from large blocks, the strings are interned
+ * in a string table of the arena and nothing is freed until the whole
+ * arena is freed with e_poolv_arena_free().
+ *
+ * This is useful for many vectors which all go away at once, such as
+ * the values cached for the messages of a folder.  Since the strings are
+ * never freed on their own, it is not meant for often changing values.
+ *
+ * Returns: a new #EPoolvArena
+ *
+ * Since: 3.26
+ **/
+EPoolvArena *
+e_poolv_arena_new (void)
+{
+	EPoolvArena *arena;
+
+	arena = g_slice_new0 (EPoolvArena);
+	arena->strings = g_string_chunk_new (ARENA_BLOCK_SIZE);
+
+	return arena;
+}
+
+/**
+ * e_poolv_arena_alloc:
+ * @arena: an #EPoolvArena
+ * @size: The number of elements in the poolv, from 1 to 254.
+ *
+ * Allocate a new #EPoolv from the @arena.  It is used the same as the
+ * vectors from e_poolv_new(), except that the strings returned by
+ * e_poolv_get() are valid until the @arena is freed, and that it is
+ * freed with the @arena, thus it can be left without e_poolv_destroy().
+ *
+ * Returns: a new #EPoolv
+ *
+ * Since: 3.26
+ **/
+EPoolv *
+e_poolv_arena_alloc (EPoolvArena *arena,
+                     guint size)
+{
+	EPoolv *poolv;
+	gsize poolv_size;
+
+	g_return_val_if_fail (arena != NULL, NULL);
+	g_return_val_if_fail (size > 0 && size < 255, NULL);
+
+	/* All vectors of an arena tend to have the same size, thus reusing
+	 * only the last destroyed one is enough */
+	poolv = arena->free_poolvs;
+	if (poolv && poolv->length == size) {
+		arena->free_poolvs = (EPoolv *) poolv->s[0];
+	} else {
+		poolv_size = G_STRUCT_OFFSET (EPoolv, s) + size * sizeof (gchar *);
+
+		if (!arena->blocks || arena->block_used + poolv_size > ARENA_BLOCK_SIZE) {
+			arena->blocks = g_slist_prepend (arena->blocks, g_malloc (ARENA_BLOCK_SIZE));
+			arena->block_used = 0;
+		}
+
+		poolv = (EPoolv *) ((gchar *) arena->blocks->data + arena->block_used);
+		arena->block_used += poolv_size;
+
+		poolv->arena = arena;
+		poolv->length = size;
+	}
+
+	memset (poolv->s, 0, size * sizeof (gchar *));
+
+	return poolv;
+}
+
+/**
+ * e_poolv_arena_free:
+ * @arena: an #EPoolvArena
+ *
+ * Free the @arena with all the vectors allocated from it and all their
+ * strings at once.
+ *
+ * Since: 3.26
+ **/
+void
+e_poolv_arena_free (EPoolvArena *arena)
+{
+	g_return_if_fail (arena != NULL);
+
+	g_slist_free_full (arena->blocks, g_free);
+	g_string_chunk_free (arena->strings);
+
+	g_slice_free (EPoolvArena, arena);
+}
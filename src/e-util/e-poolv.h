@@ -29,6 +29,7 @@
 G_BEGIN_DECLS
 
 typedef struct _EPoolv EPoolv;
+typedef struct _EPoolvArena EPoolvArena;
 
 EPoolv *	e_poolv_new			(guint size);
 EPoolv *	e_poolv_set			(EPoolv *poolv,
@@ -39,6 +40,11 @@ const gchar *	e_poolv_get			(EPoolv *poolv,
 						 gint index);
 void		e_poolv_destroy			(EPoolv *poolv);
 
+EPoolvArena *	e_poolv_arena_new		(void);
+EPoolv *	e_poolv_arena_alloc		(EPoolvArena *arena,
+						 guint size);
+void		e_poolv_arena_free		(EPoolvArena *arena);
+
 G_END_DECLS
 
 #endif /* E_POOLV_H */
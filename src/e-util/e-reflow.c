@@ -53,6 +53,9 @@ static void e_reflow_resize_children (GnomeCanvasItem *item);
 #define E_REFLOW_BORDER_WIDTH 7
 #define E_REFLOW_FULL_GUTTER (E_REFLOW_DIVIDER_WIDTH + E_REFLOW_BORDER_WIDTH * 2)
 
+/* How many hidden items to keep for reuse, at least */
+#define E_REFLOW_MIN_SPARE_ITEMS 16
+
 G_DEFINE_TYPE (EReflow, e_reflow, GNOME_TYPE_CANVAS_GROUP)
 
 enum {
@@ -103,7 +106,13 @@ static gint
 er_find_item (EReflow *reflow,
               GnomeCanvasItem *item)
 {
+	gpointer row;
 	gint i;
+
+	if (g_hash_table_lookup_extended (reflow->item_rows, item, NULL, &row))
+		return GPOINTER_TO_INT (row);
+
+	/* Not incarnated by the reflow itself */
 	for (i = 0; i < reflow->count; i++) {
 		if (reflow->items[i] == item)
 			return i;
@@ -111,22 +120,123 @@ er_find_item (EReflow *reflow,
 	return -1;
 }
 
+/* Returns the column the sorted position is in */
+static gint
+er_find_column (EReflow *reflow,
+                gint sorted)
+{
+	gint low = 0, high = reflow->column_count - 1;
+
+	while (low < high) {
+		gint middle = (low + high + 1) / 2;
+
+		if (reflow->columns[middle] <= sorted)
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+static gboolean
+er_get_item_position (EReflow *reflow,
+                      gint row,
+                      gdouble *x,
+                      gdouble *y)
+{
+	gint sorted, column;
+
+	if (!reflow->columns || !reflow->offsets || reflow->need_reflow_columns)
+		return FALSE;
+
+	sorted = e_sorter_model_to_sorted (E_SORTER (reflow->sorter), row);
+	if (sorted < 0 || sorted >= reflow->count)
+		return FALSE;
+
+	column = er_find_column (reflow, sorted);
+
+	*x = E_REFLOW_BORDER_WIDTH + column * (reflow->column_width + E_REFLOW_FULL_GUTTER);
+	*y = E_REFLOW_BORDER_WIDTH + reflow->offsets[sorted] - reflow->offsets[reflow->columns[column]];
+
+	return TRUE;
+}
+
+static void
+er_place_item (EReflow *reflow,
+               gint row,
+               GnomeCanvasItem *item)
+{
+	gdouble x, y;
+
+	if (er_get_item_position (reflow, row, &x, &y))
+		e_canvas_item_move_absolute (item, x, y);
+}
+
+static void
+er_recycle_row (EReflow *reflow,
+                gint row)
+{
+	GnomeCanvasItem *item = reflow->items[row];
+
+	if (!item)
+		return;
+
+	reflow->items[row] = NULL;
+	g_hash_table_remove (reflow->item_rows, item);
+
+	if (reflow->model && E_REFLOW_MODEL_GET_CLASS (reflow->model)->reincarnate &&
+	    reflow->spare_items->len < MAX (g_hash_table_size (reflow->item_rows), E_REFLOW_MIN_SPARE_ITEMS)) {
+		gnome_canvas_item_hide (item);
+		g_ptr_array_add (reflow->spare_items, item);
+	} else {
+		g_object_run_dispose (G_OBJECT (item));
+	}
+}
+
+static void
+er_clear_spare_items (EReflow *reflow)
+{
+	guint ii;
+
+	for (ii = 0; ii < reflow->spare_items->len; ii++)
+		g_object_run_dispose (g_ptr_array_index (reflow->spare_items, ii));
+
+	g_ptr_array_set_size (reflow->spare_items, 0);
+}
+
+/* Shifts the rows of the incarnated items after an insert or a remove */
+static void
+er_shift_item_rows (EReflow *reflow,
+                    gint from_row,
+                    gint delta)
+{
+	GHashTableIter iter;
+	gpointer item, row;
+
+	g_hash_table_iter_init (&iter, reflow->item_rows);
+	while (g_hash_table_iter_next (&iter, &item, &row)) {
+		if (GPOINTER_TO_INT (row) >= from_row)
+			g_hash_table_iter_replace (&iter, GINT_TO_POINTER (GPOINTER_TO_INT (row) + delta));
+	}
+}
+
 static void
 e_reflow_resize_children (GnomeCanvasItem *item)
 {
 	EReflow *reflow;
-	gint i;
-	gint count;
+	GHashTableIter iter;
+	gpointer child;
 
 	reflow = E_REFLOW (item);
 
-	count = reflow->count;
-	for (i = 0; i < count; i++) {
-		if (reflow->items[i])
-			gnome_canvas_item_set (
-				reflow->items[i],
-				"width", (gdouble) reflow->column_width,
-				NULL);
+	/* The spare items get the width when being reused */
+	g_hash_table_iter_init (&iter, reflow->item_rows);
+	while (g_hash_table_iter_next (&iter, &child, NULL)) {
+		gnome_canvas_item_set (
+			child,
+			"width", (gdouble) reflow->column_width,
+			NULL);
 	}
 }
 
@@ -134,30 +244,27 @@ static inline void
 e_reflow_update_selection_row (EReflow *reflow,
                                gint row)
 {
+	/* The rows out of the view get their state when incarnated */
 	if (reflow->items[row]) {
 		g_object_set (
 			reflow->items[row],
 			"selected", e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), row),
 			NULL);
-	} else if (e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), row)) {
-		reflow->items[row] = e_reflow_model_incarnate (reflow->model, row, GNOME_CANVAS_GROUP (reflow));
-		g_object_set (
-			reflow->items[row],
-			"selected", e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), row),
-			"width", (gdouble) reflow->column_width,
-			NULL);
 	}
 }
 
 static void
 e_reflow_update_selection (EReflow *reflow)
 {
-	gint i;
-	gint count;
+	GHashTableIter iter;
+	gpointer item, row;
 
-	count = reflow->count;
-	for (i = 0; i < count; i++) {
-		e_reflow_update_selection_row (reflow, i);
+	g_hash_table_iter_init (&iter, reflow->item_rows);
+	while (g_hash_table_iter_next (&iter, &item, &row)) {
+		g_object_set (
+			item,
+			"selected", e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), GPOINTER_TO_INT (row)),
+			NULL);
 	}
 }
 
@@ -196,10 +303,11 @@ do_adjustment (gpointer user_data)
 	value = gtk_adjustment_get_value (adjustment);
 	page_size = gtk_adjustment_get_page_size (adjustment);
 
-	if ((!reflow->items) || (!reflow->items[row]))
+	/* Wait for the columns reflow */
+	if (!er_get_item_position (reflow, row, &min_value, &max_value))
 		return TRUE;
-	min_value = reflow->items[row]->x2 - page_size;
-	max_value = reflow->items[row]->x1;
+	max_value = min_value;
+	min_value = max_value + reflow->column_width - page_size;
 
 	if (value < min_value)
 		value = min_value;
@@ -236,17 +344,13 @@ cursor_changed (ESelectionModel *selection,
 	reflow->cursor_row = row;
 
 	if (row < count && row >= 0) {
-		if (reflow->items[row]) {
-			g_object_set (
-				reflow->items[row],
-				"has_cursor", TRUE,
-				NULL);
-		} else {
-			reflow->items[row] = e_reflow_model_incarnate (reflow->model, row, GNOME_CANVAS_GROUP (reflow));
+		GnomeCanvasItem *item;
+
+		item = e_reflow_incarnate_row (reflow, row);
+		if (item) {
 			g_object_set (
-				reflow->items[row],
+				item,
 				"has_cursor", TRUE,
-				"width", (gdouble) reflow->column_width,
 				NULL);
 		}
 	}
@@ -267,9 +371,18 @@ incarnate (EReflow *reflow)
 	gint i;
 	GtkLayout *layout;
 	GtkAdjustment *adjustment;
+	GnomeCanvasItem *focused_item;
+	GHashTableIter iter;
+	GArray *recycle;
+	gpointer item, row;
 	gdouble value;
 	gdouble page_size;
 
+	reflow->incarnate_idle_id = 0;
+
+	if (!reflow->columns || !reflow->model)
+		return;
+
 	layout = GTK_LAYOUT (GNOME_CANVAS_ITEM (reflow)->canvas);
 	adjustment = gtk_scrollable_get_hadjustment (GTK_SCROLLABLE (layout));
 
@@ -295,20 +408,33 @@ incarnate (EReflow *reflow)
 	else
 		last_cell = reflow->count;
 
+	/* Hide the items scrolled out of the view first, to reuse them
+	 * for the rows scrolled in; keep the one with the cursor and
+	 * the one with the focus. */
+	focused_item = GNOME_CANVAS_ITEM (reflow)->canvas->focused_item;
+	recycle = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	g_hash_table_iter_init (&iter, reflow->item_rows);
+	while (g_hash_table_iter_next (&iter, &item, &row)) {
+		gint model_row = GPOINTER_TO_INT (row);
+		gint sorted = e_sorter_model_to_sorted (E_SORTER (reflow->sorter), model_row);
+
+		if ((sorted < first_cell || sorted >= last_cell) &&
+		    model_row != reflow->cursor_row && item != focused_item)
+			g_array_append_val (recycle, model_row);
+	}
+
+	for (i = 0; i < recycle->len; i++)
+		er_recycle_row (reflow, g_array_index (recycle, gint, i));
+
+	g_array_free (recycle, TRUE);
+
 	for (i = first_cell; i < last_cell; i++) {
 		gint unsorted = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), i);
-		if (reflow->items[unsorted] == NULL) {
-			if (reflow->model) {
-				reflow->items[unsorted] = e_reflow_model_incarnate (reflow->model, unsorted, GNOME_CANVAS_GROUP (reflow));
-				g_object_set (
-					reflow->items[unsorted],
-					"selected", e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), unsorted),
-					"width", (gdouble) reflow->column_width,
-					NULL);
-			}
-		}
+
+		if (reflow->items[unsorted] == NULL)
+			e_reflow_incarnate_row (reflow, unsorted);
 	}
-	reflow->incarnate_idle_id = 0;
 }
 
 static gboolean
@@ -330,16 +456,13 @@ queue_incarnate (EReflow *reflow)
 static void
 reflow_columns (EReflow *reflow)
 {
-	GSList *list;
-	gint count;
 	gint start;
 	gint i;
 	gint column_count, column_start;
-	gdouble running_height;
+	gint limit;
 
-	if (reflow->reflow_from_column <= 1) {
+	if (reflow->reflow_from_column <= 1 || reflow->reflow_from_column > reflow->column_count || !reflow->offsets) {
 		start = 0;
-		column_count = 1;
 		column_start = 0;
 	}
 	else {
@@ -348,37 +471,59 @@ reflow_columns (EReflow *reflow)
 		 * inserted at the start of the column */
 		column_start = reflow->reflow_from_column - 1;
 		start = reflow->columns[column_start];
-		column_count = column_start + 1;
 	}
 
-	list = NULL;
+	/* The heights before the start did not change */
+	reflow->offsets = g_renew (gint, reflow->offsets, reflow->count + 1);
+	if (start == 0)
+		reflow->offsets[0] = 0;
 
-	running_height = E_REFLOW_BORDER_WIDTH;
-
-	count = reflow->count - start;
-	for (i = start; i < count; i++) {
+	for (i = start; i < reflow->count; i++) {
 		gint unsorted = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), i);
-		if (i != 0 && running_height + reflow->heights[unsorted] + E_REFLOW_BORDER_WIDTH > reflow->height) {
-			list = g_slist_prepend (list, GINT_TO_POINTER (i));
-			column_count++;
-			running_height = E_REFLOW_BORDER_WIDTH * 2 + reflow->heights[unsorted];
-		} else
-			running_height += reflow->heights[unsorted] + E_REFLOW_BORDER_WIDTH;
-	}
 
-	reflow->column_count = column_count;
-	reflow->columns = g_renew (int, reflow->columns, column_count);
-	column_count--;
-
-	for (; list && column_count > column_start; column_count--) {
-		GSList *to_free;
-		reflow->columns[column_count] = GPOINTER_TO_INT (list->data);
-		to_free = list;
-		list = list->next;
-		g_slist_free_1 (to_free);
+		reflow->offsets[i + 1] = reflow->offsets[i] + reflow->heights[unsorted] + E_REFLOW_BORDER_WIDTH;
 	}
+
+	/* Each column ends before the first item, which does not fit
+	 * in the height; the offsets are sorted, thus binary search it */
+	column_count = column_start + 1;
+	reflow->columns = g_renew (gint, reflow->columns, MAX (column_count, reflow->column_count));
 	reflow->columns[column_start] = start;
 
+	while (start < reflow->count) {
+		gint low, high;
+
+		limit = reflow->offsets[start] + reflow->height - E_REFLOW_BORDER_WIDTH;
+
+		/* The first sorted position with the end over the limit */
+		low = start + 1;
+		high = reflow->count + 1;
+		while (low < high) {
+			gint middle = (low + high) / 2;
+
+			if (reflow->offsets[middle] > limit)
+				high = middle;
+			else
+				low = middle + 1;
+		}
+
+		if (low > reflow->count)
+			break;
+
+		/* The item on the top of a column always stays there,
+		 * even when it is higher than the column */
+		start = MAX (low - 1, start + 1);
+		if (start >= reflow->count)
+			break;
+
+		column_count++;
+		reflow->columns = g_renew (gint, reflow->columns, column_count);
+		reflow->columns[column_count - 1] = start;
+	}
+
+	reflow->column_count = column_count;
+	reflow->columns = g_renew (gint, reflow->columns, column_count);
+
 	queue_incarnate (reflow);
 
 	reflow->need_reflow_columns = FALSE;
@@ -426,8 +571,8 @@ item_removed (EReflowModel *model,
 		}
 	}
 
-	if (reflow->items[i])
-		g_object_run_dispose (G_OBJECT (reflow->items[i]));
+	er_recycle_row (reflow, i);
+	er_shift_item_rows (reflow, i + 1, -1);
 
 	memmove (reflow->heights + i, reflow->heights + i + 1, (reflow->count - i - 1) * sizeof (gint));
 	memmove (reflow->items + i, reflow->items + i + 1, (reflow->count - i - 1) * sizeof (GnomeCanvasItem *));
@@ -467,6 +612,7 @@ items_inserted (EReflowModel *model,
 		reflow->heights = g_renew (int, reflow->heights, reflow->allocated_count);
 		reflow->items = g_renew (GnomeCanvasItem *, reflow->items, reflow->allocated_count);
 	}
+	er_shift_item_rows (reflow, position, count);
 	memmove (reflow->heights + position + count, reflow->heights + position, (reflow->count - position - count) * sizeof (gint));
 	memmove (reflow->items + position + count, reflow->items + position, (reflow->count - position - count) * sizeof (GnomeCanvasItem *));
 	for (i = position; i < position + count; i++) {
@@ -513,6 +659,8 @@ model_changed (EReflowModel *model,
 	count = reflow->count;
 	oldcount = count;
 
+	g_hash_table_remove_all (reflow->item_rows);
+	er_clear_spare_items (reflow);
 	for (i = 0; i < count; i++) {
 		if (reflow->items[i])
 			g_object_run_dispose (G_OBJECT (reflow->items[i]));
@@ -616,6 +764,7 @@ disconnect_model (EReflow *reflow)
 	g_signal_handler_disconnect (
 		reflow->model,
 		reflow->model_item_changed_id);
+	er_clear_spare_items (reflow);
 	g_object_unref (reflow->model);
 
 	reflow->model_changed_id = 0;
@@ -874,10 +1023,12 @@ e_reflow_dispose (GObject *object)
 	g_free (reflow->items);
 	g_free (reflow->heights);
 	g_free (reflow->columns);
+	g_free (reflow->offsets);
 
 	reflow->items = NULL;
 	reflow->heights = NULL;
 	reflow->columns = NULL;
+	reflow->offsets = NULL;
 	reflow->count = 0;
 	reflow->allocated_count = 0;
 
@@ -892,6 +1043,10 @@ e_reflow_dispose (GObject *object)
 	disconnect_model (reflow);
 	disconnect_selection (reflow);
 
+	/* The items themselves are destroyed with the group */
+	g_clear_pointer (&reflow->item_rows, g_hash_table_destroy);
+	g_clear_pointer (&reflow->spare_items, g_ptr_array_unref);
+
 	g_free (reflow->empty_message);
 	reflow->empty_message = NULL;
 
@@ -911,8 +1066,6 @@ e_reflow_realize (GnomeCanvasItem *item)
 	gdouble page_increment;
 	gdouble step_increment;
 	gdouble page_size;
-	gint count;
-	gint i;
 
 	reflow = E_REFLOW (item);
 
@@ -922,14 +1075,7 @@ e_reflow_realize (GnomeCanvasItem *item)
 	reflow->arrow_cursor = gdk_cursor_new (GDK_SB_H_DOUBLE_ARROW);
 	reflow->default_cursor = gdk_cursor_new (GDK_LEFT_PTR);
 
-	count = reflow->count;
-	for (i = 0; i < count; i++) {
-		if (reflow->items[i])
-			gnome_canvas_item_set (
-				reflow->items[i],
-				"width", reflow->column_width,
-				NULL);
-	}
+	e_reflow_resize_children (item);
 
 	set_empty (reflow);
 
@@ -961,7 +1107,9 @@ e_reflow_unrealize (GnomeCanvasItem *item)
 	reflow->default_cursor = NULL;
 
 	g_free (reflow->columns);
+	g_free (reflow->offsets);
 	reflow->columns = NULL;
+	reflow->offsets = NULL;
 
 	disconnect_set_adjustment (reflow);
 	disconnect_adjustment (reflow);
@@ -1457,11 +1605,9 @@ e_reflow_reflow (GnomeCanvasItem *item,
                  gint flags)
 {
 	EReflow *reflow = E_REFLOW (item);
+	GHashTableIter iter;
+	gpointer child, row;
 	gdouble old_width;
-	gdouble running_width;
-	gdouble running_height;
-	gint next_column;
-	gint i;
 
 	if (!(item->flags & GNOME_CANVAS_ITEM_REALIZED))
 		return;
@@ -1472,28 +1618,13 @@ e_reflow_reflow (GnomeCanvasItem *item,
 
 	old_width = reflow->width;
 
-	running_width = E_REFLOW_BORDER_WIDTH;
-	running_height = E_REFLOW_BORDER_WIDTH;
-
-	next_column = 1;
-
-	for (i = 0; i < reflow->count; i++) {
-		gint unsorted = e_sorter_sorted_to_model (E_SORTER (reflow->sorter), i);
-		if (next_column < reflow->column_count && i == reflow->columns[next_column]) {
-			running_height = E_REFLOW_BORDER_WIDTH;
-			running_width += reflow->column_width + E_REFLOW_FULL_GUTTER;
-			next_column++;
-		}
+	/* Only the items in the view are incarnated */
+	g_hash_table_iter_init (&iter, reflow->item_rows);
+	while (g_hash_table_iter_next (&iter, &child, &row))
+		er_place_item (reflow, GPOINTER_TO_INT (row), child);
 
-		if (unsorted >= 0 && reflow->items[unsorted]) {
-			e_canvas_item_move_absolute (
-				GNOME_CANVAS_ITEM (reflow->items[unsorted]),
-				(gdouble) running_width,
-				(gdouble) running_height);
-			running_height += reflow->heights[unsorted] + E_REFLOW_BORDER_WIDTH;
-		}
-	}
-	reflow->width = running_width + reflow->column_width + E_REFLOW_BORDER_WIDTH;
+	reflow->width = E_REFLOW_BORDER_WIDTH + MAX (reflow->column_count - 1, 0) * (reflow->column_width + E_REFLOW_FULL_GUTTER) +
+		reflow->column_width + E_REFLOW_BORDER_WIDTH;
 	if (reflow->width < reflow->minimum_width)
 		reflow->width = reflow->minimum_width;
 	if (reflow->empty_text) {
@@ -1676,6 +1807,10 @@ e_reflow_init (EReflow *reflow)
 
 	reflow->columns = NULL;
 	reflow->column_count = 0;
+	reflow->offsets = NULL;
+
+	reflow->item_rows = g_hash_table_new (g_direct_hash, g_direct_equal);
+	reflow->spare_items = g_ptr_array_new ();
 
 	reflow->empty_text = NULL;
 	reflow->empty_message = NULL;
@@ -1727,3 +1862,69 @@ e_reflow_init (EReflow *reflow)
 
 	e_canvas_item_set_reflow_callback (GNOME_CANVAS_ITEM (reflow), e_reflow_reflow);
 }
+
+/**
+ * e_reflow_incarnate_row:
+ * @reflow: an #EReflow
+ * @row: a model row
+ *
+ * Makes sure the @row has its canvas item, reusing one of the items
+ * scrolled out of the view when possible. The item is not guaranteed
+ * to be kept once it is out of the view again, unless it has the cursor
+ * or the focus.
+ *
+ * Returns: (transfer none) (nullable): the canvas item for the @row
+ **/
+GnomeCanvasItem *
+e_reflow_incarnate_row (EReflow *reflow,
+                        gint row)
+{
+	GnomeCanvasItem *item;
+
+	g_return_val_if_fail (E_IS_REFLOW (reflow), NULL);
+
+	if (row < 0 || row >= reflow->count || !reflow->model)
+		return NULL;
+
+	if (reflow->items[row])
+		return reflow->items[row];
+
+	if (reflow->spare_items->len > 0) {
+		item = g_ptr_array_remove_index_fast (reflow->spare_items, reflow->spare_items->len - 1);
+		e_reflow_model_reincarnate (reflow->model, row, item);
+		gnome_canvas_item_show (item);
+	} else {
+		item = e_reflow_model_incarnate (reflow->model, row, GNOME_CANVAS_GROUP (reflow));
+		if (!item)
+			return NULL;
+	}
+
+	reflow->items[row] = item;
+	g_hash_table_insert (reflow->item_rows, item, GINT_TO_POINTER (row));
+
+	g_object_set (
+		item,
+		"selected", e_selection_model_is_row_selected (E_SELECTION_MODEL (reflow->selection), row),
+		"width", (gdouble) reflow->column_width,
+		NULL);
+
+	er_place_item (reflow, row, item);
+
+	return item;
+}
+
+/**
+ * e_reflow_get_item_row:
+ * @reflow: an #EReflow
+ * @item: a #GnomeCanvasItem
+ *
+ * Returns: the model row the @item is incarnated for, or -1
+ **/
+gint
+e_reflow_get_item_row (EReflow *reflow,
+                       GnomeCanvasItem *item)
+{
+	g_return_val_if_fail (E_IS_REFLOW (reflow), -1);
+
+	return er_find_item (reflow, item);
+}
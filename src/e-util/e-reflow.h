@@ -87,6 +87,16 @@ struct _EReflow {
 	gint *columns;
 	gint column_count; /* Number of columnns */
 
+	/* Sum of the item heights with the borders up to each sorted
+	 * position; count + 1 long, valid after the columns reflow. */
+	gint *offsets;
+
+	/* Incarnated items, GnomeCanvasItem * ~> model row; only those
+	 * in the view, with the cursor or the focus are kept, the others
+	 * are hidden in the spare_items, to be reused for other rows. */
+	GHashTable *item_rows;
+	GPtrArray *spare_items;
+
 	GnomeCanvasItem *empty_text;
 	gchar *empty_message;
 
@@ -138,6 +148,11 @@ struct _EReflowClass
  * changes.
  */
 GType    e_reflow_get_type       (void) G_GNUC_CONST;
+GnomeCanvasItem *
+	 e_reflow_incarnate_row  (EReflow *reflow,
+				  gint row);
+gint     e_reflow_get_item_row   (EReflow *reflow,
+				  GnomeCanvasItem *item);
 
 G_END_DECLS
 
@@ -44,6 +44,7 @@
 #include "e-cell.h"
 #include "e-marshal.h"
 #include "e-table-subset.h"
+#include "e-table-trace.h"
 #include "gal-a11y-e-table-item-factory.h"
 #include "gal-a11y-e-table-item.h"
 
@@ -70,6 +71,14 @@ typedef struct _ETableItemPrivate ETableItemPrivate;
 
 struct _ETableItemPrivate {
 	GSource *show_cursor_delay_source;
+
+	/* Fenwick tree of the row heights, including the separator line,
+	 * indexed from 1; the rows not measured yet count with the
+	 * height_estimate, see height_index_ensure() */
+	gint *height_index;
+	gint height_index_rows;
+	gint height_index_extra;
+	gint height_estimate; /* -1 when not known */
 };
 
 static void eti_check_cursor_bounds (ETableItem *eti);
@@ -716,26 +725,114 @@ confirm_height_cache (ETableItem *eti)
 	}
 }
 
+static void
+height_index_free (ETableItem *eti)
+{
+	ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+
+	g_free (priv->height_index);
+	priv->height_index = NULL;
+	priv->height_index_rows = 0;
+}
+
+/* Builds the index of the row heights, when it is not valid; the rows
+ * are measured only when shown, the rest is estimated by the height
+ * of the first row. Returns FALSE when there is nothing to index. */
 static gboolean
-height_cache_idle (ETableItem *eti)
+height_index_ensure (ETableItem *eti)
 {
-	gint changed = 0;
-	gint i;
+	ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+	gint height_extra = eti->horizontal_draw_grid ? 1 : 0;
+	gint *index;
+	gint ii, rows = eti->rows;
+
+	if (eti->uniform_row_height || rows <= 0)
+		return FALSE;
+
+	if (priv->height_index &&
+	    priv->height_index_rows == rows &&
+	    priv->height_index_extra == height_extra)
+		return TRUE;
+
+	height_index_free (eti);
 	confirm_height_cache (eti);
-	for (i = eti->height_cache_idle_count; i < eti->rows; i++) {
-		if (eti->height_cache[i] == -1) {
-			eti_row_height (eti, i);
-			changed++;
-			if (changed >= 20)
-				break;
-		}
+
+	if (priv->height_estimate == -1)
+		priv->height_estimate = eti_row_height (eti, 0);
+
+	/* Each node adds itself to its parent, which makes it linear */
+	index = g_new0 (gint, rows + 1);
+	for (ii = 1; ii <= rows; ii++) {
+		gint parent = ii + (ii & (-ii));
+
+		if (eti->height_cache[ii - 1] != -1)
+			index[ii] += eti->height_cache[ii - 1] + height_extra;
+		else
+			index[ii] += priv->height_estimate + height_extra;
+
+		if (parent <= rows)
+			index[parent] += index[ii];
 	}
-	if (changed >= 20) {
-		eti->height_cache_idle_count = i;
-		return TRUE;
+
+	priv->height_index = index;
+	priv->height_index_rows = rows;
+	priv->height_index_extra = height_extra;
+
+	return TRUE;
+}
+
+static void
+height_index_add (ETableItem *eti,
+                  gint row,
+                  gint delta)
+{
+	ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+	gint ii;
+
+	if (!priv->height_index || priv->height_index_rows != eti->rows) {
+		height_index_free (eti);
+		return;
 	}
-	eti->height_cache_idle_id = 0;
-	return FALSE;
+
+	for (ii = row + 1; ii <= priv->height_index_rows; ii += ii & (-ii))
+		priv->height_index[ii] += delta;
+}
+
+/* The sum of the heights of the rows before the row */
+static gint
+height_index_prefix (ETableItem *eti,
+                     gint row)
+{
+	ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+	gint ii, sum = 0;
+
+	for (ii = MIN (row, priv->height_index_rows); ii > 0; ii -= ii & (-ii))
+		sum += priv->height_index[ii];
+
+	return sum;
+}
+
+/* Returns the row at the y, counted from the top of the first row,
+ * or eti->rows when the y is below the last row */
+static gint
+height_index_find (ETableItem *eti,
+                   gint y)
+{
+	ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+	gint pos = 0, step = 1;
+
+	while (step * 2 <= priv->height_index_rows)
+		step *= 2;
+
+	for (; step > 0; step /= 2) {
+		if (pos + step <= priv->height_index_rows &&
+		    priv->height_index[pos + step] <= y) {
+			pos += step;
+			y -= priv->height_index[pos];
+		}
+	}
+
+	return pos;
 }
 
 static void
@@ -746,19 +843,15 @@ free_height_cache (ETableItem *eti)
 	item = GNOME_CANVAS_ITEM (eti);
 
 	if (item->flags & GNOME_CANVAS_ITEM_REALIZED) {
+		ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+
 		if (eti->height_cache)
 			g_free (eti->height_cache);
 		eti->height_cache = NULL;
-		eti->height_cache_idle_count = 0;
 		eti->uniform_row_height_cache = -1;
 
-		if (eti->uniform_row_height && eti->height_cache_idle_id != 0) {
-			g_source_remove (eti->height_cache_idle_id);
-			eti->height_cache_idle_id = 0;
-		}
-
-		if ((!eti->uniform_row_height) && eti->height_cache_idle_id == 0)
-			eti->height_cache_idle_id = g_idle_add_full (G_PRIORITY_LOW, (GSourceFunc) height_cache_idle, eti, NULL);
+		height_index_free (eti);
+		priv->height_estimate = -1;
 	}
 }
 
@@ -787,11 +880,18 @@ eti_row_height (ETableItem *eti,
 			calculate_height_cache (eti);
 		}
 		if (eti->height_cache[row] == -1) {
+			ETableItemPrivate *priv = E_TABLE_ITEM_GET_PRIVATE (eti);
+
 			eti->height_cache[row] = eti_row_height_real (eti, row);
+
+			if (priv->height_index)
+				height_index_add (eti, row, eti->height_cache[row] - priv->height_estimate);
+
+			/* The height of the large tables is estimated */
 			if (row > 0 &&
 			    eti->length_threshold != -1 &&
 			    eti->rows > eti->length_threshold &&
-			    eti->height_cache[row] != eti_row_height (eti, 0)) {
+			    eti->height_cache[row] != priv->height_estimate) {
 				eti->needs_compute_height = 1;
 				e_canvas_item_request_reflow (GNOME_CANVAS_ITEM (eti));
 			}
@@ -800,6 +900,27 @@ eti_row_height (ETableItem *eti,
 	}
 }
 
+/* Measures the row again, after its content changed, and
+ * returns whether its height changed */
+static gboolean
+eti_remeasure_row (ETableItem *eti,
+                   gint row)
+{
+	gint height;
+
+	if (eti->uniform_row_height || !eti->height_cache || eti->height_cache[row] == -1)
+		return FALSE;
+
+	height = eti_row_height_real (eti, row);
+	if (height == eti->height_cache[row])
+		return FALSE;
+
+	height_index_add (eti, row, height - eti->height_cache[row]);
+	eti->height_cache[row] = height;
+
+	return TRUE;
+}
+
 /*
  * eti_get_height:
  *
@@ -810,7 +931,7 @@ eti_row_height (ETableItem *eti,
  * many rows in the table that performing the previous step could take
  * too long) set by the ETableItem->length_threshold that would determine
  * when the height is computed by using the first row as the size for
- * every other row in the ETableItem.
+ * every row not shown yet in the ETableItem.
  */
 static gint
 eti_get_height (ETableItem *eti)
@@ -825,36 +946,19 @@ eti_get_height (ETableItem *eti)
 		gint row_height = ETI_ROW_HEIGHT (eti, -1);
 		return ((row_height + height_extra) * rows + height_extra);
 	} else {
-		gint height;
 		gint row;
-		if (eti->length_threshold != -1) {
-			if (rows > eti->length_threshold) {
-				gint row_height = ETI_ROW_HEIGHT (eti, 0);
-				if (eti->height_cache) {
-					height = 0;
-					for (row = 0; row < rows; row++) {
-						if (eti->height_cache[row] == -1) {
-							height += (row_height + height_extra) * (rows - row);
-							break;
-						}
-						else
-							height += eti->height_cache[row] + height_extra;
-					}
-				} else
-					height = (ETI_ROW_HEIGHT (eti, 0) + height_extra) * rows;
 
-				/*
-				 * 1 pixel at the top
-				 */
-				return height + height_extra;
+		if (eti->length_threshold == -1 || rows <= eti->length_threshold) {
+			for (row = 0; row < rows; row++) {
+				if (!eti->height_cache || eti->height_cache[row] == -1)
+					eti_row_height (eti, row);
 			}
 		}
 
-		height = height_extra;
-		for (row = 0; row < rows; row++)
-			height += ETI_ROW_HEIGHT (eti, row) + height_extra;
-
-		return height;
+		/*
+		 * 1 pixel at the top
+		 */
+		return e_table_item_row_diff (eti, 0, rows) + height_extra;
 	}
 }
 
@@ -898,12 +1002,10 @@ e_table_item_row_diff (ETableItem *eti,
 	if (eti->uniform_row_height) {
 		return ((end_row - start_row) * (ETI_ROW_HEIGHT (eti, -1) + height_extra));
 	} else {
-		gint row, total;
-		total = 0;
-		for (row = start_row; row < end_row; row++)
-			total += ETI_ROW_HEIGHT (eti, row) + height_extra;
+		if (start_row >= end_row || !height_index_ensure (eti))
+			return 0;
 
-		return total;
+		return height_index_prefix (eti, end_row) - height_index_prefix (eti, start_row);
 	}
 }
 
@@ -1209,6 +1311,21 @@ eti_table_model_no_change (ETableModel *table_model,
 	eti_unfreeze (eti);
 }
 
+/* Ends a change which moved the rows, like when the height of some rows
+ * changed, or rows were added or removed */
+static void
+eti_unfreeze_and_relayout (ETableItem *eti)
+{
+	eti_unfreeze (eti);
+
+	eti_idle_maybe_show_cursor (eti);
+
+	eti->needs_compute_height = 1;
+	e_canvas_item_request_reflow (GNOME_CANVAS_ITEM (eti));
+	eti->needs_redraw = 1;
+	gnome_canvas_item_request_update (GNOME_CANVAS_ITEM (eti));
+}
+
 /*
  * Callback routine: invoked when the ETableModel has suffered a change
  */
@@ -1228,36 +1345,38 @@ eti_table_model_changed (ETableModel *table_model,
 
 	free_height_cache (eti);
 
-	eti_unfreeze (eti);
-
-	eti->needs_compute_height = 1;
-	e_canvas_item_request_reflow (GNOME_CANVAS_ITEM (eti));
-	eti->needs_redraw = 1;
-	gnome_canvas_item_request_update (GNOME_CANVAS_ITEM (eti));
-
-	eti_idle_maybe_show_cursor (eti);
+	eti_unfreeze_and_relayout (eti);
 }
 
 static void
-eti_table_model_row_changed (ETableModel *table_model,
-                             gint row,
-                             ETableItem *eti)
+eti_table_model_rows_changed (ETableModel *table_model,
+                              const gint *rows,
+                              gint n_rows,
+                              ETableItem *eti)
 {
 	GnomeCanvasItem *item = GNOME_CANVAS_ITEM (eti);
+	gboolean resized = FALSE;
+	gint ii;
 
 	if (!(item->flags & GNOME_CANVAS_ITEM_REALIZED)) {
 		eti_unfreeze (eti);
 		return;
 	}
 
-	if ((!eti->uniform_row_height) && eti->height_cache && eti->height_cache[row] != -1 && eti_row_height_real (eti, row) != eti->height_cache[row]) {
-		eti_table_model_changed (table_model, eti);
+	for (ii = 0; ii < n_rows; ii++) {
+		if (eti_remeasure_row (eti, rows[ii]))
+			resized = TRUE;
+	}
+
+	if (resized) {
+		eti_unfreeze_and_relayout (eti);
 		return;
 	}
 
 	eti_unfreeze (eti);
 
-	e_table_item_redraw_row (eti, row);
+	for (ii = 0; ii < n_rows; ii++)
+		e_table_item_redraw_row (eti, rows[ii]);
 }
 
 static void
@@ -1273,8 +1392,8 @@ eti_table_model_cell_changed (ETableModel *table_model,
 		return;
 	}
 
-	if ((!eti->uniform_row_height) && eti->height_cache && eti->height_cache[row] != -1 && eti_row_height_real (eti, row) != eti->height_cache[row]) {
-		eti_table_model_changed (table_model, eti);
+	if (eti_remeasure_row (eti, row)) {
+		eti_unfreeze_and_relayout (eti);
 		return;
 	}
 
@@ -1305,14 +1424,9 @@ eti_table_model_rows_inserted (ETableModel *table_model,
 			eti->height_cache[i] = -1;
 	}
 
-	eti_unfreeze (eti);
-
-	eti_idle_maybe_show_cursor (eti);
+	height_index_free (eti);
 
-	eti->needs_compute_height = 1;
-	e_canvas_item_request_reflow (GNOME_CANVAS_ITEM (eti));
-	eti->needs_redraw = 1;
-	gnome_canvas_item_request_update (GNOME_CANVAS_ITEM (eti));
+	eti_unfreeze_and_relayout (eti);
 }
 
 static void
@@ -1334,14 +1448,9 @@ eti_table_model_rows_deleted (ETableModel *table_model,
 		memmove (eti->height_cache + row, eti->height_cache + row + count, (eti->rows - row) * sizeof (gint));
 	}
 
-	eti_unfreeze (eti);
-
-	eti_idle_maybe_show_cursor (eti);
+	height_index_free (eti);
 
-	eti->needs_compute_height = 1;
-	e_canvas_item_request_reflow (GNOME_CANVAS_ITEM (eti));
-	eti->needs_redraw = 1;
-	gnome_canvas_item_request_update (GNOME_CANVAS_ITEM (eti));
+	eti_unfreeze_and_relayout (eti);
 }
 
 /**
@@ -1415,8 +1524,8 @@ eti_add_table_model (ETableItem *eti,
 		G_CALLBACK (eti_table_model_changed), eti);
 
 	eti->table_model_row_change_id = g_signal_connect (
-		table_model, "model_row_changed",
-		G_CALLBACK (eti_table_model_row_changed), eti);
+		table_model, "model_rows_changed",
+		G_CALLBACK (eti_table_model_rows_changed), eti);
 
 	eti->table_model_cell_change_id = g_signal_connect (
 		table_model, "model_cell_changed",
@@ -1573,12 +1682,6 @@ eti_dispose (GObject *object)
 	eti_remove_table_model (eti);
 	eti_remove_selection_model (eti);
 
-	if (eti->height_cache_idle_id) {
-		g_source_remove (eti->height_cache_idle_id);
-		eti->height_cache_idle_id = 0;
-	}
-	eti->height_cache_idle_count = 0;
-
 	if (eti->cursor_idle_id) {
 		g_source_remove (eti->cursor_idle_id);
 		eti->cursor_idle_id = 0;
@@ -1587,6 +1690,7 @@ eti_dispose (GObject *object)
 	if (eti->height_cache)
 		g_free (eti->height_cache);
 	eti->height_cache = NULL;
+	height_index_free (eti);
 
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (e_table_item_parent_class)->dispose (object);
@@ -1739,8 +1843,7 @@ e_table_item_init (ETableItem *eti)
 	eti->click_count = 0;
 
 	eti->height_cache = NULL;
-	eti->height_cache_idle_id = 0;
-	eti->height_cache_idle_count = 0;
+	E_TABLE_ITEM_GET_PRIVATE (eti)->height_estimate = -1;
 
 	eti->length_threshold = -1;
 	eti->uniform_row_height = FALSE;
@@ -1855,15 +1958,10 @@ eti_unrealize (GnomeCanvasItem *item)
 	if (eti_editing (eti))
 		e_table_item_leave_edit_(eti);
 
-	if (eti->height_cache_idle_id) {
-		g_source_remove (eti->height_cache_idle_id);
-		eti->height_cache_idle_id = 0;
-	}
-
 	if (eti->height_cache)
 		g_free (eti->height_cache);
 	eti->height_cache = NULL;
-	eti->height_cache_idle_count = 0;
+	height_index_free (eti);
 
 	eti_unrealize_cell_views (eti);
 
@@ -1911,6 +2009,7 @@ eti_draw (GnomeCanvasItem *item,
 	gint x1, x2;
 	gint f_x1, f_x2, f_y1, f_y2;
 	gboolean f_found;
+	gint64 trace_begin;
 	cairo_matrix_t i2c;
 	gdouble eti_base_x, eti_base_y, lower_right_y, lower_right_x;
 	GtkWidget *canvas = GTK_WIDGET (item->canvas);
@@ -1976,34 +2075,29 @@ eti_draw (GnomeCanvasItem *item,
 	} else {
 		gint y1, y2;
 
-		y_offset = 0;
-		first_row = -1;
-
-		y1 = y2 = floor (eti_base_y) + height_extra;
-		for (row = 0; row < rows; row++, y1 = y2) {
+		if (!height_index_ensure (eti))
+			return;
 
-			y2 += ETI_ROW_HEIGHT (eti, row) + height_extra;
+		/* Only the shown rows are measured */
+		y1 = floor (eti_base_y) + height_extra;
+		first_row = height_index_find (eti, y - y1 - 1);
+		if (first_row >= rows)
+			return;
 
-			if (y1 > y + height)
-				break;
+		y1 = y2 = y1 + height_index_prefix (eti, first_row);
+		y_offset = y1 - y;
 
-			if (y2 < y)
-				continue;
+		for (row = first_row; row < rows && y1 <= y + height; row++, y1 = y2)
+			y2 += ETI_ROW_HEIGHT (eti, row) + height_extra;
 
-			if (first_row == -1) {
-				y_offset = y1 - y;
-				first_row = row;
-			}
-		}
 		last_row = row;
-
-		if (first_row == -1)
-			return;
 	}
 
 	if (first_row == -1)
 		return;
 
+	trace_begin = E_TABLE_TRACE_BEGIN ();
+
 	/*
 	 * Draw cells
 	 */
@@ -2206,6 +2300,8 @@ eti_draw (GnomeCanvasItem *item,
 		gdk_cairo_set_source_rgba (cr, &fg);
 		cairo_stroke (cr);
 	}
+
+	E_TABLE_TRACE_END ("eti_draw", trace_begin);
 }
 
 static GnomeCanvasItem *
@@ -2268,18 +2364,22 @@ find_cell (ETableItem *eti,
 		if (row >= eti->rows)
 			return FALSE;
 	} else {
-		y1 = y2 = height_extra;
-		if (y < height_extra)
+		if (y < height_extra || !height_index_ensure (eti))
 			return FALSE;
-		for (row = 0; row < rows; row++, y1 = y2) {
-			y2 += ETI_ROW_HEIGHT (eti, row) + height_extra;
 
-			if (y <= y2)
+		/* Measuring the row can move the rows after it */
+		while (TRUE) {
+			row = height_index_find (eti, ceil (y) - height_extra - 1);
+			if (row >= rows)
+				return FALSE;
+
+			if (eti->height_cache[row] != -1)
 				break;
+
+			eti_row_height (eti, row);
 		}
 
-		if (row == rows)
-			return FALSE;
+		y1 = height_extra + height_index_prefix (eti, row);
 	}
 	*view_col_res = col;
 	if (x1_res)
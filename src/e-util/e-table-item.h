@@ -146,8 +146,6 @@ struct _ETableItem {
 
 	gint *height_cache;
 	gint uniform_row_height_cache;
-	gint height_cache_idle_id;
-	gint height_cache_idle_count;
 
 	/*
 	 * Lengh Threshold: above this, we stop computing correctly
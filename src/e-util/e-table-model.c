@@ -15,7 +15,10 @@
  *
  */
 
+#include "evolution-config.h"
+
 #include "e-table-model.h"
+#include "e-table-trace.h"
 
 #define d(x)
 
@@ -31,6 +34,7 @@ enum {
 	MODEL_CELL_CHANGED,
 	MODEL_ROWS_INSERTED,
 	MODEL_ROWS_DELETED,
+	MODEL_ROWS_CHANGED,
 	ROW_SELECTION,
 	LAST_SIGNAL
 };
@@ -112,6 +116,17 @@ e_table_model_default_init (ETableModelInterface *iface)
 		G_TYPE_NONE, 2,
 		G_TYPE_INT,
 		G_TYPE_INT);
+
+	/* The rows are in ascending order; see e_table_model_rows_changed() */
+	signals[MODEL_ROWS_CHANGED] = g_signal_new (
+		"model_rows_changed",
+		G_TYPE_FROM_INTERFACE (iface),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET (ETableModelInterface, model_rows_changed),
+		NULL, NULL, NULL,
+		G_TYPE_NONE, 2,
+		G_TYPE_POINTER,
+		G_TYPE_INT);
 }
 
 /**
@@ -205,6 +220,8 @@ e_table_model_value_at (ETableModel *table_model,
 	iface = E_TABLE_MODEL_GET_INTERFACE (table_model);
 	g_return_val_if_fail (iface->value_at != NULL, NULL);
 
+	E_TABLE_TRACE_COUNT (E_TABLE_TRACE_COUNTER_VALUE_AT);
+
 	return iface->value_at (table_model, col, row);
 }
 
@@ -476,8 +493,8 @@ e_table_model_changed (ETableModel *table_model)
  *
  * Use this function to notify any views of the table model that
  * the contents of row @row have changed in model.  This function
- * will emit the "model_row_changed" signal on the @table_model
- * object
+ * will emit the "model_rows_changed" and the "model_row_changed"
+ * signals on the @table_model object
  */
 void
 e_table_model_row_changed (ETableModel *table_model,
@@ -485,12 +502,46 @@ e_table_model_row_changed (ETableModel *table_model,
 {
 	g_return_if_fail (E_IS_TABLE_MODEL (table_model));
 
+	e_table_model_rows_changed (table_model, &row, 1);
+}
+
+/**
+ * e_table_model_rows_changed:
+ * @table_model: the table model to notify of the change
+ * @rows: (array length=n_rows): the changed rows, in ascending order
+ * @n_rows: the number of the @rows
+ *
+ * Use this function to notify any views of the table model that
+ * the contents of the @rows have changed in model, all at once.  This
+ * function will emit the "model_rows_changed" signal on the
+ * @table_model object, and then the "model_row_changed" signal for
+ * each of the @rows, for the views which handle only single rows.
+ *
+ * Since: 3.26
+ */
+void
+e_table_model_rows_changed (ETableModel *table_model,
+                            const gint *rows,
+                            gint n_rows)
+{
+	gint ii;
+
+	g_return_if_fail (E_IS_TABLE_MODEL (table_model));
+	g_return_if_fail (rows != NULL || n_rows == 0);
+
 	if (table_model_is_frozen (table_model))
 		return;
 
 	d (print_tabs ());
 	d (depth++);
-	g_signal_emit (table_model, signals[MODEL_ROW_CHANGED], 0, row);
+	g_signal_emit (
+		table_model, signals[MODEL_ROWS_CHANGED], 0, rows, n_rows);
+
+	if (g_signal_has_handler_pending (table_model, signals[MODEL_ROW_CHANGED], 0, FALSE)) {
+		for (ii = 0; ii < n_rows; ii++)
+			g_signal_emit (
+				table_model, signals[MODEL_ROW_CHANGED], 0, rows[ii]);
+	}
 	d (depth--);
 }
 
@@ -97,6 +97,7 @@ struct _ETableModelInterface {
 	 * No changes, cancel pre_change: no_change
 	 * Major structural changes: model_changed
 	 * Changes only in a row: row_changed
+	 * Changes only in some rows: rows_changed
 	 * Only changes in a cell: cell_changed
 	 * A row inserted: row_inserted
 	 * A row deleted: row_deleted
@@ -116,6 +117,9 @@ struct _ETableModelInterface {
 	void		(*model_rows_deleted)	(ETableModel *table_model,
 						 gint row,
 						 gint count);
+	void		(*model_rows_changed)	(ETableModel *table_model,
+						 const gint *rows,
+						 gint n_rows);
 };
 
 GType		e_table_model_get_type		(void) G_GNUC_CONST;
@@ -183,6 +187,9 @@ void		e_table_model_rows_inserted	(ETableModel *table_model,
 void		e_table_model_rows_deleted	(ETableModel *table_model,
 						 gint row,
 						 gint count);
+void		e_table_model_rows_changed	(ETableModel *table_model,
+						 const gint *rows,
+						 gint n_rows);
 
 /**/
 void		e_table_model_row_inserted	(ETableModel *table_model,
@@ -37,6 +37,25 @@ struct _ETableSearchPrivate {
 	gunichar last_character;
 };
 
+typedef struct {
+	gchar *key;
+	gint position;
+	gint order;
+} ETableSearchIndexEntry;
+
+/* The values of the searched column, sorted by their lower cased form,
+ * thus the values starting with the typed text are next to each other,
+ * and the same values by their order in the search */
+struct _ETableSearchIndex {
+	GArray *entries;
+	gboolean sorted;
+
+	/* The range of the last search, which the next character narrows */
+	gchar *last_prefix;
+	guint last_start;
+	guint last_end;
+};
+
 G_DEFINE_TYPE (ETableSearch, e_table_search, G_TYPE_OBJECT)
 
 enum {
@@ -233,3 +252,261 @@ e_table_search_backspace (ETableSearch *ets)
 	add_timeout (ets);
 	return TRUE;
 }
+
+/* Lower cases the string the same way as the "string" search does */
+static gchar *
+ets_index_fold (const gchar *value)
+{
+	GString *folded;
+	const gchar *p;
+
+	folded = g_string_sized_new (strlen (value));
+
+	for (p = value; *p; p = g_utf8_next_char (p))
+		g_string_append_unichar (folded, g_unichar_tolower (g_utf8_get_char (p)));
+
+	return g_string_free (folded, FALSE);
+}
+
+static gint
+ets_index_entry_compare (gconstpointer a,
+                         gconstpointer b)
+{
+	const ETableSearchIndexEntry *entry1 = a;
+	const ETableSearchIndexEntry *entry2 = b;
+	gint res;
+
+	res = strcmp (entry1->key, entry2->key);
+	if (!res)
+		res = entry1->order - entry2->order;
+
+	return res;
+}
+
+/**
+ * e_table_search_index_new:
+ *
+ * Creates an index of the values of a searched column, which finds
+ * the values starting with the typed text, case insensitively, without
+ * checking every row. Add the values with e_table_search_index_add().
+ *
+ * Returns: a new #ETableSearchIndex, free it with
+ *    e_table_search_index_free()
+ *
+ * Since: 3.26
+ **/
+ETableSearchIndex *
+e_table_search_index_new (void)
+{
+	ETableSearchIndex *index;
+
+	index = g_new0 (ETableSearchIndex, 1);
+	index->entries = g_array_new (FALSE, FALSE, sizeof (ETableSearchIndexEntry));
+
+	return index;
+}
+
+/**
+ * e_table_search_index_free:
+ * @index: an #ETableSearchIndex
+ *
+ * Frees the @index.
+ *
+ * Since: 3.26
+ **/
+void
+e_table_search_index_free (ETableSearchIndex *index)
+{
+	guint ii;
+
+	if (!index)
+		return;
+
+	for (ii = 0; ii < index->entries->len; ii++)
+		g_free (g_array_index (index->entries, ETableSearchIndexEntry, ii).key);
+
+	g_array_free (index->entries, TRUE);
+	g_free (index->last_prefix);
+	g_free (index);
+}
+
+/**
+ * e_table_search_index_add:
+ * @index: an #ETableSearchIndex
+ * @position: position of the row, like its model row
+ * @order: place of the row in the order of the search, like its view row
+ * @value: (nullable): the value of the row, or %NULL
+ *
+ * Adds the @value of the row at @position to the @index. The %NULL values
+ * are never found. The @order of each row should be unique; the index is
+ * to be rebuilt when it changes.
+ *
+ * Since: 3.26
+ **/
+void
+e_table_search_index_add (ETableSearchIndex *index,
+                          gint position,
+                          gint order,
+                          const gchar *value)
+{
+	ETableSearchIndexEntry entry;
+
+	g_return_if_fail (index != NULL);
+
+	if (!value)
+		return;
+
+	entry.key = ets_index_fold (value);
+	entry.position = position;
+	entry.order = order;
+
+	g_array_append_val (index->entries, entry);
+
+	index->sorted = FALSE;
+	g_clear_pointer (&index->last_prefix, g_free);
+}
+
+/* Finds the range of the entries starting with the prefix */
+static void
+ets_index_find_range (ETableSearchIndex *index,
+                      const gchar *prefix,
+                      guint *out_start,
+                      guint *out_end)
+{
+	ETableSearchIndexEntry *entries;
+	gsize len = strlen (prefix);
+	guint start = 0, end = index->entries->len;
+	guint low, high;
+
+	if (!index->sorted) {
+		g_array_sort (index->entries, ets_index_entry_compare);
+		index->sorted = TRUE;
+	}
+
+	/* One more typed character only narrows the last range */
+	if (index->last_prefix && g_str_has_prefix (prefix, index->last_prefix)) {
+		start = index->last_start;
+		end = index->last_end;
+	}
+
+	entries = (ETableSearchIndexEntry *) index->entries->data;
+
+	low = start;
+	high = end;
+	while (low < high) {
+		guint middle = low + (high - low) / 2;
+
+		if (strncmp (entries[middle].key, prefix, len) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	start = low;
+
+	high = end;
+	while (low < high) {
+		guint middle = low + (high - low) / 2;
+
+		if (strncmp (entries[middle].key, prefix, len) <= 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	end = low;
+
+	g_free (index->last_prefix);
+	index->last_prefix = g_strdup (prefix);
+	index->last_start = start;
+	index->last_end = end;
+
+	*out_start = start;
+	*out_end = end;
+}
+
+/* Finds the end of the run of the entries with the same value as
+ * the entry at the start, within the range ending at the end */
+static guint
+ets_index_find_run_end (ETableSearchIndexEntry *entries,
+                        guint start,
+                        guint end)
+{
+	guint low = start + 1, high = end;
+
+	while (low < high) {
+		guint middle = low + (high - low) / 2;
+
+		if (strcmp (entries[middle].key, entries[start].key) == 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+/**
+ * e_table_search_index_find_next:
+ * @index: an #ETableSearchIndex
+ * @prefix: the typed text
+ * @after: where to search from, in the order of the search
+ *
+ * Finds the first row whose value starts with @prefix, case insensitively,
+ * after the row with the order @after, and when there is none, then from
+ * the start. The @after can be -1, to search from the start.
+ *
+ * The rows with the same value are ordered by their order, thus this does
+ * a binary search for each distinct value starting with @prefix.
+ *
+ * Returns: position of the found row, or -1, when no value starts
+ *    with @prefix
+ *
+ * Since: 3.26
+ **/
+gint
+e_table_search_index_find_next (ETableSearchIndex *index,
+                                const gchar *prefix,
+                                gint after)
+{
+	ETableSearchIndexEntry *entries;
+	gchar *folded;
+	guint start, end, run_start, run_end;
+	gint next = -1, first = -1;
+
+	g_return_val_if_fail (index != NULL, -1);
+	g_return_val_if_fail (prefix != NULL, -1);
+
+	folded = ets_index_fold (prefix);
+	ets_index_find_range (index, folded, &start, &end);
+	g_free (folded);
+
+	entries = (ETableSearchIndexEntry *) index->entries->data;
+
+	for (run_start = start; run_start < end; run_start = run_end) {
+		guint low, high;
+
+		run_end = ets_index_find_run_end (entries, run_start, end);
+
+		/* The first entry of the run ordered after the @after */
+		low = run_start;
+		high = run_end;
+		while (low < high) {
+			guint middle = low + (high - low) / 2;
+
+			if (entries[middle].order <= after)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+
+		if (low < run_end && (next == -1 || entries[low].order < entries[next].order))
+			next = low;
+
+		if (first == -1 || entries[run_start].order < entries[first].order)
+			first = run_start;
+	}
+
+	if (next != -1)
+		return entries[next].position;
+
+	return first != -1 ? entries[first].position : -1;
+}
@@ -54,6 +54,8 @@ typedef struct _ETableSearch ETableSearch;
 typedef struct _ETableSearchClass ETableSearchClass;
 typedef struct _ETableSearchPrivate ETableSearchPrivate;
 
+typedef struct _ETableSearchIndex ETableSearchIndex;
+
 typedef enum {
 	E_TABLE_SEARCH_FLAGS_CHECK_CURSOR_FIRST = 1 << 0
 } ETableSearchFlags;
@@ -80,6 +82,17 @@ void		e_table_search_input_character	(ETableSearch *e_table_search,
 gboolean	e_table_search_backspace	(ETableSearch *e_table_search);
 void		e_table_search_cancel		(ETableSearch *e_table_search);
 
+ETableSearchIndex *
+		e_table_search_index_new	(void);
+void		e_table_search_index_free	(ETableSearchIndex *index);
+void		e_table_search_index_add	(ETableSearchIndex *index,
+						 gint position,
+						 gint order,
+						 const gchar *value);
+gint		e_table_search_index_find_next	(ETableSearchIndex *index,
+						 const gchar *prefix,
+						 gint after);
+
 G_END_DECLS
 
 #endif /* _E_TABLE_SEARCH_H_ */
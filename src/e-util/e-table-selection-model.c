@@ -143,9 +143,10 @@ model_changed (ETableModel *etm,
 }
 
 static void
-model_row_changed (ETableModel *etm,
-                   gint row,
-                   ETableSelectionModel *etsm)
+model_rows_changed (ETableModel *etm,
+                    const gint *rows,
+                    gint n_rows,
+                    ETableSelectionModel *etsm)
 {
 	free_hash (etsm);
 }
@@ -215,8 +216,8 @@ add_model (ETableSelectionModel *etsm,
 			model, "model_changed",
 			G_CALLBACK (model_changed), etsm);
 		etsm->model_row_changed_id = g_signal_connect (
-			model, "model_row_changed",
-			G_CALLBACK (model_row_changed), etsm);
+			model, "model_rows_changed",
+			G_CALLBACK (model_rows_changed), etsm);
 		etsm->model_cell_changed_id = g_signal_connect (
 			model, "model_cell_changed",
 			G_CALLBACK (model_cell_changed), etsm);
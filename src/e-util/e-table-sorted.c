@@ -40,6 +40,7 @@ static void ets_sort_info_changed        (ETableSortInfo *info, ETableSorted *et
 static void ets_sort                     (ETableSorted *ets);
 static void ets_proxy_model_changed      (ETableSubset *etss, ETableModel *source);
 static void ets_proxy_model_row_changed  (ETableSubset *etss, ETableModel *source, gint row);
+static void ets_proxy_model_rows_changed (ETableSubset *etss, ETableModel *source, const gint *rows, gint n_rows);
 static void ets_proxy_model_cell_changed (ETableSubset *etss, ETableModel *source, gint col, gint row);
 static void ets_proxy_model_rows_inserted (ETableSubset *etss, ETableModel *source, gint row, gint count);
 static void ets_proxy_model_rows_deleted  (ETableSubset *etss, ETableModel *source, gint row, gint count);
@@ -80,6 +81,7 @@ e_table_sorted_class_init (ETableSortedClass *class)
 
 	etss_class->proxy_model_changed = ets_proxy_model_changed;
 	etss_class->proxy_model_row_changed = ets_proxy_model_row_changed;
+	etss_class->proxy_model_rows_changed = ets_proxy_model_rows_changed;
 	etss_class->proxy_model_cell_changed = ets_proxy_model_cell_changed;
 	etss_class->proxy_model_rows_inserted = ets_proxy_model_rows_inserted;
 	etss_class->proxy_model_rows_deleted = ets_proxy_model_rows_deleted;
@@ -118,6 +120,68 @@ ets_insert_idle (ETableSorted *ets)
 	return FALSE;
 }
 
+/* Whether to place an inserted or changed row right away; when there are
+ * too many of them between idle events, we're busy, its faster to leave
+ * them where they are and perform a full sort later */
+static gboolean
+ets_can_place_row (ETableSorted *ets)
+{
+	if (ets->sort_idle_id != 0)
+		return FALSE;
+
+	ets->insert_count++;
+	if (ets->insert_count > ETS_INSERT_MAX) {
+		/* schedule a sort instead */
+		ets->sort_idle_id = g_idle_add_full (50, (GSourceFunc) ets_sort_idle, ets, NULL);
+		return FALSE;
+	}
+
+	/* make sure we have an idle handler to reset the count every now and then */
+	if (ets->insert_idle_id == 0)
+		ets->insert_idle_id = g_idle_add_full (40, (GSourceFunc) ets_insert_idle, ets, NULL);
+
+	return TRUE;
+}
+
+/* Moves a changed row to its place among the other rows, which are
+ * still sorted. Returns whether the row moved. */
+static gboolean
+ets_move_row (ETableSorted *ets,
+              gint view_row)
+{
+	ETableSubset *etss = E_TABLE_SUBSET (ets);
+	ETableModel *source_model;
+	gint *map_table = etss->map_table;
+	gint row = map_table[view_row];
+	gint new_view_row;
+
+	source_model = e_table_subset_get_source_model (etss);
+
+	new_view_row = e_table_sorting_utils_insert (
+		source_model, ets->sort_info, ets->full_header,
+		map_table, view_row, row);
+
+	if (new_view_row == view_row)
+		new_view_row += e_table_sorting_utils_insert (
+			source_model, ets->sort_info, ets->full_header,
+			map_table + view_row + 1, etss->n_map - view_row - 1, row);
+
+	if (new_view_row == view_row)
+		return FALSE;
+
+	e_table_model_pre_change (E_TABLE_MODEL (ets));
+
+	if (new_view_row < view_row)
+		memmove (map_table + new_view_row + 1, map_table + new_view_row, (view_row - new_view_row) * sizeof (gint));
+	else
+		memmove (map_table + view_row, map_table + view_row + 1, (new_view_row - view_row) * sizeof (gint));
+	map_table[new_view_row] = row;
+
+	e_table_model_changed (E_TABLE_MODEL (ets));
+
+	return TRUE;
+}
+
 ETableModel *
 e_table_sorted_new (ETableModel *source,
                     ETableHeader *full_header,
@@ -182,13 +246,58 @@ ets_proxy_model_row_changed (ETableSubset *subset,
                              ETableModel *source,
                              gint row)
 {
-	if (!E_TABLE_SORTED (subset)->sort_idle_id)
-		E_TABLE_SORTED (subset)->sort_idle_id = g_idle_add_full (50, (GSourceFunc) ets_sort_idle, subset, NULL);
+	ETableSorted *ets = E_TABLE_SORTED (subset);
+
+	if (ets_can_place_row (ets)) {
+		gint view_row = e_table_subset_model_to_view_row (subset, row);
+
+		/* The move is announced on its own, the change forwarded
+		 * from the source is left without any effect */
+		if (view_row != -1 && ets_move_row (ets, view_row)) {
+			e_table_model_no_change (E_TABLE_MODEL (subset));
+			return;
+		}
+	}
 
 	if (E_TABLE_SUBSET_CLASS (e_table_sorted_parent_class)->proxy_model_row_changed)
 		(E_TABLE_SUBSET_CLASS (e_table_sorted_parent_class)->proxy_model_row_changed) (subset, source, row);
 }
 
+static void
+ets_proxy_model_rows_changed (ETableSubset *subset,
+                              ETableModel *source,
+                              const gint *rows,
+                              gint n_rows)
+{
+	ETableSorted *ets = E_TABLE_SORTED (subset);
+	gint unmoved[ETS_INSERT_MAX];
+	gint ii, n_unmoved = 0;
+
+	if (n_rows > ETS_INSERT_MAX) {
+		/* Sorting all the rows again later is cheaper than moving
+		 * each of them, the view is told about the changes now */
+		if (!ets->sort_idle_id)
+			ets->sort_idle_id = g_idle_add_full (50, (GSourceFunc) ets_sort_idle, ets, NULL);
+	} else {
+		for (ii = 0; ii < n_rows; ii++) {
+			if (ets_can_place_row (ets)) {
+				gint view_row = e_table_subset_model_to_view_row (subset, rows[ii]);
+
+				if (view_row != -1 && ets_move_row (ets, view_row))
+					continue;
+			}
+
+			unmoved[n_unmoved++] = rows[ii];
+		}
+
+		rows = unmoved;
+		n_rows = n_unmoved;
+	}
+
+	if (E_TABLE_SUBSET_CLASS (e_table_sorted_parent_class)->proxy_model_rows_changed)
+		(E_TABLE_SUBSET_CLASS (e_table_sorted_parent_class)->proxy_model_rows_changed) (subset, source, rows, n_rows);
+}
+
 static void
 ets_proxy_model_cell_changed (ETableSubset *subset,
                               ETableModel *source,
@@ -212,7 +321,7 @@ ets_proxy_model_rows_inserted (ETableSubset *etss,
 	ETableSorted *ets = E_TABLE_SORTED (etss);
 	ETableModel *source_model;
 	gint i;
-	gboolean full_change = FALSE;
+	gboolean batch;
 
 	source_model = e_table_subset_get_source_model (etss);
 
@@ -221,8 +330,8 @@ ets_proxy_model_rows_inserted (ETableSubset *etss,
 		return;
 	}
 
+	/* The rows after the inserted ones stay where they are in the view */
 	if (row != etss->n_map) {
-		full_change = TRUE;
 		for (i = 0; i < etss->n_map; i++) {
 			if (etss->map_table[i] >= row) {
 				etss->map_table[i] += count;
@@ -232,36 +341,28 @@ ets_proxy_model_rows_inserted (ETableSubset *etss,
 
 	etss->map_table = g_realloc (etss->map_table, (etss->n_map + count) * sizeof (gint));
 
+	/* Many rows at once are placed and announced as one change,
+	 * closing the pre-change forwarded from the source */
+	batch = count > ETS_INSERT_MAX && ets->sort_idle_id == 0;
+
 	for (; count > 0; count--) {
-		if (!full_change)
+		if (!batch)
 			e_table_model_pre_change (etm);
 		i = etss->n_map;
-		if (ets->sort_idle_id == 0) {
-			/* this is to see if we're inserting a lot of things between idle loops.
-			 * If we are, we're busy, its faster to just append and perform a full sort later */
-			ets->insert_count++;
-			if (ets->insert_count > ETS_INSERT_MAX) {
-				/* schedule a sort, and append instead */
-				ets->sort_idle_id = g_idle_add_full (50, (GSourceFunc) ets_sort_idle, ets, NULL);
-			} else {
-				/* make sure we have an idle handler to reset the count every now and then */
-				if (ets->insert_idle_id == 0) {
-					ets->insert_idle_id = g_idle_add_full (40, (GSourceFunc) ets_insert_idle, ets, NULL);
-				}
-				i = e_table_sorting_utils_insert (source_model, ets->sort_info, ets->full_header, etss->map_table, etss->n_map, row);
-				memmove (etss->map_table + i + 1, etss->map_table + i, (etss->n_map - i) * sizeof (gint));
-			}
+		if (batch || ets_can_place_row (ets)) {
+			i = e_table_sorting_utils_insert (source_model, ets->sort_info, ets->full_header, etss->map_table, etss->n_map, row);
+			memmove (etss->map_table + i + 1, etss->map_table + i, (etss->n_map - i) * sizeof (gint));
 		}
 		etss->map_table[i] = row;
 		etss->n_map++;
-		if (!full_change) {
+		if (!batch) {
 			e_table_model_row_inserted (etm, i);
 		}
 
 		d (g_print ("inserted row %d", row));
 		row++;
 	}
-	if (full_change)
+	if (batch)
 		e_table_model_changed (etm);
 	else
 		e_table_model_no_change (etm);
@@ -275,35 +376,48 @@ ets_proxy_model_rows_deleted (ETableSubset *etss,
                               gint count)
 {
 	ETableModel *etm = E_TABLE_MODEL (etss);
-	gint i;
-	gboolean shift;
-	gint j;
+	gint *deleted;
+	gint n_deleted = 0;
+	gint i, j, k;
+
+	deleted = g_new (gint, MAX (1, MIN (count, etss->n_map)));
+
+	/* Find the deleted rows and renumber the rows after them in one pass */
+	for (i = 0; i < etss->n_map; i++) {
+		if (etss->map_table[i] >= row + count)
+			etss->map_table[i] -= count;
+		else if (etss->map_table[i] >= row)
+			deleted[n_deleted++] = i;
+	}
 
-	shift = row == etss->n_map - count;
+	if (n_deleted <= ETS_INSERT_MAX) {
+		/* From the last, thus the view rows before it stay valid */
+		for (j = n_deleted - 1; j >= 0; j--) {
+			i = deleted[j];
 
-	for (j = 0; j < count; j++) {
-		for (i = 0; i < etss->n_map; i++) {
-			if (etss->map_table[i] == row + j) {
-				if (shift)
-					e_table_model_pre_change (etm);
-				memmove (etss->map_table + i, etss->map_table + i + 1, (etss->n_map - i - 1) * sizeof (gint));
-				etss->n_map--;
-				if (shift)
-					e_table_model_row_deleted (etm, i);
-			}
+			e_table_model_pre_change (etm);
+			memmove (etss->map_table + i, etss->map_table + i + 1, (etss->n_map - i - 1) * sizeof (gint));
+			etss->n_map--;
+			e_table_model_row_deleted (etm, i);
 		}
-	}
-	if (!shift) {
-		for (i = 0; i < etss->n_map; i++) {
-			if (etss->map_table[i] >= row)
-				etss->map_table[i] -= count;
+
+		e_table_model_no_change (etm);
+	} else {
+		/* Many rows at once are removed and announced as one change,
+		 * closing the pre-change forwarded from the source */
+		for (i = 0, j = 0, k = 0; i < etss->n_map; i++) {
+			if (k < n_deleted && deleted[k] == i)
+				k++;
+			else
+				etss->map_table[j++] = etss->map_table[i];
 		}
+		etss->n_map = j;
 
 		e_table_model_changed (etm);
-	} else {
-		e_table_model_no_change (etm);
 	}
 
+	g_free (deleted);
+
 	d (g_print ("deleted row %d count %d", row, count));
 	d (e_table_subset_print_debugging (etss));
 }
@@ -227,9 +227,10 @@ table_sorter_model_changed_cb (ETableModel *table_model,
 }
 
 static void
-table_sorter_model_row_changed_cb (ETableModel *table_model,
-                                   gint row,
-                                   ETableSorter *table_sorter)
+table_sorter_model_rows_changed_cb (ETableModel *table_model,
+                                    const gint *rows,
+                                    gint n_rows,
+                                    ETableSorter *table_sorter)
 {
 	table_sorter_clean (table_sorter);
 }
@@ -526,8 +527,8 @@ e_table_sorter_new (ETableModel *source,
 		G_CALLBACK (table_sorter_model_changed_cb), table_sorter);
 
 	table_sorter->table_model_row_changed_id = g_signal_connect (
-		source, "model_row_changed",
-		G_CALLBACK (table_sorter_model_row_changed_cb), table_sorter);
+		source, "model_rows_changed",
+		G_CALLBACK (table_sorter_model_rows_changed_cb), table_sorter);
 
 	table_sorter->table_model_cell_changed_id = g_signal_connect (
 		source, "model_cell_changed",
@@ -83,14 +83,6 @@ etsu_compare (ETableModel *source,
 	return comp_val;
 }
 
-typedef struct {
-	gint cols;
-	gpointer *vals;
-	GtkSortType *sort_type;
-	GCompareDataFunc *compare;
-	gpointer cmp_cache;
-} ETableSortClosure;
-
 typedef struct {
 	ETreeModel *tree;
 	ETableSortInfo *sort_info;
@@ -98,34 +90,156 @@ typedef struct {
 	gpointer cmp_cache;
 } ETreeSortClosure;
 
-/* FIXME: Make it not cache the second and later columns (as if anyone cares.) */
+/* Sorting of the arrays of rows, shared by the table and the tree sort.
+ * The values of the columns with the common compare functions are turned
+ * into keys, which are compared without calling the compare function,
+ * thus also without the compare cache, and which can be sorted in more
+ * threads. Other columns use the compare function on the model values. */
+
+/* Sort in more threads only from this many rows */
+#define ETSU_PARALLEL_MIN_ROWS 8192
+#define ETSU_MAX_THREADS 8
+
+typedef enum {
+	ETSU_KEY_CUSTOM,	/* the column's compare function */
+	ETSU_KEY_INT,		/* "integer" */
+	ETSU_KEY_INT64,		/* "pointer-integer64" */
+	ETSU_KEY_STRING,	/* "string" */
+	ETSU_KEY_COLLATE,	/* "collate" */
+	ETSU_KEY_STRING_CASE	/* "stringcase" */
+} ETSUKeyKind;
+
+typedef struct {
+	ETSUKeyKind kind;
+	GtkSortType sort_type;
+	GCompareDataFunc compare;
+
+	gpointer *vals;		/* the model values */
+	gint64 *ints;		/* the numbers, or the string prefixes */
+	guint8 *unset;		/* ETSU_KEY_INT64 NULL values */
+	gchar **strs;		/* the strings or the collate keys */
+} ETSUColumn;
+
+typedef struct {
+	ETSUColumn *columns;
+	gint n_columns;
+	gint count;
+	const gint *ties;	/* the positions themselves, when NULL */
+	gpointer cmp_cache;
+} ETSUKeys;
+
+typedef struct {
+	ETSUKeys *keys;
+	ETSUColumn *column;
+	gint *positions;
+	gint *tmp;
+	gint start;
+	gint middle;
+	gint end;
+} ETSUTask;
+
+static ETSUKeyKind
+etsu_column_get_kind (ETableCol *col)
+{
+	const gchar *compare = col->spec->compare;
+
+	/* The names are those ETableExtras registers its compare
+	 * functions under, which is verified where possible */
+	if (col->compare == (GCompareDataFunc) e_int_compare)
+		return ETSU_KEY_INT;
+	if (col->compare == (GCompareDataFunc) e_str_compare)
+		return ETSU_KEY_STRING;
+	if (g_strcmp0 (compare, "pointer-integer64") == 0)
+		return ETSU_KEY_INT64;
+	if (g_strcmp0 (compare, "collate") == 0)
+		return ETSU_KEY_COLLATE;
+	if (g_strcmp0 (compare, "stringcase") == 0)
+		return ETSU_KEY_STRING_CASE;
+
+	return ETSU_KEY_CUSTOM;
+}
+
+/* The first 8 bytes, comparable as a number the same way as by strcmp() */
+static gint64
+etsu_string_prefix (const gchar *str)
+{
+	guint64 prefix = 0;
+	gint ii;
+
+	for (ii = 0; ii < 8; ii++) {
+		prefix <<= 8;
+		if (*str)
+			prefix |= (guchar) *str++;
+	}
+
+	/* Flip the sign bit to compare as signed */
+	return (gint64) (prefix ^ G_GUINT64_CONSTANT (0x8000000000000000));
+}
+
+static gint
+etsu_column_compare (ETSUColumn *column,
+                     gint pos1,
+                     gint pos2,
+                     gpointer cmp_cache)
+{
+	const gchar *str1, *str2;
+
+	switch (column->kind) {
+	case ETSU_KEY_CUSTOM:
+		return (*column->compare) (column->vals[pos1], column->vals[pos2], cmp_cache);
+	case ETSU_KEY_INT64:
+		/* sort unset values before set */
+		if (column->unset[pos1] || column->unset[pos2])
+			return column->unset[pos1] == column->unset[pos2] ? 0 : column->unset[pos1] ? -1 : 1;
+		/* falls through */
+	case ETSU_KEY_INT:
+		if (column->ints[pos1] == column->ints[pos2])
+			return 0;
+		return column->ints[pos1] < column->ints[pos2] ? -1 : 1;
+	case ETSU_KEY_STRING:
+	case ETSU_KEY_COLLATE:
+	case ETSU_KEY_STRING_CASE:
+		str1 = column->strs[pos1];
+		str2 = column->strs[pos2];
+
+		/* sort NULL values after set */
+		if (!str1 || !str2)
+			return str1 == str2 ? 0 : str1 ? -1 : 1;
+
+		if (column->ints[pos1] != column->ints[pos2])
+			return column->ints[pos1] < column->ints[pos2] ? -1 : 1;
+
+		return strcmp (str1, str2);
+	}
+
+	g_warn_if_reached ();
+
+	return 0;
+}
 
 static gint
-e_sort_callback (gconstpointer data1,
-                 gconstpointer data2,
-                 gpointer user_data)
+etsu_keys_compare (ETSUKeys *keys,
+                   gint pos1,
+                   gint pos2)
 {
-	gint row1 = *(gint *) data1;
-	gint row2 = *(gint *) data2;
-	ETableSortClosure *closure = user_data;
 	gint j;
-	gint sort_count = closure->cols;
 	gint comp_val = 0;
 	GtkSortType sort_type = GTK_SORT_ASCENDING;
 
-	for (j = 0; j < sort_count; j++) {
-		comp_val = (*(closure->compare[j])) (
-			closure->vals[closure->cols * row1 + j],
-			closure->vals[closure->cols * row2 + j],
-			closure->cmp_cache);
-		sort_type = closure->sort_type[j];
+	for (j = 0; j < keys->n_columns; j++) {
+		comp_val = etsu_column_compare (&keys->columns[j], pos1, pos2, keys->cmp_cache);
+		sort_type = keys->columns[j].sort_type;
 		if (comp_val != 0)
 			break;
 	}
+
 	if (comp_val == 0) {
-		if (row1 < row2)
+		gint tie1 = keys->ties ? keys->ties[pos1] : pos1;
+		gint tie2 = keys->ties ? keys->ties[pos2] : pos2;
+
+		if (tie1 < tie2)
 			comp_val = -1;
-		if (row1 > row2)
+		if (tie1 > tie2)
 			comp_val = 1;
 	}
 
@@ -135,6 +249,309 @@ e_sort_callback (gconstpointer data1,
 	return comp_val;
 }
 
+static gint
+etsu_keys_sort_cb (gconstpointer data1,
+                   gconstpointer data2,
+                   gpointer user_data)
+{
+	return etsu_keys_compare (user_data, *(const gint *) data1, *(const gint *) data2);
+}
+
+static gpointer
+etsu_build_keys_thread (gpointer user_data)
+{
+	ETSUTask *task = user_data;
+	ETSUColumn *column = task->column;
+	gint ii;
+
+	for (ii = task->start; ii < task->end; ii++) {
+		const gchar *str = column->vals[ii];
+		gchar *tmp;
+
+		if (!str) {
+			column->strs[ii] = NULL;
+			continue;
+		}
+
+		switch (column->kind) {
+		case ETSU_KEY_STRING:
+			column->strs[ii] = (gchar *) str;
+			break;
+		case ETSU_KEY_COLLATE:
+			column->strs[ii] = g_utf8_collate_key (str, -1);
+			break;
+		case ETSU_KEY_STRING_CASE:
+			tmp = g_utf8_casefold (str, -1);
+			column->strs[ii] = g_utf8_collate_key (tmp, -1);
+			g_free (tmp);
+			break;
+		default:
+			g_warn_if_reached ();
+			break;
+		}
+
+		column->ints[ii] = etsu_string_prefix (column->strs[ii]);
+	}
+
+	return NULL;
+}
+
+static gpointer
+etsu_sort_thread (gpointer user_data)
+{
+	ETSUTask *task = user_data;
+
+	g_qsort_with_data (
+		task->positions + task->start, task->end - task->start,
+		sizeof (gint), etsu_keys_sort_cb, task->keys);
+
+	return NULL;
+}
+
+static gpointer
+etsu_merge_thread (gpointer user_data)
+{
+	ETSUTask *task = user_data;
+	gint *positions = task->positions;
+	gint ii = task->start, jj = task->middle, kk = task->start;
+
+	while (ii < task->middle && jj < task->end) {
+		if (etsu_keys_compare (task->keys, positions[ii], positions[jj]) <= 0)
+			task->tmp[kk++] = positions[ii++];
+		else
+			task->tmp[kk++] = positions[jj++];
+	}
+
+	while (ii < task->middle)
+		task->tmp[kk++] = positions[ii++];
+	while (jj < task->end)
+		task->tmp[kk++] = positions[jj++];
+
+	memcpy (positions + task->start, task->tmp + task->start, (task->end - task->start) * sizeof (gint));
+
+	return NULL;
+}
+
+/* Runs the first task in this thread, the others each in a new thread */
+static void
+etsu_run_tasks (GThreadFunc func,
+                ETSUTask *tasks,
+                gint n_tasks)
+{
+	GThread **threads;
+	gint ii;
+
+	threads = g_new0 (GThread *, n_tasks);
+
+	for (ii = 1; ii < n_tasks; ii++) {
+		threads[ii] = g_thread_try_new ("etsu-sort", func, &tasks[ii], NULL);
+		if (!threads[ii])
+			func (&tasks[ii]);
+	}
+
+	func (&tasks[0]);
+
+	for (ii = 1; ii < n_tasks; ii++) {
+		if (threads[ii])
+			g_thread_join (threads[ii]);
+	}
+
+	g_free (threads);
+}
+
+static gint
+etsu_get_n_threads (gint count)
+{
+	if (count < ETSU_PARALLEL_MIN_ROWS)
+		return 1;
+
+	return CLAMP (g_get_num_processors (), 1, ETSU_MAX_THREADS);
+}
+
+static void
+etsu_keys_init (ETSUKeys *keys,
+                gint n_columns,
+                gint count,
+                const gint *ties)
+{
+	keys->columns = g_new0 (ETSUColumn, n_columns);
+	keys->n_columns = n_columns;
+	keys->count = count;
+	keys->ties = ties;
+	keys->cmp_cache = NULL;
+}
+
+/* Takes the model values of the column, which are freed by the caller
+ * after the sort, and turns them into keys where possible. */
+static void
+etsu_keys_set_column (ETSUKeys *keys,
+                      gint index,
+                      ETableCol *col,
+                      GtkSortType sort_type,
+                      gpointer *vals)
+{
+	ETSUColumn *column = &keys->columns[index];
+	ETSUTask *tasks;
+	gint ii, n_tasks;
+
+	column->kind = etsu_column_get_kind (col);
+	column->sort_type = sort_type;
+	column->compare = col->compare;
+	column->vals = vals;
+
+	switch (column->kind) {
+	case ETSU_KEY_CUSTOM:
+		if (!keys->cmp_cache)
+			keys->cmp_cache = e_table_sorting_utils_create_cmp_cache ();
+		break;
+	case ETSU_KEY_INT:
+		column->ints = g_new (gint64, keys->count);
+		for (ii = 0; ii < keys->count; ii++)
+			column->ints[ii] = GPOINTER_TO_INT (vals[ii]);
+		break;
+	case ETSU_KEY_INT64:
+		column->ints = g_new (gint64, keys->count);
+		column->unset = g_new (guint8, keys->count);
+		for (ii = 0; ii < keys->count; ii++) {
+			const gint64 *pvalue = vals[ii];
+
+			column->unset[ii] = pvalue == NULL;
+			column->ints[ii] = pvalue ? *pvalue : 0;
+		}
+		break;
+	case ETSU_KEY_STRING:
+	case ETSU_KEY_COLLATE:
+	case ETSU_KEY_STRING_CASE:
+		column->ints = g_new (gint64, keys->count);
+		column->strs = g_new (gchar *, keys->count);
+
+		/* The collate keys are the most expensive part */
+		n_tasks = etsu_get_n_threads (keys->count);
+		tasks = g_new0 (ETSUTask, n_tasks);
+		for (ii = 0; ii < n_tasks; ii++) {
+			tasks[ii].column = column;
+			tasks[ii].start = (gint64) keys->count * ii / n_tasks;
+			tasks[ii].end = (gint64) keys->count * (ii + 1) / n_tasks;
+		}
+
+		etsu_run_tasks (etsu_build_keys_thread, tasks, n_tasks);
+
+		g_free (tasks);
+		break;
+	}
+}
+
+static void
+etsu_keys_clear (ETSUKeys *keys)
+{
+	gint j, ii;
+
+	for (j = 0; j < keys->n_columns; j++) {
+		ETSUColumn *column = &keys->columns[j];
+
+		if (column->strs && column->kind != ETSU_KEY_STRING) {
+			for (ii = 0; ii < keys->count; ii++)
+				g_free (column->strs[ii]);
+		}
+
+		g_free (column->ints);
+		g_free (column->unset);
+		g_free (column->strs);
+	}
+
+	g_free (keys->columns);
+
+	if (keys->cmp_cache)
+		e_table_sorting_utils_free_cmp_cache (keys->cmp_cache);
+}
+
+/* Sorts the positions 0 to keys->count - 1, by the keys. The compare
+ * functions of the other columns are not expected to be thread safe,
+ * thus they are sorted in this thread only. */
+static void
+etsu_keys_sort (ETSUKeys *keys,
+                gint *positions)
+{
+	ETSUTask *tasks;
+	gint *bounds, *tmp;
+	gint ii, j, n_tasks;
+
+	n_tasks = etsu_get_n_threads (keys->count);
+	for (j = 0; j < keys->n_columns && n_tasks > 1; j++) {
+		if (keys->columns[j].kind == ETSU_KEY_CUSTOM)
+			n_tasks = 1;
+	}
+
+	if (n_tasks == 1) {
+		g_qsort_with_data (
+			positions, keys->count, sizeof (gint),
+			etsu_keys_sort_cb, keys);
+		return;
+	}
+
+	/* Sort the parts in parallel, then merge them in pairs */
+	tasks = g_new0 (ETSUTask, n_tasks);
+	bounds = g_new (gint, n_tasks + 1);
+	tmp = g_new (gint, keys->count);
+
+	for (ii = 0; ii <= n_tasks; ii++)
+		bounds[ii] = (gint64) keys->count * ii / n_tasks;
+
+	for (ii = 0; ii < n_tasks; ii++) {
+		tasks[ii].keys = keys;
+		tasks[ii].positions = positions;
+		tasks[ii].tmp = tmp;
+		tasks[ii].start = bounds[ii];
+		tasks[ii].end = bounds[ii + 1];
+	}
+
+	etsu_run_tasks (etsu_sort_thread, tasks, n_tasks);
+
+	while (n_tasks > 1) {
+		gint n_merges = n_tasks / 2;
+
+		for (ii = 0; ii < n_merges; ii++) {
+			tasks[ii].start = bounds[2 * ii];
+			tasks[ii].middle = bounds[2 * ii + 1];
+			tasks[ii].end = bounds[2 * ii + 2];
+		}
+
+		etsu_run_tasks (etsu_merge_thread, tasks, n_merges);
+
+		/* An odd part is left for the next round */
+		for (ii = 0; ii <= n_merges; ii++)
+			bounds[ii] = bounds[MIN (2 * ii, n_tasks)];
+		if (n_tasks % 2)
+			bounds[++n_merges] = bounds[n_tasks];
+
+		n_tasks = n_merges;
+	}
+
+	g_free (tasks);
+	g_free (bounds);
+	g_free (tmp);
+}
+
+static ETableCol *
+etsu_get_sort_column (ETableSortInfo *sort_info,
+                      ETableHeader *full_header,
+                      gint n,
+                      GtkSortType *sort_type)
+{
+	ETableColumnSpecification *spec;
+	ETableCol *col;
+
+	spec = e_table_sort_info_sorting_get_nth (sort_info, n, sort_type);
+
+	col = e_table_header_get_column_by_spec (full_header, spec);
+	if (col == NULL) {
+		gint last = e_table_header_count (full_header) - 1;
+		col = e_table_header_get_column (full_header, last);
+	}
+
+	return col;
+}
+
 void
 e_table_sorting_utils_sort (ETableModel *source,
                             ETableSortInfo *sort_info,
@@ -142,69 +559,67 @@ e_table_sorting_utils_sort (ETableModel *source,
                             gint *map_table,
                             gint rows)
 {
-	gint total_rows;
 	gint i;
 	gint j;
 	gint cols;
-	ETableSortClosure closure;
+	gint *positions;
+	gint *map_copy;
+	gpointer **vals;
+	ETSUKeys keys;
 
 	g_return_if_fail (E_IS_TABLE_MODEL (source));
 	g_return_if_fail (E_IS_TABLE_SORT_INFO (sort_info));
 	g_return_if_fail (E_IS_TABLE_HEADER (full_header));
 
-	total_rows = e_table_model_row_count (source);
 	cols = e_table_sort_info_sorting_get_count (sort_info);
-	closure.cols = cols;
 
-	closure.vals = g_new (gpointer, total_rows * cols);
-	closure.sort_type = g_new (GtkSortType, cols);
-	closure.compare = g_new (GCompareDataFunc, cols);
-	closure.cmp_cache = e_table_sorting_utils_create_cmp_cache ();
+	/* The model rows break the ties */
+	map_copy = g_memdup (map_table, sizeof (gint) * rows);
+	etsu_keys_init (&keys, cols, rows, map_copy);
 
+	vals = g_new (gpointer *, cols);
 	for (j = 0; j < cols; j++) {
-		ETableColumnSpecification *spec;
+		GtkSortType sort_type = GTK_SORT_ASCENDING;
 		ETableCol *col;
 
-		spec = e_table_sort_info_sorting_get_nth (
-			sort_info, j, &closure.sort_type[j]);
-
-		col = e_table_header_get_column_by_spec (full_header, spec);
-		if (col == NULL) {
-			gint last = e_table_header_count (full_header) - 1;
-			col = e_table_header_get_column (full_header, last);
-		}
+		col = etsu_get_sort_column (sort_info, full_header, j, &sort_type);
 
+		vals[j] = g_new (gpointer, rows);
 		for (i = 0; i < rows; i++) {
-			closure.vals[map_table[i] * cols + j] = e_table_model_value_at (source, col->spec->compare_col, map_table[i]);
+			vals[j][i] = e_table_model_value_at (source, col->spec->compare_col, map_table[i]);
 		}
-		closure.compare[j] = col->compare;
+
+		etsu_keys_set_column (&keys, j, col, sort_type, vals[j]);
 	}
 
-	g_qsort_with_data (
-		map_table, rows, sizeof (gint), e_sort_callback, &closure);
+	positions = g_new (gint, rows);
+	for (i = 0; i < rows; i++) {
+		positions[i] = i;
+	}
+
+	etsu_keys_sort (&keys, positions);
+
+	for (i = 0; i < rows; i++) {
+		map_table[i] = map_copy[positions[i]];
+	}
+
+	etsu_keys_clear (&keys);
 
 	for (j = 0; j < cols; j++) {
-		ETableColumnSpecification *spec;
 		ETableCol *col;
 
-		spec = e_table_sort_info_sorting_get_nth (
-			sort_info, j, &closure.sort_type[j]);
-
-		col = e_table_header_get_column_by_spec (full_header, spec);
-		if (col == NULL) {
-			gint last = e_table_header_count (full_header) - 1;
-			col = e_table_header_get_column (full_header, last);
-		}
+		col = etsu_get_sort_column (sort_info, full_header, j, NULL);
 
 		for (i = 0; i < rows; i++) {
-			e_table_model_free_value (source, col->spec->compare_col, closure.vals[map_table[i] * cols + j]);
+			e_table_model_free_value (source, col->spec->compare_col, vals[j][i]);
 		}
+
+		g_free (vals[j]);
 	}
 
-	g_free (closure.vals);
-	g_free (closure.sort_type);
-	g_free (closure.compare);
-	e_table_sorting_utils_free_cmp_cache (closure.cmp_cache);
+	g_free (vals);
+	g_free (positions);
+	g_free (map_copy);
 }
 
 gboolean
@@ -240,7 +655,7 @@ e_table_sorting_utils_affects_sort (ETableSortInfo *sort_info,
 	return FALSE;
 }
 
-/* FIXME: This could be done in time log n instead of time n with a binary search. */
+/* The map_table is sorted, thus the place is found with a binary search. */
 gint
 e_table_sorting_utils_insert (ETableModel *source,
                               ETableSortInfo *sort_info,
@@ -249,17 +664,22 @@ e_table_sorting_utils_insert (ETableModel *source,
                               gint rows,
                               gint row)
 {
-	gint i;
+	gint low = 0, high = rows;
 	gpointer cmp_cache = e_table_sorting_utils_create_cmp_cache ();
 
-	i = 0;
-	/* handle insertions when we have a 'sort group' */
-	while (i < rows && etsu_compare (source, sort_info, full_header, map_table[i], row, cmp_cache) < 0)
-		i++;
+	/* the first row which sorts after the row */
+	while (low < high) {
+		gint middle = low + (high - low) / 2;
+
+		if (etsu_compare (source, sort_info, full_header, map_table[middle], row, cmp_cache) < 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
 
 	e_table_sorting_utils_free_cmp_cache (cmp_cache);
 
-	return i;
+	return low;
 }
 
 /* FIXME: This could be done in time log n instead of time n with a binary search. */
@@ -357,41 +777,33 @@ e_table_sorting_utils_tree_sort (ETreeModel *source,
                                  ETreePath *map_table,
                                  gint count)
 {
-	ETableSortClosure closure;
 	gint cols;
 	gint i, j;
 	gint *map;
+	gpointer **vals;
 	ETreePath *map_copy;
+	ETSUKeys keys;
 
 	g_return_if_fail (E_IS_TREE_MODEL (source));
 	g_return_if_fail (E_IS_TABLE_SORT_INFO (sort_info));
 	g_return_if_fail (E_IS_TABLE_HEADER (full_header));
 
 	cols = e_table_sort_info_sorting_get_count (sort_info);
-	closure.cols = cols;
-
-	closure.vals = g_new (gpointer , count * cols);
-	closure.sort_type = g_new (GtkSortType, cols);
-	closure.compare = g_new (GCompareDataFunc, cols);
-	closure.cmp_cache = e_table_sorting_utils_create_cmp_cache ();
+	etsu_keys_init (&keys, cols, count, NULL);
 
+	vals = g_new (gpointer *, cols);
 	for (j = 0; j < cols; j++) {
-		ETableColumnSpecification *spec;
+		GtkSortType sort_type = GTK_SORT_ASCENDING;
 		ETableCol *col;
 
-		spec = e_table_sort_info_sorting_get_nth (
-			sort_info, j, &closure.sort_type[j]);
-
-		col = e_table_header_get_column_by_spec (full_header, spec);
-		if (col == NULL) {
-			gint last = e_table_header_count (full_header) - 1;
-			col = e_table_header_get_column (full_header, last);
-		}
+		col = etsu_get_sort_column (sort_info, full_header, j, &sort_type);
 
+		vals[j] = g_new (gpointer, count);
 		for (i = 0; i < count; i++) {
-			closure.vals[i * cols + j] = e_tree_model_sort_value_at (source, map_table[i], col->spec->compare_col);
+			vals[j][i] = e_tree_model_sort_value_at (source, map_table[i], col->spec->compare_col);
 		}
-		closure.compare[j] = col->compare;
+
+		etsu_keys_set_column (&keys, j, col, sort_type, vals[j]);
 	}
 
 	map = g_new (int, count);
@@ -399,8 +811,7 @@ e_table_sorting_utils_tree_sort (ETreeModel *source,
 		map[i] = i;
 	}
 
-	g_qsort_with_data (
-		map, count, sizeof (gint), e_sort_callback, &closure);
+	etsu_keys_sort (&keys, map);
 
 	map_copy = g_new (ETreePath, count);
 	for (i = 0; i < count; i++) {
@@ -410,31 +821,23 @@ e_table_sorting_utils_tree_sort (ETreeModel *source,
 		map_table[i] = map_copy[map[i]];
 	}
 
+	etsu_keys_clear (&keys);
+
 	for (j = 0; j < cols; j++) {
-		ETableColumnSpecification *spec;
 		ETableCol *col;
 
-		spec = e_table_sort_info_sorting_get_nth (
-			sort_info, j, &closure.sort_type[j]);
-
-		col = e_table_header_get_column_by_spec (full_header, spec);
-		if (col == NULL) {
-			gint last = e_table_header_count (full_header) - 1;
-			col = e_table_header_get_column (full_header, last);
-		}
+		col = etsu_get_sort_column (sort_info, full_header, j, NULL);
 
 		for (i = 0; i < count; i++) {
-			e_tree_model_free_value (source, col->spec->compare_col, closure.vals[i * cols + j]);
+			e_tree_model_free_value (source, col->spec->compare_col, vals[j][i]);
 		}
+
+		g_free (vals[j]);
 	}
 
+	g_free (vals);
 	g_free (map);
 	g_free (map_copy);
-
-	g_free (closure.vals);
-	g_free (closure.sort_type);
-	g_free (closure.compare);
-	e_table_sorting_utils_free_cmp_cache (closure.cmp_cache);
 }
 
 /* FIXME: This could be done in time log n instead of time n with a binary search. */
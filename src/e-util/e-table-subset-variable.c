@@ -113,20 +113,19 @@ etssv_remove (ETableSubsetVariable *etssv,
 	ETableSubset *etss = E_TABLE_SUBSET (etssv);
 	gint i;
 
-	for (i = 0; i < etss->n_map; i++) {
-		if (etss->map_table[i] == row) {
-			e_table_model_pre_change (etm);
-			memmove (
-				etss->map_table + i,
-				etss->map_table + i + 1,
-				(etss->n_map - i - 1) * sizeof (gint));
-			etss->n_map--;
-
-			e_table_model_row_deleted (etm, i);
-			return TRUE;
-		}
-	}
-	return FALSE;
+	i = e_table_subset_model_to_view_row (etss, row);
+	if (i == -1)
+		return FALSE;
+
+	e_table_model_pre_change (etm);
+	memmove (
+		etss->map_table + i,
+		etss->map_table + i + 1,
+		(etss->n_map - i - 1) * sizeof (gint));
+	etss->n_map--;
+
+	e_table_model_row_deleted (etm, i);
+	return TRUE;
 }
 
 static void
@@ -38,12 +38,15 @@
 
 #define d(x)
 
+/* More changed rows than this are looked up in an inverted map */
+#define LOOKUP_MAX_ROWS 8
+
 struct _ETableSubsetPrivate {
 	ETableModel *source_model;
 	gulong table_model_pre_change_handler_id;
 	gulong table_model_no_change_handler_id;
 	gulong table_model_changed_handler_id;
-	gulong table_model_row_changed_handler_id;
+	gulong table_model_rows_changed_handler_id;
 	gulong table_model_cell_changed_handler_id;
 	gulong table_model_rows_inserted_handler_id;
 	gulong table_model_rows_deleted_handler_id;
@@ -128,11 +131,11 @@ table_subset_dispose (GObject *object)
 		priv->table_model_changed_handler_id = 0;
 	}
 
-	if (priv->table_model_row_changed_handler_id > 0) {
+	if (priv->table_model_rows_changed_handler_id > 0) {
 		g_signal_handler_disconnect (
 			priv->source_model,
-			priv->table_model_row_changed_handler_id);
-		priv->table_model_row_changed_handler_id = 0;
+			priv->table_model_rows_changed_handler_id);
+		priv->table_model_rows_changed_handler_id = 0;
 	}
 
 	if (priv->table_model_cell_changed_handler_id > 0) {
@@ -210,6 +213,79 @@ table_subset_proxy_model_row_changed_real (ETableSubset *table_subset,
 		e_table_model_no_change (E_TABLE_MODEL (table_subset));
 }
 
+static gint
+table_subset_compare_rows (gconstpointer a,
+                           gconstpointer b)
+{
+	return *((const gint *) a) - *((const gint *) b);
+}
+
+static void
+table_subset_proxy_model_rows_changed_real (ETableSubset *table_subset,
+                                            ETableModel *source_model,
+                                            const gint *rows,
+                                            gint n_rows)
+{
+	ETableSubsetClass *class;
+	gint *view_rows;
+	gint n_view_rows = 0;
+	gint ii;
+
+	class = E_TABLE_SUBSET_GET_CLASS (table_subset);
+
+	/* Subclasses which handle only single rows get them one by one */
+	if (class->proxy_model_row_changed != table_subset_proxy_model_row_changed_real &&
+	    class->proxy_model_rows_changed == table_subset_proxy_model_rows_changed_real) {
+		for (ii = 0; ii < n_rows; ii++)
+			class->proxy_model_row_changed (table_subset, source_model, rows[ii]);
+		if (n_rows == 0)
+			e_table_model_no_change (E_TABLE_MODEL (table_subset));
+		return;
+	}
+
+	view_rows = g_new (gint, MAX (n_rows, 1));
+
+	if (n_rows <= LOOKUP_MAX_ROWS) {
+		for (ii = 0; ii < n_rows; ii++) {
+			gint view_row = table_subset_get_view_row (table_subset, rows[ii]);
+
+			if (view_row != -1)
+				view_rows[n_view_rows++] = view_row;
+		}
+	} else {
+		gint n_source_rows = e_table_model_row_count (source_model);
+		gint *source_to_view;
+
+		source_to_view = g_new (gint, MAX (n_source_rows, 1));
+		for (ii = 0; ii < n_source_rows; ii++)
+			source_to_view[ii] = -1;
+
+		for (ii = 0; ii < table_subset->n_map; ii++) {
+			gint row = table_subset->map_table[ii];
+
+			if (row >= 0 && row < n_source_rows)
+				source_to_view[row] = ii;
+		}
+
+		for (ii = 0; ii < n_rows; ii++) {
+			if (rows[ii] >= 0 && rows[ii] < n_source_rows && source_to_view[rows[ii]] != -1)
+				view_rows[n_view_rows++] = source_to_view[rows[ii]];
+		}
+
+		g_free (source_to_view);
+	}
+
+	if (n_view_rows > 0) {
+		qsort (view_rows, n_view_rows, sizeof (gint), table_subset_compare_rows);
+		e_table_model_rows_changed (
+			E_TABLE_MODEL (table_subset), view_rows, n_view_rows);
+	} else {
+		e_table_model_no_change (E_TABLE_MODEL (table_subset));
+	}
+
+	g_free (view_rows);
+}
+
 static void
 table_subset_proxy_model_cell_changed_real (ETableSubset *table_subset,
                                             ETableModel *source_model,
@@ -411,6 +487,7 @@ e_table_subset_class_init (ETableSubsetClass *class)
 	class->proxy_model_cell_changed = table_subset_proxy_model_cell_changed_real;
 	class->proxy_model_rows_inserted = table_subset_proxy_model_rows_inserted_real;
 	class->proxy_model_rows_deleted = table_subset_proxy_model_rows_deleted_real;
+	class->proxy_model_rows_changed = table_subset_proxy_model_rows_changed_real;
 }
 
 static void
@@ -477,17 +554,18 @@ table_subset_proxy_model_changed (ETableModel *source_model,
 }
 
 static void
-table_subset_proxy_model_row_changed (ETableModel *source_model,
-                                      gint row,
-                                      ETableSubset *table_subset)
+table_subset_proxy_model_rows_changed (ETableModel *source_model,
+                                       const gint *rows,
+                                       gint n_rows,
+                                       ETableSubset *table_subset)
 {
 	ETableSubsetClass *class;
 
 	class = E_TABLE_SUBSET_GET_CLASS (table_subset);
 
-	if (class->proxy_model_row_changed != NULL)
-		class->proxy_model_row_changed (
-			table_subset, source_model, row);
+	if (class->proxy_model_rows_changed != NULL)
+		class->proxy_model_rows_changed (
+			table_subset, source_model, rows, n_rows);
 }
 
 static void
@@ -573,10 +651,10 @@ e_table_subset_construct (ETableSubset *table_subset,
 	table_subset->priv->table_model_changed_handler_id = handler_id;
 
 	handler_id = g_signal_connect (
-		source_model, "model_row_changed",
-		G_CALLBACK (table_subset_proxy_model_row_changed),
+		source_model, "model_rows_changed",
+		G_CALLBACK (table_subset_proxy_model_rows_changed),
 		table_subset);
-	table_subset->priv->table_model_row_changed_handler_id = handler_id;
+	table_subset->priv->table_model_rows_changed_handler_id = handler_id;
 
 	handler_id = g_signal_connect (
 		source_model, "model_cell_changed",
@@ -629,15 +707,9 @@ gint
 e_table_subset_model_to_view_row (ETableSubset *table_subset,
                                   gint model_row)
 {
-	gint i;
-
 	g_return_val_if_fail (E_IS_TABLE_SUBSET (table_subset), -1);
 
-	for (i = 0; i < table_subset->n_map; i++) {
-		if (table_subset->map_table[i] == model_row)
-			return i;
-	}
-	return -1;
+	return table_subset_get_view_row (table_subset, model_row);
 }
 
 gint
@@ -94,6 +94,11 @@ struct _ETableSubsetClass {
 						 ETableModel *source_model,
 						 gint row,
 						 gint count);
+	void		(*proxy_model_rows_changed)
+						(ETableSubset *table_subset,
+						 ETableModel *source_model,
+						 const gint *rows,
+						 gint n_rows);
 };
 
 GType		e_table_subset_get_type		(void) G_GNUC_CONST;
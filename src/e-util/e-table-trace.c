@@ -0,0 +1,242 @@
+/*
+ * e-table-trace.c
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "evolution-config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "e-table-trace.h"
+
+#ifdef ENABLE_TABLE_TRACE
+
+/* How many frames and spans are kept; the oldest are overwritten */
+#define TRACE_RING_SIZE 65536
+
+typedef struct _TraceRecord {
+	const gchar *name; /* NULL for a frame */
+	gint64 begin;
+	gint64 duration;
+	guint counters[E_TABLE_TRACE_N_COUNTERS];
+} TraceRecord;
+
+static const gchar *counter_names[E_TABLE_TRACE_N_COUNTERS] = {
+	"value_at",
+	"layouts",
+	"adapter_lookups"
+};
+
+G_LOCK_DEFINE_STATIC (trace);
+static TraceRecord *trace_ring;
+static guint trace_next;
+static guint trace_length;
+static gchar *trace_filename;
+
+/* Counted since the beginning of the current frame */
+static gint trace_counters[E_TABLE_TRACE_N_COUNTERS];
+
+static void
+trace_save_at_exit (void)
+{
+	GError *error = NULL;
+
+	if (!e_table_trace_save (trace_filename, &error)) {
+		g_warning (
+			"%s: Failed to save trace to '%s': %s",
+			G_STRFUNC, trace_filename, error->message);
+		g_clear_error (&error);
+	}
+}
+
+/* The caller holds the lock */
+static TraceRecord *
+trace_record_new (const gchar *name,
+                  gint64 begin)
+{
+	TraceRecord *record;
+
+	record = &trace_ring[trace_next];
+	trace_next = (trace_next + 1) % TRACE_RING_SIZE;
+	if (trace_length < TRACE_RING_SIZE)
+		trace_length++;
+
+	memset (record, 0, sizeof (TraceRecord));
+	record->name = name;
+	record->begin = begin;
+	record->duration = g_get_monotonic_time () - begin;
+
+	return record;
+}
+
+/* Whether E_TABLE_TRACE names the file to save the trace into */
+gboolean
+e_table_trace_enabled (void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		const gchar *filename = g_getenv ("E_TABLE_TRACE");
+
+		if (filename && *filename) {
+			trace_filename = g_strdup (filename);
+			trace_ring = g_new0 (TraceRecord, TRACE_RING_SIZE);
+			atexit (trace_save_at_exit);
+		}
+
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return trace_ring != NULL;
+}
+
+/* Returns the time to pass to e_table_trace_end(), or 0 when disabled */
+gint64
+e_table_trace_begin (void)
+{
+	if (!e_table_trace_enabled ())
+		return 0;
+
+	return g_get_monotonic_time ();
+}
+
+void
+e_table_trace_end (const gchar *name,
+                   gint64 begin)
+{
+	if (!begin)
+		return;
+
+	G_LOCK (trace);
+	trace_record_new (name, begin);
+	G_UNLOCK (trace);
+}
+
+/* Like e_table_trace_begin(), and also restarts the counters */
+gint64
+e_table_trace_frame_begin (void)
+{
+	gint ii;
+
+	if (!e_table_trace_enabled ())
+		return 0;
+
+	for (ii = 0; ii < E_TABLE_TRACE_N_COUNTERS; ii++)
+		g_atomic_int_set (&trace_counters[ii], 0);
+
+	return g_get_monotonic_time ();
+}
+
+/* Records the frame with what was counted during it */
+void
+e_table_trace_frame_end (gint64 begin)
+{
+	TraceRecord *record;
+	gint ii;
+
+	if (!begin)
+		return;
+
+	G_LOCK (trace);
+
+	record = trace_record_new (NULL, begin);
+
+	for (ii = 0; ii < E_TABLE_TRACE_N_COUNTERS; ii++)
+		record->counters[ii] = g_atomic_int_get (&trace_counters[ii]);
+
+	G_UNLOCK (trace);
+}
+
+void
+e_table_trace_count (ETableTraceCounter counter)
+{
+	g_return_if_fail (counter < E_TABLE_TRACE_N_COUNTERS);
+
+	if (e_table_trace_enabled ())
+		g_atomic_int_inc (&trace_counters[counter]);
+}
+
+/* Saves the recorded frames and spans in the Chrome trace event format;
+ * the frames carry the counters as arguments and as counter events */
+gboolean
+e_table_trace_save (const gchar *filename,
+                    GError **error)
+{
+	GString *json;
+	guint ii, first;
+	gboolean success;
+
+	g_return_val_if_fail (filename != NULL, FALSE);
+
+	json = g_string_new ("{\"traceEvents\":[");
+
+	G_LOCK (trace);
+
+	first = (trace_next + TRACE_RING_SIZE - trace_length) % TRACE_RING_SIZE;
+
+	for (ii = 0; ii < trace_length; ii++) {
+		const TraceRecord *record = &trace_ring[(first + ii) % TRACE_RING_SIZE];
+		gint jj;
+
+		if (ii > 0)
+			g_string_append_c (json, ',');
+
+		/* The names are type names and literals, no need to escape them */
+		g_string_append_printf (
+			json,
+			"\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+			"\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+			"\"pid\":1,\"tid\":1",
+			record->name ? record->name : "frame",
+			record->name ? "span" : "frame",
+			record->begin, record->duration);
+
+		if (record->name) {
+			g_string_append_c (json, '}');
+			continue;
+		}
+
+		g_string_append (json, ",\"args\":{");
+		for (jj = 0; jj < E_TABLE_TRACE_N_COUNTERS; jj++)
+			g_string_append_printf (
+				json, "%s\"%s\":%u", jj > 0 ? "," : "",
+				counter_names[jj], record->counters[jj]);
+		g_string_append (json, "}}");
+
+		g_string_append_printf (
+			json,
+			",\n{\"name\":\"counters\",\"ph\":\"C\","
+			"\"ts\":%" G_GINT64_FORMAT ",\"pid\":1,\"args\":{",
+			record->begin);
+		for (jj = 0; jj < E_TABLE_TRACE_N_COUNTERS; jj++)
+			g_string_append_printf (
+				json, "%s\"%s\":%u", jj > 0 ? "," : "",
+				counter_names[jj], record->counters[jj]);
+		g_string_append (json, "}}");
+	}
+
+	G_UNLOCK (trace);
+
+	g_string_append (json, "\n]}\n");
+
+	success = g_file_set_contents (filename, json->str, json->len, error);
+
+	g_string_free (json, TRUE);
+
+	return success;
+}
+
+#endif /* ENABLE_TABLE_TRACE */
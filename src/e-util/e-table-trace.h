@@ -0,0 +1,70 @@
+/*
+ * e-table-trace.h
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Tracing of the drawing paths of ETable and ETree. It is built only when
+ * configured with -DENABLE_TABLE_TRACE=ON, otherwise the macros below
+ * expand to nothing. In such build it is enabled by setting E_TABLE_TRACE
+ * to a file name; the recorded frames and spans are written into that file
+ * at exit, in the Chrome trace event format (chrome://tracing, Perfetto).
+ * This header is private to libevolution-util. */
+
+#ifndef E_TABLE_TRACE_H
+#define E_TABLE_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+	E_TABLE_TRACE_COUNTER_VALUE_AT,
+	E_TABLE_TRACE_COUNTER_LAYOUT,
+	E_TABLE_TRACE_COUNTER_ADAPTER_LOOKUP,
+	E_TABLE_TRACE_N_COUNTERS
+} ETableTraceCounter;
+
+#ifdef ENABLE_TABLE_TRACE
+
+gboolean	e_table_trace_enabled		(void);
+gint64		e_table_trace_begin		(void);
+void		e_table_trace_end		(const gchar *name,
+						 gint64 begin);
+gint64		e_table_trace_frame_begin	(void);
+void		e_table_trace_frame_end		(gint64 begin);
+void		e_table_trace_count		(ETableTraceCounter counter);
+gboolean	e_table_trace_save		(const gchar *filename,
+						 GError **error);
+
+/* The name of a span should be a static string, it is not copied */
+#define E_TABLE_TRACE_BEGIN() e_table_trace_begin ()
+#define E_TABLE_TRACE_END(name, begin) e_table_trace_end ((name), (begin))
+#define E_TABLE_TRACE_FRAME_BEGIN() e_table_trace_frame_begin ()
+#define E_TABLE_TRACE_FRAME_END(begin) e_table_trace_frame_end (begin)
+#define E_TABLE_TRACE_COUNT(counter) e_table_trace_count (counter)
+
+#else /* ENABLE_TABLE_TRACE */
+
+#define E_TABLE_TRACE_BEGIN() ((gint64) 0)
+#define E_TABLE_TRACE_END(name, begin) ((void) (begin))
+#define E_TABLE_TRACE_FRAME_BEGIN() ((gint64) 0)
+#define E_TABLE_TRACE_FRAME_END(begin) ((void) (begin))
+#define E_TABLE_TRACE_COUNT(counter) G_STMT_START { } G_STMT_END
+
+#endif /* ENABLE_TABLE_TRACE */
+
+G_END_DECLS
+
+#endif /* E_TABLE_TRACE_H */
@@ -214,10 +214,25 @@ e_table_state_change (ETable *et)
 	if ((et)->horizontal_scrolling || (et)->horizontal_resize) \
 		e_table_header_update_horizontal (et->header);
 
+static void
+et_search_index_clear (ETable *et)
+{
+	if (!et->search_index)
+		return;
+
+	g_signal_handlers_disconnect_by_func (
+		et->model, et_search_index_clear, et);
+
+	e_table_search_index_free (et->search_index);
+	et->search_index = NULL;
+}
+
 static void
 clear_current_search_col (ETable *et)
 {
 	et->search_col_set = FALSE;
+
+	et_search_index_clear (et);
 }
 
 static ETableCol *
@@ -343,6 +358,8 @@ et_dispose (GObject *object)
 
 	et_disconnect_model (et);
 
+	et_search_index_clear (et);
+
 	if (et->search) {
 		if (et->search_search_id)
 			g_signal_handler_disconnect (
@@ -457,12 +474,56 @@ check_row (ETable *et,
 	return search (value, string);
 }
 
+/* Indexes the values of the searched column, when it is searched by the
+ * common "string" search, until the model or the sorting changes. */
+static ETableSearchIndex *
+et_search_index_get (ETable *et,
+                     ETableCol *col)
+{
+	gint rows, row;
+
+	if (et->search_index)
+		return et->search_index;
+
+	if (g_strcmp0 (col->spec->search, "string") != 0)
+		return NULL;
+
+	et->search_index = e_table_search_index_new ();
+
+	rows = e_table_model_row_count (et->model);
+	for (row = 0; row < rows; row++) {
+		e_table_search_index_add (
+			et->search_index, row,
+			e_sorter_model_to_sorted (E_SORTER (et->sorter), row),
+			e_table_model_value_at (et->model, col->spec->model_col, row));
+	}
+
+	g_signal_connect_swapped (
+		et->model, "model_changed",
+		G_CALLBACK (et_search_index_clear), et);
+	g_signal_connect_swapped (
+		et->model, "model_rows_changed",
+		G_CALLBACK (et_search_index_clear), et);
+	g_signal_connect_swapped (
+		et->model, "model_cell_changed",
+		G_CALLBACK (et_search_index_clear), et);
+	g_signal_connect_swapped (
+		et->model, "model_rows_inserted",
+		G_CALLBACK (et_search_index_clear), et);
+	g_signal_connect_swapped (
+		et->model, "model_rows_deleted",
+		G_CALLBACK (et_search_index_clear), et);
+
+	return et->search_index;
+}
+
 static gboolean
 et_search_search (ETableSearch *search,
                   gchar *string,
                   ETableSearchFlags flags,
                   ETable *et)
 {
+	ETableSearchIndex *search_index;
 	gint cursor;
 	gint rows;
 	gint i;
@@ -483,6 +544,29 @@ et_search_search (ETableSearch *search,
 		check_row (et, cursor, col->spec->model_col, col->search, string))
 		return TRUE;
 
+	search_index = et_search_index_get (et, col);
+	if (search_index) {
+		gint model_row;
+
+		model_row = e_table_search_index_find_next (
+			search_index, string,
+			e_sorter_model_to_sorted (E_SORTER (et->sorter), cursor));
+
+		if (model_row == -1)
+			return FALSE;
+
+		if (model_row != cursor) {
+			e_selection_model_select_as_key_press (
+				E_SELECTION_MODEL (et->selection),
+				model_row, col->spec->model_col,
+				GDK_CONTROL_MASK);
+			return TRUE;
+		}
+
+		/* The cursor row is the only matching row. */
+		return !(flags & E_TABLE_SEARCH_FLAGS_CHECK_CURSOR_FIRST);
+	}
+
 	cursor = e_sorter_model_to_sorted (E_SORTER (et->sorter), cursor);
 
 	for (i = cursor + 1; i < rows; i++) {
@@ -1029,6 +1113,23 @@ et_table_row_changed (ETableModel *table_model,
 	}
 }
 
+static void
+et_table_rows_changed (ETableModel *table_model,
+                       const gint *rows,
+                       gint n_rows,
+                       ETable *et)
+{
+	gint ii;
+
+	if (!et->need_rebuild) {
+		for (ii = 0; ii < n_rows; ii++) {
+			if (e_table_group_remove (et->group, rows[ii]))
+				e_table_group_add (et->group, rows[ii]);
+		}
+		CHECK_HORIZONTAL (et);
+	}
+}
+
 static void
 et_table_cell_changed (ETableModel *table_model,
                        gint view_col,
@@ -1164,8 +1265,8 @@ et_build_groups (ETable *et)
 			G_CALLBACK (et_table_model_changed), et);
 
 		et->table_row_change_id = g_signal_connect (
-			et->model, "model_row_changed",
-			G_CALLBACK (et_table_row_changed), et);
+			et->model, "model_rows_changed",
+			G_CALLBACK (et_table_rows_changed), et);
 
 		et->table_cell_change_id = g_signal_connect (
 			et->model, "model_cell_changed",
@@ -1651,6 +1752,7 @@ e_table_set_state_object (ETable *e_table,
 			e_table->sorter,
 			"sort_info", e_table->sort_info,
 			NULL);
+	et_search_index_clear (e_table);
 	if (e_table->header_item)
 		g_object_set (
 			e_table->header_item,
@@ -94,6 +94,7 @@ struct _ETable {
 	ETableSpecification *spec;
 
 	ETableSearch *search;
+	ETableSearchIndex *search_index;
 
 	ETableCol *current_search_col;
 
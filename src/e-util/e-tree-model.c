@@ -15,12 +15,16 @@
  *
  */
 
+#include "evolution-config.h"
+
 #include "e-tree-model.h"
+#include "e-table-trace.h"
 
 enum {
 	PRE_CHANGE,
 	NODE_CHANGED,
 	NODE_DATA_CHANGED,
+	NODES_DATA_CHANGED,
 	NODE_INSERTED,
 	NODE_REMOVED,
 	NODE_DELETED,
@@ -69,6 +73,17 @@ e_tree_model_default_init (ETreeModelInterface *iface)
 		G_TYPE_NONE, 1,
 		G_TYPE_POINTER);
 
+	/* See e_tree_model_nodes_data_changed() */
+	signals[NODES_DATA_CHANGED] = g_signal_new (
+		"nodes_data_changed",
+		G_TYPE_FROM_INTERFACE (iface),
+		G_SIGNAL_RUN_LAST,
+		G_STRUCT_OFFSET (ETreeModelInterface, nodes_data_changed),
+		NULL, NULL, NULL,
+		G_TYPE_NONE, 2,
+		G_TYPE_POINTER,
+		G_TYPE_INT);
+
 	signals[NODE_INSERTED] = g_signal_new (
 		"node_inserted",
 		G_TYPE_FROM_INTERFACE (iface),
@@ -160,7 +175,38 @@ e_tree_model_node_data_changed (ETreeModel *tree_model,
 {
 	g_return_if_fail (E_IS_TREE_MODEL (tree_model));
 
-	g_signal_emit (tree_model, signals[NODE_DATA_CHANGED], 0, path);
+	e_tree_model_nodes_data_changed (tree_model, &path, 1);
+}
+
+/**
+ * e_tree_model_nodes_data_changed:
+ * @tree_model: an #ETreeModel
+ * @paths: (array length=n_paths): the changed nodes
+ * @n_paths: the number of the @paths
+ *
+ * Notifies the views of the @tree_model that the data of the @paths
+ * changed, all at once.  This emits the "nodes_data_changed" signal,
+ * and then the "node_data_changed" signal for each of the @paths, for
+ * the views which handle only single nodes.
+ *
+ * Since: 3.26
+ **/
+void
+e_tree_model_nodes_data_changed (ETreeModel *tree_model,
+                                 ETreePath *paths,
+                                 gint n_paths)
+{
+	gint ii;
+
+	g_return_if_fail (E_IS_TREE_MODEL (tree_model));
+	g_return_if_fail (paths != NULL || n_paths == 0);
+
+	g_signal_emit (tree_model, signals[NODES_DATA_CHANGED], 0, paths, n_paths);
+
+	if (g_signal_has_handler_pending (tree_model, signals[NODE_DATA_CHANGED], 0, FALSE)) {
+		for (ii = 0; ii < n_paths; ii++)
+			g_signal_emit (tree_model, signals[NODE_DATA_CHANGED], 0, paths[ii]);
+	}
 }
 
 /**
@@ -564,6 +610,8 @@ e_tree_model_value_at (ETreeModel *tree_model,
 	iface = E_TREE_MODEL_GET_INTERFACE (tree_model);
 	g_return_val_if_fail (iface->value_at != NULL, NULL);
 
+	E_TABLE_TRACE_COUNT (E_TABLE_TRACE_COUNTER_VALUE_AT);
+
 	return iface->value_at (tree_model, path, col);
 }
 
@@ -128,6 +128,9 @@ struct _ETreeModelInterface {
 	void		(*node_deleted)		(ETreeModel *tree_model,
 						 ETreePath deleted_path);
 	void		(*rebuilt)		(ETreeModel *tree_model);
+	void		(*nodes_data_changed)	(ETreeModel *tree_model,
+						 ETreePath *paths,
+						 gint n_paths);
 };
 
 GType		e_tree_model_get_type		(void) G_GNUC_CONST;
@@ -201,6 +204,9 @@ void		e_tree_model_node_changed	(ETreeModel *tree_model,
 						 ETreePath path);
 void		e_tree_model_node_data_changed	(ETreeModel *tree_model,
 						 ETreePath path);
+void		e_tree_model_nodes_data_changed	(ETreeModel *tree_model,
+						 ETreePath *paths,
+						 gint n_paths);
 void		e_tree_model_node_inserted	(ETreeModel *tree_model,
 						 ETreePath parent_path,
 						 ETreePath inserted_path);
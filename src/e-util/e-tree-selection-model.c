@@ -43,11 +43,29 @@ enum {
 	PROP_ETTA
 };
 
+/* A run of selected rows, in the ETreeTableAdapter order */
+typedef struct {
+	gint start;
+	gint end; /* inclusive */
+} SelectionRange;
+
+/* The selection is kept in one of two forms:
+ *  - all_selected is FALSE: the rows of the 'ranges' and the 'paths',
+ *    which are disjoint; the ranges are sorted and do not touch,
+ *  - all_selected is TRUE: all nodes of the model, except of the root
+ *    and of the 'paths', which are the deselected nodes then.
+ * Thus selecting all or a range of rows does not depend on the count
+ * of the rows. The ranges follow the rows, thus they are turned into
+ * the 'paths' before the ETreeTableAdapter reorders them. */
 struct _ETreeSelectionModelPrivate {
 	ETreeTableAdapter *etta;
 	ETreeModel *model;
 
 	GHashTable *paths;
+	GArray *ranges; /* SelectionRange */
+	gboolean all_selected;
+	gint n_all_nodes; /* -1 when not counted yet */
+
 	ETreePath cursor_path;
 	ETreePath start_path;
 	gint cursor_col;
@@ -55,10 +73,12 @@ struct _ETreeSelectionModelPrivate {
 
 	gint tree_model_pre_change_id;
 	gint tree_model_node_changed_id;
-	gint tree_model_node_data_changed_id;
+	gint tree_model_nodes_data_changed_id;
 	gint tree_model_node_inserted_id;
 	gint tree_model_node_removed_id;
 	gint tree_model_node_deleted_id;
+
+	gulong etta_pre_change_id;
 };
 
 static gint
@@ -75,6 +95,153 @@ static void
 clear_selection (ETreeSelectionModel *etsm)
 {
 	g_hash_table_remove_all (etsm->priv->paths);
+	g_array_set_size (etsm->priv->ranges, 0);
+	etsm->priv->all_selected = FALSE;
+}
+
+/* Returns the index of the range with the row, or -1 */
+static gint
+ranges_find (ETreeSelectionModel *etsm,
+             gint row)
+{
+	GArray *ranges = etsm->priv->ranges;
+	gint low = 0, high = (gint) ranges->len - 1;
+
+	while (low <= high) {
+		gint middle = (low + high) / 2;
+		SelectionRange *range = &g_array_index (ranges, SelectionRange, middle);
+
+		if (row < range->start)
+			high = middle - 1;
+		else if (row > range->end)
+			low = middle + 1;
+		else
+			return middle;
+	}
+
+	return -1;
+}
+
+static void
+ranges_add (ETreeSelectionModel *etsm,
+            gint start,
+            gint end)
+{
+	GArray *ranges = etsm->priv->ranges;
+	SelectionRange merged;
+	guint first, last;
+
+	/* The first range which ends right before the start or later */
+	for (first = 0; first < ranges->len; first++) {
+		if (g_array_index (ranges, SelectionRange, first).end >= start - 1)
+			break;
+	}
+
+	merged.start = start;
+	merged.end = end;
+
+	/* Absorb the ranges which overlap or touch the new one */
+	for (last = first; last < ranges->len; last++) {
+		SelectionRange *range = &g_array_index (ranges, SelectionRange, last);
+
+		if (range->start > end + 1)
+			break;
+
+		merged.start = MIN (merged.start, range->start);
+		merged.end = MAX (merged.end, range->end);
+	}
+
+	if (last > first)
+		g_array_remove_range (ranges, first, last - first);
+
+	g_array_insert_val (ranges, first, merged);
+}
+
+static void
+ranges_remove_row (ETreeSelectionModel *etsm,
+                   gint index,
+                   gint row)
+{
+	SelectionRange *range;
+
+	range = &g_array_index (etsm->priv->ranges, SelectionRange, index);
+
+	if (range->start == range->end) {
+		g_array_remove_index (etsm->priv->ranges, index);
+	} else if (row == range->start) {
+		range->start++;
+	} else if (row == range->end) {
+		range->end--;
+	} else {
+		SelectionRange tail;
+
+		tail.start = row + 1;
+		tail.end = range->end;
+		range->end = row - 1;
+
+		g_array_insert_val (etsm->priv->ranges, index + 1, tail);
+	}
+}
+
+static gint
+ranges_count_rows (ETreeSelectionModel *etsm)
+{
+	gint count = 0;
+	guint ii;
+
+	for (ii = 0; ii < etsm->priv->ranges->len; ii++) {
+		SelectionRange *range;
+
+		range = &g_array_index (etsm->priv->ranges, SelectionRange, ii);
+		count += range->end - range->start + 1;
+	}
+
+	return count;
+}
+
+/* Turns the ranges into paths, which do not depend on the row order */
+static void
+ranges_to_paths (ETreeSelectionModel *etsm)
+{
+	guint ii;
+
+	for (ii = 0; ii < etsm->priv->ranges->len; ii++) {
+		SelectionRange *range;
+		gint row;
+
+		range = &g_array_index (etsm->priv->ranges, SelectionRange, ii);
+
+		for (row = range->start; row <= range->end; row++) {
+			ETreePath path;
+
+			path = e_tree_table_adapter_node_at_row (etsm->priv->etta, row);
+			if (path != NULL)
+				g_hash_table_add (etsm->priv->paths, path);
+		}
+	}
+
+	g_array_set_size (etsm->priv->ranges, 0);
+}
+
+/* The row is the one of the path, or -1 when not known */
+static gboolean
+is_path_selected (ETreeSelectionModel *etsm,
+                  ETreePath path,
+                  gint row)
+{
+	if (etsm->priv->all_selected)
+		return !e_tree_model_node_is_root (etsm->priv->model, path) &&
+			!g_hash_table_contains (etsm->priv->paths, path);
+
+	if (etsm->priv->ranges->len > 0) {
+		if (row < 0)
+			row = e_tree_table_adapter_row_of_node (etsm->priv->etta, path);
+
+		if (row >= 0 && ranges_find (etsm, row) != -1)
+			return TRUE;
+	}
+
+	return g_hash_table_contains (etsm->priv->paths, path);
 }
 
 static void
@@ -85,6 +252,32 @@ change_one_path (ETreeSelectionModel *etsm,
 	if (path == NULL)
 		return;
 
+	if (etsm->priv->all_selected) {
+		/* The root is not part of the selection */
+		if (e_tree_model_node_is_root (etsm->priv->model, path))
+			return;
+
+		if (grow)
+			g_hash_table_remove (etsm->priv->paths, path);
+		else
+			g_hash_table_add (etsm->priv->paths, path);
+
+		return;
+	}
+
+	if (etsm->priv->ranges->len > 0) {
+		gint row, index;
+
+		row = e_tree_table_adapter_row_of_node (etsm->priv->etta, path);
+		index = row >= 0 ? ranges_find (etsm, row) : -1;
+
+		if (index != -1) {
+			if (!grow)
+				ranges_remove_row (etsm, index, row);
+			return;
+		}
+	}
+
 	if (grow)
 		g_hash_table_add (etsm->priv->paths, path);
 	else
@@ -106,6 +299,8 @@ select_range (ETreeSelectionModel *etsm,
               gint start,
               gint end)
 {
+	GHashTableIter iter;
+	gpointer key;
 	gint i;
 
 	if (start > end) {
@@ -114,11 +309,24 @@ select_range (ETreeSelectionModel *etsm,
 		end = i;
 	}
 
-	for (i = start; i <= end; i++) {
-		ETreePath path = e_tree_table_adapter_node_at_row (etsm->priv->etta, i);
-		if (path != NULL)
-			g_hash_table_add (etsm->priv->paths, path);
+	start = MAX (start, 0);
+	end = MIN (end, e_table_model_row_count (E_TABLE_MODEL (etsm->priv->etta)) - 1);
+
+	if (start > end)
+		return;
+
+	/* Keep the ranges and the paths disjoint; when all is selected
+	 * the paths are the deselected nodes, which are selected now */
+	g_hash_table_iter_init (&iter, etsm->priv->paths);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		i = e_tree_table_adapter_row_of_node (etsm->priv->etta, key);
+
+		if (i >= start && i <= end)
+			g_hash_table_iter_remove (&iter);
 	}
+
+	if (!etsm->priv->all_selected)
+		ranges_add (etsm, start, end);
 }
 
 static void
@@ -183,9 +391,10 @@ etsm_node_changed (ETreeModel *etm,
 }
 
 static void
-etsm_node_data_changed (ETreeModel *etm,
-                        ETreePath node,
-                        ETreeSelectionModel *etsm)
+etsm_nodes_data_changed (ETreeModel *etm,
+                         ETreePath *nodes,
+                         gint n_nodes,
+                         ETreeSelectionModel *etsm)
 {
 	free_id (etsm);
 }
@@ -217,6 +426,41 @@ etsm_node_deleted (ETreeModel *etm,
 	restore_cursor (etsm, etm);
 }
 
+static void
+etsm_etta_pre_change (ETableModel *etta,
+                      ETreeSelectionModel *etsm)
+{
+	/* The rows can be reordered, expanded or collapsed now */
+	if (etsm->priv->ranges->len > 0)
+		ranges_to_paths (etsm);
+}
+
+static void
+set_etta (ETreeSelectionModel *etsm,
+          ETreeTableAdapter *etta)
+{
+	ETreeSelectionModelPrivate *priv = etsm->priv;
+
+	if (priv->etta) {
+		if (priv->ranges->len > 0)
+			ranges_to_paths (etsm);
+
+		g_signal_handler_disconnect (priv->etta, priv->etta_pre_change_id);
+		g_object_remove_weak_pointer (G_OBJECT (priv->etta), (gpointer *) &priv->etta);
+		priv->etta_pre_change_id = 0;
+	}
+
+	/* Not referenced, the ETree owns both */
+	priv->etta = etta;
+
+	if (priv->etta) {
+		g_object_add_weak_pointer (G_OBJECT (priv->etta), (gpointer *) &priv->etta);
+		priv->etta_pre_change_id = g_signal_connect (
+			priv->etta, "model_pre_change",
+			G_CALLBACK (etsm_etta_pre_change), etsm);
+	}
+}
+
 static void
 add_model (ETreeSelectionModel *etsm,
            ETreeModel *model)
@@ -238,9 +482,9 @@ add_model (ETreeSelectionModel *etsm,
 		priv->model, "node_changed",
 		G_CALLBACK (etsm_node_changed), etsm);
 
-	priv->tree_model_node_data_changed_id = g_signal_connect_after (
-		priv->model, "node_data_changed",
-		G_CALLBACK (etsm_node_data_changed), etsm);
+	priv->tree_model_nodes_data_changed_id = g_signal_connect_after (
+		priv->model, "nodes_data_changed",
+		G_CALLBACK (etsm_nodes_data_changed), etsm);
 
 	priv->tree_model_node_inserted_id = g_signal_connect_after (
 		priv->model, "node_inserted",
@@ -268,7 +512,7 @@ drop_model (ETreeSelectionModel *etsm)
 	g_signal_handler_disconnect (
 		priv->model, priv->tree_model_node_changed_id);
 	g_signal_handler_disconnect (
-		priv->model, priv->tree_model_node_data_changed_id);
+		priv->model, priv->tree_model_nodes_data_changed_id);
 	g_signal_handler_disconnect (
 		priv->model, priv->tree_model_node_inserted_id);
 	g_signal_handler_disconnect (
@@ -281,7 +525,7 @@ drop_model (ETreeSelectionModel *etsm)
 
 	priv->tree_model_pre_change_id = 0;
 	priv->tree_model_node_changed_id = 0;
-	priv->tree_model_node_data_changed_id = 0;
+	priv->tree_model_nodes_data_changed_id = 0;
 	priv->tree_model_node_inserted_id = 0;
 	priv->tree_model_node_removed_id = 0;
 	priv->tree_model_node_deleted_id = 0;
@@ -315,8 +559,7 @@ tree_selection_model_set_property (GObject *object,
 		break;
 
 	case PROP_ETTA:
-		etsm->priv->etta =
-			E_TREE_TABLE_ADAPTER (g_value_get_object (value));
+		set_etta (etsm, E_TREE_TABLE_ADAPTER (g_value_get_object (value)));
 		break;
 	}
 }
@@ -354,6 +597,7 @@ tree_selection_model_dispose (GObject *object)
 	ETreeSelectionModel *etsm = E_TREE_SELECTION_MODEL (object);
 
 	drop_model (etsm);
+	set_etta (etsm, NULL);
 
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (e_tree_selection_model_parent_class)->dispose (object);
@@ -368,6 +612,7 @@ tree_selection_model_finalize (GObject *object)
 
 	clear_selection (E_TREE_SELECTION_MODEL (object));
 	g_hash_table_destroy (priv->paths);
+	g_array_free (priv->ranges, TRUE);
 
 	/* Chain up to parent's finalize() method. */
 	G_OBJECT_CLASS (e_tree_selection_model_parent_class)->finalize (object);
@@ -390,7 +635,7 @@ tree_selection_model_is_row_selected (ESelectionModel *selection,
 	if (path == NULL)
 		return FALSE;
 
-	return g_hash_table_contains (etsm->priv->paths, path);
+	return is_path_selected (etsm, path, row);
 }
 
 static void
@@ -401,6 +646,41 @@ tree_selection_model_foreach (ESelectionModel *selection,
 	ETreeSelectionModel *etsm = E_TREE_SELECTION_MODEL (selection);
 	GList *list, *link;
 
+	if (etsm->priv->all_selected) {
+		gint row, row_count;
+
+		row_count = e_table_model_row_count (E_TABLE_MODEL (etsm->priv->etta));
+
+		for (row = 0; row < row_count; row++) {
+			ETreePath path;
+
+			path = e_tree_table_adapter_node_at_row (etsm->priv->etta, row);
+			if (path && is_path_selected (etsm, path, row))
+				callback (row, closure);
+		}
+
+		return;
+	}
+
+	if (etsm->priv->ranges->len > 0) {
+		GArray *ranges;
+		guint ii;
+
+		/* A copy, in case the callback changes the selection */
+		ranges = g_array_sized_new (FALSE, FALSE, sizeof (SelectionRange), etsm->priv->ranges->len);
+		g_array_append_vals (ranges, etsm->priv->ranges->data, etsm->priv->ranges->len);
+
+		for (ii = 0; ii < ranges->len; ii++) {
+			SelectionRange *range = &g_array_index (ranges, SelectionRange, ii);
+			gint row;
+
+			for (row = range->start; row <= range->end; row++)
+				callback (row, closure);
+		}
+
+		g_array_free (ranges, TRUE);
+	}
+
 	list = g_hash_table_get_keys (etsm->priv->paths);
 
 	for (link = list; link != NULL; link = g_list_next (link)) {
@@ -427,26 +707,45 @@ tree_selection_model_clear (ESelectionModel *selection)
 	e_selection_model_cursor_changed (E_SELECTION_MODEL (etsm), -1, -1);
 }
 
-static gint
-tree_selection_model_selected_count (ESelectionModel *selection)
+/* Helper for tree_selection_model_selected_count() */
+static gboolean
+tree_selection_model_count_cb (ETreeModel *tree_model,
+                               ETreePath path,
+                               gpointer user_data)
 {
-	ETreeSelectionModel *etsm = E_TREE_SELECTION_MODEL (selection);
+	gint *n_nodes = user_data;
+
+	(*n_nodes)++;
 
-	return g_hash_table_size (etsm->priv->paths);
+	return FALSE;
 }
 
-/* Helper for tree_selection_model_select_all() */
-static gboolean
-tree_selection_model_traverse_cb (ETreeModel *tree_model,
-                                  ETreePath path,
-                                  gpointer user_data)
+static gint
+tree_selection_model_selected_count (ESelectionModel *selection)
 {
-	ETreeSelectionModel *etsm;
+	ETreeSelectionModel *etsm = E_TREE_SELECTION_MODEL (selection);
 
-	etsm = E_TREE_SELECTION_MODEL (user_data);
-	g_hash_table_add (etsm->priv->paths, path);
+	if (etsm->priv->all_selected) {
+		/* Any change of the model clears the selection,
+		 * thus the nodes are counted only once */
+		if (etsm->priv->n_all_nodes < 0) {
+			ETreePath root;
+
+			etsm->priv->n_all_nodes = 0;
+
+			root = e_tree_model_get_root (etsm->priv->model);
+			if (root) {
+				e_tree_model_node_traverse (
+					etsm->priv->model, root,
+					tree_selection_model_count_cb,
+					&etsm->priv->n_all_nodes);
+			}
+		}
 
-	return FALSE;
+		return etsm->priv->n_all_nodes - g_hash_table_size (etsm->priv->paths);
+	}
+
+	return g_hash_table_size (etsm->priv->paths) + ranges_count_rows (etsm);
 }
 
 static void
@@ -463,12 +762,9 @@ tree_selection_model_select_all (ESelectionModel *selection)
 
 	/* We want to select ALL rows regardless of expanded state.
 	 * ETreeTableAdapter pretends that collapsed rows don't exist,
-	 * so instead we need to iterate over the ETreeModel directly. */
-
-	e_tree_model_node_traverse (
-		etsm->priv->model, root,
-		tree_selection_model_traverse_cb,
-		selection);
+	 * thus the selection covers the nodes of the ETreeModel. */
+	etsm->priv->all_selected = TRUE;
+	etsm->priv->n_all_nodes = -1;
 
 	if (etsm->priv->cursor_path == NULL)
 		etsm->priv->cursor_path = e_tree_table_adapter_node_at_row (
@@ -569,8 +865,9 @@ tree_selection_model_select_single_row (ESelectionModel *selection,
 	g_return_if_fail (path != NULL);
 
 	/* we really only care about the size=1 case (cursor changed),
-	 * but this doesn't cost much */
-	size = g_hash_table_size (etsm->priv->paths);
+	 * but this doesn't cost much; all selected means many rows */
+	size = etsm->priv->all_selected ? G_MAXINT :
+		tree_selection_model_selected_count (selection);
 	if (size > 0 && size <= 5) {
 		rowp = rows;
 		tree_selection_model_foreach (selection, etsm_get_rows, &rowp);
@@ -603,10 +900,7 @@ tree_selection_model_toggle_single_row (ESelectionModel *selection,
 	path = e_tree_table_adapter_node_at_row (etsm->priv->etta, row);
 	g_return_if_fail (path);
 
-	if (g_hash_table_contains (etsm->priv->paths, path))
-		g_hash_table_remove (etsm->priv->paths, path);
-	else
-		g_hash_table_add (etsm->priv->paths, path);
+	change_one_path (etsm, path, !is_path_selected (etsm, path, row));
 
 	etsm->priv->start_path = NULL;
 
@@ -734,6 +1028,8 @@ e_tree_selection_model_init (ETreeSelectionModel *etsm)
 	etsm->priv = E_TREE_SELECTION_MODEL_GET_PRIVATE (etsm);
 
 	etsm->priv->paths = g_hash_table_new (NULL, NULL);
+	etsm->priv->ranges = g_array_new (FALSE, FALSE, sizeof (SelectionRange));
+	etsm->priv->n_all_nodes = -1;
 	etsm->priv->cursor_col = -1;
 }
 
@@ -743,6 +1039,27 @@ e_tree_selection_model_new (void)
 	return g_object_new (E_TYPE_TREE_SELECTION_MODEL, NULL);
 }
 
+/* Helper for e_tree_selection_model_foreach() */
+typedef struct _ForeachData {
+	ETreeSelectionModel *etsm;
+	ETreeForeachFunc callback;
+	gpointer closure;
+} ForeachData;
+
+/* Helper for e_tree_selection_model_foreach() */
+static gboolean
+tree_selection_model_foreach_cb (ETreeModel *tree_model,
+                                 ETreePath path,
+                                 gpointer user_data)
+{
+	ForeachData *fd = user_data;
+
+	if (!g_hash_table_contains (fd->etsm->priv->paths, path))
+		fd->callback (path, fd->closure);
+
+	return FALSE;
+}
+
 void
 e_tree_selection_model_foreach (ETreeSelectionModel *etsm,
                                 ETreeForeachFunc callback,
@@ -753,6 +1070,49 @@ e_tree_selection_model_foreach (ETreeSelectionModel *etsm,
 	g_return_if_fail (E_IS_TREE_SELECTION_MODEL (etsm));
 	g_return_if_fail (callback != NULL);
 
+	if (etsm->priv->all_selected) {
+		ForeachData fd;
+		ETreePath root;
+
+		root = e_tree_model_get_root (etsm->priv->model);
+		if (!root)
+			return;
+
+		fd.etsm = etsm;
+		fd.callback = callback;
+		fd.closure = closure;
+
+		e_tree_model_node_traverse (
+			etsm->priv->model, root,
+			tree_selection_model_foreach_cb, &fd);
+
+		return;
+	}
+
+	if (etsm->priv->ranges->len > 0) {
+		GArray *ranges;
+		guint ii;
+
+		/* A copy, in case the callback changes the selection */
+		ranges = g_array_sized_new (FALSE, FALSE, sizeof (SelectionRange), etsm->priv->ranges->len);
+		g_array_append_vals (ranges, etsm->priv->ranges->data, etsm->priv->ranges->len);
+
+		for (ii = 0; ii < ranges->len; ii++) {
+			SelectionRange *range = &g_array_index (ranges, SelectionRange, ii);
+			gint row;
+
+			for (row = range->start; row <= range->end; row++) {
+				ETreePath path;
+
+				path = e_tree_table_adapter_node_at_row (etsm->priv->etta, row);
+				if (path)
+					callback (path, closure);
+			}
+		}
+
+		g_array_free (ranges, TRUE);
+	}
+
 	list = g_hash_table_get_keys (etsm->priv->paths);
 
 	for (link = list; link != NULL; link = g_list_next (link))
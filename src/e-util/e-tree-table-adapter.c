@@ -20,6 +20,8 @@
  *
  */
 
+#include "evolution-config.h"
+
 #include "e-tree-table-adapter.h"
 
 #include <stdlib.h>
@@ -34,6 +36,7 @@
 
 #include "e-marshal.h"
 #include "e-table-sorting-utils.h"
+#include "e-table-trace.h"
 #include "e-xml-utils.h"
 
 #define E_TREE_TABLE_ADAPTER_GET_PRIVATE(obj) \
@@ -59,7 +62,7 @@ struct _ETreeTableAdapterPrivate {
 	gulong pre_change_handler_id;
 	gulong rebuilt_handler_id;
 	gulong node_changed_handler_id;
-	gulong node_data_changed_handler_id;
+	gulong nodes_data_changed_handler_id;
 	gulong node_inserted_handler_id;
 	gulong node_removed_handler_id;
 
@@ -171,10 +174,16 @@ fill_map (ETreeTableAdapter *etta,
 static void
 remap_indices (ETreeTableAdapter *etta)
 {
+	gint64 trace_begin;
 	gint i;
+
+	trace_begin = E_TABLE_TRACE_BEGIN ();
+
 	for (i = 0; i < etta->priv->n_map; i++)
 		etta->priv->map_table[i]->index = i;
 	etta->priv->remap_needed = FALSE;
+
+	E_TABLE_TRACE_END ("etta_remap_indices", trace_begin);
 }
 
 static node_t *
@@ -626,19 +635,52 @@ tree_table_adapter_source_model_node_changed_cb (ETreeModel *source_model,
 			tree_table_adapter_resort_model_idle_cb, etta);
 }
 
+static gint
+tree_table_adapter_compare_rows (gconstpointer a,
+                                 gconstpointer b)
+{
+	return *((const gint *) a) - *((const gint *) b);
+}
+
+/* Tells about the shown ones of the changed nodes in one change */
 static void
-tree_table_adapter_source_model_node_data_changed_cb (ETreeModel *source_model,
-                                                      ETreePath path,
-                                                      ETreeTableAdapter *etta)
+tree_table_adapter_source_model_nodes_data_changed_cb (ETreeModel *source_model,
+                                                       ETreePath *paths,
+                                                       gint n_paths,
+                                                       ETreeTableAdapter *etta)
 {
-	gint row = e_tree_table_adapter_row_of_node (etta, path);
+	gint *rows;
+	gint ii, n_rows = 0;
 
-	if (row == -1) {
-		e_table_model_no_change (E_TABLE_MODEL (etta));
-		return;
+	rows = g_new (gint, MAX (n_paths, 1));
+
+	for (ii = 0; ii < n_paths; ii++) {
+		gint row = e_tree_table_adapter_row_of_node (etta, paths[ii]);
+
+		if (row != -1)
+			rows[n_rows++] = row;
 	}
 
-	e_table_model_row_changed (E_TABLE_MODEL (etta), row);
+	if (n_rows > 1) {
+		gint jj;
+
+		qsort (rows, n_rows, sizeof (gint), tree_table_adapter_compare_rows);
+
+		/* A node can be listed more than once */
+		for (ii = 1, jj = 1; ii < n_rows; ii++) {
+			if (rows[ii] != rows[jj - 1])
+				rows[jj++] = rows[ii];
+		}
+
+		n_rows = jj;
+	}
+
+	if (n_rows > 0)
+		e_table_model_rows_changed (E_TABLE_MODEL (etta), rows, n_rows);
+	else
+		e_table_model_no_change (E_TABLE_MODEL (etta));
+
+	g_free (rows);
 }
 
 static void
@@ -791,11 +833,11 @@ tree_table_adapter_dispose (GObject *object)
 		priv->node_changed_handler_id = 0;
 	}
 
-	if (priv->node_data_changed_handler_id > 0) {
+	if (priv->nodes_data_changed_handler_id > 0) {
 		g_signal_handler_disconnect (
 			priv->source_model,
-			priv->node_data_changed_handler_id);
-		priv->node_data_changed_handler_id = 0;
+			priv->nodes_data_changed_handler_id);
+		priv->nodes_data_changed_handler_id = 0;
 	}
 
 	if (priv->node_inserted_handler_id > 0) {
@@ -891,10 +933,10 @@ tree_table_adapter_constructed (GObject *object)
 	etta->priv->node_changed_handler_id = handler_id;
 
 	handler_id = g_signal_connect (
-		source_model, "node_data_changed",
-		G_CALLBACK (tree_table_adapter_source_model_node_data_changed_cb),
+		source_model, "nodes_data_changed",
+		G_CALLBACK (tree_table_adapter_source_model_nodes_data_changed_cb),
 		etta);
-	etta->priv->node_data_changed_handler_id = handler_id;
+	etta->priv->nodes_data_changed_handler_id = handler_id;
 
 	handler_id = g_signal_connect (
 		source_model, "node_inserted",
@@ -1581,6 +1623,8 @@ e_tree_table_adapter_node_at_row (ETreeTableAdapter *etta,
 {
 	g_return_val_if_fail (E_IS_TREE_TABLE_ADAPTER (etta), NULL);
 
+	E_TABLE_TRACE_COUNT (E_TABLE_TRACE_COUNTER_ADAPTER_LOOKUP);
+
 	if (row == -1 && etta->priv->n_map > 0)
 		row = etta->priv->n_map - 1;
 	else if (row < 0 || row >= etta->priv->n_map)
@@ -1597,6 +1641,8 @@ e_tree_table_adapter_row_of_node (ETreeTableAdapter *etta,
 
 	g_return_val_if_fail (E_IS_TREE_TABLE_ADAPTER (etta), -1);
 
+	E_TABLE_TRACE_COUNT (E_TABLE_TRACE_COUNTER_ADAPTER_LOOKUP);
+
 	node = get_node (etta, path);
 	if (node == NULL)
 		return -1;
@@ -129,6 +129,12 @@ struct _ETreePrivate {
 
 	ETableSearch     *search;
 
+	/* The searched column in the order of the search, with
+	 * the nodes at the indexed positions and their positions */
+	ETableSearchIndex *search_index;
+	GPtrArray        *search_index_paths;
+	GHashTable       *search_index_positions;
+
 	ETableCol        *current_search_col;
 
 	guint	  search_search_id;
@@ -302,10 +308,28 @@ et_disconnect_from_etta (ETree *tree)
 	tree->priv->table_rows_delete_id = 0;
 }
 
+static void
+et_search_index_clear (ETree *tree)
+{
+	if (!tree->priv->search_index)
+		return;
+
+	g_signal_handlers_disconnect_by_func (
+		tree->priv->model, et_search_index_clear, tree);
+
+	e_table_search_index_free (tree->priv->search_index);
+	tree->priv->search_index = NULL;
+
+	g_clear_pointer (&tree->priv->search_index_paths, g_ptr_array_unref);
+	g_clear_pointer (&tree->priv->search_index_positions, g_hash_table_unref);
+}
+
 static void
 clear_current_search_col (ETree *tree)
 {
 	tree->priv->search_col_set = FALSE;
+
+	et_search_index_clear (tree);
 }
 
 static ETableCol *
@@ -425,6 +449,8 @@ et_dispose (GObject *object)
 
 	priv = E_TREE_GET_PRIVATE (object);
 
+	et_search_index_clear (E_TREE (object));
+
 	if (priv->search != NULL) {
 		g_signal_handler_disconnect (
 			priv->search, priv->search_search_id);
@@ -546,12 +572,103 @@ search_search_callback (ETreeModel *model,
 	return col->search (value, cb_data->string);
 }
 
+/* Indexes the values of the searched column, when it is searched by the
+ * common "string" search, until the model changes. The nodes are indexed
+ * in the order e_tree_model_node_find() visits them. */
+static ETableSearchIndex *
+et_search_index_get (ETree *tree,
+                     ETableCol *col)
+{
+	ETreeModel *model = tree->priv->model;
+	ETreePath path;
+
+	if (tree->priv->search_index)
+		return tree->priv->search_index;
+
+	if (g_strcmp0 (col->spec->search, "string") != 0)
+		return NULL;
+
+	tree->priv->search_index = e_table_search_index_new ();
+	tree->priv->search_index_paths = g_ptr_array_new ();
+	tree->priv->search_index_positions = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	path = e_tree_model_get_root (model);
+	while (path) {
+		gint position = tree->priv->search_index_paths->len;
+		ETreePath next;
+
+		g_ptr_array_add (tree->priv->search_index_paths, path);
+		g_hash_table_insert (tree->priv->search_index_positions, path, GINT_TO_POINTER (position));
+
+		e_table_search_index_add (
+			tree->priv->search_index, position, position,
+			e_tree_model_value_at (model, path, col->spec->model_col));
+
+		next = e_tree_model_node_get_first_child (model, path);
+		while (!next && path) {
+			next = e_tree_model_node_get_next (model, path);
+			if (!next)
+				path = e_tree_model_node_get_parent (model, path);
+		}
+
+		path = next;
+	}
+
+	g_signal_connect_swapped (
+		model, "pre_change",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "rebuilt",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "node_changed",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "nodes_data_changed",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "node_inserted",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "node_removed",
+		G_CALLBACK (et_search_index_clear), tree);
+	g_signal_connect_swapped (
+		model, "node_deleted",
+		G_CALLBACK (et_search_index_clear), tree);
+
+	return tree->priv->search_index;
+}
+
+/* Finds the next matching node after the cursor, or from the start */
+static ETreePath
+et_search_index_find (ETree *tree,
+                      ETableSearchIndex *search_index,
+                      const gchar *string,
+                      ETreePath cursor)
+{
+	gpointer value;
+	gint after = -1, position;
+
+	if (cursor && g_hash_table_lookup_extended (
+		tree->priv->search_index_positions, cursor, NULL, &value))
+		after = GPOINTER_TO_INT (value);
+
+	position = e_table_search_index_find_next (
+		search_index, string, after);
+
+	if (position == -1)
+		return NULL;
+
+	return g_ptr_array_index (tree->priv->search_index_paths, position);
+}
+
 static gboolean
 et_search_search (ETableSearch *search,
                   gchar *string,
                   ETableSearchFlags flags,
                   ETree *tree)
 {
+	ETableSearchIndex *search_index;
 	ETreePath cursor;
 	ETreePath found;
 	SearchSearchStruct cb_data;
@@ -576,13 +693,18 @@ et_search_search (ETableSearch *search,
 		}
 	}
 
-	found = e_tree_model_node_find (
-		tree->priv->model, cursor, NULL,
-		search_search_callback, &cb_data);
-	if (found == NULL)
+	search_index = et_search_index_get (tree, col);
+	if (search_index) {
+		found = et_search_index_find (tree, search_index, string, cursor);
+	} else {
 		found = e_tree_model_node_find (
-			tree->priv->model, NULL, cursor,
+			tree->priv->model, cursor, NULL,
 			search_search_callback, &cb_data);
+		if (found == NULL)
+			found = e_tree_model_node_find (
+				tree->priv->model, NULL, cursor,
+				search_search_callback, &cb_data);
+	}
 
 	if (found && found != cursor) {
 		gint model_row;
@@ -1509,9 +1631,10 @@ et_table_model_changed (ETableModel *model,
 }
 
 static void
-et_table_row_changed (ETableModel *table_model,
-                      gint row,
-                      ETree *tree)
+et_table_rows_changed (ETableModel *table_model,
+                       const gint *rows,
+                       gint n_rows,
+                       ETree *tree)
 {
 	et_table_model_changed (table_model, tree);
 }
@@ -1586,8 +1709,8 @@ et_connect_to_etta (ETree *tree)
 		G_CALLBACK (et_table_model_changed), tree);
 
 	tree->priv->table_row_change_id = g_signal_connect (
-		tree->priv->etta, "model_row_changed",
-		G_CALLBACK (et_table_row_changed), tree);
+		tree->priv->etta, "model_rows_changed",
+		G_CALLBACK (et_table_rows_changed), tree);
 
 	tree->priv->table_cell_change_id = g_signal_connect (
 		tree->priv->etta, "model_cell_changed",
@@ -0,0 +1,390 @@
+/*
+ * test-name-selector-benchmark.c
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* A benchmark of the ENameSelectorEntry autocompletion. It types name
+ * prefixes into an entry, which is not shown on the screen, completing
+ * from the address book given by --source, and reports how long each
+ * stage of the completion took, as measured by the entry itself (see
+ * its "completion-timings" property). With --populate it first fills
+ * the address book with --contacts synthetic contacts, thus use a scratch
+ * address book for it. The entry is a GtkWidget, thus the program still
+ * requires a display; use Xvfb or similar on machines without one. */
+
+#include "evolution-config.h"
+
+#include <stdlib.h>
+#include <camel/camel.h>
+#include <e-util/e-util.h>
+
+#define POPULATE_BATCH_SIZE 1000
+
+static gint opt_contacts = 10000;
+static gint opt_iterations = 20;
+static gint opt_seed = 1;
+static gint opt_cue_length = 3;
+static gchar *opt_source_uid = NULL;
+static gboolean opt_populate = FALSE;
+
+static GOptionEntry entries[] = {
+	{ "source", 's', 0, G_OPTION_ARG_STRING, &opt_source_uid,
+	  "UID of an address book to complete from", "UID" },
+	{ "populate", 'p', 0, G_OPTION_ARG_NONE, &opt_populate,
+	  "Store the synthetic contacts into the --source address book first", NULL },
+	{ "contacts", 'c', 0, G_OPTION_ARG_INT, &opt_contacts,
+	  "Number of synthetic contacts to populate with", "N" },
+	{ "iterations", 'i', 0, G_OPTION_ARG_INT, &opt_iterations,
+	  "How many completions to measure", "N" },
+	{ "cue-length", 'l', 0, G_OPTION_ARG_INT, &opt_cue_length,
+	  "Length of the typed name prefixes", "N" },
+	{ "seed", 0, 0, G_OPTION_ARG_INT, &opt_seed,
+	  "Seed of the random generator", "N" },
+	{ NULL }
+};
+
+static const gchar *given_names[] = {
+	"Adam", "Alice", "Andrew", "Barbara", "Benjamin", "Carla", "Charles",
+	"Daniel", "Diana", "Edward", "Elena", "Frank", "George", "Hannah",
+	"Isabel", "Jacob", "Julia", "Karl", "Laura", "Martin", "Monica",
+	"Nathan", "Olivia", "Peter", "Rachel", "Samuel", "Sophia", "Thomas",
+	"Victor", "Wendy"
+};
+
+static const gchar *family_names[] = {
+	"Anderson", "Baker", "Brown", "Carter", "Clark", "Davis", "Evans",
+	"Fischer", "Garcia", "Hughes", "Jansson", "Johnson", "Keller", "Lopez",
+	"Martin", "Miller", "Moore", "Nelson", "Novak", "Parker", "Roberts",
+	"Schmidt", "Smith", "Taylor", "Thompson", "Turner", "Walker", "White",
+	"Wilson", "Young"
+};
+
+static EContact *
+bench_new_contact (GRand *rand,
+                   gint index)
+{
+	EContact *contact;
+	EContactName *name;
+	const gchar *given, *family;
+	gchar *email;
+
+	given = given_names[g_rand_int_range (rand, 0, G_N_ELEMENTS (given_names))];
+	family = family_names[g_rand_int_range (rand, 0, G_N_ELEMENTS (family_names))];
+
+	contact = e_contact_new ();
+
+	name = e_contact_name_new ();
+	name->given = g_strdup (given);
+	name->family = g_strdup_printf ("%s%d", family, index);
+	e_contact_set (contact, E_CONTACT_NAME, name);
+	e_contact_name_free (name);
+
+	email = g_strdup_printf ("%s.%s%d@example.com", given, family, index);
+	e_contact_set (contact, E_CONTACT_EMAIL_1, email);
+	g_free (email);
+
+	/* Every tenth contact has a second address */
+	if ((index % 10) == 9) {
+		email = g_strdup_printf ("%c%s%d@example.org", given[0], family, index);
+		e_contact_set (contact, E_CONTACT_EMAIL_2, email);
+		g_free (email);
+	}
+
+	return contact;
+}
+
+static gboolean
+bench_populate (EBookClient *book_client,
+                gint n_contacts,
+                GRand *rand)
+{
+	GSList *batch = NULL;
+	gint64 started;
+	gint ii, n_batch = 0;
+	gboolean success = TRUE;
+	GError *local_error = NULL;
+
+	started = g_get_monotonic_time ();
+
+	for (ii = 0; ii < n_contacts && success; ii++) {
+		batch = g_slist_prepend (batch, bench_new_contact (rand, ii));
+		n_batch++;
+
+		if (n_batch == POPULATE_BATCH_SIZE || ii + 1 == n_contacts) {
+			success = e_book_client_add_contacts_sync (book_client, batch, NULL, NULL, &local_error);
+
+			g_slist_free_full (batch, g_object_unref);
+			batch = NULL;
+			n_batch = 0;
+		}
+	}
+
+	if (!success) {
+		g_printerr ("Failed to populate the address book: %s\n", local_error ? local_error->message : "Unknown error");
+		g_clear_error (&local_error);
+		return FALSE;
+	}
+
+	g_print ("%-16s %10.3f ms   %d contacts\n", "populate",
+		(g_get_monotonic_time () - started) / 1000.0, n_contacts);
+
+	return TRUE;
+}
+
+typedef struct _BenchStage {
+	const gchar *name;
+	gint64 sum;
+	gint64 min;
+	gint64 max;
+} BenchStage;
+
+typedef struct _BenchData {
+	GMainLoop *main_loop;
+	gboolean completed;
+} BenchData;
+
+static void
+bench_completion_timings_cb (ENameSelectorEntry *entry,
+                             GParamSpec *param,
+                             BenchData *bd)
+{
+	bd->completed = TRUE;
+	g_main_loop_quit (bd->main_loop);
+}
+
+static gboolean
+bench_timeout_cb (gpointer user_data)
+{
+	BenchData *bd = user_data;
+
+	g_main_loop_quit (bd->main_loop);
+
+	return FALSE;
+}
+
+static gchar *
+bench_new_cue (GRand *rand,
+               gint cue_length)
+{
+	const gchar *name;
+
+	if (g_rand_boolean (rand))
+		name = given_names[g_rand_int_range (rand, 0, G_N_ELEMENTS (given_names))];
+	else
+		name = family_names[g_rand_int_range (rand, 0, G_N_ELEMENTS (family_names))];
+
+	return g_strndup (name, cue_length);
+}
+
+static void
+bench_add_timings (BenchStage *stages,
+                   gint n_stages,
+                   GVariant *timings)
+{
+	gint ii;
+
+	for (ii = 0; ii < n_stages; ii++) {
+		gint64 value = 0;
+
+		g_variant_lookup (timings, stages[ii].name, "x", &value);
+
+		stages[ii].sum += value;
+		if (stages[ii].min < 0 || value < stages[ii].min)
+			stages[ii].min = value;
+		if (value > stages[ii].max)
+			stages[ii].max = value;
+	}
+}
+
+static gboolean
+bench_completion (EClientCache *client_cache,
+                  EBookClient *book_client,
+                  gint iterations,
+                  gint cue_length,
+                  GRand *rand)
+{
+	BenchStage stages[] = {
+		{ "update-model", 0, -1, 0 },
+		{ "first-result", 0, -1, 0 },
+		{ "generate-rows", 0, -1, 0 },
+		{ "find-completion", 0, -1, 0 },
+		{ "total", 0, -1, 0 },
+		{ "contacts", 0, -1, 0 }
+	};
+	EContactStore *contact_store;
+	GtkWidget *window, *entry;
+	BenchData bd;
+	gulong handler_id;
+	gint ii, n_completed = 0, n_timed_out = 0;
+
+	contact_store = e_contact_store_new ();
+	e_contact_store_add_client (contact_store, book_client);
+
+	entry = e_name_selector_entry_new (client_cache);
+	e_name_selector_entry_set_contact_store (E_NAME_SELECTOR_ENTRY (entry), contact_store);
+	e_name_selector_entry_set_minimum_query_length (E_NAME_SELECTOR_ENTRY (entry), cue_length);
+
+	/* Realized, but never shown on the screen */
+	window = gtk_offscreen_window_new ();
+	gtk_container_add (GTK_CONTAINER (window), entry);
+	gtk_widget_show_all (window);
+
+	bd.main_loop = g_main_loop_new (NULL, FALSE);
+
+	handler_id = g_signal_connect (entry, "notify::completion-timings",
+		G_CALLBACK (bench_completion_timings_cb), &bd);
+
+	for (ii = 0; ii < iterations; ii++) {
+		GVariant *timings;
+		gchar *cue;
+		guint timeout_id;
+		gint position = 0;
+
+		gtk_editable_delete_text (GTK_EDITABLE (entry), 0, -1);
+
+		cue = bench_new_cue (rand, cue_length);
+		gtk_editable_insert_text (GTK_EDITABLE (entry), cue, -1, &position);
+		gtk_editable_set_position (GTK_EDITABLE (entry), position);
+		g_free (cue);
+
+		bd.completed = FALSE;
+
+		timeout_id = e_named_timeout_add_seconds (60, bench_timeout_cb, &bd);
+		g_main_loop_run (bd.main_loop);
+
+		if (!bd.completed) {
+			n_timed_out++;
+			continue;
+		}
+
+		g_source_remove (timeout_id);
+
+		timings = e_name_selector_entry_ref_completion_timings (E_NAME_SELECTOR_ENTRY (entry));
+		if (timings) {
+			bench_add_timings (stages, G_N_ELEMENTS (stages), timings);
+			g_variant_unref (timings);
+			n_completed++;
+		}
+	}
+
+	g_signal_handler_disconnect (entry, handler_id);
+
+	for (ii = 0; ii < (gint) G_N_ELEMENTS (stages) && n_completed > 0; ii++) {
+		/* The "contacts" is a count, not a time */
+		if (ii + 1 == (gint) G_N_ELEMENTS (stages)) {
+			g_print ("%-16s %10.1f avg %10" G_GINT64_FORMAT " min %10" G_GINT64_FORMAT " max\n",
+				stages[ii].name, (gdouble) stages[ii].sum / n_completed,
+				stages[ii].min, stages[ii].max);
+		} else {
+			g_print ("%-16s %10.3f ms avg %10.3f ms min %10.3f ms max\n",
+				stages[ii].name, stages[ii].sum / 1000.0 / n_completed,
+				stages[ii].min / 1000.0, stages[ii].max / 1000.0);
+		}
+	}
+
+	g_print ("%d completions measured, %d timed out\n", n_completed, n_timed_out);
+
+	gtk_widget_destroy (window);
+	g_main_loop_unref (bd.main_loop);
+	g_object_unref (contact_store);
+
+	return n_completed > 0;
+}
+
+gint
+main (gint argc,
+      gchar **argv)
+{
+	GOptionContext *context;
+	ESourceRegistry *registry;
+	EClientCache *client_cache;
+	ESource *source;
+	EClient *client;
+	GRand *rand;
+	gboolean success = FALSE;
+	GError *local_error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Measures the autocompletion of the name selector entry.");
+	g_option_context_add_main_entries (context, entries, NULL);
+	g_option_context_add_group (context, gtk_get_option_group (FALSE));
+
+	if (!g_option_context_parse (context, &argc, &argv, &local_error)) {
+		g_printerr ("%s\n", local_error->message);
+		g_clear_error (&local_error);
+		g_option_context_free (context);
+		exit (EXIT_FAILURE);
+	}
+
+	g_option_context_free (context);
+
+	if (!opt_source_uid) {
+		g_printerr ("The --source option is required\n");
+		exit (EXIT_FAILURE);
+	}
+
+	if (!gtk_init_check (&argc, &argv)) {
+		g_printerr ("Cannot open a display\n");
+		exit (EXIT_FAILURE);
+	}
+
+	camel_init (NULL, 0);
+
+	if (opt_iterations <= 0)
+		opt_iterations = 1;
+
+	if (opt_cue_length <= 0)
+		opt_cue_length = 1;
+
+	registry = e_source_registry_new_sync (NULL, &local_error);
+	if (!registry) {
+		g_printerr ("Failed to create source registry: %s\n", local_error ? local_error->message : "Unknown error");
+		g_clear_error (&local_error);
+		exit (EXIT_FAILURE);
+	}
+
+	source = e_source_registry_ref_source (registry, opt_source_uid);
+	if (!source) {
+		g_printerr ("Address book '%s' not found\n", opt_source_uid);
+		g_object_unref (registry);
+		exit (EXIT_FAILURE);
+	}
+
+	client = e_book_client_connect_sync (source, 30, NULL, &local_error);
+	if (!client) {
+		g_printerr ("Failed to open '%s': %s\n", opt_source_uid, local_error ? local_error->message : "Unknown error");
+		g_clear_error (&local_error);
+		g_object_unref (source);
+		g_object_unref (registry);
+		exit (EXIT_FAILURE);
+	}
+
+	client_cache = e_client_cache_new (registry);
+	rand = g_rand_new_with_seed (opt_seed);
+
+	if (!opt_populate || bench_populate (E_BOOK_CLIENT (client), MAX (opt_contacts, 0), rand))
+		success = bench_completion (client_cache, E_BOOK_CLIENT (client), opt_iterations, opt_cue_length, rand);
+
+	g_rand_free (rand);
+	g_object_unref (client_cache);
+	g_object_unref (client);
+	g_object_unref (source);
+	g_object_unref (registry);
+	g_free (opt_source_uid);
+
+	e_util_cleanup_settings ();
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -90,6 +90,9 @@
 /* We must run our idle update handler *before* GDK wants to redraw. */
 #define CANVAS_IDLE_PRIORITY (GDK_PRIORITY_REDRAW - 5)
 
+/* Exposed areas of more rectangles are painted as their bounding box */
+#define CANVAS_MAX_PAINT_RECTS 16
+
 static void gnome_canvas_request_update (GnomeCanvas      *canvas);
 static void group_add                   (GnomeCanvasGroup *group,
 					 GnomeCanvasItem  *item);
@@ -1536,6 +1539,8 @@ gnome_canvas_group_draw (GnomeCanvasItem *item,
 		    && (child->y1 < (y + height))
 		    && (child->x2 > x)
 		    && (child->y2 > y))) {
+			item->canvas->frame_items_drawn++;
+
 			cairo_save (cr);
 
 			GNOME_CANVAS_ITEM_GET_CLASS (child)->draw (
@@ -1802,6 +1807,8 @@ gnome_canvas_paint_rect (GnomeCanvas *canvas,
 	canvas->draw_xofs = draw_x1;
 	canvas->draw_yofs = draw_y1;
 
+	canvas->frame_pixels_painted += (guint64) draw_width * draw_height;
+
 	cairo_save (cr);
 
 	g_signal_emit (
@@ -1811,6 +1818,8 @@ gnome_canvas_paint_rect (GnomeCanvas *canvas,
 	cairo_restore (cr);
 
 	if (canvas->root->flags & GNOME_CANVAS_ITEM_VISIBLE) {
+		canvas->frame_items_drawn++;
+
 		cairo_save (cr);
 
 		(* GNOME_CANVAS_ITEM_GET_CLASS (canvas->root)->draw) (
@@ -1940,6 +1949,8 @@ gnome_canvas_init (GnomeCanvas *canvas)
 
 	canvas->need_update = FALSE;
 	canvas->idle_id = 0;
+	canvas->tick_id = 0;
+	canvas->redraw_region = NULL;
 
 	canvas->scroll_x1 = 0.0;
 	canvas->scroll_y1 = 0.0;
@@ -1970,14 +1981,19 @@ gnome_canvas_init (GnomeCanvas *canvas)
 static void
 remove_idle (GnomeCanvas *canvas)
 {
-	if (canvas->idle_id == 0)
-		return;
+	if (canvas->idle_id) {
+		g_source_remove (canvas->idle_id);
+		canvas->idle_id = 0;
+	}
 
-	g_source_remove (canvas->idle_id);
-	canvas->idle_id = 0;
+	if (canvas->tick_id) {
+		gtk_widget_remove_tick_callback (GTK_WIDGET (canvas), canvas->tick_id);
+		canvas->tick_id = 0;
+	}
 }
 
-/* Removes the transient state of the canvas (idle handler, grabs). */
+/* Removes the transient state of the canvas (idle handler, grabs,
+ * pending redraws). */
 static void
 shutdown_transients (GnomeCanvas *canvas)
 {
@@ -1990,6 +2006,8 @@ shutdown_transients (GnomeCanvas *canvas)
 	canvas->grabbed_item = NULL;
 
 	remove_idle (canvas);
+
+	g_clear_pointer (&canvas->redraw_region, cairo_region_destroy);
 }
 
 /* Dispose handler for GnomeCanvas */
@@ -2266,12 +2284,12 @@ gnome_canvas_size_allocate (GtkWidget *widget,
 	g_object_thaw_notify (G_OBJECT (vadjustment));
 }
 
-static gboolean
-gnome_canvas_draw (GtkWidget *widget,
-                   cairo_t *cr)
+static void
+gnome_canvas_paint_area (GnomeCanvas *canvas,
+                         cairo_t *cr,
+                         cairo_rectangle_int_t *rect,
+                         gboolean clip)
 {
-	GnomeCanvas *canvas = GNOME_CANVAS (widget);
-	cairo_rectangle_int_t rect;
 	GtkLayout *layout;
 	GtkAdjustment *hadjustment;
 	GtkAdjustment *vadjustment;
@@ -2285,7 +2303,37 @@ gnome_canvas_draw (GtkWidget *widget,
 	hadjustment_value = gtk_adjustment_get_value (hadjustment);
 	vadjustment_value = gtk_adjustment_get_value (vadjustment);
 
-	gdk_cairo_get_clip_rectangle (cr, &rect);
+	cairo_save (cr);
+
+	/* The items may draw outside of the area, thus keep them
+	 * from covering the items above them in the other areas */
+	if (clip) {
+		cairo_rectangle (cr, rect->x, rect->y, rect->width, rect->height);
+		cairo_clip (cr);
+	}
+
+	cairo_translate (
+		cr,
+		-canvas->zoom_xofs + rect->x,
+		-canvas->zoom_yofs + rect->y);
+
+	/* No pending updates, draw exposed area immediately */
+	gnome_canvas_paint_rect (
+		canvas, cr,
+		rect->x + hadjustment_value,
+		rect->y + vadjustment_value,
+		rect->x + hadjustment_value + rect->width,
+		rect->y + vadjustment_value + rect->height);
+	cairo_restore (cr);
+}
+
+static gboolean
+gnome_canvas_draw (GtkWidget *widget,
+                   cairo_t *cr)
+{
+	GnomeCanvas *canvas = GNOME_CANVAS (widget);
+	cairo_rectangle_list_t *rects;
+	cairo_rectangle_int_t rect;
 
 	if (canvas->need_update) {
 		cairo_matrix_t w2c;
@@ -2298,22 +2346,34 @@ gnome_canvas_draw (GtkWidget *widget,
 		canvas->need_update = FALSE;
 	}
 
-	cairo_save (cr);
-	cairo_translate (
-		cr,
-		-canvas->zoom_xofs + rect.x,
-		-canvas->zoom_yofs + rect.y);
+	canvas->frame_items_drawn = 0;
+	canvas->frame_pixels_painted = 0;
 
-	rect.x += hadjustment_value;
-	rect.y += vadjustment_value;
+	/* Paint only the damaged rectangles, not everything between them */
+	rects = cairo_copy_clip_rectangle_list (cr);
 
-	/* No pending updates, draw exposed area immediately */
-	gnome_canvas_paint_rect (
-		canvas, cr,
-		rect.x, rect.y,
-		rect.x + rect.width,
-		rect.y + rect.height);
-	cairo_restore (cr);
+	if (rects->status == CAIRO_STATUS_SUCCESS &&
+	    rects->num_rectangles > 0 &&
+	    rects->num_rectangles <= CANVAS_MAX_PAINT_RECTS) {
+		gint ii;
+
+		for (ii = 0; ii < rects->num_rectangles; ii++) {
+			cairo_rectangle_t *clip_rect = &rects->rectangles[ii];
+
+			rect.x = floor (clip_rect->x);
+			rect.y = floor (clip_rect->y);
+			rect.width = ceil (clip_rect->x + clip_rect->width) - rect.x;
+			rect.height = ceil (clip_rect->y + clip_rect->height) - rect.y;
+
+			gnome_canvas_paint_area (canvas, cr, &rect, rects->num_rectangles > 1);
+		}
+	} else {
+		gdk_cairo_get_clip_rectangle (cr, &rect);
+
+		gnome_canvas_paint_area (canvas, cr, &rect, FALSE);
+	}
+
+	cairo_rectangle_list_destroy (rects);
 
 	/* And call expose on parent container class */
 	GTK_WIDGET_CLASS (gnome_canvas_parent_class)->draw (widget, cr);
@@ -2879,6 +2939,26 @@ update_again:
 	}
 }
 
+/* Passes the areas requested to be redrawn to the window at once */
+static void
+flush_redraw_region (GnomeCanvas *canvas)
+{
+	cairo_region_t *region;
+
+	region = canvas->redraw_region;
+	canvas->redraw_region = NULL;
+
+	if (!region)
+		return;
+
+	if (gtk_widget_is_drawable (GTK_WIDGET (canvas)))
+		gdk_window_invalidate_region (
+			gtk_layout_get_bin_window (GTK_LAYOUT (canvas)),
+			region, FALSE);
+
+	cairo_region_destroy (region);
+}
+
 /* Idle handler for the canvas.  It deals with pending updates and redraws. */
 static gboolean
 idle_handler (gpointer data)
@@ -2888,6 +2968,7 @@ idle_handler (gpointer data)
 	canvas = GNOME_CANVAS (data);
 
 	do_update (canvas);
+	flush_redraw_region (canvas);
 
 	/* Reset idle id */
 	canvas->idle_id = 0;
@@ -2895,20 +2976,47 @@ idle_handler (gpointer data)
 	return FALSE;
 }
 
+/* Frame clock tick callback for the canvas, the same as the idle
+ * handler, only run right before the frame is painted. */
+static gboolean
+tick_handler (GtkWidget *widget,
+              GdkFrameClock *frame_clock,
+              gpointer user_data)
+{
+	GnomeCanvas *canvas;
+
+	canvas = GNOME_CANVAS (widget);
+
+	do_update (canvas);
+	flush_redraw_region (canvas);
+
+	/* Reset tick id */
+	canvas->tick_id = 0;
+
+	return G_SOURCE_REMOVE;
+}
+
 /* Convenience function to add an idle handler to a canvas */
 static void
 add_idle (GnomeCanvas *canvas)
 {
-	g_return_if_fail (canvas->need_update);
+	GtkWidget *widget = GTK_WIDGET (canvas);
+
+	g_return_if_fail (canvas->need_update || canvas->redraw_region);
 
-	if (!canvas->idle_id)
+	if (canvas->idle_id || canvas->tick_id)
+		return;
+
+	/* Update once per frame, when the frame clock is available */
+	if (gtk_widget_get_mapped (widget) && gtk_widget_get_frame_clock (widget))
+		canvas->tick_id = gtk_widget_add_tick_callback (
+			widget, tick_handler, NULL, NULL);
+	else
 		canvas->idle_id = g_idle_add_full (
 			CANVAS_IDLE_PRIORITY,
 			idle_handler,
 			canvas,
 			NULL);
-
-/*	canvas->idle_id = gtk_idle_add (idle_handler, canvas); */
 }
 
 /**
@@ -3181,9 +3289,36 @@ gnome_canvas_request_redraw (GnomeCanvas *canvas,
 	if (!gdk_rectangle_intersect (&area, &clip, &area))
 		return;
 
-	gdk_window_invalidate_rect (
-		gtk_layout_get_bin_window (GTK_LAYOUT (canvas)),
-		&area, FALSE);
+	/* Merged with the other requests and passed to the window
+	 * before the next frame is painted */
+	if (canvas->redraw_region)
+		cairo_region_union_rectangle (canvas->redraw_region, &area);
+	else
+		canvas->redraw_region = cairo_region_create_rectangle (&area);
+
+	add_idle (canvas);
+}
+
+/**
+ * gnome_canvas_get_frame_stats:
+ * @canvas: A canvas.
+ * @items_drawn: (out) (optional): number of items drawn
+ * @pixels_painted: (out) (optional): number of pixels painted
+ *
+ * Gets how many items the canvas drew and how many pixels it painted
+ * the last time it was drawn, for measuring the cost of the redraws.
+ **/
+void
+gnome_canvas_get_frame_stats (GnomeCanvas *canvas,
+                              guint *items_drawn,
+                              guint64 *pixels_painted)
+{
+	g_return_if_fail (GNOME_IS_CANVAS (canvas));
+
+	if (items_drawn)
+		*items_drawn = canvas->frame_items_drawn;
+	if (pixels_painted)
+		*pixels_painted = canvas->frame_pixels_painted;
 }
 
 /**
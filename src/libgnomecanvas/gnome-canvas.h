@@ -376,6 +376,16 @@ struct _GnomeCanvas {
 	/* Idle handler ID */
 	guint idle_id;
 
+	/* Frame clock tick callback ID, used instead of the idle handler */
+	guint tick_id;
+
+	/* Area to be redrawn, not passed to the window yet */
+	cairo_region_t *redraw_region;
+
+	/* Items drawn and pixels painted by the last draw */
+	guint frame_items_drawn;
+	guint64 frame_pixels_painted;
+
 	/* Offsets of the temprary drawing pixmap */
 	gint draw_xofs, draw_yofs;
 
@@ -459,6 +469,11 @@ GnomeCanvasItem *gnome_canvas_get_item_at (GnomeCanvas *canvas, gdouble x, gdoub
  */
 void gnome_canvas_request_redraw (GnomeCanvas *canvas, gint x1, gint y1, gint x2, gint y2);
 
+/* Gets how many items were drawn and how many pixels painted by the last
+ * draw of the canvas.
+ */
+void gnome_canvas_get_frame_stats (GnomeCanvas *canvas, guint *items_drawn, guint64 *pixels_painted);
+
 /* Gets the affine transform that converts world coordinates into canvas pixel
  * coordinates.
  */
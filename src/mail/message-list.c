@@ -86,6 +86,15 @@ struct _MessageListPrivate {
 	CamelFolder *folder;
 	gulong folder_changed_handler_id;
 
+	/* Backs the vectors of normalised_hash; freed with them. The regen
+	 * thread sorts by the normalised strings too, thus both are guarded
+	 * by the lock, and an arena replaced while regen threads run is kept
+	 * in retired_arenas until the last of them finishes. */
+	GMutex normalised_lock;
+	EPoolvArena *normalised_arena;
+	GSList *retired_arenas;
+	guint n_regen_threads;
+
 	/* For message list regeneration. */
 	GMutex regen_lock;
 	RegenData *regen_data;
@@ -746,7 +755,7 @@ get_normalised_string (MessageList *message_list,
                        CamelMessageInfo *info,
                        gint col)
 {
-	const gchar *string, *str;
+	const gchar *string, *str = NULL;
 	gchar *normalised;
 	EPoolv *poolv;
 	gint index;
@@ -774,15 +783,14 @@ get_normalised_string (MessageList *message_list,
 	if (string == NULL || string[0] == '\0')
 		return "";
 
+	g_mutex_lock (&message_list->priv->normalised_lock);
 	poolv = g_hash_table_lookup (message_list->normalised_hash, camel_message_info_get_uid (info));
-	if (poolv == NULL) {
-		poolv = e_poolv_new (NORMALISED_LAST);
-		g_hash_table_insert (message_list->normalised_hash, (gchar *) camel_message_info_get_uid (info), poolv);
-	} else {
+	if (poolv != NULL)
 		str = e_poolv_get (poolv, index);
-		if (*str)
-			return str;
-	}
+	g_mutex_unlock (&message_list->priv->normalised_lock);
+
+	if (str && *str)
+		return str;
 
 	if (col == COL_SUBJECT_NORM) {
 		gint skip_len;
@@ -816,9 +824,41 @@ get_normalised_string (MessageList *message_list,
 		normalised = g_strdup (string);
 	}
 
+	g_mutex_lock (&message_list->priv->normalised_lock);
+
+	poolv = g_hash_table_lookup (message_list->normalised_hash, camel_message_info_get_uid (info));
+	if (poolv == NULL) {
+		poolv = e_poolv_arena_alloc (message_list->priv->normalised_arena, NORMALISED_LAST);
+		g_hash_table_insert (message_list->normalised_hash, (gchar *) camel_message_info_get_uid (info), poolv);
+	}
+
 	e_poolv_set (poolv, index, normalised, TRUE);
+	str = e_poolv_get (poolv, index);
+
+	g_mutex_unlock (&message_list->priv->normalised_lock);
 
-	return e_poolv_get (poolv, index);
+	return str;
+}
+
+/* Drops all the normalised strings. Those still used by a running regen
+ * thread are freed only after the last of the threads finishes. */
+static void
+message_list_reset_normalised (MessageList *message_list)
+{
+	g_mutex_lock (&message_list->priv->normalised_lock);
+
+	g_hash_table_remove_all (message_list->normalised_hash);
+
+	if (message_list->priv->n_regen_threads > 0)
+		message_list->priv->retired_arenas = g_slist_prepend (
+			message_list->priv->retired_arenas,
+			message_list->priv->normalised_arena);
+	else
+		e_poolv_arena_free (message_list->priv->normalised_arena);
+
+	message_list->priv->normalised_arena = e_poolv_arena_new ();
+
+	g_mutex_unlock (&message_list->priv->normalised_lock);
 }
 
 static void
@@ -3007,6 +3047,10 @@ message_list_finalize (GObject *object)
 	MessageList *message_list = MESSAGE_LIST (object);
 
 	g_hash_table_destroy (message_list->normalised_hash);
+	e_poolv_arena_free (message_list->priv->normalised_arena);
+	g_slist_free_full (
+		message_list->priv->retired_arenas,
+		(GDestroyNotify) e_poolv_arena_free);
 
 	if (message_list->priv->thread_tree != NULL)
 		camel_folder_thread_messages_unref (
@@ -3018,6 +3062,7 @@ message_list_finalize (GObject *object)
 	g_strfreev (message_list->priv->re_prefixes);
 	g_strfreev (message_list->priv->re_separators);
 
+	g_mutex_clear (&message_list->priv->normalised_lock);
 	g_mutex_clear (&message_list->priv->regen_lock);
 	g_mutex_clear (&message_list->priv->thread_tree_lock);
 	g_mutex_clear (&message_list->priv->re_prefixes_lock);
@@ -3691,12 +3736,14 @@ message_list_init (MessageList *message_list)
 		g_str_hash, g_str_equal,
 		(GDestroyNotify) NULL,
 		(GDestroyNotify) e_poolv_destroy);
+	message_list->priv->normalised_arena = e_poolv_arena_new ();
 
 	message_list->uid_nodemap = g_hash_table_new (g_str_hash, g_str_equal);
 
 	message_list->cursor_uid = NULL;
 	message_list->last_sel_single = FALSE;
 
+	g_mutex_init (&message_list->priv->normalised_lock);
 	g_mutex_init (&message_list->priv->regen_lock);
 	g_mutex_init (&message_list->priv->thread_tree_lock);
 	g_mutex_init (&message_list->priv->re_prefixes_lock);
@@ -4587,15 +4634,15 @@ build_flat (MessageList *message_list,
 
 }
 
+/* Adds the collapsed parent showing the node, if any, to the changed nodes */
 static void
-message_list_change_first_visible_parent (MessageList *message_list,
-                                          GNode *node)
+message_list_add_first_visible_parent (MessageList *message_list,
+                                       GNode *node,
+                                       GPtrArray *changed_nodes)
 {
-	ETreeModel *tree_model;
 	ETreeTableAdapter *adapter;
 	GNode *first_visible = NULL;
 
-	tree_model = E_TREE_MODEL (message_list);
 	adapter = e_tree_get_table_adapter (E_TREE (message_list));
 
 	while (node != NULL && (node = node->parent) != NULL) {
@@ -4603,10 +4650,8 @@ message_list_change_first_visible_parent (MessageList *message_list,
 			first_visible = node;
 	}
 
-	if (first_visible != NULL) {
-		e_tree_model_pre_change (tree_model);
-		e_tree_model_node_data_changed (tree_model, first_visible);
-	}
+	if (first_visible != NULL)
+		g_ptr_array_add (changed_nodes, first_visible);
 }
 
 static CamelFolderChangeInfo *
@@ -4689,10 +4734,12 @@ message_list_folder_changed (CamelFolder *folder,
 		changes ? changes->uid_recent->len : -1,
 		camel_folder_get_full_name (folder)));
 	if (changes != NULL) {
+		g_mutex_lock (&message_list->priv->normalised_lock);
 		for (i = 0; i < changes->uid_removed->len; i++)
 			g_hash_table_remove (
 				message_list->normalised_hash,
 				changes->uid_removed->pdata[i]);
+		g_mutex_unlock (&message_list->priv->normalised_lock);
 
 		/* Check if the hidden state has changed.
 		 * If so, modify accordingly and regenerate. */
@@ -4707,6 +4754,10 @@ message_list_folder_changed (CamelFolder *folder,
 		}
 
 		if (altered_changes->uid_added->len == 0 && altered_changes->uid_removed->len == 0 && altered_changes->uid_changed->len < 100) {
+			GPtrArray *changed_nodes;
+
+			changed_nodes = g_ptr_array_new ();
+
 			for (i = 0; i < altered_changes->uid_changed->len; i++) {
 				GNode *node;
 
@@ -4714,13 +4765,22 @@ message_list_folder_changed (CamelFolder *folder,
 					message_list->uid_nodemap,
 					altered_changes->uid_changed->pdata[i]);
 				if (node) {
-					e_tree_model_pre_change (tree_model);
-					e_tree_model_node_data_changed (tree_model, node);
-
-					message_list_change_first_visible_parent (message_list, node);
+					g_ptr_array_add (changed_nodes, node);
+					message_list_add_first_visible_parent (message_list, node, changed_nodes);
 				}
 			}
 
+			/* All the changed messages in one change */
+			if (changed_nodes->len > 0) {
+				e_tree_model_pre_change (tree_model);
+				e_tree_model_nodes_data_changed (
+					tree_model,
+					(ETreePath *) changed_nodes->pdata,
+					changed_nodes->len);
+			}
+
+			g_ptr_array_free (changed_nodes, TRUE);
+
 			g_signal_emit (
 				message_list,
 				signals[MESSAGE_LIST_BUILT], 0);
@@ -4790,11 +4850,11 @@ message_list_set_folder (MessageList *message_list,
 		message_list->seen_id = 0;
 	}
 
-	/* reset the normalised sort performance hack */
-	g_hash_table_remove_all (message_list->normalised_hash);
-
 	mail_regen_cancel (message_list);
 
+	/* reset the normalised sort performance hack */
+	message_list_reset_normalised (message_list);
+
 	if (message_list->priv->folder != NULL)
 		save_tree_state (message_list, message_list->priv->folder);
 
@@ -5842,6 +5902,10 @@ message_list_regen_thread (GSimpleAsyncResult *simple,
 	if (g_cancellable_is_cancelled (cancellable))
 		return;
 
+	g_mutex_lock (&message_list->priv->normalised_lock);
+	message_list->priv->n_regen_threads++;
+	g_mutex_unlock (&message_list->priv->normalised_lock);
+
 	/* Just for convenience. */
 	folder = g_object_ref (regen_data->folder);
 
@@ -5978,6 +6042,16 @@ exit:
 		camel_folder_free_uids (folder, uids);
 
 	g_object_unref (folder);
+
+	g_mutex_lock (&message_list->priv->normalised_lock);
+	message_list->priv->n_regen_threads--;
+	if (message_list->priv->n_regen_threads == 0) {
+		g_slist_free_full (
+			message_list->priv->retired_arenas,
+			(GDestroyNotify) e_poolv_arena_free);
+		message_list->priv->retired_arenas = NULL;
+	}
+	g_mutex_unlock (&message_list->priv->normalised_lock);
 }
 
 static void
@@ -687,6 +687,23 @@ e_book_shell_content_set_preview_contact (EBookShellContent *book_shell_content,
 	g_object_notify (G_OBJECT (book_shell_content), "preview-contact");
 }
 
+void
+e_book_shell_content_prerender_preview_contacts (EBookShellContent *book_shell_content,
+                                                 const GSList *contacts)
+{
+	EPreviewPane *preview_pane;
+	EABContactDisplay *display;
+	EWebView *web_view;
+
+	g_return_if_fail (E_IS_BOOK_SHELL_CONTENT (book_shell_content));
+
+	preview_pane = E_PREVIEW_PANE (book_shell_content->priv->preview_pane);
+	web_view = e_preview_pane_get_web_view (preview_pane);
+	display = EAB_CONTACT_DISPLAY (web_view);
+
+	eab_contact_display_prerender_contacts (display, contacts);
+}
+
 EPreviewPane *
 e_book_shell_content_get_preview_pane (EBookShellContent *book_shell_content)
 {
@@ -95,6 +95,9 @@ EContact *	e_book_shell_content_get_preview_contact
 void		e_book_shell_content_set_preview_contact
 					(EBookShellContent *book_shell_content,
 					 EContact *preview_contact);
+void		e_book_shell_content_prerender_preview_contacts
+					(EBookShellContent *book_shell_content,
+					 const GSList *contacts);
 EPreviewPane *	e_book_shell_content_get_preview_pane
 					(EBookShellContent *book_shell_content);
 gboolean	e_book_shell_content_get_preview_visible
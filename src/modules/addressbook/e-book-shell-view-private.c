@@ -71,6 +71,48 @@ popup_event (EBookShellView *book_shell_view,
 	e_shell_view_show_popup_menu (shell_view, widget_path, button_event);
 }
 
+/* Renders the contacts around the previewed row, in the view order,
+ * thus moving through the list with the keyboard shows them quickly */
+static void
+book_shell_view_prerender_neighbours (EBookShellView *book_shell_view,
+                                      EAddressbookView *view,
+                                      gint row)
+{
+	EAddressbookModel *model;
+	ESelectionModel *selection_model;
+	GSList *contacts = NULL;
+	gint sorted, count, ii;
+
+	model = e_addressbook_view_get_model (view);
+	selection_model = e_addressbook_view_get_selection_model (view);
+	count = e_addressbook_model_contact_count (model);
+
+	if (selection_model && selection_model->sorter)
+		sorted = e_sorter_model_to_sorted (selection_model->sorter, row);
+	else
+		sorted = row;
+
+	for (ii = sorted - 1; ii <= sorted + 1; ii += 2) {
+		gint model_row = ii;
+		EContact *contact;
+
+		if (ii < 0 || ii >= count)
+			continue;
+
+		if (selection_model && selection_model->sorter)
+			model_row = e_sorter_sorted_to_model (selection_model->sorter, ii);
+
+		contact = e_addressbook_model_contact_at (model, model_row);
+		if (contact)
+			contacts = g_slist_prepend (contacts, contact);
+	}
+
+	e_book_shell_content_prerender_preview_contacts (
+		book_shell_view->priv->book_shell_content, contacts);
+
+	g_slist_free (contacts);
+}
+
 static void
 book_shell_view_selection_change_foreach (gint row,
                                           EBookShellView *book_shell_view)
@@ -92,8 +134,10 @@ book_shell_view_selection_change_foreach (gint row,
 	e_book_shell_content_set_preview_contact (book_shell_content, contact);
 	book_shell_view->priv->preview_index = row;
 
-	if (contact)
+	if (contact) {
+		book_shell_view_prerender_neighbours (book_shell_view, view, row);
 		g_object_unref (contact);
+	}
 }
 
 static void
@@ -133,23 +177,26 @@ selection_change (EBookShellView *book_shell_view,
 }
 
 static void
-contact_changed (EBookShellView *book_shell_view,
-                 gint index,
-                 EAddressbookModel *model)
+contacts_changed (EBookShellView *book_shell_view,
+                  gint index,
+                  gint count,
+                  EAddressbookModel *model)
 {
 	EBookShellContent *book_shell_content;
 	EContact *contact;
+	gint preview_index;
 
 	g_return_if_fail (E_IS_SHELL_VIEW (book_shell_view));
 	g_return_if_fail (book_shell_view->priv != NULL);
 
 	book_shell_content = book_shell_view->priv->book_shell_content;
+	preview_index = book_shell_view->priv->preview_index;
 
-	contact = e_addressbook_model_contact_at (model, index);
-
-	if (book_shell_view->priv->preview_index != index)
+	if (preview_index < index || preview_index >= index + count)
 		return;
 
+	contact = e_addressbook_model_contact_at (model, preview_index);
+
 	/* Re-render the same contact. */
 	e_book_shell_content_set_preview_contact (book_shell_content, contact);
 }
@@ -321,8 +368,8 @@ book_shell_view_activate_selected_source (EBookShellView *book_shell_view,
 		model = e_addressbook_view_get_model (view);
 
 		g_signal_connect_object (
-			model, "contact-changed",
-			G_CALLBACK (contact_changed),
+			model, "contacts-changed",
+			G_CALLBACK (contacts_changed),
 			book_shell_view, G_CONNECT_SWAPPED);
 
 		g_signal_connect_object (
@@ -23,13 +23,31 @@
 	(G_TYPE_INSTANCE_GET_PRIVATE \
 	((obj), E_TYPE_PHOTO_CACHE_CONTACT_LOADER, EPhotoCacheContactLoaderPrivate))
 
+typedef struct _BookMonitor BookMonitor;
+
 struct _EPhotoCacheContactLoaderPrivate {
 	ESourceRegistry *registry;
 	gulong source_added_handler_id;
 	gulong source_removed_handler_id;
 
+	EClientCache *client_cache;
+	gulong client_created_handler_id;
+
 	/* ESource -> EPhotoSource */
 	GHashTable *photo_sources;
+
+	/* ESource -> BookMonitor */
+	GHashTable *book_monitors;
+};
+
+/* Watches the contacts with an email address in an opened book,
+ * to drop the cached photos of the addresses which changed. */
+struct _BookMonitor {
+	EPhotoCacheContactLoader *loader;
+	GCancellable *cancellable;
+	EBookClientView *view;
+	GHashTable *uid_emails; /* gchar *uid ~> gchar **emails */
+	gboolean complete;
 };
 
 G_DEFINE_DYNAMIC_TYPE (
@@ -47,6 +65,211 @@ photo_cache_contact_loader_get_photo_cache (EPhotoCacheContactLoader *loader)
 	return E_PHOTO_CACHE (extensible);
 }
 
+static void
+book_monitor_free (gpointer ptr)
+{
+	BookMonitor *monitor = ptr;
+
+	if (!monitor)
+		return;
+
+	g_cancellable_cancel (monitor->cancellable);
+	g_clear_object (&monitor->cancellable);
+
+	if (monitor->view) {
+		g_signal_handlers_disconnect_matched (
+			monitor->view, G_SIGNAL_MATCH_DATA,
+			0, 0, NULL, NULL, monitor);
+		e_book_client_view_stop (monitor->view, NULL);
+		g_clear_object (&monitor->view);
+	}
+
+	g_hash_table_destroy (monitor->uid_emails);
+
+	g_slice_free (BookMonitor, monitor);
+}
+
+static void
+book_monitor_remove_photos (BookMonitor *monitor,
+                            gchar **emails)
+{
+	EPhotoCache *photo_cache;
+	gint ii;
+
+	if (!emails || !monitor->complete)
+		return;
+
+	photo_cache = photo_cache_contact_loader_get_photo_cache (monitor->loader);
+
+	for (ii = 0; emails[ii]; ii++) {
+		e_photo_cache_remove_photo (photo_cache, emails[ii]);
+	}
+}
+
+static gchar **
+book_monitor_dup_emails (EContact *contact)
+{
+	GList *emails, *link;
+	GPtrArray *array;
+
+	emails = e_contact_get (contact, E_CONTACT_EMAIL);
+	if (!emails)
+		return NULL;
+
+	array = g_ptr_array_new ();
+
+	for (link = emails; link; link = g_list_next (link)) {
+		g_ptr_array_add (array, link->data);
+	}
+
+	g_ptr_array_add (array, NULL);
+	g_list_free (emails);
+
+	return (gchar **) g_ptr_array_free (array, FALSE);
+}
+
+/* Added or modified contacts; the photo of the email address
+ * can be either new or changed, thus drop the cache entry */
+static void
+book_monitor_objects_changed_cb (EBookClientView *view,
+                                 const GSList *contacts,
+                                 BookMonitor *monitor)
+{
+	const GSList *link;
+
+	for (link = contacts; link; link = g_slist_next (link)) {
+		EContact *contact = link->data;
+		const gchar *uid;
+		gchar **emails;
+
+		uid = e_contact_get_const (contact, E_CONTACT_UID);
+		if (!uid)
+			continue;
+
+		book_monitor_remove_photos (monitor, g_hash_table_lookup (monitor->uid_emails, uid));
+
+		emails = book_monitor_dup_emails (contact);
+		book_monitor_remove_photos (monitor, emails);
+
+		if (emails)
+			g_hash_table_insert (monitor->uid_emails, g_strdup (uid), emails);
+		else
+			g_hash_table_remove (monitor->uid_emails, uid);
+	}
+}
+
+static void
+book_monitor_objects_removed_cb (EBookClientView *view,
+                                 const GSList *uids,
+                                 BookMonitor *monitor)
+{
+	const GSList *link;
+
+	for (link = uids; link; link = g_slist_next (link)) {
+		const gchar *uid = link->data;
+
+		book_monitor_remove_photos (monitor, g_hash_table_lookup (monitor->uid_emails, uid));
+		g_hash_table_remove (monitor->uid_emails, uid);
+	}
+}
+
+static void
+book_monitor_complete_cb (EBookClientView *view,
+                          const GError *error,
+                          BookMonitor *monitor)
+{
+	/* The initial set of contacts is known, react on changes since now */
+	monitor->complete = TRUE;
+}
+
+static void
+book_monitor_view_ready_cb (GObject *source_object,
+                            GAsyncResult *result,
+                            gpointer user_data)
+{
+	BookMonitor *monitor = user_data;
+	EBookClientView *view = NULL;
+	GSList *fields = NULL;
+	GError *local_error = NULL;
+
+	e_book_client_get_view_finish (E_BOOK_CLIENT (source_object), result, &view, &local_error);
+
+	/* The monitor is freed when cancelled */
+	if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_clear_error (&local_error);
+		return;
+	}
+
+	if (local_error) {
+		g_warning ("%s: Failed to get book view: %s", G_STRFUNC, local_error->message);
+		g_clear_error (&local_error);
+		return;
+	}
+
+	monitor->view = view;
+
+	fields = g_slist_prepend (fields, (gpointer) e_contact_field_name (E_CONTACT_EMAIL));
+	fields = g_slist_prepend (fields, (gpointer) e_contact_field_name (E_CONTACT_UID));
+	e_book_client_view_set_fields_of_interest (view, fields, NULL);
+	g_slist_free (fields);
+
+	g_signal_connect (
+		view, "objects-added",
+		G_CALLBACK (book_monitor_objects_changed_cb), monitor);
+	g_signal_connect (
+		view, "objects-modified",
+		G_CALLBACK (book_monitor_objects_changed_cb), monitor);
+	g_signal_connect (
+		view, "objects-removed",
+		G_CALLBACK (book_monitor_objects_removed_cb), monitor);
+	g_signal_connect (
+		view, "complete",
+		G_CALLBACK (book_monitor_complete_cb), monitor);
+
+	e_book_client_view_start (view, NULL);
+}
+
+static void
+photo_cache_contact_loader_client_created_cb (EClientCache *client_cache,
+                                              EClient *client,
+                                              EPhotoCacheContactLoader *loader)
+{
+	ESourceBackend *extension;
+	EBookQuery *book_query;
+	BookMonitor *monitor;
+	ESource *source;
+	gchar *sexp;
+
+	if (!E_IS_BOOK_CLIENT (client))
+		return;
+
+	source = e_client_get_source (client);
+
+	if (!g_hash_table_contains (loader->priv->photo_sources, source) ||
+	    g_hash_table_contains (loader->priv->book_monitors, source))
+		return;
+
+	/* Do not download the whole directory, only the books which
+	 * have their contacts at hand are watched */
+	extension = e_source_get_extension (source, E_SOURCE_EXTENSION_ADDRESS_BOOK);
+	if (g_strcmp0 (e_source_backend_get_backend_name (extension), "ldap") == 0)
+		return;
+
+	monitor = g_slice_new0 (BookMonitor);
+	monitor->loader = loader;
+	monitor->cancellable = g_cancellable_new ();
+	monitor->uid_emails = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+
+	g_hash_table_insert (loader->priv->book_monitors, g_object_ref (source), monitor);
+
+	book_query = e_book_query_field_exists (E_CONTACT_EMAIL);
+	sexp = e_book_query_to_string (book_query);
+	e_book_query_unref (book_query);
+
+	e_book_client_get_view (E_BOOK_CLIENT (client), sexp, monitor->cancellable, book_monitor_view_ready_cb, monitor);
+	g_free (sexp);
+}
+
 static void
 photo_cache_contact_loader_add_source (EPhotoCacheContactLoader *loader,
                                        ESource *source)
@@ -85,6 +308,8 @@ photo_cache_contact_loader_remove_source (EPhotoCacheContactLoader *loader,
 		e_photo_cache_remove_photo_source (photo_cache, photo_source);
 		g_hash_table_remove (hash_table, source);
 	}
+
+	g_hash_table_remove (loader->priv->book_monitors, source);
 }
 
 static void
@@ -132,7 +357,17 @@ photo_cache_contact_loader_dispose (GObject *object)
 
 	g_clear_object (&priv->registry);
 
+	if (priv->client_created_handler_id > 0) {
+		g_signal_handler_disconnect (
+			priv->client_cache,
+			priv->client_created_handler_id);
+		priv->client_created_handler_id = 0;
+	}
+
+	g_clear_object (&priv->client_cache);
+
 	g_hash_table_remove_all (priv->photo_sources);
+	g_hash_table_remove_all (priv->book_monitors);
 
 	/* Chain up to parent's dispose() method. */
 	G_OBJECT_CLASS (e_photo_cache_contact_loader_parent_class)->
@@ -147,6 +382,7 @@ photo_cache_contact_loader_finalize (GObject *object)
 	priv = E_PHOTO_CACHE_CONTACT_LOADER_GET_PRIVATE (object);
 
 	g_hash_table_destroy (priv->photo_sources);
+	g_hash_table_destroy (priv->book_monitors);
 
 	/* Chain up to parent's finalize() method. */
 	G_OBJECT_CLASS (e_photo_cache_contact_loader_parent_class)->
@@ -181,8 +417,6 @@ photo_cache_contact_loader_constructed (GObject *object)
 		photo_cache_contact_loader_add_source (loader, source);
 	}
 
-	g_list_free_full (list, (GDestroyNotify) g_object_unref);
-
 	loader->priv->registry = g_object_ref (registry);
 
 	handler_id = g_signal_connect (
@@ -197,6 +431,30 @@ photo_cache_contact_loader_constructed (GObject *object)
 		loader);
 	loader->priv->source_removed_handler_id = handler_id;
 
+	loader->priv->client_cache = g_object_ref (client_cache);
+
+	handler_id = g_signal_connect (
+		client_cache, "client-created",
+		G_CALLBACK (photo_cache_contact_loader_client_created_cb),
+		loader);
+	loader->priv->client_created_handler_id = handler_id;
+
+	/* Monitor also the books opened before the loader was created. */
+	for (link = list; link != NULL; link = g_list_next (link)) {
+		ESource *source = E_SOURCE (link->data);
+		EClient *client;
+
+		client = e_client_cache_ref_cached_client (
+			client_cache, source, extension_name);
+		if (client != NULL) {
+			photo_cache_contact_loader_client_created_cb (
+				client_cache, client, loader);
+			g_object_unref (client);
+		}
+	}
+
+	g_list_free_full (list, (GDestroyNotify) g_object_unref);
+
 	g_object_unref (client_cache);
 	g_object_unref (registry);
 }
@@ -228,6 +486,7 @@ static void
 e_photo_cache_contact_loader_init (EPhotoCacheContactLoader *loader)
 {
 	GHashTable *photo_sources;
+	GHashTable *book_monitors;
 
 	photo_sources = g_hash_table_new_full (
 		(GHashFunc) e_source_hash,
@@ -235,8 +494,15 @@ e_photo_cache_contact_loader_init (EPhotoCacheContactLoader *loader)
 		(GDestroyNotify) g_object_unref,
 		(GDestroyNotify) g_object_unref);
 
+	book_monitors = g_hash_table_new_full (
+		(GHashFunc) e_source_hash,
+		(GEqualFunc) e_source_equal,
+		(GDestroyNotify) g_object_unref,
+		(GDestroyNotify) book_monitor_free);
+
 	loader->priv = E_PHOTO_CACHE_CONTACT_LOADER_GET_PRIVATE (loader);
 	loader->priv->photo_sources = photo_sources;
+	loader->priv->book_monitors = book_monitors;
 }
 
 void
@@ -92,6 +92,9 @@ empe_itip_parse (EMailParserExtension *extension,
 		itip_part->vcalendar = g_strndup (
 			(gchar *) byte_array->data, byte_array->len);
 
+	/* Look up the components while the part is being formatted */
+	itip_view_prefetch_components (itip_part->vcalendar);
+
 	g_object_unref (stream);
 
 	g_queue_push_tail (&work_queue, itip_part);
@@ -3929,78 +3929,586 @@ decrease_find_data (FormatItipFindData *fd)
 	}
 }
 
+/* Lookups of the existing components are shared by all ItipView-s.
+ * Requests for one calendar are collected for a short time and then
+ * answered by a single object list query, thus a flood of updates of
+ * the same meetings does not query each calendar again and again.
+ * The answers are kept only for one burst, long enough for the views
+ * of the pre-fetched messages to pick them, because nothing tells
+ * about the changes done in the calendars meanwhile. */
+
+#define ITIP_LOOKUP_BATCH_DELAY_MSEC		50
+#define ITIP_LOOKUP_BATCH_MAX_UIDS		100
+#define ITIP_LOOKUP_CACHE_BURST_SECONDS		5
+#define ITIP_LOOKUP_CACHE_PRUNE_SIZE		1000
+
+/* The @icalcomp is owned by the callee; it is NULL when the component
+ * does not exist in the calendar or when the lookup had been cancelled. */
+typedef void (* ItipLookupDoneFunc)	(ECalClient *cal_client,
+					 icalcomponent *icalcomp,
+					 gboolean cancelled,
+					 gpointer user_data);
+
+typedef struct _ItipLookupEntry {
+	icalcomponent *icalcomp; /* NULL when the component does not exist */
+	gint64 expires;
+} ItipLookupEntry;
+
+typedef struct _ItipLookupRequest {
+	gchar *uid;
+	gchar *rid;
+	GCancellable *cancellable;
+	ItipLookupDoneFunc done_func; /* NULL when only pre-fetching */
+	gpointer user_data;
+} ItipLookupRequest;
+
+typedef struct _ItipLookupBatch {
+	ECalClient *cal_client;
+	GHashTable *uids;
+	GSList *requests; /* ItipLookupRequest * */
+	guint timeout_id;
+} ItipLookupBatch;
+
+/* "source-uid\nuid\nrid" ~> ItipLookupEntry * */
+static GHashTable *itip_lookup_cache = NULL;
+/* ECalClient * ~> ItipLookupBatch *, for the batches not submitted yet */
+static GHashTable *itip_lookup_batches = NULL;
+
+static gchar *
+itip_lookup_make_key (ECalClient *cal_client,
+		      const gchar *uid,
+		      const gchar *rid)
+{
+	ESource *source;
+
+	source = e_client_get_source (E_CLIENT (cal_client));
+
+	return g_strconcat (e_source_get_uid (source), "\n", uid, "\n", rid ? rid : "", NULL);
+}
+
+static gchar *
+itip_lookup_dup_rid (icalcomponent *icalcomp)
+{
+	icalproperty *prop;
+	struct icaltimetype rid;
+
+	prop = icalcomponent_get_first_property (icalcomp, ICAL_RECURRENCEID_PROPERTY);
+	if (!prop)
+		return NULL;
+
+	rid = icalproperty_get_recurrenceid (prop);
+	if (icaltime_is_null_time (rid) || !icaltime_is_valid_time (rid))
+		return NULL;
+
+	return g_strdup (icaltime_as_ical_string (rid));
+}
+
 static void
-get_object_without_rid_ready_cb (GObject *source_object,
-                                 GAsyncResult *result,
-                                 gpointer user_data)
+itip_lookup_entry_free (gpointer ptr)
 {
-	ECalClient *cal_client = E_CAL_CLIENT (source_object);
-	FormatItipFindData *fd = user_data;
-	icalcomponent *icalcomp = NULL;
-	GError *error = NULL;
+	ItipLookupEntry *entry = ptr;
 
-	e_cal_client_get_object_finish (cal_client, result, &icalcomp, &error);
+	if (entry) {
+		if (entry->icalcomp)
+			icalcomponent_free (entry->icalcomp);
+		g_free (entry);
+	}
+}
 
-	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) ||
-	    g_cancellable_is_cancelled (fd->cancellable)) {
-		g_clear_error (&error);
-		find_cal_update_ui (fd, cal_client);
-		decrease_find_data (fd);
+static void
+itip_lookup_request_free (gpointer ptr)
+{
+	ItipLookupRequest *request = ptr;
+
+	if (request) {
+		g_clear_object (&request->cancellable);
+		g_free (request->uid);
+		g_free (request->rid);
+		g_free (request);
+	}
+}
+
+static void
+itip_lookup_batch_free (ItipLookupBatch *batch)
+{
+	if (batch) {
+		if (batch->timeout_id)
+			g_source_remove (batch->timeout_id);
+		g_slist_free_full (batch->requests, itip_lookup_request_free);
+		g_hash_table_destroy (batch->uids);
+		g_object_unref (batch->cal_client);
+		g_free (batch);
+	}
+}
+
+static gboolean
+itip_lookup_entry_expired_cb (gpointer key,
+			      gpointer value,
+			      gpointer user_data)
+{
+	ItipLookupEntry *entry = value;
+	const gint64 *now = user_data;
+
+	return entry->expires <= *now;
+}
+
+/* Returns whether the answer is known; the @out_icalcomp is set to a copy
+ * of the stored component, or to NULL, when it is not in the calendar. */
+static gboolean
+itip_lookup_cache_get (ECalClient *cal_client,
+		       const gchar *uid,
+		       const gchar *rid,
+		       icalcomponent **out_icalcomp)
+{
+	ItipLookupEntry *entry;
+	gchar *key;
+
+	key = itip_lookup_make_key (cal_client, uid, rid);
+	entry = g_hash_table_lookup (itip_lookup_cache, key);
+
+	if (entry && entry->expires <= g_get_monotonic_time ()) {
+		g_hash_table_remove (itip_lookup_cache, key);
+		entry = NULL;
+	}
+
+	g_free (key);
+
+	if (!entry)
+		return FALSE;
+
+	*out_icalcomp = entry->icalcomp ? icalcomponent_new_clone (entry->icalcomp) : NULL;
+
+	return TRUE;
+}
+
+static void
+itip_lookup_cache_put (ECalClient *cal_client,
+		       const gchar *uid,
+		       const gchar *rid,
+		       icalcomponent *icalcomp)
+{
+	ItipLookupEntry *entry;
+	gint64 now;
+
+	now = g_get_monotonic_time ();
+
+	if (g_hash_table_size (itip_lookup_cache) >= ITIP_LOOKUP_CACHE_PRUNE_SIZE)
+		g_hash_table_foreach_remove (itip_lookup_cache, itip_lookup_entry_expired_cb, &now);
+
+	entry = g_new0 (ItipLookupEntry, 1);
+	entry->icalcomp = icalcomp ? icalcomponent_new_clone (icalcomp) : NULL;
+	entry->expires = now + ITIP_LOOKUP_CACHE_BURST_SECONDS * G_USEC_PER_SEC;
+
+	g_hash_table_insert (itip_lookup_cache, itip_lookup_make_key (cal_client, uid, rid), entry);
+}
+
+/* Forgets everything known about the @uid, in all calendars; called
+ * whenever the view itself changes the component in a calendar. */
+static void
+itip_lookup_cache_remove_uid (const gchar *uid)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gsize uid_len;
+
+	if (!itip_lookup_cache || !uid)
 		return;
+
+	uid_len = strlen (uid);
+
+	g_hash_table_iter_init (&iter, itip_lookup_cache);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		const gchar *ptr = strchr (key, '\n');
+
+		if (ptr && strncmp (ptr + 1, uid, uid_len) == 0 && ptr[uid_len + 1] == '\n')
+			g_hash_table_iter_remove (&iter);
 	}
+}
+
+static void
+itip_lookup_request_done (ECalClient *cal_client,
+			  icalcomponent *icalcomp,
+			  GCancellable *cancellable,
+			  ItipLookupDoneFunc done_func,
+			  gpointer user_data)
+{
+	gboolean cancelled;
+
+	cancelled = g_cancellable_is_cancelled (cancellable);
 
-	g_clear_error (&error);
+	if (icalcomp && (cancelled || !done_func)) {
+		icalcomponent_free (icalcomp);
+		icalcomp = NULL;
+	}
+
+	if (done_func)
+		done_func (cal_client, icalcomp, cancelled, user_data);
+}
+
+/* The same as asking the calendar for the component with the given RID
+ * and then for the master object, when no such instance exists. */
+static icalcomponent *
+itip_lookup_batch_resolve (GHashTable *found,
+			   const gchar *uid,
+			   const gchar *rid)
+{
+	icalcomponent *icalcomp;
+	gchar *key;
+
+	key = g_strconcat (uid, "\n", rid ? rid : "", NULL);
+	icalcomp = g_hash_table_lookup (found, key);
+	g_free (key);
+
+	if (icalcomp)
+		return icalcomponent_new_clone (icalcomp);
+
+	if (!rid || !*rid)
+		return NULL;
+
+	key = g_strconcat (uid, "\n", NULL);
+	icalcomp = g_hash_table_lookup (found, key);
+	g_free (key);
 
 	if (icalcomp) {
-		ECalComponent *comp;
+		icalcomponent *instance;
 
-		fd->view->priv->current_client = cal_client;
-		fd->keep_alarm_check = (fd->view->priv->method == ICAL_METHOD_PUBLISH || fd->view->priv->method == ICAL_METHOD_REQUEST) &&
-			(icalcomponent_get_first_component (icalcomp, ICAL_VALARM_COMPONENT) ||
-			icalcomponent_get_first_component (icalcomp, ICAL_XAUDIOALARM_COMPONENT) ||
-			icalcomponent_get_first_component (icalcomp, ICAL_XDISPLAYALARM_COMPONENT) ||
-			icalcomponent_get_first_component (icalcomp, ICAL_XPROCEDUREALARM_COMPONENT) ||
-			icalcomponent_get_first_component (icalcomp, ICAL_XEMAILALARM_COMPONENT));
+		instance = e_cal_util_construct_instance (icalcomp, icaltime_from_string (rid));
 
-		comp = e_cal_component_new_from_icalcomponent (icalcomp);
-		if (comp) {
-			ESource *source = e_client_get_source (E_CLIENT (cal_client));
+		return instance ? instance : icalcomponent_new_clone (icalcomp);
+	}
 
-			g_hash_table_insert (fd->view->priv->real_comps, g_strdup (e_source_get_uid (source)), comp);
+	return NULL;
+}
+
+static void
+itip_lookup_batch_done_cb (GObject *source_object,
+			   GAsyncResult *result,
+			   gpointer user_data)
+{
+	ItipLookupBatch *batch = user_data;
+	GHashTable *found;
+	GSList *icalcomps = NULL, *link;
+	GError *local_error = NULL;
+
+	e_cal_client_get_object_list_finish (batch->cal_client, result, &icalcomps, &local_error);
+
+	/* "uid\nrid" ~> icalcomponent *, owned by the icalcomps */
+	found = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (link = icalcomps; link; link = g_slist_next (link)) {
+		icalcomponent *icalcomp = link->data;
+		const gchar *uid;
+		gchar *rid;
+
+		uid = icalcomponent_get_uid (icalcomp);
+		if (!uid)
+			continue;
+
+		rid = itip_lookup_dup_rid (icalcomp);
+
+		g_hash_table_insert (found, g_strconcat (uid, "\n", rid ? rid : "", NULL), icalcomp);
+		itip_lookup_cache_put (batch->cal_client, uid, rid, icalcomp);
+
+		g_free (rid);
+	}
+
+	for (link = batch->requests; link; link = g_slist_next (link)) {
+		ItipLookupRequest *request = link->data;
+		icalcomponent *icalcomp = NULL;
+
+		/* Failures are not remembered, the next view will try again */
+		if (!local_error) {
+			icalcomp = itip_lookup_batch_resolve (found, request->uid, request->rid);
+			itip_lookup_cache_put (batch->cal_client, request->uid, request->rid, icalcomp);
 		}
 
-		find_cal_update_ui (fd, cal_client);
-		decrease_find_data (fd);
-		return;
+		itip_lookup_request_done (batch->cal_client, icalcomp, request->cancellable,
+			request->done_func, request->user_data);
 	}
 
-	find_cal_update_ui (fd, cal_client);
-	decrease_find_data (fd);
+	g_hash_table_destroy (found);
+	e_cal_client_free_icalcomp_slist (icalcomps);
+	g_clear_error (&local_error);
+
+	itip_lookup_batch_free (batch);
 }
 
 static void
-get_object_with_rid_ready_cb (GObject *source_object,
-                              GAsyncResult *result,
-                              gpointer user_data)
+itip_lookup_batch_submit (ItipLookupBatch *batch)
 {
-	ECalClient *cal_client = E_CAL_CLIENT (source_object);
-	FormatItipFindData *fd = user_data;
+	GHashTableIter iter;
+	GString *sexp;
+	gpointer key;
+
+	g_hash_table_remove (itip_lookup_batches, batch->cal_client);
+
+	if (batch->timeout_id) {
+		g_source_remove (batch->timeout_id);
+		batch->timeout_id = 0;
+	}
+
+	batch->requests = g_slist_reverse (batch->requests);
+
+	sexp = g_string_new ("(or");
+
+	g_hash_table_iter_init (&iter, batch->uids);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		g_string_append (sexp, " (uid? ");
+		e_sexp_encode_string (sexp, key);
+		g_string_append_c (sexp, ')');
+	}
+
+	g_string_append_c (sexp, ')');
+
+	e_cal_client_get_object_list (
+		batch->cal_client, sexp->str, NULL,
+		itip_lookup_batch_done_cb, batch);
+
+	g_string_free (sexp, TRUE);
+}
+
+static gboolean
+itip_lookup_batch_timeout_cb (gpointer user_data)
+{
+	ItipLookupBatch *batch = user_data;
+
+	batch->timeout_id = 0;
+
+	itip_lookup_batch_submit (batch);
+
+	return FALSE;
+}
+
+static void
+itip_lookup_queue (ECalClient *cal_client,
+		   const gchar *uid,
+		   const gchar *rid,
+		   GCancellable *cancellable,
+		   ItipLookupDoneFunc done_func,
+		   gpointer user_data)
+{
+	ItipLookupBatch *batch;
+	ItipLookupRequest *request;
 	icalcomponent *icalcomp = NULL;
-	GError *error = NULL;
 
-	e_cal_client_get_object_finish (cal_client, result, &icalcomp, &error);
+	g_return_if_fail (E_IS_CAL_CLIENT (cal_client));
+	g_return_if_fail (uid != NULL);
 
-	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) ||
-	    g_cancellable_is_cancelled (fd->cancellable)) {
-		g_clear_error (&error);
-		find_cal_update_ui (fd, cal_client);
-		decrease_find_data (fd);
+	if (!itip_lookup_cache) {
+		itip_lookup_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, itip_lookup_entry_free);
+		itip_lookup_batches = g_hash_table_new (g_direct_hash, g_direct_equal);
+	}
+
+	if (itip_lookup_cache_get (cal_client, uid, rid, &icalcomp)) {
+		itip_lookup_request_done (cal_client, icalcomp, cancellable, done_func, user_data);
 		return;
 	}
 
-	g_clear_error (&error);
+	batch = g_hash_table_lookup (itip_lookup_batches, cal_client);
+	if (!batch) {
+		batch = g_new0 (ItipLookupBatch, 1);
+		batch->cal_client = g_object_ref (cal_client);
+		batch->uids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		batch->timeout_id = e_named_timeout_add (
+			ITIP_LOOKUP_BATCH_DELAY_MSEC,
+			itip_lookup_batch_timeout_cb, batch);
 
-	if (icalcomp) {
+		g_hash_table_insert (itip_lookup_batches, cal_client, batch);
+	}
+
+	request = g_new0 (ItipLookupRequest, 1);
+	request->uid = g_strdup (uid);
+	request->rid = g_strdup (rid);
+	request->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+	request->done_func = done_func;
+	request->user_data = user_data;
+
+	batch->requests = g_slist_prepend (batch->requests, request);
+
+	if (!g_hash_table_contains (batch->uids, uid))
+		g_hash_table_add (batch->uids, g_strdup (uid));
+
+	if (g_hash_table_size (batch->uids) >= ITIP_LOOKUP_BATCH_MAX_UIDS)
+		itip_lookup_batch_submit (batch);
+}
+
+typedef struct _ItipPrefetchData {
+	gint ref_count;
+	ECalClientSourceType type;
+	GSList *ids; /* ECalComponentId * */
+} ItipPrefetchData;
+
+static ItipPrefetchData *
+itip_prefetch_data_ref (ItipPrefetchData *pd)
+{
+	pd->ref_count++;
+
+	return pd;
+}
+
+static void
+itip_prefetch_data_unref (gpointer ptr)
+{
+	ItipPrefetchData *pd = ptr;
+
+	if (pd && !--pd->ref_count) {
+		g_slist_free_full (pd->ids, (GDestroyNotify) e_cal_component_free_id);
+		g_free (pd);
+	}
+}
+
+static void
+itip_prefetch_client_opened_cb (GObject *source_object,
+				GAsyncResult *result,
+				gpointer user_data)
+{
+	ItipPrefetchData *pd = user_data;
+	EClient *client;
+	GSList *link;
+
+	client = e_client_cache_get_client_finish (E_CLIENT_CACHE (source_object), result, NULL);
+
+	if (client && !e_client_is_readonly (client)) {
+		for (link = pd->ids; link; link = g_slist_next (link)) {
+			ECalComponentId *id = link->data;
+
+			itip_lookup_queue (E_CAL_CLIENT (client), id->uid, id->rid, NULL, NULL, NULL);
+		}
+	}
+
+	g_clear_object (&client);
+	itip_prefetch_data_unref (pd);
+}
+
+static gboolean
+itip_prefetch_idle_cb (gpointer user_data)
+{
+	GSList *prefetches = user_data, *link;
+	EShell *shell;
+	EClientCache *client_cache;
+	ESourceRegistry *registry;
+
+	shell = e_shell_get_default ();
+	client_cache = shell ? e_shell_get_client_cache (shell) : NULL;
+	registry = client_cache ? e_client_cache_ref_registry (client_cache) : NULL;
+
+	for (link = registry ? prefetches : NULL; link; link = g_slist_next (link)) {
+		ItipPrefetchData *pd = link->data;
+		const gchar *extension_name;
+		GList *sources, *slink;
+
+		switch (pd->type) {
+			case E_CAL_CLIENT_SOURCE_TYPE_EVENTS:
+				extension_name = E_SOURCE_EXTENSION_CALENDAR;
+				break;
+			case E_CAL_CLIENT_SOURCE_TYPE_TASKS:
+				extension_name = E_SOURCE_EXTENSION_TASK_LIST;
+				break;
+			case E_CAL_CLIENT_SOURCE_TYPE_MEMOS:
+				extension_name = E_SOURCE_EXTENSION_MEMO_LIST;
+				break;
+			default:
+				continue;
+		}
+
+		sources = e_source_registry_list_enabled (registry, extension_name);
+
+		for (slink = sources; slink; slink = g_list_next (slink)) {
+			e_client_cache_get_client (
+				client_cache, slink->data, extension_name, 30, NULL,
+				itip_prefetch_client_opened_cb, itip_prefetch_data_ref (pd));
+		}
+
+		g_list_free_full (sources, g_object_unref);
+	}
+
+	g_clear_object (&registry);
+	g_slist_free_full (prefetches, itip_prefetch_data_unref);
+
+	return FALSE;
+}
+
+/**
+ * itip_view_prefetch_components:
+ * @vcalendar: a text of an iCalendar object
+ *
+ * Starts looking up the components of the @vcalendar in the calendars,
+ * thus the answers are ready when an #ItipView for them is shown. The
+ * function can be called from any thread.
+ **/
+void
+itip_view_prefetch_components (const gchar *vcalendar)
+{
+	icalcomponent *icalcomp, *subcomp;
+	ItipPrefetchData *per_type[3] = { NULL, NULL, NULL };
+	GSList *prefetches = NULL;
+	guint ii;
+
+	if (!vcalendar || !*vcalendar)
+		return;
+
+	icalcomp = icalparser_parse_string (vcalendar);
+	if (!icalcomp)
+		return;
+
+	for (subcomp = icalcomponent_get_first_component (icalcomp, ICAL_ANY_COMPONENT);
+	     subcomp;
+	     subcomp = icalcomponent_get_next_component (icalcomp, ICAL_ANY_COMPONENT)) {
+		ECalClientSourceType type;
+		ECalComponentId *id;
+		const gchar *uid;
+
+		switch (icalcomponent_isa (subcomp)) {
+			case ICAL_VEVENT_COMPONENT:
+				type = E_CAL_CLIENT_SOURCE_TYPE_EVENTS;
+				break;
+			case ICAL_VTODO_COMPONENT:
+				type = E_CAL_CLIENT_SOURCE_TYPE_TASKS;
+				break;
+			case ICAL_VJOURNAL_COMPONENT:
+				type = E_CAL_CLIENT_SOURCE_TYPE_MEMOS;
+				break;
+			default:
+				continue;
+		}
+
+		uid = icalcomponent_get_uid (subcomp);
+		if (!uid || !*uid)
+			continue;
+
+		if (!per_type[type]) {
+			per_type[type] = g_new0 (ItipPrefetchData, 1);
+			per_type[type]->ref_count = 1;
+			per_type[type]->type = type;
+		}
+
+		id = g_new0 (ECalComponentId, 1);
+		id->uid = g_strdup (uid);
+		id->rid = itip_lookup_dup_rid (subcomp);
+
+		per_type[type]->ids = g_slist_prepend (per_type[type]->ids, id);
+	}
+
+	icalcomponent_free (icalcomp);
+
+	for (ii = 0; ii < G_N_ELEMENTS (per_type); ii++) {
+		if (per_type[ii])
+			prefetches = g_slist_prepend (prefetches, per_type[ii]);
+	}
+
+	if (prefetches)
+		g_idle_add (itip_prefetch_idle_cb, prefetches);
+}
+
+static void
+find_cal_object_done_cb (ECalClient *cal_client,
+			 icalcomponent *icalcomp,
+			 gboolean cancelled,
+			 gpointer user_data)
+{
+	FormatItipFindData *fd = user_data;
+
+	if (!cancelled && !g_cancellable_is_cancelled (fd->cancellable) && icalcomp) {
 		ECalComponent *comp;
 
 		fd->view->priv->current_client = cal_client;
@@ -4017,15 +4525,8 @@ get_object_with_rid_ready_cb (GObject *source_object,
 
 			g_hash_table_insert (fd->view->priv->real_comps, g_strdup (e_source_get_uid (source)), comp);
 		}
-
-		find_cal_update_ui (fd, cal_client);
-		decrease_find_data (fd);
-		return;
-	}
-
-	if (fd->rid && *fd->rid) {
-		e_cal_client_get_object (cal_client, fd->uid, NULL, fd->cancellable, get_object_without_rid_ready_cb, fd);
-		return;
+	} else if (icalcomp) {
+		icalcomponent_free (icalcomp);
 	}
 
 	find_cal_update_ui (fd, cal_client);
@@ -4063,9 +4564,9 @@ get_object_list_ready_cb (GObject *source_object,
 		g_hash_table_insert (fd->conflicts, cal_client, objects);
 	}
 
-	e_cal_client_get_object (
+	itip_lookup_queue (
 		cal_client, fd->uid, fd->rid, fd->cancellable,
-		get_object_with_rid_ready_cb, fd);
+		find_cal_object_done_cb, fd);
 }
 
 static void
@@ -4146,10 +4647,10 @@ find_cal_opened_cb (GObject *source_object,
 	}
 
 	if (!view->priv->current_client) {
-		e_cal_client_get_object (
+		itip_lookup_queue (
 			cal_client, fd->uid, fd->rid,
 			fd->cancellable,
-			get_object_with_rid_ready_cb, fd);
+			find_cal_object_done_cb, fd);
 		return;
 	}
 
@@ -4658,6 +5159,8 @@ receive_objects_ready_cb (GObject *ecalclient,
 		return;
 	}
 
+	itip_lookup_cache_remove_uid (icalcomponent_get_uid (view->priv->ical_comp));
+
 	itip_view_set_extension_name (view, NULL);
 
 	itip_view_clear_lower_info_items (view);
@@ -5009,6 +5512,8 @@ modify_object_cb (GObject *ecalclient,
 		g_error_free (error);
 
 	} else {
+		itip_lookup_cache_remove_uid (icalcomponent_get_uid (view->priv->ical_comp));
+
 		update_item_progress_info (view, NULL);
 		itip_view_add_lower_info_item (
 			view, ITIP_VIEW_INFO_ITEM_TYPE_INFO,
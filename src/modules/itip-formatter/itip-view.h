@@ -252,6 +252,7 @@ void		itip_view_set_error		(ItipView *view,
 						 gboolean show_save_btn);
 GDBusProxy *	itip_view_get_web_extension_proxy
 						(ItipView *view);
+void		itip_view_prefetch_components	(const gchar *vcalendar);
 
 G_END_DECLS
 
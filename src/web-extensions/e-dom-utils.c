@@ -1054,6 +1054,24 @@ e_dom_utils_eab_contact_formatter_bind_dom (WebKitDOMDocument *document)
 		document);
 }
 
+/* Shows another contact in the already loaded preview, without loading
+ * the whole page again; the header and the style sheets stay the same. */
+void
+e_dom_utils_eab_contact_formatter_replace_body (WebKitDOMDocument *document,
+                                                const gchar *html)
+{
+	WebKitDOMHTMLElement *body;
+
+	body = webkit_dom_document_get_body (document);
+	if (!body)
+		return;
+
+	webkit_dom_element_set_inner_html (WEBKIT_DOM_ELEMENT (body), html, NULL);
+
+	e_dom_utils_replace_local_image_links (document);
+	e_dom_utils_eab_contact_formatter_bind_dom (document);
+}
+
 /* ! This function can be called only from WK2 web-extension ! */
 WebKitDOMElement *
 e_dom_utils_find_element_by_selector (WebKitDOMDocument *document,
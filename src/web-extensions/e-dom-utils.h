@@ -60,6 +60,9 @@ void		e_dom_utils_add_css_rule_into_style_sheet
 						 const gchar *style);
 void		e_dom_utils_eab_contact_formatter_bind_dom
 						(WebKitDOMDocument *document);
+void		e_dom_utils_eab_contact_formatter_replace_body
+						(WebKitDOMDocument *document,
+						 const gchar *html);
 void		e_dom_resize_document_content_to_preview_width
 						(WebKitDOMDocument *document);
 void		e_dom_utils_e_mail_display_bind_dom
@@ -129,6 +129,10 @@ static const char introspection_xml[] =
 "    <method name='EABContactFormatterBindDOM'>"
 "      <arg type='t' name='page_id' direction='in'/>"
 "    </method>"
+"    <method name='EABContactFormatterReplaceBody'>"
+"      <arg type='t' name='page_id' direction='in'/>"
+"      <arg type='s' name='html' direction='in'/>"
+"    </method>"
 "    <method name='EMailDisplayBindDOM'>"
 "      <arg type='t' name='page_id' direction='in'/>"
 "    </method>"
@@ -840,6 +844,19 @@ handle_method_call (GDBusConnection *connection,
 		document = webkit_web_page_get_dom_document (web_page);
 		e_dom_utils_eab_contact_formatter_bind_dom (document);
 
+		g_dbus_method_invocation_return_value (invocation, NULL);
+	} else if (g_strcmp0 (method_name, "EABContactFormatterReplaceBody") == 0) {
+		const gchar *html;
+
+		g_variant_get (parameters, "(t&s)", &page_id, &html);
+		web_page = get_webkit_web_page_or_return_dbus_error (
+			invocation, web_extension, page_id);
+		if (!web_page)
+			return;
+
+		document = webkit_web_page_get_dom_document (web_page);
+		e_dom_utils_eab_contact_formatter_replace_body (document, html);
+
 		g_dbus_method_invocation_return_value (invocation, NULL);
 	} else if (g_strcmp0 (method_name, "EMailDisplayBindDOM") == 0) {
 		g_variant_get (parameters, "(t)", &page_id);